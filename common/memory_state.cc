@@ -16,6 +16,8 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <cstring>
 #include <optional>
 #include <string>
 #include <utility>
@@ -26,6 +28,7 @@
 #include "./common/mapped_memory_map.h"
 #include "./common/memory_mapping.h"
 #include "./common/memory_perms.h"
+#include "./common/paged_memory_bytes.h"
 #include "./common/snapshot.h"
 #include "./util/checks.h"
 #include "./util/itoa.h"
@@ -48,18 +51,20 @@ std::string MemoryState::MemoryMappingCmd::DebugString() const {
 
 // static
 MemoryState MemoryState::MakeInitial(const Snapshot& snapshot,
-                                     MappedZeroing mapped_zeroing) {
-  MemoryState r;
+                                     MappedZeroing mapped_zeroing,
+                                     ByteStorage byte_storage) {
+  MemoryState r(byte_storage);
   r.SetInitialState(snapshot, mapped_zeroing);
   return r;
 }
 
 // static
 MemoryState MemoryState::MakeEnd(const Snapshot& snapshot, int end_state_index,
-                                 MappedZeroing mapped_zeroing) {
+                                 MappedZeroing mapped_zeroing,
+                                 ByteStorage byte_storage) {
   DCHECK_GE(end_state_index, 0);
   DCHECK_LT(end_state_index, snapshot.expected_end_states().size());
-  MemoryState r;
+  MemoryState r(byte_storage);
   r.AddNewMemoryMappings(snapshot.memory_mappings());
   if (mapped_zeroing == kZeroMappedBytes) {
     // No filtering of what is zeroed is needed here: all mappings of
@@ -73,33 +78,54 @@ MemoryState MemoryState::MakeEnd(const Snapshot& snapshot, int end_state_index,
 
 // ----------------------------------------------------------------------- //
 
-MemoryState::MemoryState()
-    : mapped_memory_map_(), written_memory_set_(), written_memory_bytes_() {}
+MemoryState::MemoryState(ByteStorage byte_storage)
+    : mapped_memory_map_(),
+      written_memory_set_(),
+      byte_storage_(byte_storage),
+      written_memory_bytes_(),
+      paged_memory_bytes_() {}
 
 MemoryState::~MemoryState() {}
 
 MemoryState MemoryState::Copy() const {
-  MemoryState r;
+  MemoryState r(byte_storage_);
   r.mapped_memory_map_ = mapped_memory_map_.Copy();
   r.written_memory_set_ = written_memory_set_;
   r.written_memory_bytes_ = written_memory_bytes_;
+  // Only copies references to the pages.
+  r.paged_memory_bytes_ = paged_memory_bytes_;
   return r;
 }
 
 bool MemoryState::operator==(const MemoryState& y) const {
   return mapped_memory_map_ == y.mapped_memory_map_ &&
-         written_memory_bytes_ ==
-             y.written_memory_bytes_;  // covers written_memory_set_
+         MemoryBytesEq(y);  // covers written_memory_set_
 }
 
 bool MemoryState::MemoryBytesEq(const MemoryState& y) const {
-  return written_memory_bytes_ == y.written_memory_bytes_;
+  if (byte_storage_ == kRangeBytes && y.byte_storage_ == kRangeBytes) {
+    return written_memory_bytes_ == y.written_memory_bytes_;
+  }
+  if (written_memory_set_ != y.written_memory_set_) return false;
+  bool eq = true;
+  written_memory_set_.Iterate([this, &y, &eq](Address start, Address limit) {
+    for (Address addr = start; eq && addr < limit;) {
+      ByteSize x_size, y_size;
+      const char* x_data = ContiguousMemoryBytes(addr, &x_size);
+      const char* y_data = y.ContiguousMemoryBytes(addr, &y_size);
+      const ByteSize n = std::min({x_size, y_size, limit - addr});
+      // Shared pages need no comparison.
+      eq = x_data == y_data || memcmp(x_data, y_data, n) == 0;
+      addr += n;
+    }
+  });
+  return eq;
 }
 
 bool MemoryState::IsEmpty() const {
   // mapped_memory_map_.IsEmpty() actually implies the rest.
   return mapped_memory_map_.IsEmpty() && written_memory_set_.empty() &&
-         written_memory_bytes_.empty();
+         written_memory_bytes_.empty() && paged_memory_bytes_.empty();
 }
 
 // ----------------------------------------------------------------------- //
@@ -128,7 +154,11 @@ void MemoryState::RemoveMemoryMapping(Address start_address,
                                       Address limit_address) {
   mapped_memory_map_.Remove(start_address, limit_address);
   written_memory_set_.Remove(start_address, limit_address);
-  written_memory_bytes_.Remove(start_address, limit_address, ByteData());
+  if (byte_storage_ == kPagedBytes) {
+    paged_memory_bytes_.Remove(start_address, limit_address);
+  } else {
+    written_memory_bytes_.Remove(start_address, limit_address, ByteData());
+  }
 }
 
 void MemoryState::RemoveMemoryMappingsNotIn(const Snapshot& snapshot) {
@@ -153,12 +183,29 @@ void MemoryState::SetMemoryBytes(const MemoryBytes& bytes) {
   DCHECK(mapped_memory_map_.Contains(bytes.start_address(),
                                      bytes.limit_address()));
   written_memory_set_.Add(bytes.start_address(), bytes.limit_address());
-  written_memory_bytes_.Add(bytes.start_address(), bytes.limit_address(),
-                            bytes.byte_values());
+  if (byte_storage_ == kPagedBytes) {
+    paged_memory_bytes_.Write(bytes.start_address(), bytes.byte_values().data(),
+                              bytes.num_bytes());
+  } else {
+    written_memory_bytes_.Add(bytes.start_address(), bytes.limit_address(),
+                              bytes.byte_values());
+  }
+}
+
+void MemoryState::SetZeroMemoryBytes(Address start_address,
+                                     Address limit_address) {
+  if (byte_storage_ == kPagedBytes) {
+    written_memory_set_.Add(start_address, limit_address);
+    paged_memory_bytes_.WriteZeros(start_address, limit_address);
+  } else {
+    SetMemoryBytes(MemoryBytes(start_address,
+                               ByteData(limit_address - start_address, '\0')));
+  }
 }
 
 void MemoryState::ForgetMemoryBytes(Address start_address,
                                     Address limit_address) {
+  if (byte_storage_ == kPagedBytes) return;
   written_memory_bytes_.Remove(start_address, limit_address, ByteData());
 }
 
@@ -168,8 +215,9 @@ void MemoryState::SetMemoryBytes(const Snapshot& snapshot) {
 
 void MemoryState::ZeroMappedMemoryBytes(const MemoryMapping& mapping) {
   DCHECK(!mapping.perms().IsEmpty());
-  SetMemoryBytes(MemoryBytes(mapping.start_address(),
-                             ByteData(mapping.num_bytes(), '\0')));
+  DCHECK(mapped_memory_map_.Contains(mapping.start_address(),
+                                     mapping.limit_address()));
+  SetZeroMemoryBytes(mapping.start_address(), mapping.limit_address());
 }
 
 void MemoryState::SetInitialState(const Snapshot& snapshot,
@@ -205,7 +253,7 @@ void MemoryState::SetInitialState(const Snapshot& snapshot,
     // in `snapshot` that did not exist before this SetInitialState() call:
     new_mappings.Iterate(
         [this](Address start, Address limit, MemoryPerms perms) {
-          SetMemoryBytes(MemoryBytes(start, ByteData(limit - start, '\0')));
+          SetZeroMemoryBytes(start, limit);
         });
   }
   SetMemoryBytes(snapshot);
@@ -231,6 +279,11 @@ char MemoryState::memory_byte(Address address) const {
 
 MemoryState::ByteData MemoryState::memory_bytes(Address start_address,
                                                 ByteSize num_bytes) const {
+  if (byte_storage_ == kPagedBytes) {
+    ByteData r(num_bytes, '\0');
+    paged_memory_bytes_.Read(start_address, num_bytes, r.data());
+    return r;
+  }
   const auto limit_address = start_address + num_bytes;
   auto iters = written_memory_bytes_.Find(start_address, limit_address);
   // Precondition: exactly one range covers the request:
@@ -244,6 +297,31 @@ MemoryState::ByteData MemoryState::memory_bytes(Address start_address,
   return ByteData(it.value().data() + start_address - it.start(), num_bytes);
 }
 
+void MemoryState::CopyMemoryBytes(Address start_address, ByteSize num_bytes,
+                                  char* dest) const {
+  for (Address addr = start_address; addr < start_address + num_bytes;) {
+    ByteSize size;
+    const char* data = ContiguousMemoryBytes(addr, &size);
+    size = std::min(size, start_address + num_bytes - addr);
+    memcpy(dest, data, size);
+    dest += size;
+    addr += size;
+  }
+}
+
+const char* MemoryState::ContiguousMemoryBytes(Address address,
+                                               ByteSize* size) const {
+  if (byte_storage_ == kPagedBytes) {
+    const char* data = paged_memory_bytes_.Data(address, size);
+    DCHECK(data != nullptr);
+    return data;
+  }
+  auto it = written_memory_bytes_.FindAt(address);
+  DCHECK(it != written_memory_bytes_.end());
+  *size = it.limit() - address;
+  return it.value().data() + address - it.start();
+}
+
 MemoryState::MemoryBytesList MemoryState::memory_bytes_list(
     const MemoryBytesSet& bytes) const {
   MemoryBytesList r;
@@ -424,6 +502,7 @@ MemoryState::MemoryBytesList MemoryState::DeltaMemoryBytes(
                                        bytes.limit_address()));
   }
 
+  if (byte_storage_ == kPagedBytes) return DeltaPagedMemoryBytes(bytes);
   if (written_memory_bytes_.empty()) return {bytes};
 
   // Let's do the work to pass-through parts of `bytes` that differ or missing
@@ -506,6 +585,56 @@ MemoryState::MemoryBytesList MemoryState::DeltaMemoryBytes(
   return result;
 }
 
+MemoryState::MemoryBytesList MemoryState::DeltaPagedMemoryBytes(
+    const MemoryBytes& bytes) const {
+  // Same result as the kRangeBytes loop in DeltaMemoryBytes(), but a page
+  // chunk at a time: equal chunks are skipped with one memcmp() and bytes
+  // outside written_memory_set_ are passed through in one go.
+  MemoryBytesSet known;
+  known.Add(bytes.start_address(), bytes.limit_address());
+  known.Intersect(written_memory_set_);
+  if (known.empty()) return {bytes};
+
+  const auto& byte_values = bytes.byte_values();
+  MemoryBytesList result;
+  std::optional<MemoryBytes> chunk  // next candidate to add to `result`
+      = std::nullopt;
+  Address addr = bytes.start_address();
+  known.Iterate([&](Address start, Address limit) {
+    if (addr < start) {
+      GrowResultChunk(bytes, addr, start - addr, chunk, result);
+    }
+    for (addr = start; addr < limit;) {
+      ByteSize size;
+      const char* old_bytes = ContiguousMemoryBytes(addr, &size);
+      size = std::min(size, limit - addr);
+      const char* new_bytes =
+          byte_values.data() + (addr - bytes.start_address());
+      if (memcmp(old_bytes, new_bytes, size) != 0) {
+        // Pass runs of differing bytes through.
+        for (ByteSize i = 0; i < size;) {
+          if (old_bytes[i] == new_bytes[i]) {
+            ++i;
+            continue;
+          }
+          ByteSize j = i + 1;
+          while (j < size && old_bytes[j] != new_bytes[j]) ++j;
+          GrowResultChunk(bytes, addr + i, j - i, chunk, result);
+          i = j;
+        }
+      }
+      addr += size;
+    }
+  });
+  if (addr < bytes.limit_address()) {
+    GrowResultChunk(bytes, addr, bytes.limit_address() - addr, chunk, result);
+  }
+  if (chunk.has_value()) {
+    result.push_back(std::move(chunk).value());
+  }
+  return result;
+}
+
 MemoryState::MemoryBytesList MemoryState::DeltaMemoryBytes(
     const MemoryBytesList& bytes) const {
   if (DEBUG_MODE) {  // DCHECK disjointness of `bytes`
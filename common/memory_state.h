@@ -26,6 +26,7 @@
 #include "./common/mapped_memory_map.h"
 #include "./common/memory_mapping.h"
 #include "./common/memory_perms.h"
+#include "./common/paged_memory_bytes.h"
 #include "./common/snapshot.h"
 #include "./common/snapshot_types.h"
 #include "./util/checks.h"
@@ -72,25 +73,38 @@ class MemoryState : private SnapshotTypeNames {
   // should be happening or not for all the relevant mapped regions.
   enum MappedZeroing { kZeroMappedBytes, kIgnoreMappedBytes };
 
+  // How the values of written memory bytes are stored.
+  // kRangeBytes keeps a ByteData blob per written address range. Good for
+  // small states that are built once.
+  // kPagedBytes keeps copy-on-write pages (see PagedMemoryBytes). Copy() is
+  // O(number of pages) and SetMemoryBytes() only copies the pages it touches,
+  // which is much cheaper for large states that get copied and updated, e.g.
+  // once per end state of a snapshot.
+  // The two kinds behave the same with the exception of ForgetMemoryBytes().
+  enum ByteStorage { kRangeBytes, kPagedBytes };
+
   // ----------------------------------------------------------------------- //
   // Factories.
 
   // Returns state corresponding to the initial snapshot state.
   // See also SetInitialState().
   static MemoryState MakeInitial(const Snapshot& snapshot,
-                                 MappedZeroing mapped_zeroing);
+                                 MappedZeroing mapped_zeroing,
+                                 ByteStorage byte_storage = kRangeBytes);
 
   // Returns state corresponding to the given endstate in `snapshot`.
   // REQUIRES: end_state_index is in [0, snapshot.expected_end_states().size())
   static MemoryState MakeEnd(const Snapshot& snapshot, int end_state_index,
-                             MappedZeroing mapped_zeroing);
+                             MappedZeroing mapped_zeroing,
+                             ByteStorage byte_storage = kRangeBytes);
 
   // ----------------------------------------------------------------------- //
   // Construction, etc.
 
   // Creates an empty MemoryState.
   // PROVIDES: IsEmpty()
-  MemoryState();
+  MemoryState() : MemoryState(kRangeBytes) {}
+  explicit MemoryState(ByteStorage byte_storage);
   ~MemoryState();
 
   // Movable, but not copyable (can be large and expensive to copy by accident).
@@ -107,14 +121,18 @@ class MemoryState : private SnapshotTypeNames {
 
   // Equality constrained to all the data behind memory_bytes().
   // Note that mapped_memory() can be compared directly.
+  // States with different byte_storage() can be compared.
   bool MemoryBytesEq(const MemoryState& y) const;
 
   // Whether *this has no data.
   bool IsEmpty() const;
 
-  // Returns *this to empty state.
+  // Returns *this to empty state. Keeps byte_storage().
   // PROVIDES: IsEmpty()
-  void Clear() { *this = MemoryState(); }
+  void Clear() { *this = MemoryState(byte_storage_); }
+
+  // How *this stores memory bytes.
+  ByteStorage byte_storage() const { return byte_storage_; }
 
   // ----------------------------------------------------------------------- //
   // Mutators.
@@ -165,6 +183,8 @@ class MemoryState : private SnapshotTypeNames {
   // repeatedly split-up into three parts, middle chunk overwrittend, and
   // then the three parts merged back. Whereas with the pre-removal the added
   // chunks are appended to a growing ByteData blob.
+  // kPagedBytes updates bytes in place and does not need this, so it is a
+  // no-op for it.
   void ForgetMemoryBytes(Address start_address, Address limit_address);
 
   // SetMemoryBytes() for all snapshot.memory_bytes()
@@ -211,6 +231,11 @@ class MemoryState : private SnapshotTypeNames {
   // REQUIRES: the byte range requested is fully within written_memory().
   ByteData memory_bytes(Address start_address, ByteSize num_bytes) const;
 
+  // Like memory_bytes(), but copies the bytes into `dest` that must have room
+  // for `num_bytes`.
+  void CopyMemoryBytes(Address start_address, ByteSize num_bytes,
+                       char* dest) const;
+
   // Convenience helper reading and returning memory_bytes() for the ranges
   // of addresses in a MemoryBytesSet as MemoryBytesList.
   MemoryBytesList memory_bytes_list(const MemoryBytesSet& bytes) const;
@@ -340,6 +365,18 @@ class MemoryState : private SnapshotTypeNames {
       RangeMap<MemoryBytesMethods::Key, MemoryBytesMethods::Value,
                MemoryBytesMethods>;
 
+  // Returns a pointer to the byte value at `address` and sets `*size` to the
+  // number of following bytes readable through it, i.e. to the end of the
+  // written range or page that holds them.
+  // REQUIRES: `address` is inside written_memory().
+  const char* ContiguousMemoryBytes(Address address, ByteSize* size) const;
+
+  // Sets bytes in [start_address, limit_address) to 0.
+  void SetZeroMemoryBytes(Address start_address, Address limit_address);
+
+  // DeltaMemoryBytes(bytes) for kPagedBytes.
+  MemoryBytesList DeltaPagedMemoryBytes(const MemoryBytes& bytes) const;
+
   // Helper for DeltaMemoryBytes(): see .cc for the spec.
   // Declared here only to get short type names for MemoryBytes and such.
   static void GrowResultChunk(const MemoryBytes& bytes, Address addr,
@@ -353,9 +390,18 @@ class MemoryState : private SnapshotTypeNames {
   // Present only to support the written_memory() accessor.
   MemoryBytesSet written_memory_set_;
 
+  // See byte_storage().
+  ByteStorage byte_storage_;
+
   // The memory bytes in the set of known (written) memory.
   // Same set of address ranges as written_memory_set_.
+  // Only used for kRangeBytes.
   MemoryBytesMap written_memory_bytes_;
+
+  // Pages holding the bytes of written_memory_set_. Bytes outside of
+  // written_memory_set_ are meaningless.
+  // Only used for kPagedBytes.
+  PagedMemoryBytes paged_memory_bytes_;
 };
 
 // EnumStr() works for MemoryState::MemoryMappingCmd::Action.
@@ -0,0 +1,192 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests that MemoryState::kPagedBytes behaves like MemoryState::kRangeBytes.
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "./common/memory_mapping.h"
+#include "./common/memory_perms.h"
+#include "./common/memory_state.h"
+#include "./common/paged_memory_bytes.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
+#include "./common/snapshot_test_util.h"
+#include "./util/arch.h"
+#include "./util/itoa.h"
+#include "./util/misc_util.h"
+
+namespace silifuzz {
+namespace {
+
+using Address = Snapshot::Address;
+using MemoryBytes = Snapshot::MemoryBytes;
+using MemoryBytesList = Snapshot::MemoryBytesList;
+
+constexpr Address kPageSize = PagedMemoryBytes::kPageSize;
+constexpr Address kMappedSize = 16 * kPageSize;
+
+// Expects range-based `expected` and paged `actual` to hold the same state.
+void ExpectEquivalent(const MemoryState& expected, const MemoryState& actual) {
+  ASSERT_EQ(expected.byte_storage(), MemoryState::kRangeBytes);
+  ASSERT_EQ(actual.byte_storage(), MemoryState::kPagedBytes);
+  EXPECT_TRUE(expected.mapped_memory() == actual.mapped_memory());
+  ASSERT_EQ(expected.written_memory(), actual.written_memory());
+  EXPECT_EQ(expected.num_written_bytes(), actual.num_written_bytes());
+  EXPECT_EQ(expected.memory_bytes_list(expected.written_memory()),
+            actual.memory_bytes_list(actual.written_memory()));
+  EXPECT_TRUE(expected.MemoryBytesEq(actual));
+  EXPECT_TRUE(actual.MemoryBytesEq(expected));
+  EXPECT_TRUE(expected == actual);
+  EXPECT_TRUE(actual == expected);
+}
+
+// Returns `size` random bytes. Only uses a few values so that random bytes
+// often match existing ones.
+std::string RandomBytes(std::mt19937_64& gen, size_t size) {
+  std::uniform_int_distribution<int> byte_dist(0, 2);
+  std::string bytes(size, '\0');
+  for (char& c : bytes) c = byte_dist(gen);
+  return bytes;
+}
+
+// Returns a random [start, limit) range inside the mapped memory.
+std::pair<Address, Address> RandomRange(std::mt19937_64& gen) {
+  std::uniform_int_distribution<Address> start_dist(0, kMappedSize - 1);
+  std::uniform_int_distribution<Address> size_dist(1, 3 * kPageSize);
+  const Address start = start_dist(gen);
+  return {start, std::min(start + size_dist(gen), kMappedSize)};
+}
+
+TEST(MemoryStatePaged, RandomOperations) {
+  std::mt19937_64 gen(1);
+  MemoryState expected(MemoryState::kRangeBytes);
+  MemoryState actual(MemoryState::kPagedBytes);
+  const auto mapping =
+      MemoryMapping::MakeSized(0, kMappedSize, MemoryPerms::RW());
+  for (MemoryState* s : {&expected, &actual}) {
+    s->AddNewMemoryMapping(mapping);
+    s->ZeroMappedMemoryBytes(
+        MemoryMapping::MakeSized(kPageSize, 4 * kPageSize, MemoryPerms::RW()));
+  }
+  ExpectEquivalent(expected, actual);
+
+  std::uniform_int_distribution<int> op_dist(0, 9);
+  for (int i = 0; i < 200; ++i) {
+    const auto [start, limit] = RandomRange(gen);
+    switch (op_dist(gen)) {
+      case 0: {
+        // Unmaps the range and maps it back without bytes.
+        for (MemoryState* s : {&expected, &actual}) {
+          s->RemoveMemoryMapping(start, limit);
+          s->SetMemoryMapping(
+              MemoryMapping::MakeRanged(start, limit, MemoryPerms::RW()));
+        }
+        break;
+      }
+      case 1: {
+        // Continues with copies, leaving pages shared with the originals.
+        MemoryState expected_copy = expected.Copy();
+        MemoryState actual_copy = actual.Copy();
+        const MemoryBytes bytes(start, RandomBytes(gen, limit - start));
+        expected_copy.SetMemoryBytes(bytes);
+        actual_copy.SetMemoryBytes(bytes);
+        ExpectEquivalent(expected_copy, actual_copy);
+        // The originals are unchanged.
+        ExpectEquivalent(expected, actual);
+        expected = std::move(expected_copy);
+        actual = std::move(actual_copy);
+        break;
+      }
+      case 2: {
+        const MemoryMapping m =
+            MemoryMapping::MakeRanged(start, limit, MemoryPerms::RW());
+        expected.ZeroMappedMemoryBytes(m);
+        actual.ZeroMappedMemoryBytes(m);
+        break;
+      }
+      default: {
+        const MemoryBytes bytes(start, RandomBytes(gen, limit - start));
+        EXPECT_EQ(expected.DeltaMemoryBytes(bytes),
+                  actual.DeltaMemoryBytes(bytes));
+        expected.SetMemoryBytes(bytes);
+        actual.SetMemoryBytes(bytes);
+        break;
+      }
+    }
+    ExpectEquivalent(expected, actual);
+    if (::testing::Test::HasFailure()) {
+      FAIL() << "Operation " << i;
+    }
+  }
+
+  // A difference in a single byte is detected.
+  for (MemoryState* s : {&expected, &actual}) {
+    s->SetMemoryBytes(MemoryBytes(kPageSize, "a"));
+  }
+  MemoryState actual_copy = actual.Copy();
+  actual_copy.SetMemoryBytes(MemoryBytes(kPageSize, "b"));
+  EXPECT_FALSE(actual_copy == actual);
+  EXPECT_FALSE(expected == actual_copy);
+}
+
+TEST(MemoryStatePaged, Clear) {
+  MemoryState state(MemoryState::kPagedBytes);
+  state.AddNewMemoryMapping(
+      MemoryMapping::MakeSized(0, kPageSize, MemoryPerms::R()));
+  state.ZeroMappedMemoryBytes(
+      MemoryMapping::MakeSized(0, kPageSize, MemoryPerms::R()));
+  EXPECT_FALSE(state.IsEmpty());
+  state.Clear();
+  EXPECT_TRUE(state.IsEmpty());
+  EXPECT_EQ(state.byte_storage(), MemoryState::kPagedBytes);
+}
+
+TEST(MemoryStatePaged, TestSnapshots) {
+  for (int i = 0; i < ToInt(TestSnapshot::kNumTestSnapshot); ++i) {
+    const TestSnapshot type = static_cast<TestSnapshot>(i);
+    if (!TestSnapshotExists<Host>(type)) continue;
+    SCOPED_TRACE(EnumStr(type));
+    const Snapshot snapshot = CreateTestSnapshot<Host>(type);
+    for (auto zeroing :
+         {MemoryState::kZeroMappedBytes, MemoryState::kIgnoreMappedBytes}) {
+      const MemoryState expected = MemoryState::MakeInitial(snapshot, zeroing);
+      const MemoryState actual = MemoryState::MakeInitial(
+          snapshot, zeroing, MemoryState::kPagedBytes);
+      ExpectEquivalent(expected, actual);
+      EXPECT_EQ(expected.DeltaMemoryBytes(snapshot),
+                actual.DeltaMemoryBytes(snapshot));
+      for (int j = 0; j < snapshot.expected_end_states().size(); ++j) {
+        const MemoryState expected_end =
+            MemoryState::MakeEnd(snapshot, j, zeroing);
+        const MemoryState actual_end = MemoryState::MakeEnd(
+            snapshot, j, zeroing, MemoryState::kPagedBytes);
+        ExpectEquivalent(expected_end, actual_end);
+        const MemoryBytesList& end_bytes =
+            snapshot.expected_end_states()[j].memory_bytes();
+        EXPECT_EQ(expected.DeltaMemoryBytes(end_bytes),
+                  actual.DeltaMemoryBytes(end_bytes));
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace silifuzz
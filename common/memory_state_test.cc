@@ -24,6 +24,9 @@
 namespace silifuzz {
 namespace {
 
+using Address = SnapshotTypeNames::Address;
+using ByteSize = SnapshotTypeNames::ByteSize;
+using MemoryBytes = SnapshotTypeNames::MemoryBytes;
 using MemoryBytesList = SnapshotTypeNames::MemoryBytesList;
 
 MemoryBytesList MakeSequence(int step, int width, int n) {
@@ -59,5 +62,59 @@ BENCHMARK(BM_SetMemoryBytes<MakeDisjoint>);
 BENCHMARK(BM_SetMemoryBytes<MakeOverlapping>);
 BENCHMARK(BM_SetMemoryBytes<MakeReplacing>);
 
+constexpr Address kPageSize = 4096;
+
+// Returns a state with state.range(0) pages of non-zero data, as for a
+// snapshot with a large data region.
+MemoryState MakeLargeData(benchmark::State& state,
+                          MemoryState::ByteStorage byte_storage) {
+  const ByteSize size = state.range(0) * kPageSize;
+  MemoryState memory_state(byte_storage);
+  const auto mapping = MemoryMapping::MakeSized(0, size, MemoryPerms::RW());
+  memory_state.AddNewMemoryMapping(mapping);
+  memory_state.ZeroMappedMemoryBytes(mapping);
+  for (Address page = 0; page < size; page += kPageSize) {
+    memory_state.SetMemoryBytes(
+        MemoryBytes(page + 8, std::string(64, 'd')));
+  }
+  return memory_state;
+}
+
+// Models building the memory state of every end state of a snapshot: copy the
+// initial state and apply a few small end state writes.
+template <MemoryState::ByteStorage byte_storage>
+void BM_CopyAndApplyEndState(benchmark::State& state) {
+  const MemoryState initial = MakeLargeData(state, byte_storage);
+  const MemoryBytesList end_state_bytes = {
+      {16, std::string(8, 'e')},
+      {(state.range(0) / 2) * kPageSize + 100, std::string(16, 'e')},
+  };
+  for (const auto _ : state) {
+    MemoryState memory_state = initial.Copy();
+    memory_state.SetMemoryBytes(end_state_bytes);
+    benchmark::DoNotOptimize(memory_state);
+  }
+}
+
+BENCHMARK(BM_CopyAndApplyEndState<MemoryState::kRangeBytes>)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(4096);
+BENCHMARK(BM_CopyAndApplyEndState<MemoryState::kPagedBytes>)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(4096);
+
+template <MemoryState::ByteStorage byte_storage>
+void BM_MakeLargeData(benchmark::State& state) {
+  for (const auto _ : state) {
+    MemoryState memory_state = MakeLargeData(state, byte_storage);
+    benchmark::DoNotOptimize(memory_state);
+  }
+}
+
+BENCHMARK(BM_MakeLargeData<MemoryState::kRangeBytes>)->Arg(16)->Arg(256);
+BENCHMARK(BM_MakeLargeData<MemoryState::kPagedBytes>)->Arg(16)->Arg(256);
+
 }  // namespace
 }  // namespace silifuzz
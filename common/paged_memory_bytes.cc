@@ -0,0 +1,153 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./common/paged_memory_bytes.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "./util/checks.h"
+
+namespace silifuzz {
+
+namespace {
+
+using Address = PagedMemoryBytes::Address;
+using ByteSize = PagedMemoryBytes::ByteSize;
+
+constexpr Address PageAddress(Address address) {
+  return address & ~(PagedMemoryBytes::kPageSize - 1);
+}
+
+}  // namespace
+
+// static
+const std::shared_ptr<PagedMemoryBytes::Page>& PagedMemoryBytes::ZeroPage() {
+  // The extra reference held here keeps the zero page shared forever, so no
+  // writer ever modifies it in place.
+  static const auto* const zero_page =
+      new std::shared_ptr<Page>(std::make_shared<Page>());
+  return *zero_page;
+}
+
+size_t PagedMemoryBytes::NumPagesSharedWith(const PagedMemoryBytes& y) const {
+  size_t n = 0;
+  for (const auto& [address, page] : pages_) {
+    auto it = y.pages_.find(address);
+    if (it != y.pages_.end() && it->second == page) ++n;
+  }
+  return n;
+}
+
+PagedMemoryBytes::Page& PagedMemoryBytes::MutablePage(Address page_address,
+                                                      bool overwrite) {
+  std::shared_ptr<Page>& page = pages_[page_address];
+  if (page == nullptr) {
+    page = std::make_shared<Page>();
+  } else if (page.use_count() > 1) {
+    page = overwrite ? std::make_shared<Page>() : std::make_shared<Page>(*page);
+  }
+  return *page;
+}
+
+void PagedMemoryBytes::Write(Address start_address, const char* data,
+                             ByteSize size) {
+  Address address = start_address;
+  const Address limit_address = start_address + size;
+  while (address < limit_address) {
+    const Address page_address = PageAddress(address);
+    const ByteSize offset = address - page_address;
+    const ByteSize n = std::min(kPageSize - offset, limit_address - address);
+    auto it = pages_.find(page_address);
+    // Writing the bytes a shared page already has would only break sharing.
+    if (it == pages_.end() || it->second.use_count() == 1 ||
+        memcmp(it->second->data() + offset, data, n) != 0) {
+      Page& page = MutablePage(page_address, n == kPageSize);
+      memcpy(page.data() + offset, data, n);
+    }
+    address += n;
+    data += n;
+  }
+}
+
+void PagedMemoryBytes::WriteZeros(Address start_address,
+                                  Address limit_address) {
+  Address address = start_address;
+  while (address < limit_address) {
+    const Address page_address = PageAddress(address);
+    const ByteSize offset = address - page_address;
+    const ByteSize n = std::min(kPageSize - offset, limit_address - address);
+    if (n == kPageSize) {
+      pages_[page_address] = ZeroPage();
+    } else {
+      auto it = pages_.find(page_address);
+      if (it == pages_.end() || it->second != ZeroPage()) {
+        Page& page = MutablePage(page_address, false);
+        memset(page.data() + offset, 0, n);
+      }
+    }
+    address += n;
+  }
+}
+
+void PagedMemoryBytes::Read(Address start_address, ByteSize size,
+                            char* dest) const {
+  Address address = start_address;
+  const Address limit_address = start_address + size;
+  while (address < limit_address) {
+    ByteSize n;
+    const char* data = Data(address, &n);
+    DCHECK(data != nullptr);
+    n = std::min(n, limit_address - address);
+    if (data != nullptr) {
+      memcpy(dest, data, n);
+    } else {
+      memset(dest, 0, n);
+    }
+    address += n;
+    dest += n;
+  }
+}
+
+const char* PagedMemoryBytes::Data(Address address, ByteSize* size) const {
+  const Address page_address = PageAddress(address);
+  const ByteSize offset = address - page_address;
+  *size = kPageSize - offset;
+  auto it = pages_.find(page_address);
+  if (it == pages_.end()) return nullptr;
+  return it->second->data() + offset;
+}
+
+void PagedMemoryBytes::Remove(Address start_address, Address limit_address) {
+  // A page is fully inside the range iff its start is in
+  // [first_page, limit_page).
+  const Address first_page = PageAddress(start_address + kPageSize - 1);
+  const Address limit_page = PageAddress(limit_address);
+  if (first_page >= limit_page) return;
+  if ((limit_page - first_page) / kPageSize > pages_.size()) {
+    absl::erase_if(pages_, [&](const auto& entry) {
+      return entry.first >= first_page && entry.first < limit_page;
+    });
+  } else {
+    for (Address page = first_page; page < limit_page; page += kPageSize) {
+      pages_.erase(page);
+    }
+  }
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,105 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_COMMON_PAGED_MEMORY_BYTES_H_
+#define THIRD_PARTY_SILIFUZZ_COMMON_PAGED_MEMORY_BYTES_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "./common/snapshot_enums.h"
+
+namespace silifuzz {
+
+// PagedMemoryBytes holds byte values of a sparse address space in fixed-size
+// pages. Pages are reference counted and shared between copies of a
+// PagedMemoryBytes until one of the copies writes to them (copy-on-write), so
+// copying costs O(number of pages) and a write only copies the pages it
+// touches.
+//
+// The class does not know which bytes were written: bytes of a present page
+// that were never written read as 0. Callers that care keep track of written
+// bytes themselves (see MemoryState).
+//
+// This class is thread-compatible.
+class PagedMemoryBytes {
+ public:
+  using Address = snapshot_types::Address;
+  using ByteSize = snapshot_types::ByteSize;
+
+  // Size of a page. Independent of the page size of the host or of the
+  // snapshot architecture.
+  static constexpr ByteSize kPageSize = 4096;
+
+  PagedMemoryBytes() = default;
+  ~PagedMemoryBytes() = default;
+
+  // Copyable and movable. Copies share all pages.
+  PagedMemoryBytes(const PagedMemoryBytes&) = default;
+  PagedMemoryBytes(PagedMemoryBytes&&) = default;
+  PagedMemoryBytes& operator=(const PagedMemoryBytes&) = default;
+  PagedMemoryBytes& operator=(PagedMemoryBytes&&) = default;
+
+  // Whether *this has no pages.
+  bool empty() const { return pages_.empty(); }
+
+  // Number of pages in *this.
+  size_t num_pages() const { return pages_.size(); }
+
+  // Number of pages of *this that are shared with `y`.
+  size_t NumPagesSharedWith(const PagedMemoryBytes& y) const;
+
+  // Writes `size` bytes from `data` at `start_address`, adding pages as needed.
+  // Shared pages are only copied if their bytes actually change.
+  void Write(Address start_address, const char* data, ByteSize size);
+
+  // Sets bytes in [start_address, limit_address) to 0. Pages fully inside the
+  // range all share one zero page.
+  void WriteZeros(Address start_address, Address limit_address);
+
+  // Copies `size` bytes at `start_address` into `dest`.
+  // REQUIRES: all pages of the range are present.
+  void Read(Address start_address, ByteSize size, char* dest) const;
+
+  // Returns a pointer to the byte at `address` and sets `*size` to the number
+  // of bytes readable through it, i.e. up to the end of the page.
+  // Returns nullptr if the page of `address` is not present.
+  const char* Data(Address address, ByteSize* size) const;
+
+  // Drops the pages fully inside [start_address, limit_address). Bytes of
+  // other pages in the range keep their values.
+  void Remove(Address start_address, Address limit_address);
+
+ private:
+  using Page = std::array<char, kPageSize>;
+
+  // Returns the page shared by all zeroed pages.
+  static const std::shared_ptr<Page>& ZeroPage();
+
+  // Returns the page starting at `page_address` for writing, making a private
+  // copy of it first if it is shared. The page is added if it is not present.
+  // If `overwrite` is true, the caller will overwrite the whole page and the
+  // returned contents are unspecified.
+  Page& MutablePage(Address page_address, bool overwrite);
+
+  // Maps page-aligned addresses to pages.
+  absl::flat_hash_map<Address, std::shared_ptr<Page>> pages_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_COMMON_PAGED_MEMORY_BYTES_H_
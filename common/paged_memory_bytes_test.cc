@@ -0,0 +1,111 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./common/paged_memory_bytes.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace silifuzz {
+namespace {
+
+constexpr PagedMemoryBytes::ByteSize kPageSize = PagedMemoryBytes::kPageSize;
+
+std::string Read(const PagedMemoryBytes& bytes,
+                 PagedMemoryBytes::Address start_address,
+                 PagedMemoryBytes::ByteSize size) {
+  std::string result(size, '?');
+  bytes.Read(start_address, size, result.data());
+  return result;
+}
+
+TEST(PagedMemoryBytes, WriteAndRead) {
+  PagedMemoryBytes bytes;
+  EXPECT_TRUE(bytes.empty());
+  // Straddles a page boundary.
+  const std::string data(100, 'x');
+  bytes.Write(kPageSize - 50, data.data(), data.size());
+  EXPECT_EQ(bytes.num_pages(), 2);
+  EXPECT_EQ(Read(bytes, kPageSize - 50, 100), data);
+  // Unwritten bytes of present pages read as 0.
+  EXPECT_EQ(Read(bytes, 0, 2), std::string(2, '\0'));
+
+  PagedMemoryBytes::ByteSize size;
+  const char* p = bytes.Data(kPageSize - 50, &size);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(size, 50);
+  EXPECT_EQ(*p, 'x');
+  EXPECT_EQ(bytes.Data(10 * kPageSize, &size), nullptr);
+}
+
+TEST(PagedMemoryBytes, CopyOnWrite) {
+  PagedMemoryBytes bytes;
+  const std::string data(4 * kPageSize, 'a');
+  bytes.Write(0, data.data(), data.size());
+
+  PagedMemoryBytes copy = bytes;
+  EXPECT_EQ(copy.NumPagesSharedWith(bytes), 4);
+
+  copy.Write(kPageSize + 1, "b", 1);
+  EXPECT_EQ(copy.NumPagesSharedWith(bytes), 3);
+  EXPECT_EQ(Read(copy, kPageSize, 3), "aba");
+  EXPECT_EQ(Read(bytes, kPageSize, 3), "aaa");
+
+  // Rewriting the same values keeps pages shared.
+  copy.Write(0, data.data(), kPageSize);
+  EXPECT_EQ(copy.NumPagesSharedWith(bytes), 3);
+
+  // Writing an unshared page does not affect the original.
+  copy.Write(kPageSize + 2, "c", 1);
+  EXPECT_EQ(Read(copy, kPageSize, 3), "abc");
+  EXPECT_EQ(Read(bytes, kPageSize, 3), "aaa");
+}
+
+TEST(PagedMemoryBytes, WriteZeros) {
+  PagedMemoryBytes bytes;
+  bytes.WriteZeros(0, 3 * kPageSize);
+  PagedMemoryBytes other;
+  other.WriteZeros(kPageSize, 2 * kPageSize);
+  // All whole zero pages are the same page.
+  EXPECT_EQ(bytes.NumPagesSharedWith(other), 1);
+
+  bytes.Write(10, "z", 1);
+  EXPECT_EQ(Read(bytes, 9, 3), std::string("\0z\0", 3));
+  EXPECT_EQ(Read(other, kPageSize + 10, 1), std::string(1, '\0'));
+
+  // Partial zeroing.
+  const std::string data(kPageSize, 'd');
+  bytes.Write(0, data.data(), data.size());
+  bytes.WriteZeros(10, 20);
+  EXPECT_EQ(Read(bytes, 9, 12), "d" + std::string(10, '\0') + "d");
+}
+
+TEST(PagedMemoryBytes, Remove) {
+  PagedMemoryBytes bytes;
+  const std::string data(4 * kPageSize, 'r');
+  bytes.Write(0, data.data(), data.size());
+  // Only whole pages inside the range go away.
+  bytes.Remove(1, 3 * kPageSize);
+  EXPECT_EQ(bytes.num_pages(), 2);
+  EXPECT_EQ(Read(bytes, 0, 1), "r");
+  EXPECT_EQ(Read(bytes, 3 * kPageSize, 1), "r");
+
+  // A range much larger than the number of pages.
+  bytes.Remove(0, 1ULL << 40);
+  EXPECT_TRUE(bytes.empty());
+}
+
+}  // namespace
+}  // namespace silifuzz
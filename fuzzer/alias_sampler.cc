@@ -0,0 +1,64 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzzer/alias_sampler.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+
+namespace silifuzz {
+
+AliasSampler::AliasSampler(absl::Span<const double> weights)
+    : probability_(weights.size()), alias_(weights.size()) {
+  double total = 0.0;
+  for (double weight : weights) {
+    CHECK_GE(weight, 0.0);
+    total += weight;
+  }
+  CHECK_GT(total, 0.0);
+
+  // Scale the weights so that the average column is exactly full, then fill
+  // each underfull column with the remainder of an overfull one.
+  const size_t n = weights.size();
+  std::vector<double> scaled(n);
+  std::vector<size_t> underfull, overfull;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * n / total;
+    (scaled[i] < 1.0 ? underfull : overfull).push_back(i);
+  }
+  while (!underfull.empty() && !overfull.empty()) {
+    size_t small = underfull.back();
+    underfull.pop_back();
+    size_t large = overfull.back();
+    overfull.pop_back();
+    probability_[small] = scaled[small];
+    alias_[small] = large;
+    scaled[large] -= 1.0 - scaled[small];
+    (scaled[large] < 1.0 ? underfull : overfull).push_back(large);
+  }
+  // Whatever is left is full, up to rounding error.
+  for (size_t i : underfull) {
+    probability_[i] = 1.0;
+    alias_[i] = i;
+  }
+  for (size_t i : overfull) {
+    probability_[i] = 1.0;
+    alias_[i] = i;
+  }
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,68 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_FUZZER_ALIAS_SAMPLER_H_
+#define THIRD_PARTY_SILIFUZZ_FUZZER_ALIAS_SAMPLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace silifuzz {
+
+// Samples indexes from a fixed discrete distribution in O(1) with Vose's alias
+// method. std::discrete_distribution does a binary search per sample, which
+// adds up for the large, static distributions of instruction dictionaries.
+//
+// This class is thread-compatible.
+class AliasSampler {
+ public:
+  // An empty sampler. Sample() must not be called.
+  AliasSampler() = default;
+
+  // `weights` need not be normalized. All weights must be non-negative and at
+  // least one of them must be positive.
+  explicit AliasSampler(absl::Span<const double> weights);
+
+  // Copyable and moveable.
+  AliasSampler(const AliasSampler&) = default;
+  AliasSampler& operator=(const AliasSampler&) = default;
+  AliasSampler(AliasSampler&&) = default;
+  AliasSampler& operator=(AliasSampler&&) = default;
+
+  // Returns a random index in [0, size()) with probability proportional to its
+  // weight.
+  template <typename Rng>
+  size_t Sample(Rng& rng) const {
+    size_t column = std::uniform_int_distribution<size_t>{0, size() - 1}(rng);
+    double coin = std::uniform_real_distribution<double>{0.0, 1.0}(rng);
+    return coin < probability_[column] ? column : alias_[column];
+  }
+
+  size_t size() const { return probability_.size(); }
+  bool empty() const { return probability_.empty(); }
+
+ private:
+  // Column i yields i with probability probability_[i] and alias_[i]
+  // otherwise.
+  std::vector<double> probability_;
+  std::vector<size_t> alias_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_FUZZER_ALIAS_SAMPLER_H_
@@ -0,0 +1,95 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzzer/alias_sampler.h"
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace silifuzz {
+
+namespace {
+
+// Returns how often each index was sampled out of `num_samples`.
+std::vector<double> Frequencies(const AliasSampler& sampler,
+                                size_t num_samples) {
+  std::mt19937_64 rng(0);
+  std::vector<double> counts(sampler.size());
+  for (size_t i = 0; i < num_samples; ++i) {
+    counts[sampler.Sample(rng)]++;
+  }
+  for (double& count : counts) {
+    count /= num_samples;
+  }
+  return counts;
+}
+
+TEST(AliasSampler, Empty) {
+  AliasSampler sampler;
+  EXPECT_TRUE(sampler.empty());
+  EXPECT_EQ(sampler.size(), 0);
+}
+
+TEST(AliasSampler, Single) {
+  AliasSampler sampler(std::vector<double>{3.0});
+  std::mt19937_64 rng(0);
+  for (size_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(sampler.Sample(rng), 0);
+  }
+}
+
+TEST(AliasSampler, Distribution) {
+  AliasSampler sampler(std::vector<double>{1.0, 2.0, 0.0, 5.0, 2.0});
+  ASSERT_EQ(sampler.size(), 5);
+  std::vector<double> frequencies = Frequencies(sampler, 100000);
+  EXPECT_NEAR(frequencies[0], 0.1, 0.01);
+  EXPECT_NEAR(frequencies[1], 0.2, 0.01);
+  EXPECT_EQ(frequencies[2], 0.0);
+  EXPECT_NEAR(frequencies[3], 0.5, 0.01);
+  EXPECT_NEAR(frequencies[4], 0.2, 0.01);
+}
+
+TEST(AliasSampler, Uniform) {
+  AliasSampler sampler(std::vector<double>(8, 0.5));
+  for (double frequency : Frequencies(sampler, 80000)) {
+    EXPECT_NEAR(frequency, 0.125, 0.01);
+  }
+}
+
+TEST(AliasSampler, Skewed) {
+  // One heavy entry and many light ones, like a mined dictionary.
+  std::vector<double> weights(1000, 1.0);
+  weights[0] = 9000.0;
+  AliasSampler sampler(weights);
+  std::vector<double> frequencies = Frequencies(sampler, 100000);
+  EXPECT_NEAR(frequencies[0], 0.9, 0.01);
+  double rest = 0.0;
+  for (size_t i = 1; i < frequencies.size(); ++i) rest += frequencies[i];
+  EXPECT_NEAR(rest, 0.1, 0.01);
+}
+
+TEST(AliasSamplerDeathTest, NoPositiveWeight) {
+  EXPECT_DEATH({ AliasSampler sampler(std::vector<double>{0.0, 0.0}); }, "");
+}
+
+TEST(AliasSamplerDeathTest, NegativeWeight) {
+  EXPECT_DEATH({ AliasSampler sampler(std::vector<double>{1.0, -1.0}); }, "");
+}
+
+}  // namespace
+
+}  // namespace silifuzz
@@ -0,0 +1,171 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzzer/instruction_dictionary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "./fuzzer/program.h"
+#include "./util/arch.h"
+#include "./util/tool_util.h"
+
+namespace silifuzz {
+
+namespace {
+
+bool IsHexString(absl::string_view text) {
+  return text.size() % 2 == 0 &&
+         std::all_of(text.begin(), text.end(), absl::ascii_isxdigit);
+}
+
+}  // namespace
+
+template <typename Arch>
+InstructionDictionary<Arch>::InstructionDictionary(
+    std::vector<InstructionDictionaryEntry<Arch>> entries)
+    : entries_(std::move(entries)) {
+  if (entries_.empty()) return;
+  std::vector<double> weights;
+  weights.reserve(entries_.size());
+  for (const InstructionDictionaryEntry<Arch>& entry : entries_) {
+    weights.push_back(entry.weight);
+  }
+  sampler_ = AliasSampler(weights);
+}
+
+template <typename Arch>
+absl::StatusOr<InstructionDictionary<Arch>> InstructionDictionary<Arch>::Parse(
+    absl::string_view text) {
+  std::vector<InstructionDictionaryEntry<Arch>> entries;
+  size_t line_number = 0;
+  for (absl::string_view line : absl::StrSplit(text, '\n')) {
+    ++line_number;
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') continue;
+
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    double weight;
+    if (fields.size() != 2 || !absl::SimpleAtod(fields[0], &weight) ||
+        !std::isfinite(weight) || weight <= 0.0 || fields[1].empty() ||
+        !IsHexString(fields[1])) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("line ", line_number,
+                       ": expected <positive weight> <hex bytes>, got '", line,
+                       "'"));
+    }
+
+    const std::string bytes = absl::HexStringToBytes(fields[1]);
+    Program<Arch> program(reinterpret_cast<const uint8_t*>(bytes.data()),
+                          bytes.size());
+    // Drop the whole entry if any of its instructions was dropped, the rest
+    // is not what was mined.
+    if (program.NumInstructions() == 0 || program.ByteLen() != bytes.size()) {
+      continue;
+    }
+    entries.push_back(
+        {.instructions =
+             program.CopyInstructionBlock(0, program.NumInstructions()),
+         .weight = weight});
+  }
+  return InstructionDictionary<Arch>(std::move(entries));
+}
+
+template <typename Arch>
+absl::StatusOr<InstructionDictionary<Arch>> InstructionDictionary<Arch>::Load(
+    const std::string& path) {
+  absl::StatusOr<std::string> text = GetFileContents(path);
+  if (!text.ok()) return text.status();
+  absl::StatusOr<InstructionDictionary<Arch>> dictionary = Parse(*text);
+  if (!dictionary.ok()) {
+    const absl::Status& status = dictionary.status();
+    return absl::Status(status.code(),
+                        absl::StrCat(path, ": ", status.message()));
+  }
+  return dictionary;
+}
+
+template <typename Arch>
+InstructionDictionaryMiner<Arch>::InstructionDictionaryMiner(size_t max_length)
+    : max_length_(max_length) {
+  CHECK_GT(max_length_, 0);
+}
+
+template <typename Arch>
+void InstructionDictionaryMiner<Arch>::Add(const Program<Arch>& program) {
+  ++num_programs_;
+  absl::flat_hash_set<std::string> seen;
+  const size_t num_instructions = program.NumInstructions();
+  for (size_t start = 0; start < num_instructions; ++start) {
+    std::string sequence;
+    for (size_t end = start;
+         end < num_instructions && end - start < max_length_; ++end) {
+      const InstructionData<Arch>& encoded =
+          program.GetInstruction(end).encoded;
+      sequence.append(reinterpret_cast<const char*>(encoded.data()),
+                      encoded.size());
+      if (seen.insert(sequence).second) {
+        ++counts_[sequence];
+      }
+    }
+  }
+}
+
+template <typename Arch>
+std::string InstructionDictionaryMiner<Arch>::ToText(size_t max_entries,
+                                                     size_t min_count) const {
+  std::vector<std::pair<size_t, absl::string_view>> selected;
+  for (const auto& [sequence, count] : counts_) {
+    if (count >= min_count) selected.emplace_back(count, sequence);
+  }
+  auto more_common = [](const std::pair<size_t, absl::string_view>& a,
+                        const std::pair<size_t, absl::string_view>& b) {
+    return a.first != b.first ? a.first > b.first : a.second < b.second;
+  };
+  const size_t num_entries = std::min(max_entries, selected.size());
+  std::partial_sort(selected.begin(), selected.begin() + num_entries,
+                    selected.end(), more_common);
+
+  std::string text =
+      absl::StrCat("# ", Arch::arch_name, " instruction dictionary mined from ",
+                   num_programs_, " programs.\n");
+  for (size_t i = 0; i < num_entries; ++i) {
+    absl::StrAppend(&text, selected[i].first, " ",
+                    absl::BytesToHexString(selected[i].second), "\n");
+  }
+  return text;
+}
+
+template class InstructionDictionary<X86_64>;
+template class InstructionDictionary<AArch64>;
+template class InstructionDictionaryMiner<X86_64>;
+template class InstructionDictionaryMiner<AArch64>;
+
+}  // namespace silifuzz
@@ -0,0 +1,130 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_FUZZER_INSTRUCTION_DICTIONARY_H_
+#define THIRD_PARTY_SILIFUZZ_FUZZER_INSTRUCTION_DICTIONARY_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "./fuzzer/alias_sampler.h"
+#include "./fuzzer/program.h"
+
+namespace silifuzz {
+
+// Instruction dictionaries are stored as text, one entry per line:
+//
+//   <weight> <hex encoded instruction bytes>
+//
+// Empty lines and lines starting with '#' are ignored. An entry is a sequence
+// of one or more instructions that the fuzzer splices into programs as a unit.
+// Branches inside an entry keep pointing where they pointed relative to the
+// entry.
+
+// A weighted instruction sequence.
+template <typename Arch>
+struct InstructionDictionaryEntry {
+  // Displacement boundaries are relative to the first instruction of the
+  // sequence, i.e. they are in [0, instructions.size()].
+  std::vector<Instruction<Arch>> instructions;
+  double weight;
+};
+
+// A set of instruction sequences to sample from, typically mined from a corpus
+// by InstructionDictionaryMiner.
+//
+// This class is thread-compatible.
+template <typename Arch>
+class InstructionDictionary {
+ public:
+  // An empty dictionary.
+  InstructionDictionary() = default;
+
+  // Parses a dictionary in the text format above. Entries that do not decode
+  // into a sequence of valid instructions for Arch are dropped. Returns an
+  // error if a line is malformed.
+  static absl::StatusOr<InstructionDictionary> Parse(absl::string_view text);
+
+  // Reads and parses the dictionary in `path`.
+  static absl::StatusOr<InstructionDictionary> Load(const std::string& path);
+
+  // Copyable and moveable.
+  InstructionDictionary(const InstructionDictionary&) = default;
+  InstructionDictionary& operator=(const InstructionDictionary&) = default;
+  InstructionDictionary(InstructionDictionary&&) = default;
+  InstructionDictionary& operator=(InstructionDictionary&&) = default;
+
+  // Returns a random entry with probability proportional to its weight.
+  // The dictionary must not be empty.
+  const InstructionDictionaryEntry<Arch>& Sample(MutatorRng& rng) const {
+    return entries_[sampler_.Sample(rng)];
+  }
+
+  const std::vector<InstructionDictionaryEntry<Arch>>& entries() const {
+    return entries_;
+  }
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+ private:
+  explicit InstructionDictionary(
+      std::vector<InstructionDictionaryEntry<Arch>> entries);
+
+  std::vector<InstructionDictionaryEntry<Arch>> entries_;
+  AliasSampler sampler_;
+};
+
+// Collects the single instructions and short instruction sequences (n-grams)
+// of a corpus and weights them by the number of programs they occur in.
+// Counting programs rather than occurrences keeps a single unrolled loop from
+// dominating the dictionary.
+//
+// This class is thread-compatible.
+template <typename Arch>
+class InstructionDictionaryMiner {
+ public:
+  // Sequences of 1 to `max_length` instructions are collected.
+  explicit InstructionDictionaryMiner(size_t max_length = 3);
+
+  // Not copyable, the counts can be large.
+  InstructionDictionaryMiner(const InstructionDictionaryMiner&) = delete;
+  InstructionDictionaryMiner& operator=(const InstructionDictionaryMiner&) =
+      delete;
+
+  // Counts the sequences in `program`.
+  void Add(const Program<Arch>& program);
+
+  // Returns the `max_entries` most common sequences that occur in at least
+  // `min_count` programs, in the text format parsed by
+  // InstructionDictionary::Parse(). The output is sorted by decreasing count
+  // and then by bytes, so it does not depend on the order of Add() calls.
+  std::string ToText(size_t max_entries, size_t min_count = 1) const;
+
+  size_t num_programs() const { return num_programs_; }
+  size_t num_sequences() const { return counts_.size(); }
+
+ private:
+  size_t max_length_;
+  size_t num_programs_ = 0;
+  // Number of programs each sequence, keyed by its encoded bytes, occurs in.
+  absl::flat_hash_map<std::string, size_t> counts_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_FUZZER_INSTRUCTION_DICTIONARY_H_
@@ -0,0 +1,288 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./fuzzer/instruction_dictionary.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "./fuzzer/program.h"
+#include "./fuzzer/program_batch_mutator.h"
+#include "./fuzzer/program_mutation_ops.h"
+#include "./util/arch.h"
+
+namespace silifuzz {
+
+namespace {
+
+template <typename Arch>
+struct TestInstructions;
+
+template <>
+struct TestInstructions<X86_64> {
+  // nop
+  static std::vector<uint8_t> Nop() { return {0x90}; }
+  // inc rax
+  static std::vector<uint8_t> Inc() { return {0x48, 0xff, 0xc0}; }
+  // jnz <start of the preceding Inc()>
+  static std::vector<uint8_t> LoopToInc() { return {0x75, 0xfb}; }
+  static std::vector<uint8_t> Junk() { return {0xff, 0xff}; }
+};
+
+std::vector<uint8_t> FromInt(uint32_t insn) {
+  return std::vector<uint8_t>(reinterpret_cast<uint8_t*>(&insn),
+                              reinterpret_cast<uint8_t*>(&insn + 1));
+}
+
+template <>
+struct TestInstructions<AArch64> {
+  // nop
+  static std::vector<uint8_t> Nop() { return FromInt(0xd503201f); }
+  // add x0, x0, #1
+  static std::vector<uint8_t> Inc() { return FromInt(0x91000400); }
+  // cbnz x0, <start of the preceding Inc()>
+  static std::vector<uint8_t> LoopToInc() { return FromInt(0xb5ffffe0); }
+  // Currently unallocated.
+  static std::vector<uint8_t> Junk() { return FromInt(0xffffffff); }
+};
+
+std::vector<uint8_t> Concat(const std::vector<std::vector<uint8_t>>& parts) {
+  std::vector<uint8_t> bytes;
+  for (const std::vector<uint8_t>& part : parts) {
+    bytes.insert(bytes.end(), part.begin(), part.end());
+  }
+  return bytes;
+}
+
+std::string Hex(const std::vector<uint8_t>& bytes) {
+  return absl::BytesToHexString(
+      std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+}
+
+bool Contains(const std::vector<uint8_t>& haystack,
+              const std::vector<uint8_t>& needle) {
+  return std::search(haystack.begin(), haystack.end(), needle.begin(),
+                     needle.end()) != haystack.end();
+}
+
+template <typename Arch>
+std::vector<uint8_t> ToBytes(Program<Arch>& program) {
+  MutatorRng rng(0);
+  program.FixupEncodedDisplacements(rng);
+
+  std::vector<uint8_t> out;
+  program.ToBytes(out);
+  return out;
+}
+
+// The loop entry used by most tests: an increment and a branch back to it.
+template <typename Arch>
+std::vector<uint8_t> LoopEntry() {
+  using T = TestInstructions<Arch>;
+  return Concat({T::Inc(), T::LoopToInc()});
+}
+
+template <typename Arch>
+std::shared_ptr<const InstructionDictionary<Arch>> LoopDictionary() {
+  absl::StatusOr<InstructionDictionary<Arch>> dictionary =
+      InstructionDictionary<Arch>::Parse(
+          absl::StrCat("1 ", Hex(LoopEntry<Arch>()), "\n"));
+  CHECK_OK(dictionary.status());
+  CHECK_EQ(dictionary->size(), 1);
+  return std::make_shared<const InstructionDictionary<Arch>>(
+      *std::move(dictionary));
+}
+
+using arch_typelist = ::testing::Types<ALL_ARCH_TYPES>;
+template <class>
+struct InstructionDictionaryTest : ::testing::Test {};
+TYPED_TEST_SUITE(InstructionDictionaryTest, arch_typelist);
+
+TYPED_TEST(InstructionDictionaryTest, Parse) {
+  using T = TestInstructions<TypeParam>;
+  absl::StatusOr<InstructionDictionary<TypeParam>> dictionary =
+      InstructionDictionary<TypeParam>::Parse(
+          absl::StrCat("# comment\n", "\n", "3 ", Hex(T::Nop()), "\n",
+                       "  0.5   ", Hex(LoopEntry<TypeParam>()), "  \n"));
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+  ASSERT_EQ(dictionary->size(), 2);
+
+  const InstructionDictionaryEntry<TypeParam>& nop = dictionary->entries()[0];
+  EXPECT_EQ(nop.weight, 3.0);
+  ASSERT_EQ(nop.instructions.size(), 1);
+  EXPECT_FALSE(nop.instructions[0].direct_branch.valid());
+
+  const InstructionDictionaryEntry<TypeParam>& loop = dictionary->entries()[1];
+  EXPECT_EQ(loop.weight, 0.5);
+  ASSERT_EQ(loop.instructions.size(), 2);
+  // The branch points at the first instruction of the entry.
+  ASSERT_TRUE(loop.instructions[1].direct_branch.valid());
+  EXPECT_EQ(loop.instructions[1].direct_branch.instruction_boundary, 0);
+}
+
+TYPED_TEST(InstructionDictionaryTest, ParseDropsUndecodableEntries) {
+  using T = TestInstructions<TypeParam>;
+  absl::StatusOr<InstructionDictionary<TypeParam>> dictionary =
+      InstructionDictionary<TypeParam>::Parse(absl::StrCat(
+          "1 ", Hex(T::Junk()), "\n", "1 ", Hex(Concat({T::Nop(), T::Junk()})),
+          "\n", "1 ", Hex(T::Nop()), "\n"));
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+  ASSERT_EQ(dictionary->size(), 1);
+  EXPECT_EQ(dictionary->entries()[0].instructions.size(), 1);
+}
+
+TYPED_TEST(InstructionDictionaryTest, ParseErrors) {
+  const std::string nop = Hex(TestInstructions<TypeParam>::Nop());
+  for (const std::string& text :
+       {absl::StrCat("x ", nop), absl::StrCat("0 ", nop),
+        absl::StrCat("-1 ", nop), absl::StrCat("1 ", nop, " 1"),
+        std::string("1"), std::string("1 zz"), std::string("1 123")}) {
+    EXPECT_FALSE(InstructionDictionary<TypeParam>::Parse(text).ok()) << text;
+  }
+}
+
+TYPED_TEST(InstructionDictionaryTest, Empty) {
+  absl::StatusOr<InstructionDictionary<TypeParam>> dictionary =
+      InstructionDictionary<TypeParam>::Parse("# nothing\n");
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+  EXPECT_TRUE(dictionary->empty());
+
+  MutatorRng rng(0);
+  Program<TypeParam> program(TestInstructions<TypeParam>::Nop());
+  InsertDictionaryEntry<TypeParam> m(
+      std::make_shared<const InstructionDictionary<TypeParam>>(
+          *std::move(dictionary)));
+  EXPECT_FALSE(m.Mutate(rng, program, program));
+  EXPECT_EQ(program.NumInstructions(), 1);
+}
+
+TYPED_TEST(InstructionDictionaryTest, Mine) {
+  using T = TestInstructions<TypeParam>;
+  InstructionDictionaryMiner<TypeParam> miner(2);
+  // Repeats within a program count once.
+  miner.Add(Program<TypeParam>(Concat({T::Nop(), T::Nop(), T::Inc()})));
+  miner.Add(Program<TypeParam>(Concat({T::Inc(), T::Nop()})));
+  miner.Add(Program<TypeParam>(Concat({T::Nop(), T::Inc()})));
+  EXPECT_EQ(miner.num_programs(), 3);
+  // nop, inc, nop+nop, nop+inc, inc+nop
+  EXPECT_EQ(miner.num_sequences(), 5);
+
+  // Only nop, inc and nop+inc occur in more than one program.
+  absl::StatusOr<InstructionDictionary<TypeParam>> dictionary =
+      InstructionDictionary<TypeParam>::Parse(miner.ToText(10, 2));
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+  ASSERT_EQ(dictionary->size(), 3);
+  // nop and inc occur in all programs and come first.
+  EXPECT_EQ(dictionary->entries()[0].weight, 3.0);
+  EXPECT_EQ(dictionary->entries()[0].instructions.size(), 1);
+  EXPECT_EQ(dictionary->entries()[1].weight, 3.0);
+  EXPECT_EQ(dictionary->entries()[1].instructions.size(), 1);
+  EXPECT_EQ(dictionary->entries()[2].weight, 2.0);
+  EXPECT_EQ(dictionary->entries()[2].instructions.size(), 2);
+
+  // The output is truncated to the most common entries.
+  dictionary = InstructionDictionary<TypeParam>::Parse(miner.ToText(1));
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+  EXPECT_EQ(dictionary->size(), 1);
+
+  dictionary = InstructionDictionary<TypeParam>::Parse(miner.ToText(10));
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+  EXPECT_EQ(dictionary->size(), 5);
+}
+
+TYPED_TEST(InstructionDictionaryTest, MineKeepsBranches) {
+  using T = TestInstructions<TypeParam>;
+  InstructionDictionaryMiner<TypeParam> miner(2);
+  miner.Add(Program<TypeParam>(
+      Concat({T::Nop(), LoopEntry<TypeParam>(), T::Nop()}), {}, true));
+  absl::StatusOr<InstructionDictionary<TypeParam>> dictionary =
+      InstructionDictionary<TypeParam>::Parse(miner.ToText(100));
+  ASSERT_TRUE(dictionary.ok()) << dictionary.status();
+
+  // The loop survives mining with its branch pointing at its start.
+  bool found_loop = false;
+  for (const InstructionDictionaryEntry<TypeParam>& entry :
+       dictionary->entries()) {
+    if (entry.instructions.size() == 2 &&
+        entry.instructions[1].direct_branch.valid()) {
+      EXPECT_EQ(entry.instructions[1].direct_branch.instruction_boundary, 0);
+      found_loop = true;
+    }
+  }
+  EXPECT_TRUE(found_loop);
+}
+
+TYPED_TEST(InstructionDictionaryTest, InsertDictionaryEntry) {
+  using T = TestInstructions<TypeParam>;
+  const std::vector<uint8_t> nops =
+      Concat({T::Nop(), T::Nop(), T::Nop(), T::Nop()});
+  InsertDictionaryEntry<TypeParam> m(LoopDictionary<TypeParam>());
+
+  // Wherever the entry lands, its branch is fixed up to still point at the
+  // start of the entry.
+  for (uint64_t seed = 0; seed < 20; ++seed) {
+    MutatorRng rng(seed);
+    Program<TypeParam> program(nops);
+    ASSERT_TRUE(m.Mutate(rng, program, program));
+    EXPECT_EQ(program.NumInstructions(), 6);
+    std::vector<uint8_t> bytes = ToBytes(program);
+    EXPECT_EQ(bytes.size(), nops.size() + LoopEntry<TypeParam>().size());
+    EXPECT_TRUE(Contains(bytes, LoopEntry<TypeParam>())) << "seed " << seed;
+  }
+}
+
+TYPED_TEST(InstructionDictionaryTest, InsertDictionaryEntryTwice) {
+  using T = TestInstructions<TypeParam>;
+  InsertDictionaryEntry<TypeParam> m(LoopDictionary<TypeParam>());
+  MutatorRng rng(0);
+  Program<TypeParam> program(T::Nop());
+  ASSERT_TRUE(m.Mutate(rng, program, program));
+  ASSERT_TRUE(m.Mutate(rng, program, program));
+  EXPECT_EQ(program.NumInstructions(), 5);
+  program.CheckConsistency();
+
+  // The second copy may land inside the first one, but it is inserted in one
+  // piece with its branch intact.
+  std::vector<uint8_t> bytes = ToBytes(program);
+  EXPECT_TRUE(Contains(bytes, LoopEntry<TypeParam>()));
+}
+
+TYPED_TEST(InstructionDictionaryTest, BatchMutatorUsesDictionary) {
+  using T = TestInstructions<TypeParam>;
+  const std::vector<uint8_t> input =
+      Concat({T::Nop(), T::Nop(), T::Nop(), T::Nop()});
+  ProgramBatchMutator<TypeParam> mutator(0, 0.0, 1000,
+                                         LoopDictionary<TypeParam>());
+  std::vector<std::vector<uint8_t>> mutants(200);
+  mutator.Mutate({&input}, mutants.size(), mutants);
+
+  size_t num_with_entry = 0;
+  for (const std::vector<uint8_t>& mutant : mutants) {
+    num_with_entry += Contains(mutant, LoopEntry<TypeParam>());
+  }
+  EXPECT_GT(num_with_entry, 0);
+}
+
+}  // namespace
+
+}  // namespace silifuzz
@@ -18,8 +18,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "./fuzzer/instruction_dictionary.h"
 #include "./fuzzer/program.h"
 #include "./fuzzer/program_mutation_ops.h"
 #include "./fuzzer/program_mutator.h"
@@ -63,14 +66,18 @@ void FinalizeProgram(MutatorRng& rng, Program<Arch>& program, size_t max_len) {
 }  // namespace
 
 template <typename Arch>
-ProgramBatchMutator<Arch>::ProgramBatchMutator(uint64_t seed,
-                                               double crossover_weight,
-                                               size_t max_len)
+ProgramBatchMutator<Arch>::ProgramBatchMutator(
+    uint64_t seed, double crossover_weight, size_t max_len,
+    std::shared_ptr<const InstructionDictionary<Arch>> dictionary)
     : rng_(seed), max_len_(max_len) {
   // Clamp the crossover weight to [0.0, 1.0]
   crossover_weight = std::max(std::min(crossover_weight, 1.0), 0.0);
 
-  // TODO(ncbray): copy instruction from dictionary.
+  // Dictionary entries are known to have been useful, so they are inserted as
+  // often as generated instructions.
+  const double dictionary_weight =
+      dictionary != nullptr && !dictionary->empty() ? 2.0 : 0.0;
+
   // TODO(ncbray): how should these be weighted?
   // TODO(ncbray): consider what the best policy is for randomly removing
   // instructions.
@@ -94,6 +101,9 @@ ProgramBatchMutator<Arch>::ProgramBatchMutator(uint64_t seed,
                       128,
                       SelectMutation<Arch>(
                           Weighted(2.0, InsertGeneratedInstruction<Arch>{}),
+                          Weighted(dictionary_weight,
+                                   InsertDictionaryEntry<Arch>{
+                                       std::move(dictionary)}),
                           Weighted(5.0, MutateInstruction<Arch>{}),
                           Weighted(1.0, SwapInstructions<Arch>{}),
                           Weighted(2.0, DeleteInstruction<Arch>{3}))}}),
@@ -17,8 +17,10 @@
 
 #include <cstddef>
 #include <limits>
+#include <memory>
 #include <vector>
 
+#include "./fuzzer/instruction_dictionary.h"
 #include "./fuzzer/program.h"
 #include "./fuzzer/program_mutator.h"
 
@@ -31,8 +33,12 @@ class ProgramBatchMutator {
   // `crossover_weight` determines how much crossover the mutator performs.
   // 0.0 => no crossover / 1.0 => only crossover
   // `max_len` is the largest size (in bytes) that the output should be.
-  ProgramBatchMutator(uint64_t seed, double crossover_weight,
-                      size_t max_len = std::numeric_limits<size_t>::max());
+  // If `dictionary` is not empty, instruction sequences sampled from it are
+  // inserted alongside randomly generated instructions.
+  ProgramBatchMutator(
+      uint64_t seed, double crossover_weight,
+      size_t max_len = std::numeric_limits<size_t>::max(),
+      std::shared_ptr<const InstructionDictionary<Arch>> dictionary = nullptr);
 
   void Mutate(const std::vector<const std::vector<uint8_t> *> &inputs,
               size_t num_mutants, std::vector<std::vector<uint8_t>> &mutants);
@@ -17,8 +17,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "./fuzzer/instruction_dictionary.h"
 #include "./fuzzer/program.h"
 #include "./fuzzer/program_mutator.h"
 
@@ -222,6 +225,42 @@ class CrossoverInsert : public ProgramMutator<Arch> {
   }
 };
 
+// Insert an instruction sequence sampled from a dictionary at a random
+// instruction boundary.
+template <typename Arch>
+class InsertDictionaryEntry : public ProgramMutator<Arch> {
+ public:
+  explicit InsertDictionaryEntry(
+      std::shared_ptr<const InstructionDictionary<Arch>> dictionary)
+      : dictionary_(std::move(dictionary)) {}
+
+  // Returns `false` if the dictionary is empty.
+  bool Mutate(MutatorRng& rng, Program<Arch>& program,
+              const Program<Arch>& other) override {
+    if (dictionary_ == nullptr || dictionary_->empty()) return false;
+
+    std::vector<Instruction<Arch>> block =
+        dictionary_->Sample(rng).instructions;
+
+    // Determine where we want to insert the block.
+    size_t dst_boundary = program.RandomInstructionBoundary(rng);
+
+    // The displacements of the entry are relative to its first instruction,
+    // as if it was copied from index 0 of another program.
+    ShiftOrRandomizeInstructionDisplacementBoundaries(
+        rng, block, static_cast<int64_t>(dst_boundary),
+        program.NumInstructionBoundaries() + block.size());
+
+    // Insert.
+    bool steal_displacements = RandomIndex(rng, 2);
+    program.InsertInstructionBlock(dst_boundary, steal_displacements, block);
+    return true;
+  }
+
+ private:
+  std::shared_ptr<const InstructionDictionary<Arch>> dictionary_;
+};
+
 // Copy a random chunk from the other program and overwrite the current program
 // at a random instruction idnex.
 template <typename Arch>
@@ -14,10 +14,14 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
 #include "external/com_google_fuzztest/centipede/centipede_callbacks.h"
 #include "external/com_google_fuzztest/centipede/centipede_default_callbacks.h"
 #include "external/com_google_fuzztest/centipede/centipede_interface.h"
@@ -27,6 +31,7 @@
 #include "external/com_google_fuzztest/centipede/mutation_input.h"
 #include "external/com_google_fuzztest/centipede/util.h"
 #include "external/com_google_fuzztest/common/defs.h"
+#include "./fuzzer/instruction_dictionary.h"
 #include "./fuzzer/program_batch_mutator.h"
 #include "./util/arch.h"
 #include "./util/enum_flag_types.h"
@@ -34,20 +39,45 @@
 
 ABSL_FLAG(silifuzz::ArchitectureId, arch, silifuzz::ArchitectureId::kUndefined,
           "Architecture for instruction-aware fuzzing.");
+ABSL_FLAG(std::string, instruction_dictionary, "",
+          "If set, the instruction-aware mutator also inserts instruction "
+          "sequences from this dictionary. The dictionary must be for --arch. "
+          "See instruction_dictionary_tool.");
 
 namespace silifuzz {
 
 using centipede::MutationInputRef;
 
+// Returns the dictionary named by --instruction_dictionary if it is for Arch,
+// otherwise nullptr.
+template <typename Arch>
+std::shared_ptr<const InstructionDictionary<Arch>> LoadInstructionDictionary(
+    ArchitectureId arch) {
+  const std::string path = absl::GetFlag(FLAGS_instruction_dictionary);
+  if (path.empty() || arch != Arch::architecture_id) return nullptr;
+  absl::StatusOr<InstructionDictionary<Arch>> dictionary =
+      InstructionDictionary<Arch>::Load(path);
+  if (!dictionary.ok()) {
+    LOG(FATAL) << "Cannot load instruction dictionary: "
+               << dictionary.status();
+  }
+  LOG(INFO) << "Loaded " << dictionary->size()
+            << " instruction dictionary entries from " << path;
+  return std::make_shared<const InstructionDictionary<Arch>>(
+      *std::move(dictionary));
+}
+
 class SilifuzzCentipedeCallbacks : public centipede::CentipedeDefaultCallbacks {
  public:
   SilifuzzCentipedeCallbacks(const centipede::Environment &env)
       : CentipedeDefaultCallbacks(env),
         arch_(absl::GetFlag(FLAGS_arch)),
         x86_64_mutator_(centipede::GetRandomSeed(env.seed),
-                        env.crossover_level / 100.0, env.max_len),
+                        env.crossover_level / 100.0, env.max_len,
+                        LoadInstructionDictionary<X86_64>(arch_)),
         aarch64_mutator_(centipede::GetRandomSeed(env.seed),
-                         env.crossover_level / 100.0, env.max_len) {}
+                         env.crossover_level / 100.0, env.max_len,
+                         LoadInstructionDictionary<AArch64>(arch_)) {}
 
   void Mutate(const std::vector<centipede::MutationInputRef> &inputs,
               size_t num_mutants, std::vector<centipede::ByteArray> &mutants) {
@@ -0,0 +1,132 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_INSTRUCTION_DECODE_CACHE_H_
+#define THIRD_PARTY_SILIFUZZ_INSTRUCTION_DECODE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/container/flat_hash_map.h"
+#include "./util/checks.h"
+
+namespace silifuzz {
+
+// The parts of a decoded instruction that per-instruction tracer callbacks
+// need, packed so that they are cheap to copy and query.
+struct DecodedInstructionInfo {
+  uint32_t id;
+  uint8_t size;
+  bool valid : 1;
+  bool can_branch : 1;
+  bool can_load : 1;
+  bool can_store : 1;
+};
+
+// DecodeCache memoizes a disassembler for code that executes the same
+// instructions many times, e.g. loops in a fuzzing input.
+//
+// Entries are keyed by address and store the instruction bytes they were
+// decoded from. A lookup only hits if the bytes are unchanged, so code that
+// modifies itself is decoded again without the cache having to observe the
+// writes.
+//
+// `Disasm` is a concrete Disassembler. Calls to it are statically bound so
+// that a hit costs no virtual calls and a miss costs no more than calling the
+// disassembler directly.
+//
+// This class is not thread safe, just like the disassembler it wraps.
+template <typename Disasm>
+class DecodeCache {
+ public:
+  // Longest instruction buffer that is cached. Longer buffers bypass the
+  // cache. 16 bytes hold any x86-64 or AArch64 instruction.
+  static constexpr size_t kMaxBytes = 16;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  explicit DecodeCache(Disasm& disasm) : disasm_(disasm) {}
+
+  // Not copyable or moveable -- holds a reference to the disassembler.
+  DecodeCache(const DecodeCache&) = delete;
+  DecodeCache(DecodeCache&&) = delete;
+  DecodeCache& operator=(const DecodeCache&) = delete;
+  DecodeCache& operator=(DecodeCache&&) = delete;
+
+  // Returns the decoded instruction at `address` whose bytes are
+  // `buffer[0, buffer_size)`. See Disassembler::Disassemble() for details.
+  // The result is valid until the next call to a non-const method.
+  const DecodedInstructionInfo& Decode(uint64_t address, const uint8_t* buffer,
+                                       size_t buffer_size) {
+    if (buffer_size > kMaxBytes) {
+      ++stats_.misses;
+      uncached_ = DecodeUncached(address, buffer, buffer_size);
+      return uncached_;
+    }
+    auto [it, inserted] = entries_.try_emplace(address);
+    Entry& entry = it->second;
+    if (!inserted && entry.num_bytes == buffer_size &&
+        memcmp(entry.bytes, buffer, buffer_size) == 0) {
+      ++stats_.hits;
+      return entry.info;
+    }
+    ++stats_.misses;
+    entry.num_bytes = buffer_size;
+    memcpy(entry.bytes, buffer, buffer_size);
+    entry.info = DecodeUncached(address, buffer, buffer_size);
+    return entry.info;
+  }
+
+  // Drops all entries. Call this between inputs since addresses are reused.
+  void Clear() { entries_.clear(); }
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    uint8_t bytes[kMaxBytes];
+    uint8_t num_bytes;
+    DecodedInstructionInfo info;
+  };
+
+  DecodedInstructionInfo DecodeUncached(uint64_t address, const uint8_t* buffer,
+                                        size_t buffer_size) {
+    DecodedInstructionInfo info{};
+    info.valid = disasm_.Disasm::Disassemble(address, buffer, buffer_size);
+    info.id = disasm_.Disasm::InstructionID();
+    if (info.valid) {
+      CHECK_LT(info.id, disasm_.Disasm::NumInstructionIDs());
+      size_t size = disasm_.Disasm::InstructionSize();
+      DCHECK_LE(size, buffer_size);
+      info.size = size;
+      info.can_branch = disasm_.Disasm::CanBranch();
+      info.can_load = disasm_.Disasm::CanLoad();
+      info.can_store = disasm_.Disasm::CanStore();
+    }
+    return info;
+  }
+
+  Disasm& disasm_;
+  absl::flat_hash_map<uint64_t, Entry> entries_;
+  DecodedInstructionInfo uncached_;
+  Stats stats_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_INSTRUCTION_DECODE_CACHE_H_
@@ -0,0 +1,132 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./instruction/decode_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "./instruction/disassembler.h"
+
+namespace silifuzz {
+
+namespace {
+
+// Decodes every instruction as one byte whose value is the instruction ID.
+// Zero is invalid. Counts calls to Disassemble().
+class FakeDisassembler final : public Disassembler {
+ public:
+  bool Disassemble(uint64_t address, const uint8_t* buffer,
+                   size_t buffer_size) override {
+    ++num_calls_;
+    id_ = buffer_size > 0 ? buffer[0] : 0;
+    return id_ != 0;
+  }
+  size_t InstructionSize() const override { return 1; }
+  bool CanBranch() const override { return id_ == 1; }
+  bool CanLoad() const override { return id_ == 2; }
+  bool CanStore() const override { return id_ == 3; }
+  std::string FullText() override { return ""; }
+  uint32_t InstructionID() const override { return id_; }
+  uint32_t InvalidInstructionID() const override { return 0; }
+  uint32_t NumInstructionIDs() const override { return 256; }
+  std::string InstructionIDName(uint32_t id) const override { return ""; }
+
+  size_t num_calls() const { return num_calls_; }
+
+ private:
+  uint32_t id_ = 0;
+  size_t num_calls_ = 0;
+};
+
+TEST(DecodeCache, Hit) {
+  FakeDisassembler disasm;
+  DecodeCache<FakeDisassembler> cache(disasm);
+  const uint8_t bytes[] = {1, 0x90};
+  for (int i = 0; i < 3; ++i) {
+    const DecodedInstructionInfo& info = cache.Decode(0x1000, bytes, 2);
+    EXPECT_TRUE(info.valid);
+    EXPECT_EQ(info.id, 1);
+    EXPECT_EQ(info.size, 1);
+    EXPECT_TRUE(info.can_branch);
+    EXPECT_FALSE(info.can_load);
+    EXPECT_FALSE(info.can_store);
+  }
+  EXPECT_EQ(disasm.num_calls(), 1);
+  EXPECT_EQ(cache.stats().hits, 2);
+  EXPECT_EQ(cache.stats().misses, 1);
+}
+
+TEST(DecodeCache, DifferentAddresses) {
+  FakeDisassembler disasm;
+  DecodeCache<FakeDisassembler> cache(disasm);
+  const uint8_t load[] = {2};
+  const uint8_t store[] = {3};
+  EXPECT_TRUE(cache.Decode(0x1000, load, 1).can_load);
+  EXPECT_TRUE(cache.Decode(0x1001, store, 1).can_store);
+  EXPECT_TRUE(cache.Decode(0x1000, load, 1).can_load);
+  EXPECT_TRUE(cache.Decode(0x1001, store, 1).can_store);
+  EXPECT_EQ(disasm.num_calls(), 2);
+}
+
+TEST(DecodeCache, ModifiedCode) {
+  FakeDisassembler disasm;
+  DecodeCache<FakeDisassembler> cache(disasm);
+  uint8_t bytes[] = {2, 0};
+  EXPECT_EQ(cache.Decode(0x1000, bytes, 2).id, 2);
+  // Same address, different bytes.
+  bytes[0] = 3;
+  EXPECT_EQ(cache.Decode(0x1000, bytes, 2).id, 3);
+  // Bytes past the instruction also count.
+  bytes[1] = 1;
+  EXPECT_EQ(cache.Decode(0x1000, bytes, 2).id, 3);
+  // Same bytes, different buffer size.
+  EXPECT_EQ(cache.Decode(0x1000, bytes, 1).id, 3);
+  EXPECT_EQ(disasm.num_calls(), 4);
+  EXPECT_EQ(cache.stats().hits, 0);
+}
+
+TEST(DecodeCache, Invalid) {
+  FakeDisassembler disasm;
+  DecodeCache<FakeDisassembler> cache(disasm);
+  const uint8_t bytes[] = {0};
+  EXPECT_FALSE(cache.Decode(0x1000, bytes, 1).valid);
+  EXPECT_FALSE(cache.Decode(0x1000, bytes, 1).valid);
+  EXPECT_EQ(disasm.num_calls(), 1);
+}
+
+TEST(DecodeCache, LongBuffer) {
+  FakeDisassembler disasm;
+  DecodeCache<FakeDisassembler> cache(disasm);
+  uint8_t bytes[DecodeCache<FakeDisassembler>::kMaxBytes + 1] = {2};
+  EXPECT_EQ(cache.Decode(0x1000, bytes, sizeof(bytes)).id, 2);
+  EXPECT_EQ(cache.Decode(0x1000, bytes, sizeof(bytes)).id, 2);
+  EXPECT_EQ(disasm.num_calls(), 2);
+}
+
+TEST(DecodeCache, Clear) {
+  FakeDisassembler disasm;
+  DecodeCache<FakeDisassembler> cache(disasm);
+  const uint8_t bytes[] = {1};
+  cache.Decode(0x1000, bytes, 1);
+  cache.Clear();
+  cache.Decode(0x1000, bytes, 1);
+  EXPECT_EQ(disasm.num_calls(), 2);
+}
+
+}  // namespace
+
+}  // namespace silifuzz
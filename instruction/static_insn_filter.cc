@@ -14,20 +14,85 @@
 
 #include "./instruction/static_insn_filter.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
 #include "absl/strings/string_view.h"
+#include "./instruction/xed_util.h"
 #include "./util/arch.h"
 #include "./util/bit_matcher.h"
 
+extern "C" {
+#include "third_party/libxed/xed-interface.h"
+}
+
 namespace silifuzz {
 
+// x86_64 filter
+namespace {
+
+// The checks are the same xed_util predicates the fuzzer's mutator uses, and
+// InstructionIsDeterministicInRunner() is also what DisassemblingSnapTracer
+// applies when making. Keep it that way so that the static filter never
+// rejects something the making process would accept.
+bool InstructionIsOK(const xed_decoded_inst_t& xedd,
+                     const InstructionFilterConfig<X86_64>& config) {
+  const xed_inst_t* instruction = xed_decoded_inst_inst(&xedd);
+  if (!InstructionCanRunInUserSpace(instruction) ||
+      InstructionRequiresIOPrivileges(instruction)) {
+    return false;
+  }
+  if (!config.non_deterministic_instructions_allowed &&
+      !InstructionIsDeterministicInRunner(instruction)) {
+    return false;
+  }
+  if (!config.avx512_instructions_allowed &&
+      (xed_classify_avx512(&xedd) || xed_classify_avx512_maskop(&xedd))) {
+    return false;
+  }
+  if (!config.amx_instructions_allowed && xed_classify_amx(&xedd)) {
+    return false;
+  }
+  if (!config.memory_operands_allowed &&
+      xed_decoded_inst_number_of_memory_operands(&xedd) != 0) {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// Execution starts at the first byte, so we decode linearly from there. A
+// branch may land in the middle of what we decoded, but we accept that
+// imprecision like the aarch64 filter does for dead code. Once an instruction
+// fails to decode we lose track of the instruction boundaries and accept the
+// rest of the sequence. The first instruction is always executed, though, and
+// the making process rejects executed instructions that XED cannot decode.
 template <>
 bool StaticInstructionFilter<X86_64>(
     absl::string_view code, const InstructionFilterConfig<X86_64>& config) {
-  // It's difficult to reliably disassemble x86_64 instructions, so for now we
-  // don't try.
+  InitXedIfNeeded();
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(code.data());
+  size_t offset = 0;
+  while (offset < code.size()) {
+    xed_decoded_inst_t xedd;
+    xed_decoded_inst_zero(&xedd);
+    xed_decoded_inst_set_mode(&xedd, XED_MACHINE_MODE_LONG_64,
+                              XED_ADDRESS_WIDTH_64b);
+    const unsigned int num_bytes = std::min<size_t>(
+        code.size() - offset, XED_MAX_INSTRUCTION_BYTES);
+    const xed_error_enum_t error = xed_decode(&xedd, bytes + offset, num_bytes);
+    if (error == XED_ERROR_BUFFER_TOO_SHORT) {
+      // The last instruction continues into the exit sequence. We cannot
+      // tell what it will decode to.
+      return true;
+    }
+    if (error != XED_ERROR_NONE) return offset != 0;
+    if (!InstructionIsOK(xedd, config)) return false;
+    offset += xed_decoded_inst_get_length(&xedd);
+  }
   return true;
 }
 
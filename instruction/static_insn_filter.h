@@ -24,7 +24,18 @@ template <typename Arch>
 struct InstructionFilterConfig;
 
 template <>
-struct InstructionFilterConfig<X86_64> {};
+struct InstructionFilterConfig<X86_64> {
+  // Instructions that InstructionIsDeterministicInRunner() rejects. The
+  // making process rejects them when tracing, see DecodedInsn.
+  bool non_deterministic_instructions_allowed = false;
+  // EVEX-encoded and mask register instructions.
+  bool avx512_instructions_allowed = true;
+  // The runner does not request AMX state from the kernel, so these fault.
+  bool amx_instructions_allowed = false;
+  // Instructions with explicit or implicit memory operands, including the
+  // stack.
+  bool memory_operands_allowed = true;
+};
 
 template <>
 struct InstructionFilterConfig<AArch64> {
@@ -39,8 +50,6 @@ struct InstructionFilterConfig<AArch64> {
 // Static analysis should be lightweight compared to the full making process and
 // works fine even with a host / target mismatch - such as fuzzing aarch64 qemu
 // on a x86_64 host.
-// Some architectures may not filter any instruction sequence at this stage and
-// always return true.
 template <typename Arch>
 bool StaticInstructionFilter(absl::string_view code,
                              const InstructionFilterConfig<Arch>& config = {});
@@ -0,0 +1,81 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Measures the cost of StaticInstructionFilter<X86_64> and how many making
+// runs it saves. Every input the filter rejects is one MakeRawInstructions()
+// call, i.e. one fork/exec/ptrace cycle, that does not happen. The
+// "rejected" counter is the fraction of the sample corpus that is rejected.
+//
+// The sample corpus mimics byte-level fuzzing inputs: random bytes of random
+// length. Compare with tools:fuzz_filter_tool_benchmark for the cost of a
+// making run.
+//
+// To run:
+//
+// bazel run -c opt \
+//   third_party/silifuzz/instruction:static_insn_filter_benchmark -- \
+//   --benchmark_filter=all
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "./instruction/static_insn_filter.h"
+#include "./util/arch.h"
+
+namespace silifuzz {
+namespace {
+
+constexpr size_t kNumInputs = 4096;
+constexpr size_t kMaxInputSize = 64;
+
+std::vector<std::string> MakeSampleCorpus() {
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<size_t> size_dist(1, kMaxInputSize);
+  std::uniform_int_distribution<int> byte_dist(0, 255);
+  std::vector<std::string> corpus(kNumInputs);
+  for (std::string& input : corpus) {
+    input.resize(size_dist(rng));
+    for (char& c : input) c = static_cast<char>(byte_dist(rng));
+  }
+  return corpus;
+}
+
+// Arg 0 is the default config, arg 1 also rejects AVX-512 and memory
+// operands.
+void BM_StaticInstructionFilter(benchmark::State& state) {
+  const std::vector<std::string> corpus = MakeSampleCorpus();
+  InstructionFilterConfig<X86_64> config;
+  if (state.range(0) != 0) {
+    config.avx512_instructions_allowed = false;
+    config.memory_operands_allowed = false;
+  }
+  size_t rejected = 0;
+  for (auto s : state) {
+    rejected = 0;
+    for (const std::string& input : corpus) {
+      rejected += !StaticInstructionFilter<X86_64>(input, config);
+    }
+    benchmark::DoNotOptimize(rejected);
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.size());
+  state.counters["rejected"] =
+      static_cast<double>(rejected) / static_cast<double>(corpus.size());
+}
+
+BENCHMARK(BM_StaticInstructionFilter)->ArgName("strict")->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace silifuzz
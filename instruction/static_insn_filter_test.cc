@@ -18,6 +18,7 @@
 
 #include <ios>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -32,6 +33,17 @@ std::string FromInts(std::vector<uint32_t>&& data) {
                      reinterpret_cast<char*>(&*data.end()));
 }
 
+std::string FromBytes(std::vector<uint8_t>&& data) {
+  return std::string(data.begin(), data.end());
+}
+
+// A function rather than a macro, the commas in a list of x86 instruction
+// bytes would split macro arguments.
+bool X86_64FilterAccepts(std::vector<uint8_t>&& insn,
+                         const InstructionFilterConfig<X86_64>& config = {}) {
+  return StaticInstructionFilter<X86_64>(FromBytes(std::move(insn)), config);
+}
+
 #define EXPECT_AARCH64_FILTER_ACCEPT(insn) \
   EXPECT_TRUE(StaticInstructionFilter<AArch64>(FromInts(insn)))
 
@@ -329,6 +341,92 @@ TEST(StaticInsnFilter, FloatingPointImmediate) {
   EXPECT_AARCH64_FILTER_REJECT({0x9e38b2d0});
 }
 
+TEST(StaticInsnFilterX86_64, Basic) {
+  EXPECT_TRUE(X86_64FilterAccepts({}));
+  // nop
+  EXPECT_TRUE(X86_64FilterAccepts({0x90}));
+  // ud2
+  EXPECT_TRUE(X86_64FilterAccepts({0x0f, 0x0b}));
+  // int3
+  EXPECT_TRUE(X86_64FilterAccepts({0xcc}));
+}
+
+TEST(StaticInsnFilterX86_64, NonDeterministic) {
+  InstructionFilterConfig<X86_64> config;
+  config.non_deterministic_instructions_allowed = true;
+
+  // rdtsc
+  EXPECT_FALSE(X86_64FilterAccepts({0x0f, 0x31}));
+  EXPECT_TRUE(X86_64FilterAccepts({0x0f, 0x31}, config));
+  // rdrand eax
+  EXPECT_FALSE(X86_64FilterAccepts({0x0f, 0xc7, 0xf0}));
+  // cpuid
+  EXPECT_FALSE(X86_64FilterAccepts({0x0f, 0xa2}));
+  // xbegin .+6
+  EXPECT_FALSE(X86_64FilterAccepts({0xc7, 0xf8, 0x00, 0x00, 0x00, 0x00}));
+  // syscall
+  EXPECT_FALSE(X86_64FilterAccepts({0x0f, 0x05}));
+
+  // Not the first instruction.
+  // nop; rdtsc
+  EXPECT_FALSE(X86_64FilterAccepts({0x90, 0x0f, 0x31}));
+}
+
+TEST(StaticInsnFilterX86_64, Privileged) {
+  // These are never OK.
+  InstructionFilterConfig<X86_64> config;
+  config.non_deterministic_instructions_allowed = true;
+
+  // hlt
+  EXPECT_FALSE(X86_64FilterAccepts({0xf4}, config));
+  // cli
+  EXPECT_FALSE(X86_64FilterAccepts({0xfa}, config));
+  // in al, dx
+  EXPECT_FALSE(X86_64FilterAccepts({0xec}, config));
+}
+
+TEST(StaticInsnFilterX86_64, Undecodable) {
+  // push es is not valid in 64-bit mode. The first instruction always runs.
+  EXPECT_FALSE(X86_64FilterAccepts({0x06}));
+  // Later on, the filter loses track of instruction boundaries and gives up.
+  // nop; push es; rdtsc
+  EXPECT_TRUE(X86_64FilterAccepts({0x90, 0x06, 0x0f, 0x31}));
+}
+
+TEST(StaticInsnFilterX86_64, Avx512) {
+  InstructionFilterConfig<X86_64> config;
+  config.avx512_instructions_allowed = false;
+
+  // vaddps zmm0, zmm1, zmm2
+  EXPECT_TRUE(X86_64FilterAccepts({0x62, 0xf1, 0x74, 0x48, 0x58, 0xc2}));
+  EXPECT_FALSE(
+      X86_64FilterAccepts({0x62, 0xf1, 0x74, 0x48, 0x58, 0xc2}, config));
+  // vaddps ymm0, ymm1, ymm2
+  EXPECT_TRUE(X86_64FilterAccepts({0xc5, 0xf4, 0x58, 0xc2}, config));
+}
+
+TEST(StaticInsnFilterX86_64, Amx) {
+  InstructionFilterConfig<X86_64> config;
+  config.amx_instructions_allowed = true;
+
+  // tilerelease
+  EXPECT_FALSE(X86_64FilterAccepts({0xc4, 0xe2, 0x78, 0x49, 0xc0}));
+  EXPECT_TRUE(X86_64FilterAccepts({0xc4, 0xe2, 0x78, 0x49, 0xc0}, config));
+}
+
+TEST(StaticInsnFilterX86_64, MemoryOperands) {
+  InstructionFilterConfig<X86_64> config;
+  config.memory_operands_allowed = false;
+
+  // mov rax, [rbx]
+  EXPECT_TRUE(X86_64FilterAccepts({0x48, 0x8b, 0x03}));
+  EXPECT_FALSE(X86_64FilterAccepts({0x48, 0x8b, 0x03}, config));
+  // push rax
+  EXPECT_FALSE(X86_64FilterAccepts({0x50}, config));
+  // mov rax, rbx
+  EXPECT_TRUE(X86_64FilterAccepts({0x48, 0x89, 0xd8}, config));
+}
+
 }  // namespace
 
 }  // namespace silifuzz
@@ -19,15 +19,24 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <csignal>  // IWYU pragma: keep
+#include <cstdint>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "absl/base/internal/endian.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "third_party/liblzma/lzma.h"
 #include "./proto/binary_log_entry.pb.h"
 #include "./proto/snapshot_execution_result.pb.h"
 #include "./util/byte_io.h"
@@ -42,6 +51,51 @@ namespace {
 // End-of-channel error status
 absl::Status EndOfChannelError() { return absl::OutOfRangeError("EOC"); }
 
+// Size of the compressed and uncompressed size fields of a frame.
+constexpr size_t kFrameHeaderSize = 2 * sizeof(uint64_t);
+
+// Upper bound on either size of a frame accepted by the consumer.
+constexpr uint64_t kMaxFrameSize = uint64_t{1} << 30;
+
+// Returns `data` as an xz stream.
+absl::StatusOr<std::string> Compress(absl::string_view data) {
+  std::string compressed(lzma_stream_buffer_bound(data.size()), 0);
+  size_t compressed_size = 0;
+  // Favor speed, the producer runs on the orchestrator's event loop thread.
+  const lzma_ret ret = lzma_easy_buffer_encode(
+      1 /* preset */, LZMA_CHECK_CRC32, nullptr,
+      reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+      reinterpret_cast<uint8_t*>(compressed.data()), &compressed_size,
+      compressed.size());
+  if (ret != LZMA_OK) {
+    return absl::InternalError(
+        absl::StrCat("Failed to compress binary log frame, lzma code = ", ret));
+  }
+  compressed.resize(compressed_size);
+  return compressed;
+}
+
+// Decompresses the xz stream in `compressed`, which must expand to exactly
+// `uncompressed_size` bytes.
+absl::StatusOr<std::string> Decompress(absl::string_view compressed,
+                                       size_t uncompressed_size) {
+  std::string data(uncompressed_size, 0);
+  uint64_t memlimit = UINT64_MAX;
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  const lzma_ret ret = lzma_stream_buffer_decode(
+      &memlimit, 0 /* flags */, nullptr,
+      reinterpret_cast<const uint8_t*>(compressed.data()), &in_pos,
+      compressed.size(), reinterpret_cast<uint8_t*>(data.data()), &out_pos,
+      data.size());
+  if (ret != LZMA_OK || in_pos != compressed.size() ||
+      out_pos != uncompressed_size) {
+    return absl::DataLossError(absl::StrCat(
+        "Cannot decompress binary log frame, lzma code = ", ret));
+  }
+  return data;
+}
+
 // Clears flags of a file descriptor.
 absl::Status ClearFlags(int fd, int flags) {
   const int old_flags = fcntl(fd, F_GETFL);
@@ -67,8 +121,9 @@ absl::Status WrapConstructorError(absl::Status s) {
 
 }  // namespace
 
-BinaryLogProducer::BinaryLogProducer(int fd, bool take_ownership)
-    : fd_(fd), take_ownership_(take_ownership) {
+BinaryLogProducer::BinaryLogProducer(int fd, const Options& options,
+                                     bool take_ownership)
+    : fd_(fd), take_ownership_(take_ownership), options_(options) {
   // Ignore SIGPIPE globally so that we do not get a signal when writing
   // to a pipe with closed reading end. Signal state is global so there is
   // no guarantee that SIGPIPE handling will not be changed after this.
@@ -76,40 +131,183 @@ BinaryLogProducer::BinaryLogProducer(int fd, bool take_ownership)
 
   // We need a non-blocking file descriptor.
   constructor_status_ = WrapConstructorError(ClearFlags(fd, O_NONBLOCK));
+
+  // In sync mode every entry would become its own xz stream, which costs
+  // more than compression saves on typical entries.
+  if (constructor_status_.ok() && options_.compress && !options_.async) {
+    constructor_status_ =
+        absl::InvalidArgumentError("compress requires async");
+  }
+
+  if (constructor_status_.ok() && options_.async) {
+    writer_thread_ = std::thread(&BinaryLogProducer::WriterLoop, this);
+  }
 }
 
 BinaryLogProducer::~BinaryLogProducer() {
+  if (writer_thread_.joinable()) {
+    {
+      absl::MutexLock l(&queue_mu_);
+      stop_ = true;
+    }
+    writer_thread_.join();
+    if (absl::Status s = Flush(); !s.ok()) {
+      LOG_ERROR("Cannot flush binary log: ", s.message());
+    }
+  }
   if (take_ownership_ && close(fd_) < 0) {
     LOG_ERROR("Cannot close channel descriptor: ", ErrnoStr(errno));
   }
 }
 
+absl::Status BinaryLogProducer::Send(const proto::BinaryLogEntry& entry) {
+  return SendImpl(entry, /*may_drop=*/true);
+}
+
+absl::Status BinaryLogProducer::SendAndFlush(
+    const proto::BinaryLogEntry& entry) {
+  RETURN_IF_NOT_OK(SendImpl(entry, /*may_drop=*/false));
+  return Flush();
+}
+
 // Send a BinaryLogEntry proto over the channel and return a status indicating
 // success or failure.
-absl::Status BinaryLogProducer::Send(const proto::BinaryLogEntry& entry) {
+absl::Status BinaryLogProducer::SendImpl(const proto::BinaryLogEntry& entry,
+                                         bool may_drop) {
   RETURN_IF_NOT_OK(constructor_status_);
 
+  const absl::Time enqueue_time = absl::Now();
   const std::string serialized_proto = entry.SerializeAsString();
   const uint64_t proto_size = serialized_proto.size();
-  char le_proto_size[sizeof(uint64_t)];
-  absl::little_endian::Store64(le_proto_size, proto_size);
+  std::string bytes(sizeof(uint64_t), 0);
+  absl::little_endian::Store64(bytes.data(), proto_size);
+  bytes.append(serialized_proto);
 
-  // The whole message needs to be written into channel atomically.
-  absl::MutexLock l(&lock_);
+  if (options_.async) {
+    absl::MutexLock l(&queue_mu_);
+    RETURN_IF_NOT_OK(write_status_);
+    if (may_drop && queue_.size() >= options_.max_queued_entries) {
+      ++stats_.entries_dropped;
+      return absl::ResourceExhaustedError("Binary log queue is full");
+    }
+    queue_.push_back({.bytes = std::move(bytes), .enqueue_time = enqueue_time});
+    return absl::OkStatus();
+  }
+
+  absl::Status status;
+  {
+    // The whole message needs to be written into channel atomically.
+    absl::MutexLock l(&lock_);
+    status = WriteEntries(bytes);
+  }
+  absl::MutexLock l(&queue_mu_);
+  RecordWrite({enqueue_time}, bytes.size(), status);
+  return status;
+}
+
+absl::Status BinaryLogProducer::Flush() {
+  if (!options_.async) return absl::OkStatus();
+  queue_mu_.LockWhen(absl::Condition(this, &BinaryLogProducer::QueueDrained));
+  absl::Status status = write_status_;
+  queue_mu_.Unlock();
+  return status;
+}
+
+BinaryLogProducer::Stats BinaryLogProducer::stats() const {
+  absl::MutexLock l(&queue_mu_);
+  return stats_;
+}
+
+absl::Status BinaryLogProducer::WriteEntries(absl::string_view entries) {
+  std::string framed;
+  absl::string_view data = entries;
+  if (options_.compress) {
+    if (!magic_written_) {
+      framed.resize(sizeof(uint64_t));
+      absl::little_endian::Store64(framed.data(), kCompressedBinaryLogMagic);
+      magic_written_ = true;
+    }
+    ASSIGN_OR_RETURN_IF_NOT_OK(std::string compressed, Compress(entries));
+    char frame_header[kFrameHeaderSize];
+    absl::little_endian::Store64(frame_header, compressed.size());
+    absl::little_endian::Store64(frame_header + sizeof(uint64_t),
+                                 entries.size());
+    framed.append(frame_header, sizeof(frame_header));
+    framed.append(compressed);
+    data = framed;
+  }
 
-  const ssize_t written_size = Write(fd_, le_proto_size, sizeof(le_proto_size));
+  const ssize_t written_size = Write(fd_, data.data(), data.size());
   if (written_size == -1) {
     return EndOfChannelError();
   }
-  if (written_size != sizeof(le_proto_size)) {
-    return absl::ErrnoToStatus(errno, "Cannot write BinaryLogEntry size");
-  }
-  if (Write(fd_, serialized_proto.data(), proto_size) != proto_size) {
+  if (written_size != data.size()) {
     return absl::ErrnoToStatus(errno, "Cannot write BinaryLogEntry");
   }
   return absl::OkStatus();
 }
 
+void BinaryLogProducer::RecordWrite(const std::vector<absl::Time>& enqueue_times,
+                                    size_t num_bytes,
+                                    const absl::Status& status) {
+  if (!status.ok()) {
+    stats_.entries_dropped += enqueue_times.size();
+    return;
+  }
+  const absl::Time now = absl::Now();
+  ++stats_.writes;
+  stats_.bytes_written += num_bytes;
+  stats_.entries_sent += enqueue_times.size();
+  for (absl::Time enqueue_time : enqueue_times) {
+    const absl::Duration latency = now - enqueue_time;
+    stats_.total_latency += latency;
+    stats_.max_latency = std::max(stats_.max_latency, latency);
+  }
+}
+
+void BinaryLogProducer::WriterLoop() {
+  while (true) {
+    std::string batch;
+    std::vector<absl::Time> enqueue_times;
+    queue_mu_.LockWhen(
+        absl::Condition(this, &BinaryLogProducer::WriterWorkAvailable));
+    if (queue_.empty()) {
+      // Stopped and drained.
+      queue_mu_.Unlock();
+      return;
+    }
+    if (!write_status_.ok()) {
+      // The channel is broken. Drop everything so that Flush() can return.
+      stats_.entries_dropped += queue_.size();
+      queue_.clear();
+      queue_mu_.Unlock();
+      continue;
+    }
+    while (!queue_.empty() &&
+           (batch.empty() || batch.size() + queue_.front().bytes.size() <=
+                                 options_.max_batch_bytes)) {
+      batch.append(queue_.front().bytes);
+      enqueue_times.push_back(queue_.front().enqueue_time);
+      queue_.pop_front();
+    }
+    write_in_flight_ = true;
+    queue_mu_.Unlock();
+
+    absl::Status status;
+    {
+      absl::MutexLock l(&lock_);
+      status = WriteEntries(batch);
+    }
+
+    absl::MutexLock l(&queue_mu_);
+    write_in_flight_ = false;
+    RecordWrite(enqueue_times, batch.size(), status);
+    if (!status.ok() && write_status_.ok()) {
+      write_status_ = status;
+    }
+  }
+}
+
 absl::Status BinaryLogProducer::SendSnapshotExecutionResult(
     const proto::SnapshotExecutionResult& result) {
   proto::BinaryLogEntry entry;
@@ -134,34 +332,95 @@ BinaryLogConsumer::~BinaryLogConsumer() {
 absl::StatusOr<proto::BinaryLogEntry> BinaryLogConsumer::Receive() {
   RETURN_IF_NOT_OK(constructor_status_);
 
-  char le_proto_size[sizeof(uint64_t)];
-
   // The whole message needs to be read from channel atomically.
   absl::MutexLock l(&lock_);
+  ASSIGN_OR_RETURN_IF_NOT_OK(std::string serialized_proto,
+                             ReadSerializedEntry());
+  proto::BinaryLogEntry entry;
+  if (!entry.ParseFromString(serialized_proto)) {
+    return absl::DataLossError("Cannot deserialize BinaryLogEntry");
+  }
+  return entry;
+}
+
+absl::StatusOr<std::string> BinaryLogConsumer::ReadSerializedEntry() {
+  if (!compressed_) {
+    char le_proto_size[sizeof(uint64_t)];
+    const ssize_t bytes_read = Read(fd_, le_proto_size, sizeof(le_proto_size));
+    if (bytes_read == 0) {
+      return EndOfChannelError();
+    }
+    if (bytes_read == -1) {
+      return absl::ErrnoToStatus(
+          errno, absl::StrCat("Cannot read BinaryLogEntry size, fd=", fd_));
+    } else if (bytes_read != sizeof(le_proto_size)) {
+      return absl::DataLossError(absl::StrCat("Malformed stream: expected ",
+                                              sizeof(le_proto_size),
+                                              " but got ", bytes_read,
+                                              " bytes"));
+    }
+    const size_t proto_size = absl::little_endian::Load64(le_proto_size);
+    if (!format_known_) {
+      format_known_ = true;
+      compressed_ = proto_size == kCompressedBinaryLogMagic;
+    }
+    if (!compressed_) {
+      std::string serialized_proto;
+      serialized_proto.resize(proto_size);
+      if (Read(fd_, serialized_proto.data(), proto_size) != proto_size) {
+        return absl::ErrnoToStatus(errno, "Cannot read BinaryLogEntry proto");
+      }
+      return serialized_proto;
+    }
+  }
 
-  const ssize_t bytes_read = Read(fd_, le_proto_size, sizeof(le_proto_size));
+  while (frame_pos_ == frame_data_.size()) {
+    RETURN_IF_NOT_OK(ReadFrame());
+  }
+  absl::string_view remaining =
+      absl::string_view(frame_data_).substr(frame_pos_);
+  if (remaining.size() < sizeof(uint64_t)) {
+    return absl::DataLossError("Malformed frame: truncated entry size");
+  }
+  const uint64_t proto_size = absl::little_endian::Load64(remaining.data());
+  remaining.remove_prefix(sizeof(uint64_t));
+  if (remaining.size() < proto_size) {
+    return absl::DataLossError("Malformed frame: truncated entry");
+  }
+  frame_pos_ += sizeof(uint64_t) + proto_size;
+  return std::string(remaining.substr(0, proto_size));
+}
+
+absl::Status BinaryLogConsumer::ReadFrame() {
+  char frame_header[kFrameHeaderSize];
+  const ssize_t bytes_read = Read(fd_, frame_header, sizeof(frame_header));
   if (bytes_read == 0) {
     return EndOfChannelError();
   }
   if (bytes_read == -1) {
     return absl::ErrnoToStatus(
-        errno, absl::StrCat("Cannot read BinaryLogEntry size, fd=", fd_));
-  } else if (bytes_read != sizeof(le_proto_size)) {
+        errno, absl::StrCat("Cannot read frame header, fd=", fd_));
+  } else if (bytes_read != sizeof(frame_header)) {
     return absl::DataLossError(absl::StrCat("Malformed stream: expected ",
-                                            sizeof(le_proto_size), " but got ",
+                                            sizeof(frame_header), " but got ",
                                             bytes_read, " bytes"));
   }
-  const size_t proto_size = absl::little_endian::Load64(le_proto_size);
-  std::string serialized_proto;
-  serialized_proto.resize(proto_size);
-  if (Read(fd_, serialized_proto.data(), proto_size) != proto_size) {
-    return absl::ErrnoToStatus(errno, "Cannot read BinaryLogEntry proto");
+  const uint64_t compressed_size = absl::little_endian::Load64(frame_header);
+  const uint64_t uncompressed_size =
+      absl::little_endian::Load64(frame_header + sizeof(uint64_t));
+  if (compressed_size > kMaxFrameSize || uncompressed_size > kMaxFrameSize) {
+    return absl::DataLossError(absl::StrCat(
+        "Malformed stream: frame too large: ", compressed_size, "/",
+        uncompressed_size));
   }
-  proto::BinaryLogEntry entry;
-  if (!entry.ParseFromString(serialized_proto)) {
-    return absl::DataLossError("Cannot deserialize BinaryLogEntry");
+  std::string compressed(compressed_size, 0);
+  if (Read(fd_, compressed.data(), compressed_size) != compressed_size) {
+    return absl::ErrnoToStatus(errno, "Cannot read frame");
   }
-  return entry;
+  ASSIGN_OR_RETURN_IF_NOT_OK(frame_data_,
+                             Decompress(compressed, uncompressed_size));
+  frame_pos_ = 0;
+  return absl::OkStatus();
 }
 
 }  // namespace silifuzz
@@ -15,12 +15,19 @@
 #ifndef THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_LOG_CHANNEL_H_
 #define THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_LOG_CHANNEL_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "./proto/binary_log_entry.pb.h"
 #include "./proto/snapshot_execution_result.pb.h"
 
@@ -40,6 +47,20 @@ namespace silifuzz {
 //    a) a 64-bit little endian integer representing the byte size of a
 //       serialized BinaryLogEntry protobuf that follows.
 //    b) the BinaryLogEntry protobuf serialized as bytes.
+//
+// Compressed binary log stream format:
+//
+// Producers only emit this format when asked to. Consumers that understand it
+// tell the two formats apart by the first 8 bytes of the stream.
+//    a) kCompressedBinaryLogMagic as a 64-bit little endian integer. As a
+//       size prefix this value is implausibly large, so it cannot be confused
+//       with the start of an uncompressed stream.
+//    b) zero or more consecutive frames. Each frame consists of a 64-bit little
+//       endian compressed size, a 64-bit little endian uncompressed size and
+//       an xz stream. Decompressed, the frame holds one or more entries in the
+//       uncompressed stream format above.
+inline constexpr uint64_t kCompressedBinaryLogMagic =
+    0x315a474f4c5a4653;  // "SFZLOGZ1"
 
 // Returns true iff s is the end-of-channel status. For details see
 // BinaryLogProducer::Send() and BinaryLogConsumer::Receive().
@@ -50,12 +71,46 @@ inline bool IsEndOfChannelError(const absl::Status& s) {
 // This class is thread-safe.
 class BinaryLogProducer {
  public:
+  struct Options {
+    // If true, Send() only queues entries and a background thread writes
+    // them out. This keeps a slow consumer from stalling the caller.
+    bool async = false;
+
+    // Maximum number of queued entries in async mode. Send() drops entries
+    // that do not fit.
+    size_t max_queued_entries = 1024;
+
+    // In async mode, queued entries are coalesced into writes of up to this
+    // many bytes. A single larger entry is still written as a whole.
+    size_t max_batch_bytes = 64 * 1024;
+
+    // If true, use the compressed stream format. The consumer must support it.
+    // Requires `async` so that each frame holds a batch of entries; Send()
+    // fails with InvalidArgumentError otherwise.
+    bool compress = false;
+  };
+
+  // Producer counters. Latency is measured from Send() to the completion of
+  // the write that carried the entry.
+  struct Stats {
+    uint64_t entries_sent = 0;
+    uint64_t entries_dropped = 0;
+    uint64_t writes = 0;
+    uint64_t bytes_written = 0;
+    absl::Duration total_latency = absl::ZeroDuration();
+    absl::Duration max_latency = absl::ZeroDuration();
+  };
+
   // Constructs a BinaryLogProducer object using file descriptor 'fd'.  If
   // 'take_ownership' is true, the object takes ownerships of the descriptor.
-  explicit BinaryLogProducer(int fd, bool take_ownership = true);
+  explicit BinaryLogProducer(int fd, bool take_ownership = true)
+      : BinaryLogProducer(fd, Options(), take_ownership) {}
+  BinaryLogProducer(int fd, const Options& options,
+                    bool take_ownership = true);
 
-  // Closes the file descriptor if this owns it. Any error reported by close()
-  // is logged but ignored as it is not recoverable.
+  // Writes out any queued entries, then closes the file descriptor if this
+  // owns it. Any error reported by close() is logged but ignored as it is not
+  // recoverable.
   ~BinaryLogProducer();
 
   // This cannot be copied or moved.
@@ -67,8 +122,22 @@ class BinaryLogProducer {
   // Sends a binary log entry proto and returns a status to indicate any errors.
   // In particular if the consumer closed its end of channel already before we
   // write to the channel, an OutOfRangeError("EOC") status is reported.
+  //
+  // In async mode, write errors are reported by the next Send() or Flush()
+  // after they occur. A full queue is reported as ResourceExhaustedError.
   absl::Status Send(const proto::BinaryLogEntry& entry);
 
+  // Like Send() but never drops `entry` for lack of queue space and waits
+  // until it is written, so that write errors are reported right away. Use
+  // this for entries that must not be lost, e.g. session start and summary.
+  absl::Status SendAndFlush(const proto::BinaryLogEntry& entry);
+
+  // Waits until all queued entries are written. Returns the first write error
+  // if any. Does nothing in sync mode.
+  absl::Status Flush();
+
+  Stats stats() const;
+
   // Helpers to send different types of messages.
 
   // Send a message containing 'result' via log channel.
@@ -76,20 +145,71 @@ class BinaryLogProducer {
       const proto::SnapshotExecutionResult& result);
 
  private:
+  // Implements Send() and SendAndFlush(). In async mode, drops `entry` if
+  // `may_drop` is true and the queue is full.
+  absl::Status SendImpl(const proto::BinaryLogEntry& entry, bool may_drop);
+
+  struct QueuedEntry {
+    // Entry in the uncompressed stream format.
+    std::string bytes;
+    absl::Time enqueue_time;
+  };
+
+  // Writes `entries`, one or more entries in the uncompressed stream format,
+  // to the channel using the configured format.
+  absl::Status WriteEntries(absl::string_view entries)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Accounts for a completed write of entries queued at `enqueue_times`.
+  void RecordWrite(const std::vector<absl::Time>& enqueue_times,
+                   size_t num_bytes, const absl::Status& status)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mu_);
+
+  // Main function of the writer thread in async mode.
+  void WriterLoop();
+
+  bool WriterWorkAvailable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mu_) {
+    return stop_ || !queue_.empty();
+  }
+
+  bool QueueDrained() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(queue_mu_) {
+    return queue_.empty() && !write_in_flight_;
+  }
+
   // File descriptor of the log channel.
   int fd_;
 
   // Whether this takes over ownership of fd_.
   bool take_ownership_;
 
+  const Options options_;
+
   // The channel is protected by a lock to avoid interleaving messages.
   absl::Mutex lock_;
 
+  // Whether kCompressedBinaryLogMagic has been written.
+  bool magic_written_ ABSL_GUARDED_BY(lock_) = false;
+
+  // Guards the async queue and the counters.
+  mutable absl::Mutex queue_mu_;
+  std::deque<QueuedEntry> queue_ ABSL_GUARDED_BY(queue_mu_);
+  bool write_in_flight_ ABSL_GUARDED_BY(queue_mu_) = false;
+  bool stop_ ABSL_GUARDED_BY(queue_mu_) = false;
+
+  // First error reported by the writer thread.
+  absl::Status write_status_ ABSL_GUARDED_BY(queue_mu_);
+
+  Stats stats_ ABSL_GUARDED_BY(queue_mu_);
+
+  std::thread writer_thread_;
+
   // error status set by constructor.
   absl::Status constructor_status_;
 };
 
 // This class is thread-safe.
+//
+// Accepts both the uncompressed and the compressed stream formats.
 class BinaryLogConsumer {
  public:
   // Constructs a BinaryLogConsumer object using file descriptor 'fd'.
@@ -114,6 +234,14 @@ class BinaryLogConsumer {
   absl::StatusOr<proto::BinaryLogEntry> Receive();
 
  private:
+  // Reads the next serialized BinaryLogEntry from the channel.
+  absl::StatusOr<std::string> ReadSerializedEntry()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Reads and decompresses the next frame of a compressed stream into
+  // frame_data_.
+  absl::Status ReadFrame() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // File descriptor of the log channel.
   int fd_;
 
@@ -123,6 +251,15 @@ class BinaryLogConsumer {
   // The channel is protected by a lock to avoid interleaving messages.
   absl::Mutex lock_;
 
+  // Whether the first 8 bytes of the stream have been seen and if so, whether
+  // they marked a compressed stream.
+  bool format_known_ ABSL_GUARDED_BY(lock_) = false;
+  bool compressed_ ABSL_GUARDED_BY(lock_) = false;
+
+  // Decompressed contents of the current frame and the read position in it.
+  std::string frame_data_ ABSL_GUARDED_BY(lock_);
+  size_t frame_pos_ ABSL_GUARDED_BY(lock_) = 0;
+
   // error status set by constructor.
   absl::Status constructor_status_;
 };
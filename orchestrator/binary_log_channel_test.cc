@@ -29,6 +29,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "./proto/binary_log_entry.pb.h"
 #include "./proto/player_result.pb.h"
@@ -136,6 +137,105 @@ TEST_F(BinaryLogChannelTest, SnapshotExecutionResults) {
             expected.snapshot_execution_result().snapshot_id());
 }
 
+// Sends `num_entries` entries through a producer with `options` and checks
+// that the consumer receives all of them in order.
+void SendAndReceive(int read_fd, int write_fd,
+                    const BinaryLogProducer::Options& options,
+                    int num_entries, BinaryLogProducer::Stats* stats) {
+  std::thread producer_thread([&]() {
+    BinaryLogProducer producer(write_fd, options);
+    for (int i = 0; i < num_entries; ++i) {
+      proto::BinaryLogEntry e;
+      e.mutable_snapshot_execution_result()->set_snapshot_id(
+          absl::StrCat("snapshot_", i));
+      ASSERT_OK(producer.Send(e));
+    }
+    ASSERT_OK(producer.Flush());
+    *stats = producer.stats();
+  });
+  BinaryLogConsumer consumer(read_fd);
+  for (int i = 0; i < num_entries; ++i) {
+    ASSERT_OK_AND_ASSIGN(proto::BinaryLogEntry entry, consumer.Receive());
+    EXPECT_EQ(entry.snapshot_execution_result().snapshot_id(),
+              absl::StrCat("snapshot_", i));
+  }
+  producer_thread.join();
+  EXPECT_TRUE(IsEndOfChannelError(consumer.Receive().status()));
+}
+
+TEST_F(BinaryLogChannelTest, AsyncProducer) {
+  constexpr int kNumEntries = 1000;
+  BinaryLogProducer::Stats stats;
+  SendAndReceive(ReleaseFD(READ_FD), ReleaseFD(WRITE_FD),
+                 {.async = true, .max_queued_entries = kNumEntries}, kNumEntries,
+                 &stats);
+  EXPECT_EQ(stats.entries_sent, kNumEntries);
+  EXPECT_EQ(stats.entries_dropped, 0);
+  EXPECT_LE(stats.writes, kNumEntries);
+  EXPECT_GE(stats.max_latency, absl::ZeroDuration());
+}
+
+TEST_F(BinaryLogChannelTest, CompressRequiresAsync) {
+  BinaryLogProducer producer(ReleaseFD(WRITE_FD), {.compress = true});
+  proto::BinaryLogEntry e;
+  EXPECT_THAT(producer.Send(e),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       StartsWith("compress requires async")));
+  EXPECT_EQ(producer.stats().writes, 0);
+}
+
+TEST_F(BinaryLogChannelTest, AsyncCompressedProducer) {
+  constexpr int kNumEntries = 1000;
+  BinaryLogProducer::Stats stats;
+  SendAndReceive(ReleaseFD(READ_FD), ReleaseFD(WRITE_FD),
+                 {.async = true,
+                  .max_queued_entries = kNumEntries,
+                  .max_batch_bytes = 1024,
+                  .compress = true},
+                 kNumEntries, &stats);
+  EXPECT_EQ(stats.entries_sent, kNumEntries);
+}
+
+TEST_F(BinaryLogChannelTest, AsyncQueueFull) {
+  BinaryLogProducer producer(ReleaseFD(WRITE_FD),
+                             {.async = true, .max_queued_entries = 0});
+  proto::BinaryLogEntry e;
+  EXPECT_THAT(producer.Send(e),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_EQ(producer.stats().entries_dropped, 1);
+}
+
+TEST_F(BinaryLogChannelTest, AsyncSendAndFlushIgnoresQueueLimit) {
+  BinaryLogConsumer consumer(ReleaseFD(READ_FD));
+  BinaryLogProducer producer(ReleaseFD(WRITE_FD),
+                             {.async = true, .max_queued_entries = 0});
+  proto::BinaryLogEntry e;
+  e.mutable_snapshot_execution_result()->set_snapshot_id("some_snapshot");
+  ASSERT_OK(producer.SendAndFlush(e));
+  EXPECT_EQ(producer.stats().entries_sent, 1);
+  EXPECT_EQ(producer.stats().entries_dropped, 0);
+  ASSERT_OK_AND_ASSIGN(proto::BinaryLogEntry entry, consumer.Receive());
+  EXPECT_EQ(entry.snapshot_execution_result().snapshot_id(), "some_snapshot");
+}
+
+TEST_F(BinaryLogChannelTest, AsyncSendAndFlushReportsWriteError) {
+  BinaryLogProducer producer(ReleaseFD(WRITE_FD), {.async = true});
+  CloseFD(READ_FD);
+  proto::BinaryLogEntry e;
+  EXPECT_TRUE(IsEndOfChannelError(producer.SendAndFlush(e)));
+}
+
+TEST_F(BinaryLogChannelTest, AsyncConsumerShutdown) {
+  BinaryLogProducer producer(ReleaseFD(WRITE_FD), {.async = true});
+  CloseFD(READ_FD);
+  proto::BinaryLogEntry e;
+  e.mutable_snapshot_execution_result()->set_snapshot_id("some_snapshot");
+  ASSERT_OK(producer.Send(e));
+  EXPECT_TRUE(IsEndOfChannelError(producer.Flush()));
+  EXPECT_TRUE(IsEndOfChannelError(producer.Send(e)));
+  EXPECT_EQ(producer.stats().entries_dropped, 1);
+}
+
 // Check that we got expected error at the one end of the channel when
 // the other end has been shut down.
 TEST_F(BinaryLogChannelTest, ProducerShutdown) {
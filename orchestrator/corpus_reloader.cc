@@ -0,0 +1,266 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./orchestrator/corpus_reloader.h"
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "./orchestrator/corpus_util.h"
+#include "./util/checks.h"
+#include "./util/tool_util.h"
+
+namespace silifuzz {
+
+namespace {
+
+ShardVersion VersionOf(const InMemoryShard& shard) {
+  return {
+      .name = shard.name,
+      .checksum = shard.checksum,
+      .file_size = shard.file_size,
+  };
+}
+
+}  // namespace
+
+bool CorpusReloader::FileStamp::operator==(const FileStamp& other) const {
+  return device == other.device && inode == other.inode &&
+         size == other.size && mtime.tv_sec == other.mtime.tv_sec &&
+         mtime.tv_nsec == other.mtime.tv_nsec;
+}
+
+absl::StatusOr<std::unique_ptr<CorpusReloader>> CorpusReloader::Create(
+    const Options& options) {
+  // Cannot use std::make_unique() with a private c-tor.
+  std::unique_ptr<CorpusReloader> reloader(new CorpusReloader(options));
+  ASSIGN_OR_RETURN_IF_NOT_OK(std::string contents,
+                             GetFileContents(options.shard_list_path));
+  std::vector<std::string> paths = ParseShardList(contents);
+  if (paths.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("No shards in ", options.shard_list_path));
+  }
+
+  // Take the stamps first so that a shard changing while it is loaded is
+  // reloaded on the next check.
+  std::vector<FileStamp> stamps;
+  stamps.reserve(paths.size());
+  for (const std::string& path : paths) {
+    ASSIGN_OR_RETURN_IF_NOT_OK(FileStamp stamp, Stat(path));
+    stamps.push_back(stamp);
+  }
+  ASSIGN_OR_RETURN_IF_NOT_OK(InMemoryCorpora corpora, LoadCorpora(paths));
+  if (options.validate_shards) {
+    RETURN_IF_NOT_OK(ValidateCorpus(corpora));
+  }
+
+  auto epoch = std::make_shared<CorpusEpoch>();
+  CorpusReloadEvent event;
+  {
+    absl::MutexLock reload_lock(&reloader->reload_mu_);
+    for (size_t i = 0; i < paths.size(); ++i) {
+      auto [it, inserted] = reloader->loaded_.try_emplace(paths[i]);
+      if (inserted) {
+        it->second = {
+            .stamp = stamps[i],
+            .shard = std::make_shared<const InMemoryShard>(
+                std::move(corpora.shards[i])),
+        };
+        event.loaded_shards.push_back(VersionOf(*it->second.shard));
+      }
+      epoch->shards.push_back(it->second.shard);
+    }
+    reloader->paths_ = std::move(paths);
+  }
+  {
+    absl::MutexLock l(&reloader->mu_);
+    reloader->current_ = std::move(epoch);
+    reloader->events_.push_back(std::move(event));
+  }
+
+  if (options.poll_interval != absl::InfiniteDuration()) {
+    reloader->poll_thread_ =
+        std::thread(&CorpusReloader::PollLoop, reloader.get());
+  }
+  return reloader;
+}
+
+CorpusReloader::CorpusReloader(const Options& options) : options_(options) {}
+
+CorpusReloader::~CorpusReloader() {
+  {
+    absl::MutexLock l(&mu_);
+    stop_ = true;
+  }
+  if (poll_thread_.joinable()) {
+    poll_thread_.join();
+  }
+}
+
+std::shared_ptr<const CorpusEpoch> CorpusReloader::Current() const {
+  absl::ReaderMutexLock l(&mu_);
+  return current_;
+}
+
+bool CorpusReloader::ReloadNow() {
+  absl::MutexLock reload_lock(&reload_mu_);
+  const std::shared_ptr<const CorpusEpoch> current = Current();
+  CorpusReloadEvent event;
+  event.epoch = current->number;
+
+  // Records a failure for `path` unless it already failed in the same state.
+  auto record_failure = [&](const std::string& path, const FileStamp& stamp,
+                            const absl::Status& status) {
+    auto [it, inserted] = failed_.try_emplace(path, stamp);
+    if (!inserted && it->second == stamp) return;
+    it->second = stamp;
+    event.failed_shards.push_back(
+        {.path = path, .error = std::string(status.message())});
+  };
+
+  absl::StatusOr<FileStamp> list_stamp = Stat(options_.shard_list_path);
+  absl::StatusOr<std::string> contents =
+      list_stamp.ok() ? GetFileContents(options_.shard_list_path)
+                      : list_stamp.status();
+  if (!contents.ok()) {
+    record_failure(options_.shard_list_path, list_stamp.value_or(FileStamp{}),
+                   contents.status());
+  }
+  std::vector<std::string> paths =
+      contents.ok() ? ParseShardList(*contents) : paths_;
+
+  absl::flat_hash_map<std::string, LoadedShard> next;
+  auto epoch = std::make_shared<CorpusEpoch>();
+  for (const std::string& path : paths) {
+    if (auto it = next.find(path); it != next.end()) {
+      epoch->shards.push_back(it->second.shard);
+      continue;
+    }
+    const auto previous = loaded_.find(path);
+    absl::StatusOr<FileStamp> stamp = Stat(path);
+    if (stamp.ok() && previous != loaded_.end() &&
+        previous->second.stamp == *stamp) {
+      next.emplace(path, previous->second);
+    } else if (auto it = failed_.find(path);
+               it != failed_.end() &&
+               it->second == stamp.value_or(FileStamp{})) {
+      // Still broken. Keep the previous version, if any.
+      if (previous != loaded_.end()) next.emplace(path, previous->second);
+    } else {
+      absl::StatusOr<std::shared_ptr<const InMemoryShard>> shard =
+          stamp.ok() ? Load(path) : stamp.status();
+      if (shard.ok()) {
+        failed_.erase(path);
+        event.loaded_shards.push_back(VersionOf(**shard));
+        next.emplace(path, LoadedShard{.stamp = *stamp, .shard = *shard});
+      } else {
+        record_failure(path, stamp.value_or(FileStamp{}), shard.status());
+        if (previous != loaded_.end()) next.emplace(path, previous->second);
+      }
+    }
+    if (auto it = next.find(path); it != next.end()) {
+      epoch->shards.push_back(it->second.shard);
+    }
+  }
+
+  bool changed = false;
+  if (epoch->shards.empty()) {
+    // Never publish an empty epoch, runners need at least one shard.
+    record_failure(options_.shard_list_path, list_stamp.value_or(FileStamp{}),
+                   absl::FailedPreconditionError("No loadable shards"));
+  } else {
+    if (contents.ok()) failed_.erase(options_.shard_list_path);
+    for (const auto& [path, loaded_shard] : loaded_) {
+      if (!next.contains(path)) {
+        event.removed_shards.push_back(loaded_shard.shard->name);
+      }
+    }
+    changed = epoch->shards != current->shards;
+    loaded_ = std::move(next);
+    paths_ = std::move(paths);
+  }
+
+  if (changed) {
+    epoch->number = current->number + 1;
+    event.epoch = epoch->number;
+    VLOG_INFO(0, "Publishing corpus epoch ", epoch->number, " with ",
+              epoch->shards.size(), " shards");
+  }
+  if (!changed && event.failed_shards.empty()) {
+    return false;
+  }
+
+  absl::MutexLock l(&mu_);
+  if (changed) {
+    // Runners that still hold the previous epoch keep its shards alive.
+    current_ = std::move(epoch);
+  }
+  events_.push_back(std::move(event));
+  return changed;
+}
+
+std::vector<CorpusReloadEvent> CorpusReloader::TakeEvents() {
+  absl::MutexLock l(&mu_);
+  std::vector<CorpusReloadEvent> events;
+  events.swap(events_);
+  return events;
+}
+
+absl::StatusOr<CorpusReloader::FileStamp> CorpusReloader::Stat(
+    const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return absl::ErrnoToStatus(errno, absl::StrCat("stat(", path, ")"));
+  }
+  return FileStamp{
+      .device = st.st_dev,
+      .inode = st.st_ino,
+      .size = st.st_size,
+      .mtime = st.st_mtim,
+  };
+}
+
+absl::StatusOr<std::shared_ptr<const InMemoryShard>> CorpusReloader::Load(
+    const std::string& path) const {
+  ASSIGN_OR_RETURN_IF_NOT_OK(InMemoryShard shard, LoadCorpus(path));
+  if (options_.validate_shards) {
+    RETURN_IF_NOT_OK(ValidateShard(shard));
+  }
+  return std::make_shared<const InMemoryShard>(std::move(shard));
+}
+
+void CorpusReloader::PollLoop() {
+  while (true) {
+    mu_.LockWhenWithTimeout(absl::Condition(&stop_), options_.poll_interval);
+    const bool stop = stop_;
+    mu_.Unlock();
+    if (stop) return;
+    ReloadNow();
+  }
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,183 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_CORPUS_RELOADER_H_
+#define THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_CORPUS_RELOADER_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "./orchestrator/corpus_util.h"
+
+namespace silifuzz {
+
+// An immutable set of corpus shards published by a CorpusReloader.
+//
+// Runner threads take a reference to the current epoch for every runner
+// invocation. An epoch, and with it the memfds of its shards, stays valid
+// until the last reference to it is dropped, so a reload never pulls a shard
+// from under an in-flight runner.
+struct CorpusEpoch {
+  // Sequence number of the epoch. The shards loaded at startup are epoch 0.
+  uint64_t number = 0;
+
+  // Shards in shard list order. Shards that did not change are shared with
+  // the previous epoch.
+  std::vector<std::shared_ptr<const InMemoryShard>> shards;
+};
+
+// Identifies the contents of a loaded shard.
+struct ShardVersion {
+  std::string name;
+  uint32_t checksum = 0;
+  uint64_t file_size = 0;
+};
+
+// A shard, or the shard list itself, that could not be reloaded.
+struct ShardReloadFailure {
+  std::string path;
+  std::string error;
+};
+
+// The outcome of one reload.
+struct CorpusReloadEvent {
+  // The epoch published by the reload. If the reload failed completely, this
+  // is the epoch still in use.
+  uint64_t epoch = 0;
+
+  // Shards that were added or changed. For epoch 0 these are all shards.
+  std::vector<ShardVersion> loaded_shards;
+
+  // Names of shards no longer in the shard list.
+  std::vector<std::string> removed_shards;
+
+  // Shards that failed to load or validate. A changed shard that fails keeps
+  // its previous version, a new one is left out.
+  std::vector<ShardReloadFailure> failed_shards;
+};
+
+// CorpusReloader watches a shard list file and the shards it lists. When
+// either changes, it decompresses and validates the new or changed shards in
+// a background thread and publishes them as a new CorpusEpoch. Changes are
+// detected by file identity, size and modification time, so replacing a shard
+// by renaming a new file over it is always picked up.
+//
+// This class is thread-safe.
+class CorpusReloader {
+ public:
+  struct Options {
+    // Path of the shard list file. See ParseShardList() for the format.
+    std::string shard_list_path;
+
+    // How often to check for changes. If infinite, there is no background
+    // thread and reloads only happen on ReloadNow().
+    absl::Duration poll_interval = absl::Seconds(30);
+
+    // If true, every shard is checked with ValidateShard() after loading.
+    bool validate_shards = true;
+  };
+
+  // Loads the initial epoch. Fails if any shard in the list cannot be loaded
+  // or validated, like LoadCorpora() and ValidateCorpus() do.
+  static absl::StatusOr<std::unique_ptr<CorpusReloader>> Create(
+      const Options& options);
+
+  // Not copyable or moveable -- owns a background thread.
+  CorpusReloader(const CorpusReloader&) = delete;
+  CorpusReloader(CorpusReloader&&) = delete;
+  CorpusReloader& operator=(const CorpusReloader&) = delete;
+  CorpusReloader& operator=(CorpusReloader&&) = delete;
+
+  ~CorpusReloader();
+
+  // Returns the current epoch. Never empty.
+  std::shared_ptr<const CorpusEpoch> Current() const;
+
+  // Checks the shard list and the shards once and publishes a new epoch if
+  // anything changed. Returns true iff a new epoch was published.
+  // The background thread calls this every `poll_interval`.
+  bool ReloadNow();
+
+  // Returns and clears the events of reloads since the last call, including
+  // the initial load, oldest first.
+  std::vector<CorpusReloadEvent> TakeEvents();
+
+ private:
+  // Identity of a file on disk.
+  struct FileStamp {
+    dev_t device = 0;
+    ino_t inode = 0;
+    off_t size = 0;
+    timespec mtime = {};
+
+    bool operator==(const FileStamp& other) const;
+  };
+
+  // A shard of the current epoch and the file it was loaded from.
+  struct LoadedShard {
+    FileStamp stamp;
+    std::shared_ptr<const InMemoryShard> shard;
+  };
+
+  explicit CorpusReloader(const Options& options);
+
+  // Returns the stamp of the file at `path`.
+  static absl::StatusOr<FileStamp> Stat(const std::string& path);
+
+  // Loads and optionally validates the shard at `path`.
+  absl::StatusOr<std::shared_ptr<const InMemoryShard>> Load(
+      const std::string& path) const;
+
+  // Main function of the polling thread.
+  void PollLoop();
+
+  const Options options_;
+
+  // Serializes reloads. Only the reload in progress touches the fields below.
+  absl::Mutex reload_mu_;
+
+  // The shard list of the current epoch.
+  std::vector<std::string> paths_ ABSL_GUARDED_BY(reload_mu_);
+
+  // Shards of the current epoch by path.
+  absl::flat_hash_map<std::string, LoadedShard> loaded_
+      ABSL_GUARDED_BY(reload_mu_);
+
+  // Stamps of shard files that failed to load. These are not retried until
+  // they change.
+  absl::flat_hash_map<std::string, FileStamp> failed_
+      ABSL_GUARDED_BY(reload_mu_);
+
+  mutable absl::Mutex mu_;
+  std::shared_ptr<const CorpusEpoch> current_ ABSL_GUARDED_BY(mu_);
+  std::vector<CorpusReloadEvent> events_ ABSL_GUARDED_BY(mu_);
+  bool stop_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::thread poll_thread_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_CORPUS_RELOADER_H_
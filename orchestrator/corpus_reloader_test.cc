@@ -0,0 +1,246 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./orchestrator/corpus_reloader.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./orchestrator/corpus_util.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+class CorpusReloaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = absl::StrCat(::testing::TempDir(), "/",
+                        ::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name());
+    ASSERT_EQ(mkdir(dir_.c_str(), 0700), 0);
+    list_path_ = absl::StrCat(dir_, "/shard_list");
+  }
+
+  std::string Path(const std::string& name) const {
+    return absl::StrCat(dir_, "/", name);
+  }
+
+  // Replaces the file at `path` by renaming a new one over it, like a corpus
+  // update would.
+  static void ReplaceFile(const std::string& path,
+                          const std::string& contents) {
+    const std::string tmp_path = absl::StrCat(path, ".tmp");
+    {
+      std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+      out << contents;
+      ASSERT_TRUE(out.good());
+    }
+    ASSERT_EQ(rename(tmp_path.c_str(), path.c_str()), 0);
+  }
+
+  void WriteShardList(const std::vector<std::string>& names) {
+    std::vector<std::string> paths;
+    for (const std::string& name : names) paths.push_back(Path(name));
+    ReplaceFile(list_path_, absl::StrJoin(paths, "\n"));
+  }
+
+  absl::StatusOr<std::unique_ptr<CorpusReloader>> CreateReloader() {
+    // Shard contents are not real corpora, skip validation.
+    return CorpusReloader::Create({.shard_list_path = list_path_,
+                                   .poll_interval = absl::InfiniteDuration(),
+                                   .validate_shards = false});
+  }
+
+  std::string dir_;
+  std::string list_path_;
+};
+
+TEST_F(CorpusReloaderTest, InitialEpoch) {
+  ReplaceFile(Path("a"), "aaaa");
+  ReplaceFile(Path("b"), "bb");
+  WriteShardList({"a", "b", "a"});
+  ASSERT_OK_AND_ASSIGN(auto reloader, CreateReloader());
+
+  std::shared_ptr<const CorpusEpoch> epoch = reloader->Current();
+  EXPECT_EQ(epoch->number, 0);
+  ASSERT_THAT(epoch->shards, SizeIs(3));
+  EXPECT_EQ(epoch->shards[0]->name, "a");
+  EXPECT_EQ(epoch->shards[1]->name, "b");
+  EXPECT_EQ(epoch->shards[0], epoch->shards[2]);
+
+  std::vector<CorpusReloadEvent> events = reloader->TakeEvents();
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_EQ(events[0].epoch, 0);
+  EXPECT_THAT(events[0].loaded_shards,
+              ElementsAre(Field(&ShardVersion::file_size, 4),
+                          Field(&ShardVersion::file_size, 2)));
+  EXPECT_THAT(reloader->TakeEvents(), IsEmpty());
+
+  EXPECT_FALSE(reloader->ReloadNow());
+  EXPECT_EQ(reloader->Current(), epoch);
+  EXPECT_THAT(reloader->TakeEvents(), IsEmpty());
+}
+
+TEST_F(CorpusReloaderTest, ChangedShard) {
+  ReplaceFile(Path("a"), "aaaa");
+  ReplaceFile(Path("b"), "bb");
+  WriteShardList({"a", "b"});
+  ASSERT_OK_AND_ASSIGN(auto reloader, CreateReloader());
+  reloader->TakeEvents();
+  std::shared_ptr<const CorpusEpoch> old_epoch = reloader->Current();
+
+  ReplaceFile(Path("a"), "aaaaaaaa");
+  EXPECT_TRUE(reloader->ReloadNow());
+  std::shared_ptr<const CorpusEpoch> epoch = reloader->Current();
+  EXPECT_EQ(epoch->number, 1);
+  ASSERT_THAT(epoch->shards, SizeIs(2));
+  EXPECT_EQ(epoch->shards[0]->file_size, 8);
+  EXPECT_EQ(epoch->shards[1], old_epoch->shards[1]);
+
+  // The previous epoch stays usable for runners that still hold it.
+  struct stat st;
+  ASSERT_EQ(stat(old_epoch->shards[0]->file_path.c_str(), &st), 0);
+  EXPECT_EQ(st.st_size, 4);
+
+  std::vector<CorpusReloadEvent> events = reloader->TakeEvents();
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_EQ(events[0].epoch, 1);
+  EXPECT_THAT(events[0].loaded_shards,
+              ElementsAre(Field(&ShardVersion::name, "a")));
+  EXPECT_THAT(events[0].removed_shards, IsEmpty());
+  EXPECT_THAT(events[0].failed_shards, IsEmpty());
+}
+
+TEST_F(CorpusReloaderTest, AddedAndRemovedShards) {
+  ReplaceFile(Path("a"), "aaaa");
+  ReplaceFile(Path("b"), "bb");
+  WriteShardList({"a", "b"});
+  ASSERT_OK_AND_ASSIGN(auto reloader, CreateReloader());
+  reloader->TakeEvents();
+
+  ReplaceFile(Path("c"), "c");
+  WriteShardList({"b", "c"});
+  EXPECT_TRUE(reloader->ReloadNow());
+  std::shared_ptr<const CorpusEpoch> epoch = reloader->Current();
+  EXPECT_EQ(epoch->number, 1);
+  ASSERT_THAT(epoch->shards, SizeIs(2));
+  EXPECT_EQ(epoch->shards[0]->name, "b");
+  EXPECT_EQ(epoch->shards[1]->name, "c");
+
+  std::vector<CorpusReloadEvent> events = reloader->TakeEvents();
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_THAT(events[0].loaded_shards,
+              ElementsAre(Field(&ShardVersion::name, "c")));
+  EXPECT_THAT(events[0].removed_shards, ElementsAre("a"));
+}
+
+TEST_F(CorpusReloaderTest, BrokenShard) {
+  ReplaceFile(Path("a"), "aaaa");
+  ReplaceFile(Path("b"), "bb");
+  WriteShardList({"a", "b"});
+  ASSERT_OK_AND_ASSIGN(auto reloader, CreateReloader());
+  reloader->TakeEvents();
+  std::shared_ptr<const CorpusEpoch> old_epoch = reloader->Current();
+
+  // A directory cannot be read as a shard.
+  ASSERT_EQ(unlink(Path("a").c_str()), 0);
+  ASSERT_EQ(mkdir(Path("a").c_str(), 0700), 0);
+  WriteShardList({"a", "b", "missing"});
+  EXPECT_FALSE(reloader->ReloadNow());
+  EXPECT_EQ(reloader->Current(), old_epoch);
+
+  std::vector<CorpusReloadEvent> events = reloader->TakeEvents();
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_EQ(events[0].epoch, 0);
+  EXPECT_THAT(events[0].loaded_shards, IsEmpty());
+  EXPECT_THAT(events[0].failed_shards,
+              ElementsAre(Field(&ShardReloadFailure::path, Path("a")),
+                          Field(&ShardReloadFailure::path, Path("missing"))));
+
+  // Failures are reported once until the files change.
+  EXPECT_FALSE(reloader->ReloadNow());
+  EXPECT_THAT(reloader->TakeEvents(), IsEmpty());
+
+  ASSERT_EQ(rmdir(Path("a").c_str()), 0);
+  ReplaceFile(Path("a"), "a");
+  EXPECT_TRUE(reloader->ReloadNow());
+  EXPECT_EQ(reloader->Current()->shards[0]->file_size, 1);
+  events = reloader->TakeEvents();
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_EQ(events[0].epoch, 1);
+  EXPECT_THAT(events[0].failed_shards, IsEmpty());
+}
+
+TEST_F(CorpusReloaderTest, NoLoadableShards) {
+  ReplaceFile(Path("a"), "aaaa");
+  WriteShardList({"a"});
+  ASSERT_OK_AND_ASSIGN(auto reloader, CreateReloader());
+  reloader->TakeEvents();
+
+  WriteShardList({});
+  EXPECT_FALSE(reloader->ReloadNow());
+  EXPECT_EQ(reloader->Current()->shards[0]->name, "a");
+  std::vector<CorpusReloadEvent> events = reloader->TakeEvents();
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_THAT(events[0].failed_shards,
+              ElementsAre(Field(&ShardReloadFailure::path, list_path_)));
+}
+
+TEST_F(CorpusReloaderTest, CreateFails) {
+  EXPECT_FALSE(CreateReloader().ok());
+  WriteShardList({});
+  EXPECT_THAT(CreateReloader(), StatusIs(absl::StatusCode::kInvalidArgument));
+  WriteShardList({"missing"});
+  EXPECT_FALSE(CreateReloader().ok());
+}
+
+TEST_F(CorpusReloaderTest, PollsInBackground) {
+  ReplaceFile(Path("a"), "aaaa");
+  WriteShardList({"a"});
+  ASSERT_OK_AND_ASSIGN(
+      auto reloader,
+      CorpusReloader::Create({.shard_list_path = list_path_,
+                              .poll_interval = absl::Milliseconds(10),
+                              .validate_shards = false}));
+  ReplaceFile(Path("a"), "aa");
+  while (reloader->Current()->number == 0) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(reloader->Current()->shards[0]->file_size, 2);
+}
+
+}  // namespace
+}  // namespace silifuzz
@@ -31,9 +31,11 @@
 #include "absl/cleanup/cleanup.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "third_party/liblzma/lzma.h"
@@ -78,6 +80,16 @@ absl::StatusOr<absl::Cord> ReadCord(int fd) {
   return cord;
 }
 
+// Returns a status for a failed liblzma call. Running out of memory is
+// reported as kResourceExhausted so that callers can retry, everything else
+// means the input is broken.
+absl::Status LzmaErrorToStatus(lzma_ret ret, absl::string_view message) {
+  if (ret == LZMA_MEM_ERROR || ret == LZMA_MEMLIMIT_ERROR) {
+    return absl::ResourceExhaustedError(message);
+  }
+  return absl::InternalError(message);
+}
+
 }  // namespace
 
 absl::StatusOr<absl::Cord> ReadXzipFile(const std::string& path) {
@@ -85,8 +97,8 @@ absl::StatusOr<absl::Cord> ReadXzipFile(const std::string& path) {
   lzma_ret ret = lzma_stream_decoder(
       &decompressed_stream, lzma_easy_decoder_memusage(9 /* level */), 0);
   if (ret != LZMA_OK) {
-    return absl::InternalError(
-        absl::StrCat("Failed to initialize decoder, return code =", ret));
+    return LzmaErrorToStatus(
+        ret, absl::StrCat("Failed to initialize decoder, return code =", ret));
   }
 
   constexpr size_t kInputChunkSize = 1 << 20;
@@ -106,8 +118,8 @@ absl::StatusOr<absl::Cord> ReadXzipFile(const std::string& path) {
   });
 
   if (input_fd < 0) {
-    return absl::InternalError(
-        absl::StrCat("Failed to open compressed file ", path));
+    return absl::ErrnoToStatus(
+        errno, absl::StrCat("Failed to open compressed file ", path));
   }
 
   absl::Cord decompressed_data;
@@ -124,8 +136,8 @@ absl::StatusOr<absl::Cord> ReadXzipFile(const std::string& path) {
         if (bytes_read == 0) {
           input_eof_seen = true;
         } else {
-          return absl::InternalError(
-              absl::StrCat("Failed to read compressed file ", path));
+          return absl::ErrnoToStatus(
+              errno, absl::StrCat("Failed to read compressed file ", path));
         }
       }
     }
@@ -146,8 +158,8 @@ absl::StatusOr<absl::Cord> ReadXzipFile(const std::string& path) {
   } while (ret == LZMA_OK);
 
   if (ret != LZMA_STREAM_END) {
-    return absl::InternalError(absl::StrCat("Failed to decompress data ", path,
-                                            ", lzma code = ", ret));
+    return LzmaErrorToStatus(ret, absl::StrCat("Failed to decompress data ",
+                                               path, ", lzma code = ", ret));
   }
 
   off_t consumed_size = lseek(input_fd, 0, SEEK_CUR);
@@ -211,18 +223,23 @@ std::string FilePathForFD(const OwnedFileDescriptor& fd) {
 constexpr const absl::string_view kXzExtension = ".xz";
 
 absl::StatusOr<InMemoryShard> LoadCorpus(const std::string& path) {
+  return LoadCorpus(path, path);
+}
+
+absl::StatusOr<InMemoryShard> LoadCorpus(const std::string& path,
+                                         const std::string& source_path) {
   std::string name = absl::StrCat(Basename(path));
 
   absl::Cord contents;
   if (absl::EndsWith(path, kXzExtension)) {
     // Clip .xz the extension from the file name.
     name = name.substr(0, name.size() - kXzExtension.size());
-    ASSIGN_OR_RETURN_IF_NOT_OK(contents, ReadXzipFile(path));
+    ASSIGN_OR_RETURN_IF_NOT_OK(contents, ReadXzipFile(source_path));
   } else {
     // Assume this is an uncompressed corpus.
-    int fd = open(path.c_str(), O_RDONLY);
+    int fd = open(source_path.c_str(), O_RDONLY);
     if (fd < 0) {
-      return absl::ErrnoToStatus(errno, absl::StrCat("open(): ", path));
+      return absl::ErrnoToStatus(errno, absl::StrCat("open(): ", source_path));
     }
     absl::Cleanup file_closer = absl::MakeCleanup([fd] { close(fd); });
     ASSIGN_OR_RETURN_IF_NOT_OK(contents, ReadCord(fd));
@@ -314,7 +331,8 @@ absl::Status ValidateShard(const InMemoryShard& shard) {
   const SnapCorpusHeader& header =
       *reinterpret_cast<const SnapCorpusHeader*>(shard.header_bytes.data());
   // Likely not a corpus file if the magic is wrong.
-  if (header.magic != kSnapCorpusMagic) {
+  if (header.magic != kSnapCorpusMagic &&
+      header.magic != kVersionedSnapCorpusMagic) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Shard ", shard.name, " has bad magic: ", HexStr(header.magic)));
   }
@@ -324,6 +342,14 @@ absl::Status ValidateShard(const InMemoryShard& shard) {
         "Shard ", shard.name, " header size should be ",
         sizeof(SnapCorpusHeader), " but it is ", header.header_size));
   }
+  // Snap data encoded differently would be misread.
+  if (!SnapCorpusMagicMatchesFormatVersion(header)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Shard ", shard.name, " has unsupported format version ",
+        static_cast<int>(header.format_version), " (magic ",
+        HexStr(header.magic),
+        ", latest version ", kSnapCorpusFormatVersion, ")"));
+  }
   // Likely file corruption if the size is wrong.
   if (header.num_bytes != shard.file_size) {
     return absl::InvalidArgumentError(
@@ -358,4 +384,15 @@ absl::Status ValidateCorpus(const InMemoryCorpora& corpora) {
   return absl::OkStatus();
 }
 
+std::vector<std::string> ParseShardList(absl::string_view contents) {
+  std::vector<std::string> shards;
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (!line.empty() && line[0] != '#') {
+      shards.emplace_back(line);
+    }
+  }
+  return shards;
+}
+
 }  // namespace silifuzz
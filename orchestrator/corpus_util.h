@@ -64,7 +64,8 @@ absl::Status ValidateCorpus(const InMemoryCorpora& corpora);
 absl::Status ValidateShard(const InMemoryShard& shard);
 
 // Reads an lzma compressed file into memory.  Returns its contents in a cord or
-// an error status.
+// an error status. Running out of memory or file descriptors is reported as
+// kResourceExhausted, a corrupt file as kInternal.
 absl::StatusOr<absl::Cord> ReadXzipFile(const std::string& path);
 
 // Creates a mem file and writes `contents` to it, and then seals it
@@ -85,6 +86,13 @@ absl::StatusOr<OwnedFileDescriptor> WriteSharedMemoryFile(
 // suffix of `path`. Currently only .xz is recognized.
 absl::StatusOr<InMemoryShard> LoadCorpus(const std::string& path);
 
+// Same as above but reads the shard bytes from `source_path` instead of
+// `path`. `path` is still used to name the shard and to pick the
+// decompression algorithm. This allows loading a shard from a copy of its
+// compressed bytes, e.g. one kept in a memfd, under its original name.
+absl::StatusOr<InMemoryShard> LoadCorpus(const std::string& path,
+                                         const std::string& source_path);
+
 // Reads and decompresses gzipped relocatable Snap corpora whose paths are in
 // `corpus_path`. Contents of each corpus are written in a file created in RAM.
 //
@@ -96,6 +104,11 @@ absl::StatusOr<InMemoryShard> LoadCorpus(const std::string& path);
 absl::StatusOr<InMemoryCorpora> LoadCorpora(
     const std::vector<std::string>& corpus_paths);
 
+// Parses the `contents` of a shard list file. Each non-empty line that does
+// not start with '#' names one shard. Leading and trailing whitespace is
+// ignored.
+std::vector<std::string> ParseShardList(absl::string_view contents);
+
 }  // namespace silifuzz
 
 #endif  // THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_CORPUS_UTIL_H_
@@ -115,7 +115,7 @@ TEST(CorpusUtil, ReadXZipFile) {
 
   // Invalid filename.
   cord_or = ReadXzipFile("/this does not exist");
-  EXPECT_THAT(cord_or, StatusIs(absl::StatusCode::kInternal,
+  EXPECT_THAT(cord_or, StatusIs(absl::StatusCode::kNotFound,
                                 HasSubstr("Failed to open")));
 }
 
@@ -223,7 +223,7 @@ TEST(CorpusUtil, LoadCorporaFileNotFound) {
       LoadCorpora(corpus_paths);
   EXPECT_THAT(
       load_corpora_result_or.status(),
-      StatusIs(absl::StatusCode::kInternal, HasSubstr("Failed to open")));
+      StatusIs(absl::StatusCode::kNotFound, HasSubstr("Failed to open")));
 }
 
 TEST(CorpusUtil, LoadCorporaUncompressed) {
@@ -257,6 +257,12 @@ TEST(CorpusUtil, LoadCorporaUncompressed) {
   }
 }
 
+TEST(CorpusUtil, ParseShardList) {
+  EXPECT_THAT(ParseShardList("a.xz\n  b.xz  \n\n# c.xz\nd"),
+              ::testing::ElementsAre("a.xz", "b.xz", "d"));
+  EXPECT_THAT(ParseShardList(""), ::testing::IsEmpty());
+}
+
 class ValidateShardTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -320,6 +326,36 @@ TEST_F(ValidateShardTest, VersionMismatch) {
               StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST_F(ValidateShardTest, Version0) {
+  // Corpora generated before format_version have the original magic and zero
+  // padding where format_version is now.
+  EXPECT_EQ(header_.magic, kSnapCorpusMagic);
+  EXPECT_EQ(header_.format_version, 0);
+  EXPECT_OK(ValidateShard(shard_));
+}
+
+TEST_F(ValidateShardTest, Version1) {
+  header_.magic = kVersionedSnapCorpusMagic;
+  header_.format_version = 1;
+  SyncHeader();
+  EXPECT_OK(ValidateShard(shard_));
+}
+
+TEST_F(ValidateShardTest, FormatVersionTooNew) {
+  header_.magic = kVersionedSnapCorpusMagic;
+  header_.format_version = kSnapCorpusFormatVersion + 1;
+  SyncHeader();
+  EXPECT_THAT(ValidateShard(shard_),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(ValidateShardTest, MagicFormatVersionMismatch) {
+  header_.format_version = 1;
+  SyncHeader();
+  EXPECT_THAT(ValidateShard(shard_),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(ValidateShardTest, ChecksumMismatch) {
   header_.checksum ^= 1;
   SyncHeader();
@@ -26,6 +26,10 @@ _ORCHESTRATOR_PATH = get_data_dependency(
 
 _RUNNER_PATH = get_data_dependency('silifuzz/orchestrator/test_runner')
 
+_STATS_PAGE_TOOL_PATH = get_data_dependency(
+    'silifuzz/orchestrator/stats_page_tool'
+)
+
 _ENDS_AS_EXPECTED_CORPUS_PATH = get_data_dependency(
     'silifuzz/snap/testing/ends_as_expected_corpus'
 )
@@ -161,6 +165,29 @@ class OrchestratorTest(absltest.TestCase):
         ],
     )
 
+  def test_stats_page(self):
+    stats_page = os.path.join(absltest.get_default_test_tmpdir(), 'stats_page')
+    (err_log, returncode) = self.run_orchestrator(
+        ['short_output'],
+        max_cpus=2,
+        extra_args=[f'--stats_page={stats_page}'],
+    )
+    self.assertEqual(returncode, 0)
+    self.assertStrSeqContainsAll(err_log, ['Publishing stats at'])
+    output = subprocess.run(
+        [_STATS_PAGE_TOOL_PATH, 'print', stats_page],
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    absl.logging.info(output)
+    total = [x for x in output.split('\n') if x.startswith('total ')]
+    self.assertLen(total, 1)
+    # invocations, snap_failures, runaways, internal_errors, ...
+    invocations, snap_failures = total[0].split()[1:3]
+    self.assertGreater(int(invocations), 0)
+    self.assertEqual(int(snap_failures), 0)
+
   def test_exit7(self):
     (err_log, returncode) = self.run_orchestrator(['short_loop', 'exit7'])
     self.assertEqual(returncode, 0)
@@ -17,25 +17,19 @@
 #include <stdint.h>
 #include <unistd.h>
 
-#include <algorithm>
 #include <cerrno>
 #include <cstdio>
 #include <filesystem>  // NOLINT
 #include <fstream>
-#include <memory>
 #include <string>
 #include <system_error>  // NOLINT
 #include <vector>
 
-#include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
-#include "absl/strings/string_view.h"
-#include "./orchestrator/corpus_util.h"
 #include "./util/checks.h"
 
 namespace silifuzz {
@@ -94,28 +88,6 @@ absl::StatusOr<Statm> ProcessStatm(pid_t pid) {
   return statm;
 }
 
-uint64_t MaxRunnerRssSizeBytes(pid_t pid, absl::string_view runner_name) {
-  std::vector<pid_t> pids = ListChildrenPids(pid);
-  uint64_t value = 0;
-  for (pid_t child_pid : pids) {
-    std::error_code ec;
-    fs::path exe =
-        fs::read_symlink(absl::StrCat("/proc/", child_pid, "/exe"), ec);
-    if (ec || !absl::StrContains(exe.string(), runner_name)) {
-      continue;
-    }
-    if (absl::StatusOr<Statm> s = ProcessStatm(child_pid); s.ok()) {
-      value = std::max(value, s->rss_bytes);
-    } else {
-      // Processes come and go regularly. An error returned from ProcessStatm()
-      // doesn't indicate a problem for the purposes of this function and
-      // can be skipped.
-      VLOG_INFO(2, s.status().message());
-    }
-  }
-  return value;
-}
-
 absl::StatusOr<uint64_t> AvailableMemoryMb() {
   std::ifstream ifs{"/proc/meminfo"};
   if (!ifs.good()) {
@@ -140,9 +112,8 @@ absl::StatusOr<uint64_t> AvailableMemoryMb() {
   return absl::NotFoundError("No MemAvailable entry in /proc/meminfo");
 }
 
-absl::StatusOr<std::vector<std::string>> CapShardsToMemLimit(
-    const std::vector<std::string> &shards, int64_t memory_usage_limit_mb,
-    uint64_t max_cpus) {
+absl::StatusOr<uint64_t> ShardMemoryBudgetMb(int64_t memory_usage_limit_mb,
+                                             uint64_t max_cpus) {
   // How much memory a single runner uses. 512Mb works the current corpus but
   // ideally the value should be computed on the fly by either loading a single
   // shard into the runner or precomputing the value and recording it in the
@@ -158,38 +129,9 @@ absl::StatusOr<std::vector<std::string>> CapShardsToMemLimit(
         "Not enough memory to run ", max_cpus,
         " runners with the given budget of ", memory_usage_limit_mb, "MB"));
   }
-  ASSIGN_OR_RETURN_IF_NOT_OK(
-      uint64_t top_shard_size_mb, [&]() -> absl::StatusOr<uint64_t> {
-        // Probe the top shard size. Works under the assumption that all shards
-        // are equally sized.
-        ASSIGN_OR_RETURN_IF_NOT_OK(InMemoryCorpora top_shard,
-                                   LoadCorpora({shards[0]}));
-        off_t top_shard_size =
-            lseek64(top_shard.shards[0].file_descriptor.borrow(), 0, SEEK_END);
-        if (top_shard_size < 0) {
-          return absl::InternalError(absl::StrCat("lseek64 errno = ", errno));
-        }
-        // Round up to 1 meg.
-        return std::max<uint64_t>(1, top_shard_size / (1024 * 1024));
-      }());
-  int max_shards =
-      std::min<int>(shards.size(), memory_budget_mb / top_shard_size_mb);
-  if (max_shards <= 0) {
-    return absl::ResourceExhaustedError(absl::StrCat(
-        "Cannot load any shards given the remaining memory budget ",
-        memory_budget_mb, "MB. Shard size = ", top_shard_size_mb, "MB"));
-  }
-
-  VLOG_INFO(0, "Shard 0 size is ", top_shard_size_mb,
-            "MB. With the remaining budget of ", memory_budget_mb,
-            "MB we can fit ", max_shards, " of ", shards.size());
-  memory_budget_mb -= top_shard_size_mb * max_shards;
-  VLOG_INFO(0, "Total expected memory usage of SiliFuzz is ",
-            memory_usage_limit_mb - memory_budget_mb, "MB");
-  std::vector<std::string> rv = shards;
-  std::shuffle(rv.begin(), rv.end(), absl::BitGen());
-  rv.resize(max_shards);
-  return rv;
+  VLOG_INFO(0, "Remaining budget for resident shards is ", memory_budget_mb,
+            "MB");
+  return memory_budget_mb;
 }
 
 }  // namespace silifuzz
@@ -18,11 +18,9 @@
 #include <stdint.h>
 #include <sys/types.h>
 
-#include <string>
 #include <vector>
 
 #include "absl/status/statusor.h"
-#include "absl/strings/string_view.h"
 
 namespace silifuzz {
 
@@ -32,13 +30,6 @@ struct Statm {
   uint64_t rss_bytes;
 };
 
-// Returns max RSS of the immediate childen of `pid` as reported by the
-// corresponding /proc/pid/statm files. The `runner_name` specifies a string
-// that the executable path of the process must contain to be considered of
-// interest.
-uint64_t MaxRunnerRssSizeBytes(
-    pid_t pid, absl::string_view runner_name = "reading_runner");
-
 // Returns the `pid`s VmSize as reported by /proc/pid/statm
 absl::StatusOr<Statm> ProcessStatm(pid_t pid);
 
@@ -51,15 +42,14 @@ std::vector<pid_t> ListChildrenPids(pid_t pid);
 // containerized. Any cgroup limits won't be reflected in the result.
 absl::StatusOr<uint64_t> AvailableMemoryMb();
 
-// Caps the number of `shards` such that the entire process fits in the
-// supplied `memory_usage_limit_mb`. `max_cpus` is the number of runner
-// processes that will be run in parallel.
-// NOTE: This function relies on the shard size and a guessestimate of how much
-// memory (max) a runner can use. The caller may want to apply a fudge factor of
-// 0.8 to the limit value to reduce memory pressure.
-absl::StatusOr<std::vector<std::string>> CapShardsToMemLimit(
-    const std::vector<std::string> &shards, int64_t memory_usage_limit_mb,
-    uint64_t max_cpus);
+// Returns how much memory (in MB) is left for resident corpus shards once
+// `max_cpus` runners are accounted for in `memory_usage_limit_mb`.
+// Returns RESOURCE_EXHAUSTED if the runners alone do not fit.
+// NOTE: This function relies on a guessestimate of how much memory (max) a
+// runner can use. The caller may want to apply a fudge factor of 0.8 to the
+// limit value to reduce memory pressure.
+absl::StatusOr<uint64_t> ShardMemoryBudgetMb(int64_t memory_usage_limit_mb,
+                                             uint64_t max_cpus);
 
 }  // namespace silifuzz
 
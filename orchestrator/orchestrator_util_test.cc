@@ -24,7 +24,6 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "./util/data_dependency.h"
 #include "./util/subprocess.h"
 #include "./util/testing/status_macros.h"
 #include "./util/testing/status_matchers.h"
@@ -37,7 +36,6 @@ using ::silifuzz::testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::Gt;
 using ::testing::IsEmpty;
-using ::testing::SizeIs;
 
 TEST(OrchestratorUtil, ListChildrenPids) {
   EXPECT_THAT(ListChildrenPids(getpid()), IsEmpty());
@@ -53,7 +51,6 @@ TEST(OrchestratorUtil, NoThrow) {
   pid_t bogus_pid = 9999999;  // kernel.pid_max = 4194304
   EXPECT_THAT(ListChildrenPids(bogus_pid), IsEmpty());
   EXPECT_THAT(ProcessStatm(bogus_pid), StatusIs(absl::StatusCode::kNotFound));
-  EXPECT_EQ(MaxRunnerRssSizeBytes(bogus_pid), 0);
 }
 
 TEST(OrchestratorUtil, ProcessStatm) {
@@ -63,44 +60,19 @@ TEST(OrchestratorUtil, ProcessStatm) {
   EXPECT_GT(stat->vm_size_bytes, 0);
 }
 
-TEST(OrchestratorUtil, MaxRunnerRssSizeBytes) {
-#if defined(ABSL_HAVE_THREAD_SANITIZER)
-  GTEST_SKIP() << "This test does not work under TSAN";
-#endif
-  Subprocess s;
-  ASSERT_OK(s.Start({"/bin/sleep", "3600"}));
-  EXPECT_GT(MaxRunnerRssSizeBytes(getpid(), ""), 0);
-  kill(s.pid(), SIGKILL);
-  std::string out;
-  s.Communicate(&out);
-}
-
 TEST(OrchestratorUtil, AvailableMemoryMb) {
   EXPECT_THAT(AvailableMemoryMb(), IsOkAndHolds(Gt(0)));
 }
 
-TEST(OrchestratorUtil, CapShardsToMemLimit) {
-  std::string shard =
-      GetDataDependencyFilepath("orchestrator/testdata/one_mb_of_zeros.xz");
-  std::vector<std::string> shards{1, shard};
-  absl::StatusOr<std::vector<std::string>> capped_shards =
-      CapShardsToMemLimit(shards, /* runner size */ 512 + /* extra */ 10, 1);
-  EXPECT_THAT(capped_shards, IsOkAndHolds(shards));
-
-  shards.resize(10, shard);
-  capped_shards =
-      CapShardsToMemLimit(shards, /* runner size */ 512 + /* extra */ 10, 1);
-  EXPECT_THAT(capped_shards, IsOkAndHolds(shards));
-
-  shards.resize(100, shard);
-  capped_shards =
-      CapShardsToMemLimit(shards, /* runner size */ 512 + /* extra */ 10, 1);
-  EXPECT_THAT(capped_shards, IsOkAndHolds(SizeIs(10)));
-
-  shards.resize(1, shard);
-  capped_shards =
-      CapShardsToMemLimit(shards, /* runner size */ 512 + /* extra */ 0, 1);
-  EXPECT_THAT(capped_shards, StatusIs(absl::StatusCode::kResourceExhausted));
+TEST(OrchestratorUtil, ShardMemoryBudgetMb) {
+  EXPECT_THAT(ShardMemoryBudgetMb(/* runner size */ 512 + /* extra */ 10, 1),
+              IsOkAndHolds(10));
+  EXPECT_THAT(ShardMemoryBudgetMb(/* runner size */ 2 * 512 + 100, 2),
+              IsOkAndHolds(100));
+  EXPECT_THAT(ShardMemoryBudgetMb(/* runner size */ 512 + /* extra */ 0, 1),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_THAT(ShardMemoryBudgetMb(/* runner size */ 512, 2),
+              StatusIs(absl::StatusCode::kResourceExhausted));
 }
 
 }  // namespace
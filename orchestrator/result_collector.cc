@@ -17,7 +17,6 @@
 #include <sched.h>
 #include <stdint.h>
 #include <sys/resource.h>
-#include <unistd.h>
 
 #include <algorithm>
 #include <cerrno>
@@ -36,7 +35,7 @@
 #include "absl/time/time.h"
 #include "./common/snapshot_enums.h"
 #include "./orchestrator/binary_log_channel.h"
-#include "./orchestrator/orchestrator_util.h"
+#include "./orchestrator/corpus_reloader.h"
 #include "./player/player_result_proto.h"
 #include "./proto/binary_log_entry.pb.h"
 #include "./proto/corpus_metadata.pb.h"
@@ -140,8 +139,7 @@ void LogV1SingleSnapFailure(const RunnerDriver::RunResult &run_result) {
 
 // Logs V1-style summary e.g.
 // Silifuzz Checker Result:{issues_detected ... }
-void LogV1CompatSummary(const Summary &summary, absl::Duration elapsed,
-                        uint64_t max_rss_kb) {
+void LogV1CompatSummary(const Summary &summary, absl::Duration elapsed) {
   static bool enable_v1_compat_logging =
       absl::GetFlag(FLAGS_enable_v1_compat_logging);
   if (!enable_v1_compat_logging) return;
@@ -161,7 +159,7 @@ void LogV1CompatSummary(const Summary &summary, absl::Duration elapsed,
             << ", batch_count = ?, play_count = " << summary.play_count
             << ", snapshot_execution_errors = 0"
             << ", runaway_count = " << summary.num_runaway_snapshots
-            << ", max_rss_kb = " << max_rss_kb
+            << ", max_rss_kb = " << summary.max_runner_wait_maxrss_kb
             << ", had_checker_misconfigurations = false}" << '\n';
 }
 
@@ -174,7 +172,8 @@ ResultCollector::ResultCollector(int binary_log_channel_fd,
       options_(options) {
   binary_log_producer_ =
       binary_log_channel_fd >= 0
-          ? std::make_unique<BinaryLogProducer>(binary_log_channel_fd)
+          ? std::make_unique<BinaryLogProducer>(binary_log_channel_fd,
+                                                options.binary_log_options)
           : nullptr;
   session_id_ =
       absl::StrCat(ShortHostname(), "/", absl::ToUnixNanos(start_time_));
@@ -183,7 +182,16 @@ ResultCollector::ResultCollector(int binary_log_channel_fd,
 // Processes a single execution result.
 bool ResultCollector::operator()(const RunnerDriver::RunResult &result) {
   ++summary_.play_count;
-  max_rss_kb_ = std::max(max_rss_kb_, MaxRunnerRssSizeBytes(getpid()) / 1024);
+  // ru_maxrss is in kilobytes on Linux.
+  summary_.max_runner_wait_maxrss_kb = std::max<uint64_t>(
+      summary_.max_runner_wait_maxrss_kb, result.rusage().ru_maxrss);
+  for (const std::string &snapshot_id : result.quarantined_snapshot_ids()) {
+    if (quarantined_snapshot_ids_.insert(snapshot_id).second) {
+      LOG_ERROR("Snapshot [", snapshot_id,
+                "] quarantined: its memory mappings conflict with the runner");
+    }
+  }
+  summary_.num_quarantined_snapshots = quarantined_snapshot_ids_.size();
   bool should_stop = false;
   if (!result.success()) {
     if (result.player_result().outcome ==
@@ -197,7 +205,9 @@ bool ResultCollector::operator()(const RunnerDriver::RunResult &result) {
         RunResultToSnapshotExecutionResult(result, absl::Now(), session_id_);
     if (entry_or.ok()) {
       if (binary_log_producer_) {
-        if (absl::Status s = binary_log_producer_->Send(*entry_or); !s.ok()) {
+        // Drops due to a full queue are counted and reported by LogSummary().
+        if (absl::Status s = binary_log_producer_->Send(*entry_or);
+            !s.ok() && !absl::IsResourceExhausted(s)) {
           LOG_ERROR(s.message());
         }
       }
@@ -212,12 +222,29 @@ bool ResultCollector::operator()(const RunnerDriver::RunResult &result) {
 
 void ResultCollector::LogSummary(bool always) {
   absl::Time now = absl::Now();
-  if (always || now > last_summary_log_time_ + log_interval_) {
-    LogV1CompatSummary(summary_,
-                       absl::Trunc(now - start_time_, absl::Seconds(1)),
-                       max_rss_kb_);
-    last_summary_log_time_ = now;
-    log_interval_ = std::min(log_interval_ * 2, absl::Minutes(1));
+  if (!always && now <= last_summary_log_time_ + log_interval_) return;
+  LogV1CompatSummary(summary_,
+                     absl::Trunc(now - start_time_, absl::Seconds(1)));
+  last_summary_log_time_ = now;
+  log_interval_ = std::min(log_interval_ * 2, absl::Minutes(1));
+
+  if (binary_log_producer_ == nullptr) return;
+  BinaryLogProducer::Stats stats = binary_log_producer_->stats();
+  if (stats.entries_dropped > reported_binary_log_drops_) {
+    LOG_ERROR("Binary log: dropped ",
+              stats.entries_dropped - reported_binary_log_drops_,
+              " entries since last report");
+    reported_binary_log_drops_ = stats.entries_dropped;
+  }
+  if (always) {
+    const absl::Duration mean_latency =
+        stats.entries_sent > 0 ? stats.total_latency / stats.entries_sent
+                               : absl::ZeroDuration();
+    LOG_INFO("Binary log: sent: ", stats.entries_sent,
+             " dropped: ", stats.entries_dropped, " writes: ", stats.writes,
+             " bytes: ", stats.bytes_written,
+             " mean latency: ", absl::FormatDuration(mean_latency),
+             " max latency: ", absl::FormatDuration(stats.max_latency));
   }
 }
 
@@ -243,7 +270,7 @@ absl::Status ResultCollector::LogSessionStart(
 
   *entry.mutable_session_start()->mutable_corpus_metadata() = corpus_metadata;
 
-  return binary_log_producer_->Send(entry);
+  return binary_log_producer_->SendAndFlush(entry);
 }
 
 absl::Status ResultCollector::LogSessionSummary(
@@ -262,13 +289,18 @@ absl::Status ResultCollector::LogSessionSummary(
   auto ru = entry.mutable_session_summary()->mutable_resource_usage();
   *ru->mutable_user_time() = DurationToProto(user_time);
   *ru->mutable_system_time() = DurationToProto(sys_time);
-  ru->set_max_rss_kb(max_rss_kb_);
+  ru->set_max_rss_kb(summary_.max_runner_wait_maxrss_kb);
 
   auto playback_summary =
       entry.mutable_session_summary()->mutable_playback_summary();
   playback_summary->set_num_failed_snapshots(summary_.num_failed_snapshots);
   playback_summary->set_play_count(summary_.play_count);
   playback_summary->set_num_runaway_snapshots(summary_.num_runaway_snapshots);
+  playback_summary->set_num_quarantined_snapshots(
+      summary_.num_quarantined_snapshots);
+  playback_summary->set_num_corpus_reloads(summary_.num_corpus_reloads);
+  playback_summary->set_num_corpus_reload_failures(
+      summary_.num_corpus_reload_failures);
 
   *entry.mutable_session_summary()->mutable_duration() =
       DurationToProto(now - start_time_);
@@ -284,7 +316,47 @@ absl::Status ResultCollector::LogSessionSummary(
 
   *entry.mutable_session_summary()->mutable_corpus_metadata() = corpus_metadata;
 
-  return binary_log_producer_->Send(entry);
+  return binary_log_producer_->SendAndFlush(entry);
+}
+
+absl::Status ResultCollector::LogCorpusReload(const CorpusReloadEvent &event) {
+  if (event.epoch > last_corpus_epoch_) {
+    summary_.num_corpus_reloads += event.epoch - last_corpus_epoch_;
+    last_corpus_epoch_ = event.epoch;
+  }
+  summary_.num_corpus_reload_failures += event.failed_shards.size();
+  LOG_INFO("Corpus epoch ", event.epoch, ": loaded ",
+           event.loaded_shards.size(), " shards, removed ",
+           event.removed_shards.size(), " shards");
+  for (const ShardReloadFailure &failure : event.failed_shards) {
+    LOG_ERROR("Failed to reload ", failure.path, ": ", failure.error);
+  }
+
+  if (binary_log_producer_ == nullptr) {
+    return absl::OkStatus();
+  }
+  proto::BinaryLogEntry entry;
+  entry.set_session_id(session_id_);
+  *entry.mutable_timestamp() = TimeToProto(absl::Now());
+  proto::logging::CorpusReload *corpus_reload = entry.mutable_corpus_reload();
+  corpus_reload->set_epoch(event.epoch);
+  for (const ShardVersion &version : event.loaded_shards) {
+    proto::logging::ShardVersion *shard = corpus_reload->add_loaded_shards();
+    shard->set_name(version.name);
+    shard->set_checksum(version.checksum);
+    shard->set_file_size(version.file_size);
+  }
+  for (const std::string &name : event.removed_shards) {
+    corpus_reload->add_removed_shards(name);
+  }
+  for (const ShardReloadFailure &failure : event.failed_shards) {
+    proto::logging::ShardReloadFailure *failed = corpus_reload->add_failed_shards();
+    failed->set_path(failure.path);
+    failed->set_error(failure.error);
+  }
+  // Reloads are rare and consumers need them to attribute later results to
+  // the right shard versions, so never drop them.
+  return binary_log_producer_->SendAndFlush(entry);
 }
 
 }  // namespace silifuzz
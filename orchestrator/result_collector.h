@@ -21,10 +21,12 @@
 #include <memory>
 #include <string>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "./orchestrator/binary_log_channel.h"
+#include "./orchestrator/corpus_reloader.h"
 #include "./proto/corpus_metadata.pb.h"
 #include "./runner/driver/runner_driver.h"
 
@@ -40,6 +42,24 @@ struct Summary {
 
   // Number of runaways detected.
   uint64_t num_runaway_snapshots = 0;
+
+  // Largest ru_maxrss reported by wait4(2) for a runner. This is not the
+  // runner's own peak RSS: runners are started with vfork(), so exec seeds
+  // ru_maxrss with the orchestrator's peak RSS at that time. The value is the
+  // larger of the two. memory.peak of --runner_cgroup measures the runners
+  // alone.
+  uint64_t max_runner_wait_maxrss_kb = 0;
+
+  // Number of distinct snapshots the runners quarantined because their memory
+  // mappings conflict with those of the runner. These are not failures.
+  uint64_t num_quarantined_snapshots = 0;
+
+  // Number of corpus epochs published by hot reloads, excluding the initial
+  // one.
+  uint64_t num_corpus_reloads = 0;
+
+  // Number of shards that failed to reload.
+  uint64_t num_corpus_reload_failures = 0;
 };
 
 // ResultCollector handles execution results produced by worker threads. When
@@ -54,6 +74,9 @@ class ResultCollector {
 
     // Fail after seeing this many errors.
     int fail_after_n_errors = std::numeric_limits<int>::max();
+
+    // Options of the BinaryLogProducer, if any.
+    BinaryLogProducer::Options binary_log_options;
   };
 
   // If `binary_log_fd_channel` >= 0, will also log each result to the said
@@ -68,18 +91,25 @@ class ResultCollector {
   // Current execution summary.
   const Summary &summary() const { return summary_; }
 
-  // Logs the current execution summary to stderr. When `always` is true,
-  // disables time-based throttling.
+  // Logs the current execution summary to stderr, along with the number of
+  // binary log entries dropped since the last call. When `always` is true,
+  // disables time-based throttling and also logs all binary log counters.
   void LogSummary(bool always = false);
 
-  // Logs session start to binary_log_channel (if any).
+  // Logs session start to binary_log_channel (if any). Waits until the entry
+  // is written.
   absl::Status LogSessionStart(const proto::CorpusMetadata &corpus_metadata,
                                absl::string_view orchestrator_version);
 
-  // Logs session summary to binary_log_channel (if any).
+  // Logs session summary to binary_log_channel (if any). Waits until the
+  // entry is written.
   absl::Status LogSessionSummary(const proto::CorpusMetadata &corpus_metadata,
                                  absl::string_view orchestrator_version);
 
+  // Logs a corpus reload event to stderr and binary_log_channel (if any).
+  // Waits until the entry is written.
+  absl::Status LogCorpusReload(const CorpusReloadEvent &event);
+
  private:
   std::unique_ptr<BinaryLogProducer> binary_log_producer_;
   absl::Time last_summary_log_time_ = absl::InfinitePast();
@@ -88,7 +118,16 @@ class ResultCollector {
   absl::Time start_time_;
   Options options_;
   std::string session_id_;
-  uint64_t max_rss_kb_ = 0;
+
+  // Snapshots quarantined so far. Every runner over the same corpus reports
+  // the same snapshots, each is logged only once.
+  absl::flat_hash_set<std::string> quarantined_snapshot_ids_;
+
+  // Number of dropped binary log entries already reported by LogSummary().
+  uint64_t reported_binary_log_drops_ = 0;
+
+  // Latest corpus epoch passed to LogCorpusReload().
+  uint64_t last_corpus_epoch_ = 0;
 };
 
 }  // namespace silifuzz
@@ -14,15 +14,23 @@
 
 #include "./orchestrator/result_collector.h"
 
+#include <sys/resource.h>
 #include <unistd.h>
 
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "absl/time/clock.h"
 #include "./common/snapshot_enums.h"
 #include "./orchestrator/binary_log_channel.h"
+#include "./orchestrator/corpus_reloader.h"
 #include "./proto/binary_log_entry.pb.h"
+#include "./proto/session_summary.pb.h"
 #include "./proto/snapshot_execution_result.pb.h"
 #include "./runner/driver/runner_driver.h"
+#include "./util/subprocess.h"
 #include "./util/testing/status_macros.h"
 
 namespace silifuzz {
@@ -42,6 +50,47 @@ TEST(ResultCollector, Simple) {
   ASSERT_EQ(collector.summary().num_failed_snapshots, 1);
 }
 
+TEST(ResultCollector, MaxRunnerWaitMaxRss) {
+  // Raise the peak RSS of this process well above that of /bin/true.
+  constexpr size_t kBufferSize = 64 << 20;
+  std::vector<char> buffer(kBufferSize);
+  memset(buffer.data(), 1, buffer.size());
+  struct rusage self;
+  ASSERT_EQ(getrusage(RUSAGE_SELF, &self), 0);
+
+  // Subprocess uses vfork() just like RunnerDriver.
+  Subprocess subprocess;
+  ASSERT_OK(subprocess.Start({"/bin/true"}));
+  std::string stdout_contents;
+  ProcessInfo info = subprocess.Communicate(&stdout_contents);
+
+  ResultCollector collector(-1, absl::Now(), {});
+  collector(RunnerDriver::RunResult::Successful(info.rusage));
+  RunnerDriver::PlayerResult result = {
+      .outcome = PlaybackOutcome::kExecutionMisbehave};
+  collector(RunnerDriver::RunResult(result, {}, "snap_id"));
+  // The child's ru_maxrss includes the peak RSS of its parent.
+  EXPECT_GE(collector.summary().max_runner_wait_maxrss_kb, self.ru_maxrss);
+  EXPECT_GE(collector.summary().max_runner_wait_maxrss_kb,
+            kBufferSize / 1024);
+}
+
+TEST(ResultCollector, QuarantinedSnapshots) {
+  ResultCollector collector(-1, absl::Now(), {});
+  RunnerDriver::RunResult success = RunnerDriver::RunResult::Successful({});
+  success.set_quarantined_snapshot_ids({"snap_a", "snap_b"});
+  collector(success);
+  // Each runner over the same corpus reports the same snapshots.
+  collector(success);
+  RunnerDriver::PlayerResult result = {
+      .outcome = PlaybackOutcome::kExecutionMisbehave};
+  RunnerDriver::RunResult failure(result, {}, "snap_id");
+  failure.set_quarantined_snapshot_ids({"snap_a"});
+  collector(failure);
+  EXPECT_EQ(collector.summary().num_quarantined_snapshots, 2);
+  EXPECT_EQ(collector.summary().num_failed_snapshots, 1);
+}
+
 TEST(ResultCollector, BinaryLogging) {
   int pipefd[2] = {-1, -1};
   ASSERT_EQ(pipe(pipefd), 0);
@@ -59,6 +108,65 @@ TEST(ResultCollector, BinaryLogging) {
   ASSERT_EQ(fd_log_entry.snapshot_execution_result().snapshot_id(), "snap_id");
 }
 
+TEST(ResultCollector, CorpusReload) {
+  int pipefd[2] = {-1, -1};
+  ASSERT_EQ(pipe(pipefd), 0);
+  {
+    ResultCollector collector(pipefd[1], absl::Now(), {});
+    ASSERT_OK(collector.LogCorpusReload(
+        {.epoch = 0, .loaded_shards = {{.name = "shard_a"}}}));
+    EXPECT_EQ(collector.summary().num_corpus_reloads, 0);
+    ASSERT_OK(collector.LogCorpusReload({
+        .epoch = 1,
+        .loaded_shards = {{.name = "shard_b", .checksum = 1, .file_size = 2}},
+        .removed_shards = {"shard_a"},
+        .failed_shards = {{.path = "/shard_c", .error = "bad"}},
+    }));
+    EXPECT_EQ(collector.summary().num_corpus_reloads, 1);
+    EXPECT_EQ(collector.summary().num_corpus_reload_failures, 1);
+    // A reload that only failed keeps the epoch.
+    ASSERT_OK(collector.LogCorpusReload(
+        {.epoch = 1, .failed_shards = {{.path = "/shard_d", .error = "bad"}}}));
+    EXPECT_EQ(collector.summary().num_corpus_reloads, 1);
+    EXPECT_EQ(collector.summary().num_corpus_reload_failures, 2);
+  }
+  BinaryLogConsumer consumer(pipefd[0]);
+  ASSERT_OK_AND_ASSIGN(proto::BinaryLogEntry entry, consumer.Receive());
+  EXPECT_EQ(entry.corpus_reload().epoch(), 0);
+  ASSERT_OK_AND_ASSIGN(entry, consumer.Receive());
+  const proto::logging::CorpusReload &reload = entry.corpus_reload();
+  EXPECT_EQ(reload.epoch(), 1);
+  ASSERT_EQ(reload.loaded_shards_size(), 1);
+  EXPECT_EQ(reload.loaded_shards(0).name(), "shard_b");
+  EXPECT_EQ(reload.loaded_shards(0).checksum(), 1);
+  EXPECT_EQ(reload.loaded_shards(0).file_size(), 2);
+  ASSERT_EQ(reload.removed_shards_size(), 1);
+  EXPECT_EQ(reload.removed_shards(0), "shard_a");
+  ASSERT_EQ(reload.failed_shards_size(), 1);
+  EXPECT_EQ(reload.failed_shards(0).path(), "/shard_c");
+}
+
+TEST(ResultCollector, CorpusReloadIsNeverDropped) {
+  int pipefd[2] = {-1, -1};
+  ASSERT_EQ(pipe(pipefd), 0);
+  {
+    // A queue without room drops every entry that may be dropped.
+    ResultCollector collector(
+        pipefd[1], absl::Now(),
+        {.binary_log_options = {.async = true, .max_queued_entries = 0}});
+    RunnerDriver::PlayerResult result = {
+        .outcome = PlaybackOutcome::kExecutionMisbehave};
+    collector(RunnerDriver::RunResult(result, {}, "snap_id"));
+    ASSERT_OK(collector.LogCorpusReload(
+        {.epoch = 1, .loaded_shards = {{.name = "shard_a"}}}));
+  }
+  BinaryLogConsumer consumer(pipefd[0]);
+  ASSERT_OK_AND_ASSIGN(proto::BinaryLogEntry entry, consumer.Receive());
+  ASSERT_TRUE(entry.has_corpus_reload());
+  EXPECT_EQ(entry.corpus_reload().epoch(), 1);
+  EXPECT_TRUE(IsEndOfChannelError(consumer.Receive().status()));
+}
+
 }  // namespace
 
 }  // namespace silifuzz
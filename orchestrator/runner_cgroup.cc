@@ -0,0 +1,190 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "./orchestrator/runner_cgroup.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "./util/checks.h"
+#include "./util/itoa.h"
+#include "./util/owned_file_descriptor.h"
+
+namespace silifuzz {
+
+namespace {
+
+constexpr absl::string_view kOrchestratorCgroupName = "silifuzz_orchestrator";
+constexpr absl::string_view kRunnerCgroupName = "silifuzz_runners";
+
+absl::StatusOr<std::string> ReadCgroupFile(const std::string &path) {
+  std::ifstream ifs(path);
+  if (!ifs.good()) return absl::NotFoundError(path);
+  std::stringstream contents;
+  contents << ifs.rdbuf();
+  return contents.str();
+}
+
+// Cgroup interface files must be written with a single write(2).
+absl::Status WriteCgroupFile(const std::string &path, absl::string_view value) {
+  OwnedFileDescriptor fd(open(path.c_str(), O_WRONLY | O_CLOEXEC));
+  if (fd.borrow() == -1) {
+    return absl::ErrnoToStatus(errno, absl::StrCat("open(", path, ")"));
+  }
+  if (write(fd.borrow(), value.data(), value.size()) !=
+      static_cast<ssize_t>(value.size())) {
+    return absl::ErrnoToStatus(errno, absl::StrCat("write(", path, ")"));
+  }
+  return absl::OkStatus();
+}
+
+// Creates `path` unless it already exists, e.g. after a previous orchestrator
+// instance exited without cleaning up.
+absl::Status MakeCgroupDir(const std::string &path) {
+  if (mkdir(path.c_str(), 0755) == -1 && errno != EEXIST) {
+    return absl::ErrnoToStatus(errno, absl::StrCat("mkdir(", path, ")"));
+  }
+  return absl::OkStatus();
+}
+
+// Tests if the whitespace-separated list `list` contains `controller`.
+bool HasController(absl::string_view list, absl::string_view controller) {
+  for (absl::string_view c :
+       absl::StrSplit(list, absl::ByAnyChar(" \n"), absl::SkipEmpty())) {
+    if (c == controller) return true;
+  }
+  return false;
+}
+
+// Returns the cgroup v2 path of the current process.
+absl::StatusOr<std::string> OwnCgroup() {
+  ASSIGN_OR_RETURN_IF_NOT_OK(std::string contents,
+                             ReadCgroupFile("/proc/self/cgroup"));
+  // The unified hierarchy is always listed as "0::<path>".
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    if (absl::ConsumePrefix(&line, "0::")) {
+      return std::string(line);
+    }
+  }
+  return absl::FailedPreconditionError("Not running on cgroup v2");
+}
+
+absl::StatusOr<uint64_t> ParseCounter(absl::string_view value,
+                                      absl::string_view what) {
+  uint64_t counter = 0;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(value), &counter)) {
+    return absl::InternalError(
+        absl::StrCat("Cannot parse ", what, ": ", value));
+  }
+  return counter;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<RunnerCgroup>> RunnerCgroup::Create(
+    const Options &options) {
+  std::string parent = options.parent;
+  if (parent.empty()) {
+    ASSIGN_OR_RETURN_IF_NOT_OK(parent, OwnCgroup());
+  }
+  const absl::string_view relative =
+      absl::StripSuffix(absl::StripPrefix(parent, "/"), "/");
+  const std::string parent_dir =
+      absl::StrCat(absl::StripSuffix(options.cgroupfs_root, "/"),
+                   relative.empty() ? "" : "/", relative);
+
+  absl::StatusOr<std::string> controllers =
+      ReadCgroupFile(absl::StrCat(parent_dir, "/cgroup.controllers"));
+  if (!controllers.ok()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(parent_dir, " is not a cgroup v2 directory"));
+  }
+  if (!HasController(*controllers, "memory")) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Memory controller is not available in ", parent_dir));
+  }
+
+  const std::string subtree_control =
+      absl::StrCat(parent_dir, "/cgroup.subtree_control");
+  ASSIGN_OR_RETURN_IF_NOT_OK(std::string enabled,
+                             ReadCgroupFile(subtree_control));
+  if (!HasController(enabled, "memory")) {
+    // Vacate the parent first, see the class comment.
+    const std::string orchestrator_dir =
+        absl::StrCat(parent_dir, "/", kOrchestratorCgroupName);
+    RETURN_IF_NOT_OK(MakeCgroupDir(orchestrator_dir));
+    RETURN_IF_NOT_OK(
+        WriteCgroupFile(absl::StrCat(orchestrator_dir, "/cgroup.procs"),
+                        absl::StrCat(getpid())));
+    RETURN_IF_NOT_OK(WriteCgroupFile(subtree_control, "+memory"));
+  }
+
+  std::string path = absl::StrCat(parent_dir, "/", kRunnerCgroupName);
+  RETURN_IF_NOT_OK(MakeCgroupDir(path));
+  if (options.memory_max_bytes > 0) {
+    RETURN_IF_NOT_OK(WriteCgroupFile(absl::StrCat(path, "/memory.max"),
+                                     absl::StrCat(options.memory_max_bytes)));
+  }
+  const std::string procs = absl::StrCat(path, "/cgroup.procs");
+  OwnedFileDescriptor procs_fd(open(procs.c_str(), O_WRONLY | O_CLOEXEC));
+  if (procs_fd.borrow() == -1) {
+    return absl::ErrnoToStatus(errno, absl::StrCat("open(", procs, ")"));
+  }
+  return std::unique_ptr<RunnerCgroup>(
+      new RunnerCgroup(std::move(path), std::move(procs_fd)));
+}
+
+RunnerCgroup::~RunnerCgroup() {
+  procs_fd_ = OwnedFileDescriptor();
+  if (rmdir(path_.c_str()) == -1) {
+    LOG_ERROR("rmdir(", path_, "): ", ErrnoStr(errno));
+  }
+}
+
+absl::StatusOr<uint64_t> RunnerCgroup::PeakMemoryBytes() const {
+  ASSIGN_OR_RETURN_IF_NOT_OK(
+      std::string peak, ReadCgroupFile(absl::StrCat(path_, "/memory.peak")));
+  return ParseCounter(peak, "memory.peak");
+}
+
+absl::StatusOr<uint64_t> RunnerCgroup::OomKills() const {
+  ASSIGN_OR_RETURN_IF_NOT_OK(
+      std::string events,
+      ReadCgroupFile(absl::StrCat(path_, "/memory.events")));
+  for (absl::string_view line : absl::StrSplit(events, '\n')) {
+    if (absl::ConsumePrefix(&line, "oom_kill ")) {
+      return ParseCounter(line, "memory.events");
+    }
+  }
+  return absl::NotFoundError("No oom_kill entry in memory.events");
+}
+
+}  // namespace silifuzz
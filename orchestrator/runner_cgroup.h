@@ -0,0 +1,97 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_RUNNER_CGROUP_H_
+#define THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_RUNNER_CGROUP_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "./util/owned_file_descriptor.h"
+
+namespace silifuzz {
+
+// RunnerCgroup is a cgroup v2 leaf that holds all runner processes of one
+// orchestrator. The kernel then accounts the memory of all runners exactly
+// (memory.peak, memory.events) and can enforce a hard limit (memory.max)
+// without the orchestrator scanning /proc.
+//
+// The cgroup is created next to the orchestrator:
+//
+//   <parent>/                      memory controller enabled for children
+//   <parent>/silifuzz_orchestrator  the orchestrator process
+//   <parent>/silifuzz_runners       runners, see procs_fd()
+//
+// The orchestrator is moved out of <parent> because cgroup v2 does not allow
+// enabling controllers for children of a non-root cgroup with processes in
+// it. This requires a delegated (writable) <parent>; Create() fails otherwise
+// and the caller is expected to carry on without a cgroup.
+//
+// This class is thread-safe.
+class RunnerCgroup {
+ public:
+  struct Options {
+    // Mount point of the cgroup v2 hierarchy.
+    std::string cgroupfs_root = "/sys/fs/cgroup";
+
+    // Path of the parent cgroup relative to `cgroupfs_root`. When empty, the
+    // current cgroup of the orchestrator as per /proc/self/cgroup.
+    std::string parent;
+
+    // Hard memory limit for all runners combined. 0 means no limit.
+    uint64_t memory_max_bytes = 0;
+  };
+
+  // Creates the runner cgroup. Returns FAILED_PRECONDITION when cgroup v2 or
+  // its memory controller is not available and other errors when the parent
+  // cgroup is not writable by this process.
+  static absl::StatusOr<std::unique_ptr<RunnerCgroup>> Create(
+      const Options& options);
+
+  // Not copyable or moveable -- removes the cgroup on destruction.
+  RunnerCgroup(const RunnerCgroup&) = delete;
+  RunnerCgroup(RunnerCgroup&&) = delete;
+  RunnerCgroup& operator=(const RunnerCgroup&) = delete;
+  RunnerCgroup& operator=(RunnerCgroup&&) = delete;
+
+  // Removes the cgroup. All runners must have exited by now.
+  ~RunnerCgroup();
+
+  // Returns an FD of the cgroup.procs file for
+  // RunnerOptions::set_cgroup_procs_fd(). Valid for the lifetime of this
+  // object.
+  int procs_fd() const { return procs_fd_.borrow(); }
+
+  // Absolute path of the cgroup directory.
+  const std::string& path() const { return path_; }
+
+  // Returns the peak memory usage of the cgroup. Requires Linux 5.19+.
+  absl::StatusOr<uint64_t> PeakMemoryBytes() const;
+
+  // Returns how many runners were OOM-killed because of memory.max.
+  absl::StatusOr<uint64_t> OomKills() const;
+
+ private:
+  RunnerCgroup(std::string path, OwnedFileDescriptor procs_fd)
+      : path_(std::move(path)), procs_fd_(std::move(procs_fd)) {}
+
+  std::string path_;
+  OwnedFileDescriptor procs_fd_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_RUNNER_CGROUP_H_
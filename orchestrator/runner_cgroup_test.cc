@@ -0,0 +1,142 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "./orchestrator/runner_cgroup.h"
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+namespace fs = std::filesystem;
+using silifuzz::testing::IsOkAndHolds;
+using silifuzz::testing::StatusIs;
+
+void WriteFile(const fs::path &path, const std::string &contents) {
+  std::ofstream ofs(path);
+  ofs << contents;
+}
+
+std::string ReadFile(const fs::path &path) {
+  std::ifstream ifs(path);
+  std::stringstream contents;
+  contents << ifs.rdbuf();
+  return contents.str();
+}
+
+// Builds a fake cgroupfs with a single delegated cgroup "delegated". Cgroup
+// interface files are plain files here so the test only checks what
+// RunnerCgroup writes, not what the kernel does with it.
+class RunnerCgroupTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const char *tmpdir = getenv("TEST_TMPDIR");
+    root_ = fs::path(tmpdir != nullptr ? tmpdir : "/tmp") /
+            absl::StrCat("cgroupfs.", getpid());
+    fs::remove_all(root_);
+    parent_ = root_ / "delegated";
+    fs::create_directories(parent_ / "silifuzz_orchestrator");
+    fs::create_directories(parent_ / "silifuzz_runners");
+    WriteFile(parent_ / "cgroup.controllers", "cpu memory pids\n");
+    WriteFile(parent_ / "cgroup.subtree_control", "");
+    WriteFile(parent_ / "silifuzz_orchestrator" / "cgroup.procs", "");
+    for (const char *name : {"cgroup.procs", "memory.max"}) {
+      WriteFile(parent_ / "silifuzz_runners" / name, "");
+    }
+  }
+
+  void TearDown() override { fs::remove_all(root_); }
+
+  // Empties the runner cgroup so that ~RunnerCgroup can remove it.
+  void RemoveRunnerFiles() {
+    for (const auto &entry :
+         fs::directory_iterator(parent_ / "silifuzz_runners")) {
+      fs::remove(entry.path());
+    }
+  }
+
+  RunnerCgroup::Options options() const {
+    return {.cgroupfs_root = root_.string(), .parent = "/delegated"};
+  }
+
+  fs::path root_;
+  fs::path parent_;
+};
+
+TEST_F(RunnerCgroupTest, Create) {
+  RunnerCgroup::Options opts = options();
+  opts.memory_max_bytes = 1 << 30;
+  ASSERT_OK_AND_ASSIGN(auto cgroup, RunnerCgroup::Create(opts));
+  EXPECT_EQ(cgroup->path(), (parent_ / "silifuzz_runners").string());
+  EXPECT_NE(cgroup->procs_fd(), -1);
+  EXPECT_EQ(ReadFile(parent_ / "cgroup.subtree_control"), "+memory");
+  EXPECT_EQ(ReadFile(parent_ / "silifuzz_orchestrator" / "cgroup.procs"),
+            absl::StrCat(getpid()));
+  EXPECT_EQ(ReadFile(parent_ / "silifuzz_runners" / "memory.max"),
+            "1073741824");
+
+  RemoveRunnerFiles();
+  cgroup.reset();
+  EXPECT_FALSE(fs::exists(parent_ / "silifuzz_runners"));
+}
+
+TEST_F(RunnerCgroupTest, MemoryAlreadyDelegated) {
+  WriteFile(parent_ / "cgroup.subtree_control", "memory\n");
+  ASSERT_OK_AND_ASSIGN(auto cgroup, RunnerCgroup::Create(options()));
+  // Neither the parent nor the orchestrator are touched.
+  EXPECT_EQ(ReadFile(parent_ / "cgroup.subtree_control"), "memory\n");
+  EXPECT_EQ(ReadFile(parent_ / "silifuzz_orchestrator" / "cgroup.procs"), "");
+  EXPECT_EQ(ReadFile(parent_ / "silifuzz_runners" / "memory.max"), "");
+  RemoveRunnerFiles();
+}
+
+TEST_F(RunnerCgroupTest, NoMemoryController) {
+  WriteFile(parent_ / "cgroup.controllers", "cpu pids\n");
+  EXPECT_THAT(RunnerCgroup::Create(options()),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(RunnerCgroupTest, NotACgroup) {
+  RunnerCgroup::Options opts = options();
+  opts.parent = "/does/not/exist";
+  EXPECT_THAT(RunnerCgroup::Create(opts),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(RunnerCgroupTest, Accounting) {
+  ASSERT_OK_AND_ASSIGN(auto cgroup, RunnerCgroup::Create(options()));
+  EXPECT_THAT(cgroup->PeakMemoryBytes(),
+              StatusIs(absl::StatusCode::kNotFound));
+  WriteFile(parent_ / "silifuzz_runners" / "memory.peak", "123456\n");
+  EXPECT_THAT(cgroup->PeakMemoryBytes(), IsOkAndHolds(123456));
+  WriteFile(parent_ / "silifuzz_runners" / "memory.events",
+            "low 0\nhigh 0\nmax 7\noom 2\noom_kill 2\noom_group_kill 0\n");
+  EXPECT_THAT(cgroup->OomKills(), IsOkAndHolds(2));
+  RemoveRunnerFiles();
+}
+
+}  // namespace
+}  // namespace silifuzz
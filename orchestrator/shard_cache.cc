@@ -0,0 +1,244 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./orchestrator/shard_cache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./orchestrator/corpus_util.h"
+#include "./util/checks.h"
+#include "./util/path_util.h"
+#include "./util/tool_util.h"
+
+namespace silifuzz {
+
+namespace {
+
+// Returns true if a shard that failed to load with `status` may load fine
+// later, i.e. the process ran out of memory or file descriptors.
+bool IsTransientLoadError(const absl::Status& status) {
+  return absl::IsResourceExhausted(status) || absl::IsUnavailable(status);
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ShardCache>> ShardCache::Create(
+    const std::vector<std::string>& shard_paths, const Options& options) {
+  CHECK(!shard_paths.empty());
+  if (options.max_resident_bytes == 0) {
+    return absl::InvalidArgumentError("max_resident_bytes must be positive");
+  }
+  // Cannot use std::make_unique() with a private c-tor.
+  std::unique_ptr<ShardCache> cache(new ShardCache(options));
+  cache->entries_.reserve(shard_paths.size());
+  uint64_t compressed_bytes = 0;
+  for (const std::string& path : shard_paths) {
+    auto entry = std::make_unique<Entry>();
+    entry->path = path;
+    if (options.keep_compressed_in_memory) {
+      ASSIGN_OR_RETURN_IF_NOT_OK(std::string contents, GetFileContents(path));
+      compressed_bytes += contents.size();
+      ASSIGN_OR_RETURN_IF_NOT_OK(
+          entry->compressed_fd,
+          WriteSharedMemoryFile(absl::Cord(std::move(contents)),
+                                Basename(path)));
+      entry->compressed_path = absl::StrCat(
+          "/proc/", getpid(), "/fd/", entry->compressed_fd.borrow());
+    }
+    cache->entries_.push_back(std::move(entry));
+  }
+  if (options.keep_compressed_in_memory) {
+    VLOG_INFO(0, "Holding ", compressed_bytes, " compressed bytes of ",
+              shard_paths.size(), " shards in memory");
+  }
+  cache->prefetch_thread_ = std::thread(&ShardCache::PrefetchLoop, cache.get());
+  return cache;
+}
+
+ShardCache::ShardCache(const Options& options) : options_(options) {}
+
+ShardCache::~ShardCache() {
+  {
+    absl::MutexLock l(&mu_);
+    stop_ = true;
+  }
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+}
+
+absl::StatusOr<std::shared_ptr<const InMemoryShard>> ShardCache::Get(
+    size_t index) {
+  CHECK_LT(index, entries_.size());
+  {
+    absl::MutexLock l(&mu_);
+    if (auto shard = Lookup(index, /*count_hit=*/true); shard != nullptr) {
+      return shard;
+    }
+  }
+  return Load(index, /*prefetch=*/false);
+}
+
+void ShardCache::Prefetch(size_t index) {
+  CHECK_LT(index, entries_.size());
+  absl::MutexLock l(&mu_);
+  Entry& entry = *entries_[index];
+  if (entry.shard != nullptr || entry.prefetch_queued ||
+      !LoadError(index).ok()) {
+    return;
+  }
+  entry.prefetch_queued = true;
+  prefetch_queue_.push_back(index);
+}
+
+bool ShardCache::IsBad(size_t index) const {
+  CHECK_LT(index, entries_.size());
+  absl::MutexLock l(&mu_);
+  return !entries_[index]->error.ok();
+}
+
+ShardCache::Stats ShardCache::stats() const {
+  absl::MutexLock l(&mu_);
+  return stats_;
+}
+
+absl::Status ShardCache::LoadError(size_t index) const {
+  const Entry& entry = *entries_[index];
+  if (!entry.error.ok()) return entry.error;
+  if (absl::Now() < entry.retry_time) return entry.transient_error;
+  return absl::OkStatus();
+}
+
+std::shared_ptr<const InMemoryShard> ShardCache::Lookup(size_t index,
+                                                        bool count_hit) {
+  Entry& entry = *entries_[index];
+  if (entry.shard == nullptr) return nullptr;
+  lru_.splice(lru_.begin(), lru_, entry.lru_pos);
+  if (count_hit) ++stats_.hits;
+  return entry.shard;
+}
+
+absl::StatusOr<std::shared_ptr<const InMemoryShard>> ShardCache::Load(
+    size_t index, bool prefetch) {
+  Entry& entry = *entries_[index];
+  absl::MutexLock load_lock(&entry.load_mu);
+  {
+    // Another thread may have loaded the shard while we waited for load_mu.
+    // A Get() that blocked on an in-flight load still paid for the miss.
+    absl::MutexLock l(&mu_);
+    RETURN_IF_NOT_OK(LoadError(index));
+    if (!prefetch) ++stats_.misses;
+    if (auto shard = Lookup(index, /*count_hit=*/false); shard != nullptr) {
+      return shard;
+    }
+  }
+
+  const absl::Time start = absl::Now();
+  const std::string& source_path =
+      entry.compressed_path.empty() ? entry.path : entry.compressed_path;
+  absl::StatusOr<InMemoryShard> loaded = LoadCorpus(entry.path, source_path);
+  const absl::Duration elapsed = absl::Now() - start;
+  if (!loaded.ok() && IsTransientLoadError(loaded.status())) {
+    // The shard may be fine, retry once resources have been freed.
+    absl::MutexLock l(&mu_);
+    entry.retry_delay =
+        entry.retry_delay == absl::ZeroDuration()
+            ? options_.min_retry_delay
+            : std::min(2 * entry.retry_delay, options_.max_retry_delay);
+    entry.retry_time = absl::Now() + entry.retry_delay;
+    entry.transient_error = loaded.status();
+    ++stats_.transient_failures;
+    return entry.transient_error;
+  }
+  if (loaded.ok() && options_.validate_shards) {
+    if (absl::Status status = ValidateShard(*loaded); !status.ok()) {
+      loaded = status;
+    }
+  }
+  if (!loaded.ok()) {
+    // A shard that is broken now stays broken, do not pay for it again.
+    absl::MutexLock l(&mu_);
+    entry.error = loaded.status();
+    ++stats_.bad_shards;
+    return entry.error;
+  }
+  auto shard = std::make_shared<const InMemoryShard>(*std::move(loaded));
+  VLOG_INFO(1, prefetch ? "Prefetched " : "Loaded ", shard->name, " (",
+            shard->file_size, " bytes) in ", absl::FormatDuration(elapsed));
+
+  absl::MutexLock l(&mu_);
+  entry.transient_error = absl::OkStatus();
+  entry.retry_time = absl::InfinitePast();
+  entry.retry_delay = absl::ZeroDuration();
+  stats_.decompress_time += elapsed;
+  if (prefetch) ++stats_.prefetches;
+  entry.shard = shard;
+  lru_.push_front(index);
+  entry.lru_pos = lru_.begin();
+  stats_.resident_bytes += shard->file_size;
+  EvictIfNeeded();
+  return shard;
+}
+
+void ShardCache::EvictIfNeeded() {
+  while (stats_.resident_bytes > options_.max_resident_bytes &&
+         lru_.size() > 1) {
+    Entry& victim = *entries_[lru_.back()];
+    lru_.pop_back();
+    VLOG_INFO(1, "Evicting ", victim.shard->name);
+    stats_.resident_bytes -= victim.shard->file_size;
+    ++stats_.evictions;
+    // Runners still holding the shard keep its memfd open until they finish.
+    victim.shard.reset();
+  }
+}
+
+void ShardCache::PrefetchLoop() {
+  while (true) {
+    size_t index;
+    {
+      mu_.LockWhen(absl::Condition(this, &ShardCache::PrefetchWorkAvailable));
+      if (stop_) {
+        mu_.Unlock();
+        return;
+      }
+      index = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+      entries_[index]->prefetch_queued = false;
+      mu_.Unlock();
+    }
+    if (auto shard = Load(index, /*prefetch=*/true); !shard.ok()) {
+      LOG_ERROR("Prefetching ", entries_[index]->path,
+                " failed: ", shard.status().message());
+    }
+  }
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,203 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_SHARD_CACHE_H_
+#define THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_SHARD_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "./orchestrator/corpus_util.h"
+#include "./util/owned_file_descriptor.h"
+
+namespace silifuzz {
+
+// ShardCache keeps a bounded set of corpus shards decompressed in memfds and
+// loads the rest on demand. Shards that are not resident stay compressed,
+// either in their original files or in sealed memfds owned by the cache.
+//
+// Resident shards are evicted in LRU order once the total uncompressed size
+// exceeds `max_resident_bytes`. A shard returned by Get() stays valid while
+// the caller holds the returned pointer even if the cache evicts it in the
+// meantime, so the budget should leave room for one in-flight shard per
+// worker thread.
+//
+// This class is thread-safe.
+class ShardCache {
+ public:
+  struct Options {
+    // Upper bound on the total uncompressed size of cached shards.
+    uint64_t max_resident_bytes = 0;
+
+    // If true, the compressed bytes of every shard are copied into memory at
+    // construction time so that later loads do not touch the filesystem.
+    bool keep_compressed_in_memory = false;
+
+    // If true, every shard is checked with ValidateShard() after loading and
+    // shards that fail the check are never cached.
+    bool validate_shards = true;
+
+    // A shard that failed to load for lack of resources, e.g. memory or file
+    // descriptors, is not retried for `min_retry_delay`. The delay doubles
+    // with every consecutive failure up to `max_retry_delay`.
+    absl::Duration min_retry_delay = absl::Seconds(1);
+    absl::Duration max_retry_delay = absl::Minutes(1);
+  };
+
+  // Cache counters. All times are wall time.
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t prefetches = 0;
+    uint64_t resident_bytes = 0;
+    // Number of shards that failed to load or validate. See IsBad().
+    uint64_t bad_shards = 0;
+    // Number of loads that failed for lack of resources and will be retried.
+    uint64_t transient_failures = 0;
+    absl::Duration decompress_time = absl::ZeroDuration();
+
+    double hit_rate() const {
+      uint64_t lookups = hits + misses;
+      return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+  };
+
+  // Creates a cache for shards in `shard_paths`. Shard indices passed to
+  // Get() and Prefetch() are indices into `shard_paths`.
+  //
+  // REQUIRES: shard_paths not empty.
+  static absl::StatusOr<std::unique_ptr<ShardCache>> Create(
+      const std::vector<std::string>& shard_paths, const Options& options);
+
+  // Not copyable or moveable -- owns a background thread.
+  ShardCache(const ShardCache&) = delete;
+  ShardCache(ShardCache&&) = delete;
+  ShardCache& operator=(const ShardCache&) = delete;
+  ShardCache& operator=(ShardCache&&) = delete;
+
+  ~ShardCache();
+
+  // Returns the shard at `index`, decompressing it first if it is not
+  // resident. Fails without retrying if the shard is bad. If the last load
+  // failed for lack of resources, fails with that error until the retry
+  // delay has passed and then tries again.
+  absl::StatusOr<std::shared_ptr<const InMemoryShard>> Get(size_t index);
+
+  // Asks the background thread to make the shard at `index` resident.
+  // Does nothing if the shard is already resident, queued, bad or waiting
+  // for its retry delay.
+  void Prefetch(size_t index);
+
+  // Returns true if the shard at `index` failed validation or its data is
+  // corrupt. Bad shards are never loaded again. Shards that failed for lack
+  // of resources are not bad.
+  bool IsBad(size_t index) const;
+
+  // Returns the number of shards, resident or not.
+  size_t size() const { return entries_.size(); }
+
+  Stats stats() const;
+
+ private:
+  struct Entry {
+    std::string path;
+
+    // Compressed shard bytes if `keep_compressed_in_memory` is set.
+    OwnedFileDescriptor compressed_fd;
+    std::string compressed_path;
+
+    // Serializes loading of this shard so that concurrent Get() calls
+    // decompress it only once.
+    absl::Mutex load_mu;
+
+    // The resident shard or nullptr. Guarded by ShardCache::mu_.
+    std::shared_ptr<const InMemoryShard> shard;
+
+    // Position in lru_ if resident. Guarded by ShardCache::mu_.
+    std::list<size_t>::iterator lru_pos;
+
+    // True if queued for prefetching. Guarded by ShardCache::mu_.
+    bool prefetch_queued = false;
+
+    // Why loading this shard failed, OK if it did not. Guarded by
+    // ShardCache::mu_.
+    absl::Status error;
+
+    // Why the last load of this shard failed for lack of resources, OK if it
+    // did not. Get() returns it until `retry_time`. Guarded by
+    // ShardCache::mu_.
+    absl::Status transient_error;
+    absl::Time retry_time = absl::InfinitePast();
+    absl::Duration retry_delay = absl::ZeroDuration();
+  };
+
+  explicit ShardCache(const Options& options);
+
+  // Returns the shard at `index` if it is resident and marks it as most
+  // recently used. `count_hit` controls whether this is counted as a hit.
+  std::shared_ptr<const InMemoryShard> Lookup(size_t index, bool count_hit)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the error the shard at `index` failed with if it is bad or still
+  // waiting for its retry delay, OK otherwise.
+  absl::Status LoadError(size_t index) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Loads the shard at `index` and makes it resident.
+  absl::StatusOr<std::shared_ptr<const InMemoryShard>> Load(size_t index,
+                                                            bool prefetch);
+
+  // Evicts LRU shards until the resident size fits the budget. The most
+  // recently used shard is never evicted.
+  void EvictIfNeeded() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Main function of the prefetch thread.
+  void PrefetchLoop();
+
+  bool PrefetchWorkAvailable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stop_ || !prefetch_queue_.empty();
+  }
+
+  const Options options_;
+
+  // Sized once at construction. Entries are not moveable.
+  std::vector<std::unique_ptr<Entry>> entries_;
+
+  mutable absl::Mutex mu_;
+
+  // Indices of resident shards, most recently used first.
+  std::list<size_t> lru_ ABSL_GUARDED_BY(mu_);
+
+  std::list<size_t> prefetch_queue_ ABSL_GUARDED_BY(mu_);
+  bool stop_ ABSL_GUARDED_BY(mu_) = false;
+
+  Stats stats_ ABSL_GUARDED_BY(mu_);
+
+  std::thread prefetch_thread_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_SHARD_CACHE_H_
@@ -0,0 +1,223 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./orchestrator/shard_cache.h"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./orchestrator/corpus_util.h"
+#include "./util/data_dependency.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+
+constexpr size_t kMb = 1024 * 1024;
+
+std::string OneMbShard() {
+  return GetDataDependencyFilepath("orchestrator/testdata/one_mb_of_zeros.xz");
+}
+
+// Returns the size of the file at `path` as seen through /proc.
+size_t FileSize(const std::string& path) {
+  struct stat st;
+  EXPECT_EQ(stat(path.c_str(), &st), 0);
+  return st.st_size;
+}
+
+TEST(ShardCache, HitsAndMisses) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      ShardCache::Create({OneMbShard(), OneMbShard()},
+                         {.max_resident_bytes = 2 * kMb,
+                          .validate_shards = false}));
+  EXPECT_EQ(cache->size(), 2);
+  ASSERT_OK_AND_ASSIGN(auto shard0, cache->Get(0));
+  EXPECT_EQ(shard0->name, "one_mb_of_zeros");
+  EXPECT_EQ(shard0->file_size, kMb);
+  EXPECT_EQ(FileSize(shard0->file_path), kMb);
+
+  ASSERT_OK_AND_ASSIGN(auto shard0_again, cache->Get(0));
+  EXPECT_EQ(shard0_again, shard0);
+  ASSERT_OK_AND_ASSIGN(auto shard1, cache->Get(1));
+  EXPECT_NE(shard1, shard0);
+
+  ShardCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_EQ(stats.resident_bytes, 2 * kMb);
+  EXPECT_GT(stats.decompress_time, absl::ZeroDuration());
+  EXPECT_DOUBLE_EQ(stats.hit_rate(), 1.0 / 3);
+}
+
+TEST(ShardCache, EvictsLeastRecentlyUsed) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      ShardCache::Create({OneMbShard(), OneMbShard(), OneMbShard()},
+                         {.max_resident_bytes = 2 * kMb,
+                          .validate_shards = false}));
+  ASSERT_OK_AND_ASSIGN(auto shard0, cache->Get(0));
+  ASSERT_OK(cache->Get(1).status());
+  // Touch 0 so that 1 becomes the LRU shard.
+  ASSERT_OK(cache->Get(0).status());
+  ASSERT_OK(cache->Get(2).status());
+
+  ShardCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.resident_bytes, 2 * kMb);
+
+  // 0 is still resident, 1 is not.
+  ASSERT_OK_AND_ASSIGN(auto shard0_again, cache->Get(0));
+  EXPECT_EQ(shard0_again, shard0);
+  EXPECT_EQ(cache->stats().hits, stats.hits + 1);
+  ASSERT_OK(cache->Get(1).status());
+  EXPECT_EQ(cache->stats().misses, stats.misses + 1);
+}
+
+TEST(ShardCache, EvictedShardStaysValidWhileHeld) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      ShardCache::Create({OneMbShard(), OneMbShard()},
+                         {.max_resident_bytes = kMb,
+                          .validate_shards = false}));
+  ASSERT_OK_AND_ASSIGN(auto shard0, cache->Get(0));
+  ASSERT_OK(cache->Get(1).status());
+  EXPECT_EQ(cache->stats().evictions, 1);
+  EXPECT_EQ(FileSize(shard0->file_path), kMb);
+}
+
+TEST(ShardCache, BudgetSmallerThanShard) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache, ShardCache::Create({OneMbShard()},
+                                     {.max_resident_bytes = 1,
+                                      .validate_shards = false}));
+  // The most recently used shard is always kept.
+  ASSERT_OK(cache->Get(0).status());
+  ASSERT_OK(cache->Get(0).status());
+  EXPECT_EQ(cache->stats().hits, 1);
+}
+
+TEST(ShardCache, Prefetch) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      ShardCache::Create({OneMbShard(), OneMbShard()},
+                         {.max_resident_bytes = 2 * kMb,
+                          .keep_compressed_in_memory = true,
+                          .validate_shards = false}));
+  cache->Prefetch(1);
+  while (cache->stats().prefetches == 0) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  ASSERT_OK_AND_ASSIGN(auto shard1, cache->Get(1));
+  EXPECT_EQ(shard1->name, "one_mb_of_zeros");
+  ShardCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 0);
+}
+
+TEST(ShardCache, ConcurrentGet) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      ShardCache::Create({OneMbShard(), OneMbShard(), OneMbShard()},
+                         {.max_resident_bytes = 2 * kMb,
+                          .validate_shards = false}));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 20; ++i) {
+        auto shard = cache->Get((t + i) % cache->size());
+        ASSERT_OK(shard.status());
+        EXPECT_EQ((*shard)->file_size, kMb);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  ShardCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.hits + stats.misses, 80);
+  EXPECT_LE(stats.resident_bytes, 2 * kMb);
+}
+
+TEST(ShardCache, RetriesTransientFailures) {
+  ASSERT_OK_AND_ASSIGN(
+      auto cache,
+      ShardCache::Create({OneMbShard()},
+                         {.max_resident_bytes = kMb,
+                          .validate_shards = false,
+                          .min_retry_delay = absl::Milliseconds(100),
+                          .max_retry_delay = absl::Milliseconds(200)}));
+
+  // Run out of file descriptors so that the shard cannot be opened.
+  struct rlimit old_limit;
+  ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &old_limit), 0);
+  const int lowest_free_fd = dup(STDIN_FILENO);
+  ASSERT_GE(lowest_free_fd, 0);
+  ASSERT_EQ(close(lowest_free_fd), 0);
+  struct rlimit new_limit = old_limit;
+  new_limit.rlim_cur = lowest_free_fd;
+  ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &new_limit), 0);
+  absl::Status status = cache->Get(0).status();
+  ASSERT_EQ(setrlimit(RLIMIT_NOFILE, &old_limit), 0);
+
+  EXPECT_THAT(status, StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_FALSE(cache->IsBad(0));
+  ShardCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.bad_shards, 0);
+  EXPECT_EQ(stats.transient_failures, 1);
+
+  // The shard is not retried until the delay has passed.
+  EXPECT_THAT(cache->Get(0).status(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_EQ(cache->stats().misses, stats.misses);
+  absl::SleepFor(absl::Milliseconds(100));
+  ASSERT_OK_AND_ASSIGN(auto shard, cache->Get(0));
+  EXPECT_EQ(shard->file_size, kMb);
+  EXPECT_EQ(cache->stats().transient_failures, 1);
+}
+
+TEST(ShardCache, Errors) {
+  EXPECT_THAT(ShardCache::Create({OneMbShard()}, {.max_resident_bytes = 0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  ASSERT_OK_AND_ASSIGN(
+      auto cache, ShardCache::Create({OneMbShard(), "/this does not exist.xz"},
+                                     {.max_resident_bytes = kMb}));
+  // Not a valid corpus.
+  EXPECT_THAT(cache->Get(0).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_FALSE(cache->Get(1).ok());
+  EXPECT_TRUE(cache->IsBad(0));
+  EXPECT_TRUE(cache->IsBad(1));
+  EXPECT_EQ(cache->stats().bad_shards, 2);
+  EXPECT_EQ(cache->stats().transient_failures, 0);
+  EXPECT_EQ(cache->stats().resident_bytes, 0);
+}
+
+}  // namespace
+}  // namespace silifuzz
@@ -14,7 +14,11 @@
 
 #include "./orchestrator/silifuzz_orchestrator.h"
 
+#include <sys/resource.h>
+
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <random>
 #include <string>
 #include <utility>
@@ -29,7 +33,11 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "./common/snapshot_enums.h"
+#include "./orchestrator/corpus_reloader.h"
 #include "./orchestrator/corpus_util.h"
+#include "./orchestrator/shard_cache.h"
+#include "./orchestrator/stats_page.h"
 #include "./runner/driver/runner_driver.h"
 #include "./util/checks.h"
 
@@ -49,6 +57,52 @@ std::string RunResultToDebugString(
     return "internal_error";
   }
 }
+
+// Publishes the outcome of one runner invocation in `args.stats_page`.
+void RecordRunResult(
+    const RunnerThreadArgs &args,
+    const absl::StatusOr<RunnerDriver::RunResult> &run_result_or,
+    absl::Duration elapsed_time) {
+  StatsPage *page = args.stats_page;
+  if (page == nullptr) return;
+  const size_t slot = args.stats_slot;
+  page->Add(slot, ThreadStat::kInvocations, 1);
+  page->RecordLatency(slot, elapsed_time);
+  if (!run_result_or.ok()) {
+    page->Add(slot, ThreadStat::kInternalErrors, 1);
+    return;
+  }
+  const struct rusage &rusage = run_result_or->rusage();
+  const absl::Duration cpu_time = absl::DurationFromTimeval(rusage.ru_utime) +
+                                  absl::DurationFromTimeval(rusage.ru_stime);
+  page->Add(slot, ThreadStat::kCpuTimeNanos,
+            absl::ToInt64Nanoseconds(cpu_time));
+  if (run_result_or->success()) return;
+  if (run_result_or->player_result().outcome ==
+      snapshot_types::PlaybackOutcome::kExecutionRunaway) {
+    page->Add(slot, ThreadStat::kRunaways, 1);
+  } else {
+    page->Add(slot, ThreadStat::kSnapFailures, 1);
+  }
+}
+
+// Returns the next shard index from `generator`, skipping shards that
+// `shard_cache`, if any, failed to load. Returns kEndOfStream once there is
+// no loadable shard left.
+int NextLoadableShard(NextCorpusGenerator &generator,
+                      const ShardCache *shard_cache) {
+  while (true) {
+    const int shard_idx = generator();
+    if (shard_idx == NextCorpusGenerator::kEndOfStream ||
+        shard_cache == nullptr || !shard_cache->IsBad(shard_idx)) {
+      return shard_idx;
+    }
+    if (shard_cache->stats().bad_shards >= shard_cache->size()) {
+      return NextCorpusGenerator::kEndOfStream;
+    }
+  }
+}
+
 }  // namespace
 
 ExecutionContext::~ExecutionContext() {
@@ -99,6 +153,11 @@ void ExecutionContext::EventLoop() {
       invocation_results_.swap(current_results);
       mu_.Unlock();
     }
+    if (stats_page_ != nullptr) {
+      stats_page_->Set(GlobalStat::kHeartbeatUnixNanos,
+                       absl::ToUnixNanos(absl::Now()));
+      stats_page_->Set(GlobalStat::kQueueDepth, current_results.size());
+    }
 
     ProcessResultQueueImpl(current_results);
   }
@@ -147,10 +206,29 @@ int NextCorpusGenerator::operator()() {
 // loop until it is told to stop.
 void RunnerThread(ExecutionContext *ctx, const RunnerThreadArgs &args) {
   VLOG_INFO(0, "T", args.thread_idx, " started");
+  if (args.stats_page != nullptr) {
+    args.stats_page->Set(args.stats_slot, ThreadStat::kThreadIdx,
+                         args.thread_idx);
+  }
+  // The epoch of the current iteration. Holding it keeps its shards alive
+  // while the runner uses them, even if a newer epoch gets published.
+  std::shared_ptr<const CorpusEpoch> epoch;
+  size_t num_shards;
+  if (args.corpus_reloader != nullptr) {
+    epoch = args.corpus_reloader->Current();
+    num_shards = epoch->shards.size();
+  } else if (args.shard_cache != nullptr) {
+    num_shards = args.shard_cache->size();
+  } else {
+    num_shards = args.corpora->shards.size();
+  }
   NextCorpusGenerator next_corpus_generator(
-      args.corpora->shards.size(), args.runner_options.sequential_mode(),
-      args.thread_idx);
+      num_shards, args.runner_options.sequential_mode(), args.thread_idx);
 
+  // Shards are picked one iteration ahead so that the cache can decompress
+  // the next one while the current runner executes.
+  int next_shard_idx =
+      NextLoadableShard(next_corpus_generator, args.shard_cache);
   while (!ctx->ShouldStop()) {
     absl::Time start_time = absl::Now();
     absl::Duration time_budget = ctx->deadline() - start_time;
@@ -161,21 +239,71 @@ void RunnerThread(ExecutionContext *ctx, const RunnerThreadArgs &args) {
     runner_options.set_wall_time_budget(time_budget);
     VLOG_INFO(1, "T", args.thread_idx, " time budget ",
               absl::FormatDuration(time_budget));
-    int shard_idx = next_corpus_generator();
+    if (args.corpus_reloader != nullptr) {
+      std::shared_ptr<const CorpusEpoch> current =
+          args.corpus_reloader->Current();
+      if (current->shards.size() != num_shards) {
+        VLOG_INFO(0, "T", args.thread_idx, " switching to corpus epoch ",
+                  current->number, " with ", current->shards.size(),
+                  " shards");
+        num_shards = current->shards.size();
+        next_corpus_generator = NextCorpusGenerator(
+            num_shards, args.runner_options.sequential_mode(),
+            args.thread_idx);
+        next_shard_idx = next_corpus_generator();
+      }
+      epoch = std::move(current);
+    }
+    int shard_idx = next_shard_idx;
 
     if (shard_idx == NextCorpusGenerator::kEndOfStream) {
-      VLOG_INFO(0, "T", args.thread_idx,
-                " Reached end of stream in sequential mode");
+      VLOG_INFO(0, "T", args.thread_idx, " Reached end of stream");
       break;
     }
+    next_shard_idx = NextLoadableShard(next_corpus_generator, args.shard_cache);
 
-    const InMemoryShard &shard = args.corpora->shards[shard_idx];
+    // Keeps a cached shard alive while the runner uses it.
+    std::shared_ptr<const InMemoryShard> cached_shard;
+    if (args.shard_cache != nullptr) {
+      absl::StatusOr<std::shared_ptr<const InMemoryShard>> cached_shard_or =
+          args.shard_cache->Get(shard_idx);
+      if (!cached_shard_or.ok()) {
+        // If the shard is bad, the cache now knows and it is skipped from
+        // here on. Otherwise the cache ran out of resources and retries the
+        // shard later; back off so that threads do not spin through shards
+        // that all fail the same way. Keep running the other shards.
+        LOG_ERROR("T", args.thread_idx, " skipping shard ", shard_idx, ": ",
+                  cached_shard_or.status().message());
+        if (args.stats_page != nullptr) {
+          args.stats_page->Add(args.stats_slot, ThreadStat::kInternalErrors,
+                               1);
+        }
+        if (!args.shard_cache->IsBad(shard_idx)) {
+          absl::SleepFor(absl::Milliseconds(100));
+        }
+        if (next_shard_idx != NextCorpusGenerator::kEndOfStream &&
+            args.shard_cache->IsBad(next_shard_idx)) {
+          next_shard_idx =
+              NextLoadableShard(next_corpus_generator, args.shard_cache);
+        }
+        continue;
+      }
+      cached_shard = *std::move(cached_shard_or);
+      if (next_shard_idx != NextCorpusGenerator::kEndOfStream) {
+        args.shard_cache->Prefetch(next_shard_idx);
+      }
+    }
+    const InMemoryShard &shard = epoch != nullptr ? *epoch->shards[shard_idx]
+                                 : cached_shard != nullptr
+                                     ? *cached_shard
+                                     : args.corpora->shards[shard_idx];
     RunnerDriver driver =
         RunnerDriver::ReadingRunner(args.runner, shard.file_path, shard.name);
     absl::StatusOr<RunnerDriver::RunResult> run_result_or =
         driver.Run(runner_options);
 
     absl::Duration elapsed_time = absl::Now() - start_time;
+    RecordRunResult(args, run_result_or, elapsed_time);
 
     std::string log_msg = absl::StrCat(
         "T", args.thread_idx, " cpu: ", args.runner_options.cpu(),
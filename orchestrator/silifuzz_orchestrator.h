@@ -26,7 +26,10 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "./orchestrator/corpus_reloader.h"
 #include "./orchestrator/corpus_util.h"
+#include "./orchestrator/shard_cache.h"
+#include "./orchestrator/stats_page.h"
 #include "./runner/driver/runner_driver.h"
 #include "./runner/driver/runner_options.h"
 
@@ -40,11 +43,25 @@ struct RunnerThreadArgs {
   // Path to a reading runner.
   std::string runner = "";
 
-  // All available corpora.
+  // All available corpora. Ignored when `shard_cache` or `corpus_reloader`
+  // is set.
   const InMemoryCorpora *corpora = nullptr;
 
+  // If set, shards are taken from this cache instead of `corpora`. The thread
+  // prefetches its next pick while the current runner executes.
+  ShardCache *shard_cache = nullptr;
+
+  // If set, each runner invocation takes its shard from the current epoch of
+  // this reloader. Takes precedence over `shard_cache` and `corpora`.
+  CorpusReloader *corpus_reloader = nullptr;
+
   // Additional parameters passed to each runner binary.
   RunnerOptions runner_options = RunnerOptions::Default();
+
+  // If set, the thread publishes its counters in this slot of `stats_page`.
+  // Each thread must have its own slot.
+  StatsPage *stats_page = nullptr;
+  size_t stats_slot = 0;
 };
 
 // Orchestrator execution context.
@@ -67,11 +84,15 @@ class ExecutionContext {
   // num_threads is a hint used to size internal data structures.
   // The `result_cb` callback will be invoked by EventLoop() for each RunResult
   // produced by any of the worker threads.
+  // If `stats_page` is set, EventLoop() publishes the queue depth and a
+  // heartbeat there.
   ExecutionContext(absl::Time deadline, int num_threads,
-                   const ResultCallback &result_cb)
+                   const ResultCallback &result_cb,
+                   StatsPage *stats_page = nullptr)
       : deadline_(deadline),
         num_threads_(num_threads),
         result_cb_(result_cb),
+        stats_page_(stats_page),
         mu_(),
         stop_execution_(false),
         invocation_results_() {
@@ -121,6 +142,7 @@ class ExecutionContext {
   const absl::Time deadline_;
   const int num_threads_;
   ResultCallback result_cb_;
+  StatsPage *stats_page_;
 
   // Mutex guarding all mutable state of this class.
   mutable absl::Mutex mu_;
@@ -46,10 +46,9 @@
 #include <csignal>
 #include <cstddef>
 #include <cstdlib>
-#include <filesystem>  // NOLINT
-#include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
 #include <utility>
@@ -57,13 +56,11 @@
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
-#include "absl/functional/bind_front.h"
 #include "absl/log/flags.h"  // IWYU pragma: keep
 #include "absl/log/initialize.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/ascii.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -71,11 +68,16 @@
 #include "absl/time/time.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
+#include "./orchestrator/corpus_reloader.h"
 #include "./orchestrator/corpus_util.h"
 #include "./orchestrator/orchestrator_util.h"
 #include "./orchestrator/result_collector.h"
+#include "./orchestrator/runner_cgroup.h"
+#include "./orchestrator/shard_cache.h"
 #include "./orchestrator/silifuzz_orchestrator.h"
+#include "./orchestrator/stats_page.h"
 #include "./proto/corpus_metadata.pb.h"
+#include "./runner/driver/runner_driver.h"
 #include "./runner/driver/runner_options.h"
 #include "./util/checks.h"
 #include "./util/itoa.h"
@@ -99,6 +101,15 @@ ABSL_FLAG(
     int, binary_log_fd, -1,
     "If non-negative, a writable file descriptor for streaming out a binary "
     "log. The file descriptor should be valid when the orchestrator starts.");
+ABSL_FLAG(bool, binary_log_async, false,
+          "If true, entries are written to --binary_log_fd by a background "
+          "thread so that a slow consumer does not stall result processing. "
+          "Execution results are dropped when the queue is full, session "
+          "start and summary never are.");
+ABSL_FLAG(bool, binary_log_compress, false,
+          "If true, use the compressed binary log stream format. Only set this "
+          "if the consumer of --binary_log_fd supports it. Requires "
+          "--binary_log_async.");
 ABSL_FLAG(bool, sequential_mode, false,
           "If true, enumerate snapshots one by one in single-threaded mode and "
           "exit. Ignores --max_cpus.");
@@ -119,9 +130,31 @@ ABSL_FLAG(
     std::string, limit_memory_usage_mb, "unlimited",
     "How much memory (in Mb) can the scanning process use. The default is "
     "unlimited. When set, the orchestrator will _try to_ limit the memory "
-    "usage of itself + all the runner processes by loading just a random "
-    "fraction of the shards. A special value `auto` can be used to "
-    "automatically determine the amount of free memory from /proc/meminfo");
+    "usage of itself + all the runner processes by keeping only some of the "
+    "shards decompressed at a time and loading the others on demand. A "
+    "special value `auto` can be used to automatically determine the amount "
+    "of free memory from /proc/meminfo");
+ABSL_FLAG(bool, keep_compressed_shards_in_memory, false,
+          "When --limit_memory_usage_mb is set, also keep the compressed bytes "
+          "of all shards in memory instead of re-reading them from disk on "
+          "every load.");
+ABSL_FLAG(std::string, stats_page, "",
+          "If set, publish live counters in a shared memory stats page at "
+          "this path, e.g. under /dev/shm. A special value `memfd` keeps the "
+          "page in a memfd and logs its /proc path. Read the page with "
+          "stats_page_tool.");
+ABSL_FLAG(bool, runner_cgroup, false,
+          "If set, place all runners into a cgroup v2 subtree next to the "
+          "orchestrator for exact memory accounting. With "
+          "--limit_memory_usage_mb, runners are also hard-limited to the "
+          "memory not reserved for shards. Requires a delegated cgroup, "
+          "falls back to no cgroup with an error message otherwise.");
+ABSL_FLAG(absl::Duration, corpus_reload_interval, absl::ZeroDuration(),
+          "When > 0, check --shard_list_file and the shards it lists for "
+          "changes this often and switch new runners to the changed corpus "
+          "without restarting the session. Runners already started keep "
+          "their shards. Requires --shard_list_file. Incompatible with "
+          "--sequential_mode and --limit_memory_usage_mb.");
 // TODO(b/233457080): [bug] Investigate the cause of EXECUTION_RUNAWAY errors.
 ABSL_FLAG(bool, report_runaways_as_errors, false,
           "Whether runaway snapshot should be reported as errors");
@@ -156,8 +189,8 @@ std::vector<int> AvailableCpus() {
 // Initializes the orchestrator environment.
 ExecutionContext *OrchestratorInit(
     absl::Time deadline, int num_threads,
-    const ExecutionContext::ResultCallback &result_cb) {
-  static ExecutionContext ctx(deadline, num_threads, result_cb);
+    const ExecutionContext::ResultCallback &result_cb, StatsPage *stats_page) {
+  static ExecutionContext ctx(deadline, num_threads, result_cb, stats_page);
 
   struct sigaction sigact = {};
   sigact.sa_handler = [](int) {
@@ -210,9 +243,16 @@ bool SessionLoggingEnabled() {
   return enabled;
 }
 
+// Runs the orchestrator. If `shard_memory_budget_mb` is 0 all `corpora` are
+// loaded upfront, otherwise they are loaded on demand through a ShardCache of
+// that size. With --corpus_reload_interval, the shards are loaded and reloaded
+// by a CorpusReloader instead. If `runner_cgroup` is not null, all runners are
+// started in it.
 int OrchestratorMain(const std::vector<std::string> &corpora,
                      const std::string &runner,
-                     const std::vector<std::string> &runner_extra_argv) {
+                     const std::vector<std::string> &runner_extra_argv,
+                     uint64_t shard_memory_budget_mb,
+                     const RunnerCgroup *runner_cgroup) {
   LOG_INFO("SiliFuzz Orchestrator started");
 
   const absl::Time start_time = absl::Now();
@@ -227,17 +267,48 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
   // Load corpora and exit if there is any error.
   // File descriptors of the uncompressed corpora are kept open
   // until this struct goes out of scope.
-  const absl::StatusOr<InMemoryCorpora> in_memory_corpora =
-      LoadCorpora(corpora);
-  if (!in_memory_corpora.ok()) {
-    LOG_ERROR("Cannot load corpora: ", in_memory_corpora.status().message());
-    return EXIT_FAILURE;
-  }
+  InMemoryCorpora in_memory_corpora;
+  std::unique_ptr<ShardCache> shard_cache;
+  std::unique_ptr<CorpusReloader> corpus_reloader;
+  if (const absl::Duration reload_interval =
+          absl::GetFlag(FLAGS_corpus_reload_interval);
+      reload_interval > absl::ZeroDuration()) {
+    absl::StatusOr<std::unique_ptr<CorpusReloader>> corpus_reloader_or =
+        CorpusReloader::Create(
+            {.shard_list_path = absl::GetFlag(FLAGS_shard_list_file),
+             .poll_interval = reload_interval});
+    if (!corpus_reloader_or.ok()) {
+      LOG_ERROR("Cannot load corpora: ",
+                corpus_reloader_or.status().message());
+      return EXIT_FAILURE;
+    }
+    corpus_reloader = *std::move(corpus_reloader_or);
+  } else if (shard_memory_budget_mb == 0) {
+    absl::StatusOr<InMemoryCorpora> loaded_corpora = LoadCorpora(corpora);
+    if (!loaded_corpora.ok()) {
+      LOG_ERROR("Cannot load corpora: ", loaded_corpora.status().message());
+      return EXIT_FAILURE;
+    }
+    in_memory_corpora = *std::move(loaded_corpora);
 
-  absl::Status validation_status = ValidateCorpus(*in_memory_corpora);
-  if (!validation_status.ok()) {
-    LOG_ERROR(validation_status.message());
-    return EXIT_FAILURE;
+    absl::Status validation_status = ValidateCorpus(in_memory_corpora);
+    if (!validation_status.ok()) {
+      LOG_ERROR(validation_status.message());
+      return EXIT_FAILURE;
+    }
+  } else {
+    absl::StatusOr<std::unique_ptr<ShardCache>> shard_cache_or =
+        ShardCache::Create(
+            corpora,
+            {.max_resident_bytes = shard_memory_budget_mb * 1024 * 1024,
+             .keep_compressed_in_memory =
+                 absl::GetFlag(FLAGS_keep_compressed_shards_in_memory)});
+    if (!shard_cache_or.ok()) {
+      LOG_ERROR("Cannot create shard cache: ",
+                shard_cache_or.status().message());
+      return EXIT_FAILURE;
+    }
+    shard_cache = *std::move(shard_cache_or);
   }
 
   size_t num_threads = absl::GetFlag(FLAGS_max_cpus);
@@ -259,7 +330,9 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
           .set_extra_argv(runner_extra_argv);
       thread_args.push_back({.thread_idx = cpu,
                              .runner = runner,
-                             .corpora = &*in_memory_corpora,
+                             .corpora = &in_memory_corpora,
+                             .shard_cache = shard_cache.get(),
+                             .corpus_reloader = corpus_reloader.get(),
                              .runner_options = runner_options});
     }
   } else {
@@ -270,16 +343,45 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
           .set_extra_argv(runner_extra_argv);
       thread_args.push_back({.thread_idx = thread_idx,
                              .runner = runner,
-                             .corpora = &*in_memory_corpora,
+                             .corpora = &in_memory_corpora,
+                             .shard_cache = shard_cache.get(),
+                             .corpus_reloader = corpus_reloader.get(),
                              .runner_options = runner_options});
     }
   }
 
+  if (runner_cgroup != nullptr) {
+    for (RunnerThreadArgs &args : thread_args) {
+      args.runner_options.set_cgroup_procs_fd(runner_cgroup->procs_fd());
+    }
+  }
+
+  std::unique_ptr<StatsPage> stats_page;
+  if (std::string path = absl::GetFlag(FLAGS_stats_page); !path.empty()) {
+    absl::StatusOr<std::unique_ptr<StatsPage>> stats_page_or =
+        StatsPage::Create(path == "memfd" ? "" : path, thread_args.size(),
+                          start_time);
+    if (!stats_page_or.ok()) {
+      LOG_ERROR("Cannot create stats page: ",
+                stats_page_or.status().message());
+      return EXIT_FAILURE;
+    }
+    stats_page = *std::move(stats_page_or);
+    LOG_INFO("Publishing stats at ", stats_page->path());
+    for (size_t slot = 0; slot < thread_args.size(); ++slot) {
+      thread_args[slot].stats_page = stats_page.get();
+      thread_args[slot].stats_slot = slot;
+    }
+  }
+
   ResultCollector result_collector(
       absl::GetFlag(FLAGS_binary_log_fd), start_time,
       {.report_runaways_as_errors =
            absl::GetFlag(FLAGS_report_runaways_as_errors),
-       .fail_after_n_errors = absl::GetFlag(FLAGS_fail_after_n_errors)});
+       .fail_after_n_errors = absl::GetFlag(FLAGS_fail_after_n_errors),
+       .binary_log_options = {
+           .async = absl::GetFlag(FLAGS_binary_log_async),
+           .compress = absl::GetFlag(FLAGS_binary_log_compress)}});
 
   if (SessionLoggingEnabled()) {
     if (absl::Status s = result_collector.LogSessionStart(
@@ -289,9 +391,33 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
     }
   }
 
+  // Reports reloads of the corpus, if any, since the last call.
+  auto log_corpus_reloads = [&]() {
+    if (corpus_reloader == nullptr) return;
+    for (const CorpusReloadEvent &event : corpus_reloader->TakeEvents()) {
+      if (absl::Status s = result_collector.LogCorpusReload(event); !s.ok()) {
+        LOG_ERROR(s.message());
+      }
+    }
+  };
+  log_corpus_reloads();
+
   ExecutionContext *ctx = OrchestratorInit(
       deadline, num_threads,
-      absl::bind_front(&ResultCollector::operator(), &result_collector));
+      [&](const RunnerDriver::RunResult &result) {
+        log_corpus_reloads();
+        if (stats_page != nullptr && shard_cache != nullptr) {
+          ShardCache::Stats stats = shard_cache->stats();
+          stats_page->Set(GlobalStat::kShardResidentBytes,
+                          stats.resident_bytes);
+          stats_page->Set(GlobalStat::kShardHits, stats.hits);
+          stats_page->Set(GlobalStat::kShardMisses, stats.misses);
+          stats_page->Set(GlobalStat::kShardEvictions, stats.evictions);
+          stats_page->Set(GlobalStat::kBadShards, stats.bad_shards);
+        }
+        return result_collector(result);
+      },
+      stats_page.get());
 
   absl::Duration staggering_delay = absl::GetFlag(FLAGS_worker_thread_delay);
   // Create worker threads.
@@ -315,7 +441,20 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
     }
   }
   ctx->ProcessResultQueue();
-  result_collector.LogSummary(true);
+  log_corpus_reloads();
+  if (shard_cache != nullptr) {
+    ShardCache::Stats stats = shard_cache->stats();
+    LOG_INFO("Shard cache: hits: ", stats.hits, " misses: ", stats.misses,
+             " hit rate: ", stats.hit_rate(), " prefetches: ", stats.prefetches,
+             " evictions: ", stats.evictions, " bad: ", stats.bad_shards,
+             " transient failures: ", stats.transient_failures,
+             " decompress time: ", absl::FormatDuration(stats.decompress_time));
+  }
+  if (runner_cgroup != nullptr) {
+    LOG_INFO("Runner cgroup: peak memory: ",
+             runner_cgroup->PeakMemoryBytes().value_or(0) / (1024 * 1024),
+             "MB oom kills: ", runner_cgroup->OomKills().value_or(0));
+  }
   Summary summary = result_collector.summary();
   if (SessionLoggingEnabled() || summary.num_failed_snapshots > 0) {
     if (absl::Status s = result_collector.LogSessionSummary(
@@ -324,6 +463,8 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
       LOG_ERROR(s.message());
     }
   }
+  // Logged last so that the binary log counters cover the session summary.
+  result_collector.LogSummary(true);
   if (summary.num_failed_snapshots > 0) {
     return EXIT_FAILURE;
   }
@@ -331,28 +472,15 @@ int OrchestratorMain(const std::vector<std::string> &corpora,
 }
 
 std::vector<std::string> LoadShardFilenames(
-    const std::filesystem::path &shard_list_file) {
-  std::ifstream ifs;
-  ifs.open(shard_list_file);
-  VLOG_INFO(0, "Loading shards from ", shard_list_file.c_str());
-  if (!ifs.good()) {
-    LOG_ERROR("Error opening ", shard_list_file.c_str());
-    return {};
-  }
-  std::vector<std::string> shards;
-  std::string line;
-  while (std::getline(ifs, line)) {
-    absl::StripAsciiWhitespace(&line);
-    if (!line.empty() && line[0] != '#') {
-      shards.emplace_back(std::move(line));
-    }
-  }
-  if (ifs.bad()) {
-    LOG_ERROR("Error reading ", shard_list_file.c_str());
+    const std::string &shard_list_file) {
+  VLOG_INFO(0, "Loading shards from ", shard_list_file);
+  absl::StatusOr<std::string> contents = GetFileContents(shard_list_file);
+  if (!contents.ok()) {
+    LOG_ERROR("Error reading ", shard_list_file, ": ",
+              contents.status().message());
     return {};
   }
-  ifs.close();
-  return shards;
+  return ParseShardList(*contents);
 }
 
 }  // namespace
@@ -366,8 +494,33 @@ int main(int argc, char **argv) {
     std::cerr << "--runner must be set" << '\n';
     return EXIT_FAILURE;
   }
-  // Load the corpus shard list.
+  // Compressed frames only pay off for batches of entries.
+  if (absl::GetFlag(FLAGS_binary_log_compress) &&
+      !absl::GetFlag(FLAGS_binary_log_async)) {
+    std::cerr << "--binary_log_compress requires --binary_log_async" << '\n';
+    return EXIT_FAILURE;
+  }
   std::string shard_list_file = absl::GetFlag(FLAGS_shard_list_file);
+  std::string limit_memory_usage_mb =
+      absl::GetFlag(FLAGS_limit_memory_usage_mb);
+  if (absl::GetFlag(FLAGS_corpus_reload_interval) > absl::ZeroDuration()) {
+    // The reloader polls the shard list file, there is nothing to reload
+    // without one.
+    if (shard_list_file.empty()) {
+      std::cerr << "--corpus_reload_interval requires --shard_list_file"
+                << '\n';
+      return EXIT_FAILURE;
+    }
+    if (absl::GetFlag(FLAGS_sequential_mode) ||
+        limit_memory_usage_mb != "unlimited") {
+      std::cerr << "--corpus_reload_interval cannot be combined with "
+                   "--sequential_mode or --limit_memory_usage_mb"
+                << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Load the corpus shard list.
   if (shard_list_file.empty()) {
     std::cerr << "--shard_list_file must be set" << '\n';
     return EXIT_FAILURE;
@@ -380,10 +533,9 @@ int main(int argc, char **argv) {
         << '\n';
     return EXIT_FAILURE;
   }
-  const int total_shards = shards.size();
 
-  std::string limit_memory_usage_mb =
-      absl::GetFlag(FLAGS_limit_memory_usage_mb);
+  uint64_t shard_memory_budget_mb = 0;
+  uint64_t runner_memory_limit_mb = 0;
   if (limit_memory_usage_mb != "unlimited") {
     int64_t limit_memory_usage_mb_as_int = 0;
     if (limit_memory_usage_mb == "auto") {
@@ -404,14 +556,29 @@ int main(int argc, char **argv) {
     if (max_cpus == 0) {
       max_cpus = silifuzz::AvailableCpus().size();
     }
-    absl::StatusOr<std::vector<std::string>> capped_shards =
-        silifuzz::CapShardsToMemLimit(shards, limit_memory_usage_mb_as_int,
-                                      max_cpus);
-    if (!capped_shards.ok()) {
-      LOG_ERROR(capped_shards.status().message());
+    absl::StatusOr<uint64_t> budget_mb = silifuzz::ShardMemoryBudgetMb(
+        limit_memory_usage_mb_as_int, max_cpus);
+    if (!budget_mb.ok()) {
+      LOG_ERROR(budget_mb.status().message());
       return EXIT_FAILURE;
     }
-    shards = std::move(*capped_shards);
+    shard_memory_budget_mb = *budget_mb;
+    runner_memory_limit_mb =
+        limit_memory_usage_mb_as_int - shard_memory_budget_mb;
+  }
+
+  std::unique_ptr<silifuzz::RunnerCgroup> runner_cgroup;
+  if (absl::GetFlag(FLAGS_runner_cgroup)) {
+    absl::StatusOr<std::unique_ptr<silifuzz::RunnerCgroup>> runner_cgroup_or =
+        silifuzz::RunnerCgroup::Create(
+            {.memory_max_bytes = runner_memory_limit_mb * 1024 * 1024});
+    if (runner_cgroup_or.ok()) {
+      runner_cgroup = *std::move(runner_cgroup_or);
+      LOG_INFO("Runner cgroup: ", runner_cgroup->path());
+    } else {
+      LOG_ERROR("Running without a runner cgroup: ",
+                runner_cgroup_or.status().message());
+    }
   }
 
   std::vector<std::string> runner_extra_argv;
@@ -423,8 +590,11 @@ int main(int argc, char **argv) {
   }
 
   LOG_INFO("AVAIL MEM: ", silifuzz::AvailableMemoryMb().value_or(0),
-           " LOADABLE SHARDS: ", shards.size(), " TOTAL SHARDS: ", total_shards,
+           " SHARD MEM BUDGET: ", shard_memory_budget_mb,
+           " TOTAL SHARDS: ", shards.size(),
            " CPUS: ", silifuzz::AvailableCpus().size());
 
-  return silifuzz::OrchestratorMain(shards, runner, runner_extra_argv);
+  return silifuzz::OrchestratorMain(shards, runner, runner_extra_argv,
+                                    shard_memory_budget_mb,
+                                    runner_cgroup.get());
 }
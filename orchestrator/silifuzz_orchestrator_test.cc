@@ -14,15 +14,21 @@
 
 #include "./orchestrator/silifuzz_orchestrator.h"
 
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "./orchestrator/shard_cache.h"
 #include "./runner/driver/runner_driver.h"
+#include "./runner/driver/runner_options.h"
+#include "./util/checks.h"
+#include "./util/data_dependency.h"
 
 namespace silifuzz {
 namespace {
@@ -120,6 +126,66 @@ TEST(NextCorpusGenerator, Random) {
          "of the source at least once";
 }
 
+// Returns a shard cache over a shard that cannot be loaded followed by a good
+// one.
+std::unique_ptr<ShardCache> CacheWithBadShard() {
+  absl::StatusOr<std::unique_ptr<ShardCache>> cache = ShardCache::Create(
+      {"/does/not/exist.xz", GetDataDependencyFilepath(
+                                 "orchestrator/testdata/one_mb_of_zeros.xz")},
+      {.max_resident_bytes = 2 * 1024 * 1024, .validate_shards = false});
+  CHECK_STATUS(cache.status());
+  return *std::move(cache);
+}
+
+TEST(RunnerThread, SkipsBadShardInSequentialMode) {
+  std::unique_ptr<ShardCache> cache = CacheWithBadShard();
+  int results_processed = 0;
+  ExecutionContext ctx(absl::InfiniteFuture(), 1,
+                       [&results_processed](const RunnerDriver::RunResult& r) {
+                         results_processed++;
+                         return false;
+                       });
+  RunnerOptions runner_options = RunnerOptions::Default();
+  runner_options.set_sequential_mode(true);
+  RunnerThread(&ctx, {.thread_idx = 0,
+                      .runner = "/bin/true",
+                      .shard_cache = cache.get(),
+                      .runner_options = runner_options});
+  ctx.ProcessResultQueue();
+  EXPECT_TRUE(cache->IsBad(0));
+  EXPECT_FALSE(cache->IsBad(1));
+  // The good shard still ran after the bad one.
+  EXPECT_EQ(results_processed, 1);
+}
+
+TEST(RunnerThread, KeepsRunningWithBadShard) {
+  std::unique_ptr<ShardCache> cache = CacheWithBadShard();
+  constexpr int kNumThreads = 2;
+  int results_processed = 0;
+  ExecutionContext ctx(absl::Now() + absl::Seconds(1), kNumThreads,
+                       [&results_processed](const RunnerDriver::RunResult& r) {
+                         results_processed++;
+                         return false;
+                       });
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(RunnerThread, &ctx,
+                         RunnerThreadArgs{.thread_idx = i,
+                                          .runner = "/bin/true",
+                                          .shard_cache = cache.get()});
+  }
+  ctx.EventLoop();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ctx.ProcessResultQueue();
+  // A thread that stops early stops the whole context. Runs until the
+  // deadline mean the workers survived drawing the bad shard.
+  EXPECT_GE(absl::Now(), ctx.deadline());
+  EXPECT_EQ(cache->stats().bad_shards, 1);
+  EXPECT_GT(results_processed, kNumThreads);
+}
+
 }  // namespace
 
 }  // namespace silifuzz
@@ -0,0 +1,314 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./orchestrator/stats_page.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./util/checks.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/owned_file_descriptor.h"
+
+namespace silifuzz {
+
+namespace {
+
+constexpr size_t GlobalsOffset() { return sizeof(StatsPageHeader); }
+
+constexpr size_t SlotsOffset() {
+  return GlobalsOffset() + sizeof(StatsPageGlobals);
+}
+
+struct StatInfo {
+  absl::string_view name;
+  bool is_gauge;
+};
+
+constexpr StatInfo kGlobalStatInfo[kNumGlobalStats] = {
+    {"heartbeat_unix_nanos", true}, {"queue_depth", true},
+    {"shard_resident_bytes", true}, {"shard_hits", false},
+    {"shard_misses", false},        {"shard_evictions", false},
+    {"bad_shards", false},
+};
+
+constexpr StatInfo kThreadStatInfo[kNumThreadStats] = {
+    {"thread", true},          {"invocations", false},
+    {"snap_failures", false},  {"runaways", false},
+    {"internal_errors", false}, {"wall_time_nanos", false},
+    {"cpu_time_nanos", false}, {"max_latency_nanos", true},
+};
+
+std::string LatencyBucketName(size_t bucket) {
+  if (bucket == kNumLatencyBuckets - 1) {
+    return absl::StrCat(">=", uint64_t{1} << (bucket - 1), "ms");
+  }
+  return absl::StrCat("<", uint64_t{1} << bucket, "ms");
+}
+
+}  // namespace
+
+size_t LatencyBucket(absl::Duration latency) {
+  int64_t ms = absl::ToInt64Milliseconds(latency);
+  if (ms <= 0) return 0;
+  return std::min<size_t>(std::bit_width(static_cast<uint64_t>(ms)),
+                          kNumLatencyBuckets - 1);
+}
+
+absl::string_view GlobalStatName(GlobalStat stat) {
+  return kGlobalStatInfo[static_cast<size_t>(stat)].name;
+}
+
+absl::string_view ThreadStatName(ThreadStat stat) {
+  return kThreadStatInfo[static_cast<size_t>(stat)].name;
+}
+
+bool IsGauge(GlobalStat stat) {
+  return kGlobalStatInfo[static_cast<size_t>(stat)].is_gauge;
+}
+
+bool IsGauge(ThreadStat stat) {
+  return kThreadStatInfo[static_cast<size_t>(stat)].is_gauge;
+}
+
+size_t StatsPageSize(size_t num_threads) {
+  return SlotsOffset() + num_threads * sizeof(StatsPageThreadSlot);
+}
+
+absl::StatusOr<std::unique_ptr<StatsPage>> StatsPage::Create(
+    absl::string_view path, size_t num_threads, absl::Time start_time) {
+  std::string page_path(path);
+  int fd;
+  if (path.empty()) {
+    fd = memfd_create("silifuzz_stats_page", MFD_CLOEXEC);
+    if (fd < 0) return absl::ErrnoToStatus(errno, "memfd_create()");
+    page_path = absl::StrCat("/proc/", getpid(), "/fd/", fd);
+  } else {
+    fd = open(page_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      return absl::ErrnoToStatus(errno, absl::StrCat("open(", path, ")"));
+    }
+  }
+  OwnedFileDescriptor owned_fd(fd);
+  const size_t size = StatsPageSize(num_threads);
+  if (ftruncate(fd, size) != 0) {
+    return absl::ErrnoToStatus(errno, "ftruncate()");
+  }
+  void* addr =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) return absl::ErrnoToStatus(errno, "mmap()");
+  MmappedMemoryPtr<char> mapping =
+      MakeMmappedMemoryPtr(static_cast<char*>(addr), size);
+
+  // Cannot use std::make_unique() with a private c-tor.
+  return std::unique_ptr<StatsPage>(new StatsPage(
+      std::move(mapping), std::move(owned_fd), std::move(page_path),
+      num_threads, start_time));
+}
+
+StatsPage::StatsPage(MmappedMemoryPtr<char> mapping, OwnedFileDescriptor fd,
+                     std::string path, size_t num_threads,
+                     absl::Time start_time)
+    : mapping_(std::move(mapping)),
+      fd_(std::move(fd)),
+      path_(std::move(path)),
+      num_threads_(num_threads) {
+  char* base = mapping_.get();
+  // The file was just truncated, so everything starts out zero.
+  auto* header = new (base) StatsPageHeader{};
+  globals_ = new (base + GlobalsOffset()) StatsPageGlobals{};
+  slots_ = reinterpret_cast<StatsPageThreadSlot*>(base + SlotsOffset());
+  for (size_t i = 0; i < num_threads; ++i) {
+    new (&slots_[i]) StatsPageThreadSlot{};
+  }
+  header->version = kStatsPageVersion;
+  header->num_threads = num_threads;
+  header->num_global_stats = kNumGlobalStats;
+  header->num_thread_stats = kNumThreadStats;
+  header->num_latency_buckets = kNumLatencyBuckets;
+  header->pid = getpid();
+  header->start_time_unix_nanos = absl::ToUnixNanos(start_time);
+  header->magic.store(kStatsPageMagic, std::memory_order_release);
+}
+
+void StatsPage::RecordLatency(size_t slot, absl::Duration latency) {
+  DCHECK_LT(slot, num_threads_);
+  const uint64_t nanos = absl::ToInt64Nanoseconds(latency);
+  Add(slot, ThreadStat::kWallTimeNanos, nanos);
+  if (nanos > Stat(slot, ThreadStat::kMaxLatencyNanos)
+                  .load(std::memory_order_relaxed)) {
+    Set(slot, ThreadStat::kMaxLatencyNanos, nanos);
+  }
+  std::atomic<uint64_t>& bucket =
+      slots_[slot].latency_buckets[LatencyBucket(latency)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+}
+
+absl::StatusOr<StatsPageSnapshot> ReadStatsPage(absl::string_view path) {
+  std::string path_str(path);
+  OwnedFileDescriptor fd(open(path_str.c_str(), O_RDONLY | O_CLOEXEC));
+  if (fd.borrow() < 0) {
+    return absl::ErrnoToStatus(errno, absl::StrCat("open(", path, ")"));
+  }
+  struct stat st;
+  if (fstat(fd.borrow(), &st) != 0) {
+    return absl::ErrnoToStatus(errno, "fstat()");
+  }
+  const size_t size = st.st_size;
+  if (size < StatsPageSize(0)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " is not an initialized stats page"));
+  }
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd.borrow(), 0);
+  if (addr == MAP_FAILED) return absl::ErrnoToStatus(errno, "mmap()");
+  MmappedMemoryPtr<const char> mapping =
+      MakeMmappedMemoryPtr(static_cast<const char*>(addr), size);
+  const char* base = mapping.get();
+
+  const auto* header = reinterpret_cast<const StatsPageHeader*>(base);
+  if (header->magic.load(std::memory_order_acquire) != kStatsPageMagic) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " is not an initialized stats page"));
+  }
+  if (header->version != kStatsPageVersion ||
+      header->num_global_stats != kNumGlobalStats ||
+      header->num_thread_stats != kNumThreadStats ||
+      header->num_latency_buckets != kNumLatencyBuckets) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " has stats page version ", header->version,
+                     ", expected ", kStatsPageVersion));
+  }
+  if (size < StatsPageSize(header->num_threads)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path, " is truncated"));
+  }
+
+  StatsPageSnapshot snapshot;
+  snapshot.pid = header->pid;
+  snapshot.start_time = absl::FromUnixNanos(header->start_time_unix_nanos);
+  snapshot.read_time = absl::Now();
+  const auto* globals =
+      reinterpret_cast<const StatsPageGlobals*>(base + GlobalsOffset());
+  for (size_t i = 0; i < kNumGlobalStats; ++i) {
+    snapshot.global[i] = globals->stats[i].load(std::memory_order_relaxed);
+  }
+  const auto* slots =
+      reinterpret_cast<const StatsPageThreadSlot*>(base + SlotsOffset());
+  snapshot.threads.resize(header->num_threads);
+  for (size_t t = 0; t < header->num_threads; ++t) {
+    StatsPageSnapshot::Thread& thread = snapshot.threads[t];
+    for (size_t i = 0; i < kNumThreadStats; ++i) {
+      thread.stats[i] = slots[t].stats[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < kNumLatencyBuckets; ++i) {
+      thread.latency_buckets[i] =
+          slots[t].latency_buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+absl::StatusOr<StatsPageSnapshot> DiffStatsPages(
+    const StatsPageSnapshot& before, const StatsPageSnapshot& after) {
+  if (before.pid != after.pid || before.start_time != after.start_time ||
+      before.threads.size() != after.threads.size()) {
+    return absl::InvalidArgumentError(
+        "Stats pages are from different orchestrator sessions");
+  }
+  StatsPageSnapshot diff = after;
+  // The diff covers the time between the two reads.
+  diff.start_time = before.read_time;
+  for (size_t i = 0; i < kNumGlobalStats; ++i) {
+    if (!IsGauge(static_cast<GlobalStat>(i))) {
+      diff.global[i] -= before.global[i];
+    }
+  }
+  for (size_t t = 0; t < diff.threads.size(); ++t) {
+    StatsPageSnapshot::Thread& thread = diff.threads[t];
+    for (size_t i = 0; i < kNumThreadStats; ++i) {
+      if (!IsGauge(static_cast<ThreadStat>(i))) {
+        thread.stats[i] -= before.threads[t].stats[i];
+      }
+    }
+    for (size_t i = 0; i < kNumLatencyBuckets; ++i) {
+      thread.latency_buckets[i] -= before.threads[t].latency_buckets[i];
+    }
+  }
+  return diff;
+}
+
+std::string FormatStatsPage(const StatsPageSnapshot& snapshot) {
+  std::string out = absl::StrCat(
+      "pid: ", snapshot.pid, " elapsed: ",
+      absl::FormatDuration(snapshot.read_time - snapshot.start_time), "\n");
+  for (size_t i = 0; i < kNumGlobalStats; ++i) {
+    absl::StrAppend(&out, GlobalStatName(static_cast<GlobalStat>(i)), ": ",
+                    snapshot.global[i], "\n");
+  }
+
+  StatsPageSnapshot::Thread total;
+  for (size_t i = 0; i < kNumThreadStats; ++i) {
+    absl::StrAppend(&out, i == 0 ? "" : " ",
+                    ThreadStatName(static_cast<ThreadStat>(i)));
+  }
+  absl::StrAppend(&out, "\n");
+  for (const StatsPageSnapshot::Thread& thread : snapshot.threads) {
+    for (size_t i = 0; i < kNumThreadStats; ++i) {
+      absl::StrAppend(&out, i == 0 ? "" : " ", thread.stats[i]);
+      if (static_cast<ThreadStat>(i) == ThreadStat::kMaxLatencyNanos) {
+        total.stats[i] = std::max(total.stats[i], thread.stats[i]);
+      } else {
+        total.stats[i] += thread.stats[i];
+      }
+    }
+    absl::StrAppend(&out, "\n");
+    for (size_t i = 0; i < kNumLatencyBuckets; ++i) {
+      total.latency_buckets[i] += thread.latency_buckets[i];
+    }
+  }
+  absl::StrAppend(&out, "total");
+  for (size_t i = 1; i < kNumThreadStats; ++i) {
+    absl::StrAppend(&out, " ", total.stats[i]);
+  }
+  absl::StrAppend(&out, "\nlatency:");
+  for (size_t i = 0; i < kNumLatencyBuckets; ++i) {
+    if (total.latency_buckets[i] == 0) continue;
+    absl::StrAppend(&out, " ", LatencyBucketName(i), ": ",
+                    total.latency_buckets[i]);
+  }
+  absl::StrAppend(&out, "\n");
+  return out;
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,228 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_STATS_PAGE_H_
+#define THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_STATS_PAGE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "./util/checks.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/owned_file_descriptor.h"
+
+namespace silifuzz {
+
+// Orchestrator-wide values.
+enum class GlobalStat : uint32_t {
+  kHeartbeatUnixNanos = 0,  // Last time the event loop woke up.
+  kQueueDepth,              // Results waiting for the event loop.
+  kShardResidentBytes,      // ShardCache::Stats.
+  kShardHits,
+  kShardMisses,
+  kShardEvictions,
+  kBadShards,
+  kNumStats,
+};
+
+// Per worker thread values.
+enum class ThreadStat : uint32_t {
+  kThreadIdx = 0,       // RunnerThreadArgs::thread_idx.
+  kInvocations,         // Runner binaries executed.
+  kSnapFailures,        // Runs that reported a failing snap.
+  kRunaways,            // Runs that reported a runaway snap.
+  kInternalErrors,      // Runs or shard loads that failed, not due to a snap.
+  kWallTimeNanos,       // Total wall time of all invocations.
+  kCpuTimeNanos,        // Total user + system time of all runners.
+  kMaxLatencyNanos,     // Longest single invocation.
+  kNumStats,
+};
+
+inline constexpr size_t kNumGlobalStats =
+    static_cast<size_t>(GlobalStat::kNumStats);
+inline constexpr size_t kNumThreadStats =
+    static_cast<size_t>(ThreadStat::kNumStats);
+
+// Invocation latency histogram. Bucket 0 counts latencies below 1ms, bucket
+// i > 0 counts latencies in [2^(i-1)ms, 2^i ms) and the last bucket also
+// counts everything longer.
+inline constexpr size_t kNumLatencyBuckets = 24;
+
+// Returns the index of the latency bucket for `latency`.
+size_t LatencyBucket(absl::Duration latency);
+
+// Names used by the reader tool.
+absl::string_view GlobalStatName(GlobalStat stat);
+absl::string_view ThreadStatName(ThreadStat stat);
+
+// Returns true if `stat` is a point in time value rather than a counter.
+// Diffs report the newer value of gauges.
+bool IsGauge(GlobalStat stat);
+bool IsGauge(ThreadStat stat);
+
+// Layout of a stats page. The page is a header, followed by globals, followed
+// by one slot per worker thread, each aligned to a cache line so that worker
+// threads do not share lines. Readers must check `magic` and `version` before
+// trusting anything else. Any change to the layout or to the meaning of a stat
+// must bump kStatsPageVersion. Appending stats still changes the counts in the
+// header, which readers verify.
+inline constexpr uint64_t kStatsPageMagic = 0x3153544154534653;  // "SFSTATS1"
+inline constexpr uint32_t kStatsPageVersion = 1;
+
+struct alignas(64) StatsPageHeader {
+  // Stored last with release semantics once the rest of the page is set up.
+  std::atomic<uint64_t> magic;
+  uint32_t version;
+  uint32_t num_threads;
+  uint32_t num_global_stats;
+  uint32_t num_thread_stats;
+  uint32_t num_latency_buckets;
+  uint32_t reserved;
+  uint64_t pid;
+  uint64_t start_time_unix_nanos;
+};
+
+struct alignas(64) StatsPageGlobals {
+  std::atomic<uint64_t> stats[kNumGlobalStats];
+};
+
+struct alignas(64) StatsPageThreadSlot {
+  std::atomic<uint64_t> stats[kNumThreadStats];
+  std::atomic<uint64_t> latency_buckets[kNumLatencyBuckets];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "stats page atomics must be address free");
+
+// Returns the size of a stats page with `num_threads` slots.
+size_t StatsPageSize(size_t num_threads);
+
+// StatsPage publishes live orchestrator counters in shared memory so that
+// monitoring agents can poll them at any rate without involving the
+// orchestrator. Writers use relaxed atomic stores only, there are no locks or
+// syscalls after construction.
+//
+// Each thread slot must have a single writer. Global stats may be set from any
+// thread. Readers see each value atomically but not a consistent snapshot
+// across values.
+//
+// This class is thread-safe under the single writer per slot rule.
+class StatsPage {
+ public:
+  // Creates a page with `num_threads` thread slots. If `path` is empty the
+  // page lives in an anonymous memfd, otherwise it is created or truncated at
+  // `path`, typically under /dev/shm. The file is left in place after the
+  // orchestrator exits so that the final values can still be read.
+  static absl::StatusOr<std::unique_ptr<StatsPage>> Create(
+      absl::string_view path, size_t num_threads, absl::Time start_time);
+
+  // Not copyable or moveable -- owns a shared mapping.
+  StatsPage(const StatsPage&) = delete;
+  StatsPage(StatsPage&&) = delete;
+  StatsPage& operator=(const StatsPage&) = delete;
+  StatsPage& operator=(StatsPage&&) = delete;
+
+  ~StatsPage() = default;
+
+  // Path that readers should open. For a memfd this is a /proc path that is
+  // valid while the orchestrator is alive.
+  const std::string& path() const { return path_; }
+
+  size_t num_threads() const { return num_threads_; }
+
+  void Set(GlobalStat stat, uint64_t value) {
+    globals_->stats[static_cast<size_t>(stat)].store(
+        value, std::memory_order_relaxed);
+  }
+
+  void Set(size_t slot, ThreadStat stat, uint64_t value) {
+    Stat(slot, stat).store(value, std::memory_order_relaxed);
+  }
+
+  void Add(size_t slot, ThreadStat stat, uint64_t delta) {
+    // Single writer, so a plain load and store is enough and avoids a locked
+    // instruction.
+    std::atomic<uint64_t>& v = Stat(slot, stat);
+    v.store(v.load(std::memory_order_relaxed) + delta,
+            std::memory_order_relaxed);
+  }
+
+  // Records one runner invocation of `latency` in the histogram, the total
+  // wall time and the maximum latency of `slot`.
+  void RecordLatency(size_t slot, absl::Duration latency);
+
+ private:
+  StatsPage(MmappedMemoryPtr<char> mapping, OwnedFileDescriptor fd,
+            std::string path, size_t num_threads, absl::Time start_time);
+
+  std::atomic<uint64_t>& Stat(size_t slot, ThreadStat stat) {
+    DCHECK_LT(slot, num_threads_);
+    return slots_[slot].stats[static_cast<size_t>(stat)];
+  }
+
+  MmappedMemoryPtr<char> mapping_;
+  OwnedFileDescriptor fd_;
+  std::string path_;
+  size_t num_threads_;
+  StatsPageGlobals* globals_;
+  StatsPageThreadSlot* slots_;
+};
+
+// A plain copy of a stats page.
+struct StatsPageSnapshot {
+  struct Thread {
+    std::array<uint64_t, kNumThreadStats> stats = {};
+    std::array<uint64_t, kNumLatencyBuckets> latency_buckets = {};
+
+    uint64_t operator[](ThreadStat stat) const {
+      return stats[static_cast<size_t>(stat)];
+    }
+  };
+
+  uint64_t pid = 0;
+  // Orchestrator start time or, for a diff, the time of the earlier read.
+  absl::Time start_time = absl::InfinitePast();
+  absl::Time read_time = absl::InfinitePast();
+  std::array<uint64_t, kNumGlobalStats> global = {};
+  std::vector<Thread> threads;
+
+  uint64_t operator[](GlobalStat stat) const {
+    return global[static_cast<size_t>(stat)];
+  }
+};
+
+// Copies the stats page at `path`. Returns FailedPreconditionError if the page
+// is not initialized yet or was written by an incompatible version.
+absl::StatusOr<StatsPageSnapshot> ReadStatsPage(absl::string_view path);
+
+// Returns the change from `before` to `after`. Counters are subtracted, gauges
+// take the value in `after`. Both must be from the same orchestrator session.
+absl::StatusOr<StatsPageSnapshot> DiffStatsPages(
+    const StatsPageSnapshot& before, const StatsPageSnapshot& after);
+
+// Formats `snapshot` as human readable text. Thread rows are followed by a
+// total over all threads.
+std::string FormatStatsPage(const StatsPageSnapshot& snapshot);
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_ORCHESTRATOR_STATS_PAGE_H_
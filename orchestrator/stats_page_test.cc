@@ -0,0 +1,157 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./orchestrator/stats_page.h"
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./util/path_util.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(StatsPage, LatencyBucket) {
+  EXPECT_EQ(LatencyBucket(absl::ZeroDuration()), 0);
+  EXPECT_EQ(LatencyBucket(absl::Microseconds(999)), 0);
+  EXPECT_EQ(LatencyBucket(absl::Milliseconds(1)), 1);
+  EXPECT_EQ(LatencyBucket(absl::Milliseconds(2)), 2);
+  EXPECT_EQ(LatencyBucket(absl::Milliseconds(3)), 2);
+  EXPECT_EQ(LatencyBucket(absl::Seconds(10)), 14);
+  EXPECT_EQ(LatencyBucket(absl::Hours(1000)), kNumLatencyBuckets - 1);
+}
+
+TEST(StatsPage, WriteAndRead) {
+  const absl::Time start_time = absl::FromUnixSeconds(1000);
+  ASSERT_OK_AND_ASSIGN(auto page, StatsPage::Create("", 2, start_time));
+  page->Set(GlobalStat::kQueueDepth, 3);
+  page->Set(1, ThreadStat::kThreadIdx, 7);
+  page->Add(1, ThreadStat::kInvocations, 1);
+  page->Add(1, ThreadStat::kInvocations, 1);
+  page->RecordLatency(1, absl::Milliseconds(5));
+  page->RecordLatency(1, absl::Milliseconds(2));
+
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot snapshot, ReadStatsPage(page->path()));
+  EXPECT_EQ(snapshot.pid, getpid());
+  EXPECT_EQ(snapshot.start_time, start_time);
+  EXPECT_EQ(snapshot[GlobalStat::kQueueDepth], 3);
+  ASSERT_EQ(snapshot.threads.size(), 2);
+  EXPECT_EQ(snapshot.threads[0][ThreadStat::kInvocations], 0);
+  const StatsPageSnapshot::Thread& thread = snapshot.threads[1];
+  EXPECT_EQ(thread[ThreadStat::kThreadIdx], 7);
+  EXPECT_EQ(thread[ThreadStat::kInvocations], 2);
+  EXPECT_EQ(thread[ThreadStat::kWallTimeNanos], 7000000);
+  EXPECT_EQ(thread[ThreadStat::kMaxLatencyNanos], 5000000);
+  EXPECT_EQ(thread.latency_buckets[2], 1);
+  EXPECT_EQ(thread.latency_buckets[3], 1);
+}
+
+TEST(StatsPage, File) {
+  ASSERT_OK_AND_ASSIGN(std::string path, CreateTempFile("stats_page"));
+  {
+    ASSERT_OK_AND_ASSIGN(auto page,
+                         StatsPage::Create(path, 1, absl::Now()));
+    EXPECT_EQ(page->path(), path);
+    page->Add(0, ThreadStat::kSnapFailures, 4);
+  }
+  // The page outlives the writer.
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot snapshot, ReadStatsPage(path));
+  EXPECT_EQ(snapshot.threads[0][ThreadStat::kSnapFailures], 4);
+  unlink(path.c_str());
+}
+
+TEST(StatsPage, Diff) {
+  ASSERT_OK_AND_ASSIGN(auto page, StatsPage::Create("", 1, absl::Now()));
+  page->Set(GlobalStat::kShardHits, 10);
+  page->Set(GlobalStat::kQueueDepth, 1);
+  page->Add(0, ThreadStat::kInvocations, 5);
+  page->RecordLatency(0, absl::Milliseconds(100));
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot before, ReadStatsPage(page->path()));
+
+  page->Set(GlobalStat::kShardHits, 15);
+  page->Set(GlobalStat::kQueueDepth, 0);
+  page->Add(0, ThreadStat::kInvocations, 2);
+  page->RecordLatency(0, absl::Milliseconds(100));
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot after, ReadStatsPage(page->path()));
+
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot diff, DiffStatsPages(before, after));
+  EXPECT_EQ(diff[GlobalStat::kShardHits], 5);
+  EXPECT_EQ(diff[GlobalStat::kQueueDepth], 0);
+  EXPECT_EQ(diff.threads[0][ThreadStat::kInvocations], 2);
+  EXPECT_EQ(diff.threads[0].latency_buckets[LatencyBucket(
+                absl::Milliseconds(100))],
+            1);
+  EXPECT_EQ(diff.start_time, before.read_time);
+
+  std::string text = FormatStatsPage(diff);
+  EXPECT_THAT(text, HasSubstr("shard_hits: 5\n"));
+  EXPECT_THAT(text, HasSubstr("<128ms: 1"));
+
+  ASSERT_OK_AND_ASSIGN(auto other_page, StatsPage::Create("", 2, absl::Now()));
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot other,
+                       ReadStatsPage(other_page->path()));
+  EXPECT_THAT(DiffStatsPages(before, other),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(StatsPage, ConcurrentWriters) {
+  constexpr size_t kNumThreads = 4;
+  constexpr int kNumIterations = 10000;
+  ASSERT_OK_AND_ASSIGN(auto page,
+                       StatsPage::Create("", kNumThreads, absl::Now()));
+  std::vector<std::thread> threads;
+  for (size_t slot = 0; slot < kNumThreads; ++slot) {
+    threads.emplace_back([&page, slot]() {
+      for (int i = 0; i < kNumIterations; ++i) {
+        page->Add(slot, ThreadStat::kInvocations, 1);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  ASSERT_OK_AND_ASSIGN(StatsPageSnapshot snapshot, ReadStatsPage(page->path()));
+  for (const StatsPageSnapshot::Thread& thread : snapshot.threads) {
+    EXPECT_EQ(thread[ThreadStat::kInvocations], kNumIterations);
+  }
+}
+
+TEST(StatsPage, Errors) {
+  EXPECT_FALSE(ReadStatsPage("/this does not exist").ok());
+  ASSERT_OK_AND_ASSIGN(std::string path, CreateTempFile("stats_page"));
+  // Empty file.
+  EXPECT_THAT(ReadStatsPage(path),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  // Wrong magic.
+  ASSERT_EQ(truncate(path.c_str(), StatsPageSize(1)), 0);
+  EXPECT_THAT(ReadStatsPage(path),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  unlink(path.c_str());
+}
+
+}  // namespace
+}  // namespace silifuzz
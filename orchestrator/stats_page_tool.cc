@@ -0,0 +1,95 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Prints the live counters that silifuzz_orchestrator publishes with
+// --stats_page.
+//
+// Usage:
+//   stats_page_tool print <page>
+//   stats_page_tool diff <page> [--interval=1s]
+//   stats_page_tool diff <before> <after>
+//
+// `diff` with one page reads it twice, --interval apart, and prints the
+// change. With two pages, e.g. copies of the same page taken at different
+// times, it prints the change from <before> to <after>.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "./orchestrator/stats_page.h"
+#include "./util/checks.h"
+
+ABSL_FLAG(absl::Duration, interval, absl::Seconds(1),
+          "Time between the two reads of `diff` with a single page.");
+
+namespace silifuzz {
+namespace {
+
+absl::Status Print(const char* path) {
+  ASSIGN_OR_RETURN_IF_NOT_OK(StatsPageSnapshot snapshot, ReadStatsPage(path));
+  std::cout << FormatStatsPage(snapshot);
+  return absl::OkStatus();
+}
+
+absl::Status Diff(const char* before_path, const char* after_path) {
+  ASSIGN_OR_RETURN_IF_NOT_OK(StatsPageSnapshot before,
+                             ReadStatsPage(before_path));
+  if (before_path == after_path) {
+    absl::SleepFor(absl::GetFlag(FLAGS_interval));
+  }
+  ASSIGN_OR_RETURN_IF_NOT_OK(StatsPageSnapshot after,
+                             ReadStatsPage(after_path));
+  ASSIGN_OR_RETURN_IF_NOT_OK(StatsPageSnapshot diff,
+                             DiffStatsPages(before, after));
+  std::cout << FormatStatsPage(diff);
+  return absl::OkStatus();
+}
+
+int ToolMain(std::vector<char*>& args) {
+  if (args.size() < 3 || args.size() > 4) {
+    LOG_ERROR("Usage: stats_page_tool print|diff <page> [<page>]");
+    return EXIT_FAILURE;
+  }
+  const std::string command = args[1];
+  absl::Status status;
+  if (command == "print" && args.size() == 3) {
+    status = Print(args[2]);
+  } else if (command == "diff") {
+    status = Diff(args[2], args.size() == 4 ? args[3] : args[2]);
+  } else {
+    LOG_ERROR("Unknown command or wrong number of arguments: ", command);
+    return EXIT_FAILURE;
+  }
+  if (!status.ok()) {
+    LOG_ERROR(status.message());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace silifuzz
+
+int main(int argc, char** argv) {
+  std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  return silifuzz::ToolMain(args);
+}
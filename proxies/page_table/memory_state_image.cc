@@ -17,21 +17,63 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "./common/mapped_memory_map.h"
 #include "./common/memory_mapping.h"
 #include "./common/memory_perms.h"
 #include "./common/memory_state.h"
 #include "./proxies/page_table/page_table_creator.h"
+#include "./proxies/page_table/page_table_entry_util.h"
+#include "./proxies/page_table/physical_address.h"
+#include "./proxies/page_table/virtual_address.h"
 #include "./util/arch.h"
 #include "./util/checks.h"
 
 namespace silifuzz::proxies {
 
+namespace {
+
+// Number of 64-bit entries in a table of any level.
+constexpr size_t kEntriesPerTable = 512;
+
+// Number of virtual address bits translated by a table at each level. A table
+// at level L covers virtual addresses with the same value of
+// (address >> kTableShift[L]).
+constexpr int kTableShift[] = {48, 39, 30, 21};
+
+// Marks the absence of a last level table key.
+constexpr uint64_t kNoTable = ~uint64_t{0};
+
+// Checks that [start, limit) is a non-empty, granule-aligned range inside the
+// 48-bit address space. `descriptor` describes the range in case of error.
+template <typename arch>
+absl::Status CheckRange(uint64_t start, uint64_t limit,
+                        absl::string_view descriptor) {
+  constexpr uint64_t kGranule = PageTableCreator<arch>::kTranslationGranule;
+  constexpr uint64_t kAddressLimit = uint64_t{1} << kTableShift[0];
+  if (start >= limit || limit > kAddressLimit) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "%s [0x%x, 0x%x) is empty or does not fit within a 48-bit address "
+        "space",
+        descriptor, start, limit));
+  }
+  if (start % kGranule != 0 || limit % kGranule != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "%s [0x%x, 0x%x) should be aligned to the translation granule (4KiB)",
+        descriptor, start, limit));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 // static method.
 template <typename arch>
 absl::StatusOr<PageTableCreator<arch>> MemoryStateImage<arch>::LayoutPageTable(
@@ -53,11 +95,10 @@ absl::StatusOr<PageTableCreator<arch>> MemoryStateImage<arch>::LayoutPageTable(
     status.Update(page_table_creator.AddContiguousMapping(
         mapping, physical_address + data_offset));
     if (copy_data) {
-      const std::string byte_data =
-          memory_state.memory_bytes(start, mapping.num_bytes());
-      CHECK_LE(data_offset + byte_data.size(), memory_image_data.size());
-      memcpy(&memory_image_data[data_offset], byte_data.data(),
-             byte_data.size());
+      CHECK_LE(data_offset + mapping.num_bytes(), memory_image_data.size());
+      memory_state.CopyMemoryBytes(
+          start, mapping.num_bytes(),
+          reinterpret_cast<char*>(&memory_image_data[data_offset]));
     }
     data_offset += mapping.num_bytes();
   });
@@ -134,4 +175,241 @@ template class MemoryStateImage<AArch64>;
 
 template class MemoryStateImage<X86_64>;
 
+// static method.
+template <typename arch>
+absl::StatusOr<MemoryStateImageBuilder<arch>>
+MemoryStateImageBuilder<arch>::Create(
+    const std::vector<MemoryMapping>& regions, uint64_t physical_address,
+    const std::vector<ExternalMapping>& external_mappings) {
+  constexpr uint64_t kGranule = PageTableCreator<arch>::kTranslationGranule;
+  RETURN_IF_NOT_OK(CheckRange<arch>(physical_address,
+                                    physical_address + kGranule,
+                                    "physical_address"));
+  MemoryStateImageBuilder builder(regions, physical_address);
+
+  // The root table must be the first table of the image.
+  builder.AddTable(/*level=*/0, /*virtual_address=*/0);
+
+  // Link the L2 tables covering every region. Last level tables are added
+  // per memory state.
+  constexpr uint64_t kL2TableSize = uint64_t{1} << kTableShift[2];
+  for (const MemoryMapping& region : regions) {
+    RETURN_IF_NOT_OK(CheckRange<arch>(region.start_address(),
+                                      region.limit_address(), "region"));
+    const bool writeable = region.perms().Has(MemoryPerms::kWritable);
+    const bool executable = region.perms().Has(MemoryPerms::kExecutable);
+    for (uint64_t va = region.start_address() & ~(kL2TableSize - 1);
+         va < region.limit_address(); va += kL2TableSize) {
+      builder.LinkTables(/*level=*/2, va, writeable, executable);
+    }
+  }
+
+  // External mappings are the same in every image so they are fully mapped in
+  // the skeleton.
+  for (const ExternalMapping& external_mapping : external_mappings) {
+    const MemoryMapping& mapping = external_mapping.virtual_memory_mapping;
+    RETURN_IF_NOT_OK(CheckRange<arch>(mapping.start_address(),
+                                      mapping.limit_address(),
+                                      "external mapping"));
+    RETURN_IF_NOT_OK(CheckRange<arch>(
+        external_mapping.physical_start,
+        external_mapping.physical_start + mapping.num_bytes(),
+        "external mapping physical range"));
+    const bool writeable = mapping.perms().Has(MemoryPerms::kWritable);
+    const bool executable = mapping.perms().Has(MemoryPerms::kExecutable);
+    for (uint64_t offset = 0; offset < mapping.num_bytes();
+         offset += kGranule) {
+      const uint64_t va = mapping.start_address() + offset;
+      builder.LinkTables(/*level=*/3, va, writeable, executable);
+      uint64_t& entry =
+          builder.entries_[builder.tables_[3].at(va >> kTableShift[3]) +
+                           VirtualAddress(va).table_index_l3()];
+      ASSIGN_OR_RETURN_IF_NOT_OK_PLUS(
+          entry,
+          CreatePageDescriptor<arch>(
+              entry, PhysicalAddress(external_mapping.physical_start + offset),
+              writeable, executable),
+          absl::StrFormat("Failed to map virtual_address=0x%x: ", va));
+    }
+  }
+  return builder;
+}
+
+template <typename arch>
+size_t MemoryStateImageBuilder<arch>::AddTable(size_t level,
+                                               uint64_t virtual_address) {
+  const uint64_t key = virtual_address >> kTableShift[level];
+  auto [it, inserted] = tables_[level].try_emplace(key, entries_.size());
+  if (inserted) {
+    entries_.resize(entries_.size() + kEntriesPerTable);
+  }
+  return it->second;
+}
+
+template <typename arch>
+void MemoryStateImageBuilder<arch>::LinkTables(size_t level,
+                                               uint64_t virtual_address,
+                                               bool writeable,
+                                               bool executable) {
+  const VirtualAddress decoded_va(virtual_address);
+  size_t parent = AddTable(0, virtual_address);
+  for (size_t l = 0; l < level; ++l) {
+    const size_t child = AddTable(l + 1, virtual_address);
+    uint64_t& entry = entries_[parent + decoded_va.table_index_l(l)];
+    entry = UpdateTableDescriptor<arch>(
+        entry, PhysicalAddress(physical_address_ + child * sizeof(uint64_t)),
+        writeable, executable);
+    parent = child;
+  }
+}
+
+template <typename arch>
+absl::StatusOr<typename MemoryStateImageBuilder<arch>::Layout>
+MemoryStateImageBuilder<arch>::GetLayout(
+    const MemoryState& memory_state) const {
+  Layout layout = {.num_leaf_tables = 0, .num_data_bytes = 0};
+  absl::Status status;
+  uint64_t last_key = kNoTable;
+  memory_state.mapped_memory().Iterate([&](MappedMemoryMap::Address start,
+                                           MappedMemoryMap::Address limit,
+                                           MemoryPerms perms) {
+    if (!status.ok()) return;
+    status = CheckRange<arch>(start, limit, "mapping");
+    if (!status.ok()) return;
+    perms.Clear(MemoryPerms::kMapped);
+    const bool in_region =
+        absl::c_any_of(regions_, [&](const MemoryMapping& region) {
+          return region.start_address() <= start &&
+                 limit <= region.limit_address() && region.perms().Has(perms);
+        });
+    if (!in_region) {
+      status = absl::InvalidArgumentError(absl::StrFormat(
+          "mapping [0x%x, 0x%x) %s is not inside any region", start, limit,
+          perms.ToString()));
+      return;
+    }
+    // Mappings are iterated in address order so each last level table not in
+    // the skeleton is counted once.
+    for (uint64_t key = start >> kTableShift[3];
+         key <= (limit - 1) >> kTableShift[3]; ++key) {
+      if (key != last_key && !tables_[3].contains(key)) {
+        ++layout.num_leaf_tables;
+      }
+      last_key = key;
+    }
+    layout.num_data_bytes += limit - start;
+  });
+  RETURN_IF_NOT_OK(status);
+  return layout;
+}
+
+template <typename arch>
+absl::StatusOr<size_t> MemoryStateImageBuilder<arch>::ImageSize(
+    const MemoryState& memory_state) const {
+  ASSIGN_OR_RETURN_IF_NOT_OK(const Layout layout, GetLayout(memory_state));
+  return skeleton_size() +
+         layout.num_leaf_tables * PageTableCreator<arch>::kTranslationGranule +
+         layout.num_data_bytes;
+}
+
+template <typename arch>
+absl::Status MemoryStateImageBuilder<arch>::BuildInto(
+    const MemoryState& memory_state, void* buffer, size_t buffer_size) const {
+  constexpr uint64_t kGranule = PageTableCreator<arch>::kTranslationGranule;
+  ASSIGN_OR_RETURN_IF_NOT_OK(const Layout layout, GetLayout(memory_state));
+  const size_t table_bytes =
+      skeleton_size() + layout.num_leaf_tables * kGranule;
+  const size_t image_size = table_bytes + layout.num_data_bytes;
+  if (buffer_size < image_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "buffer too small: %d bytes, need %d", buffer_size, image_size));
+  }
+  if (reinterpret_cast<uintptr_t>(buffer) % alignof(uint64_t) != 0) {
+    return absl::InvalidArgumentError("buffer is not 8-byte aligned");
+  }
+
+  uint64_t* const tables = static_cast<uint64_t*>(buffer);
+  uint8_t* const image_data = static_cast<uint8_t*>(buffer);
+  memcpy(tables, entries_.data(), skeleton_size());
+  memset(image_data + skeleton_size(), 0, table_bytes - skeleton_size());
+
+  // Fill in last level tables and copy contents in one pass. Contents are laid
+  // out in address order after the tables, as in MemoryStateImage::Build().
+  absl::Status status;
+  size_t next_leaf_table = entries_.size();
+  uint64_t leaf_table_key = kNoTable;
+  size_t leaf_table = 0;
+  size_t data_offset = table_bytes;
+  memory_state.mapped_memory().Iterate([&](MappedMemoryMap::Address start,
+                                           MappedMemoryMap::Address limit,
+                                           MemoryPerms perms) {
+    if (!status.ok()) return;
+    const bool writeable = perms.Has(MemoryPerms::kWritable);
+    const bool executable = perms.Has(MemoryPerms::kExecutable);
+    CHECK_LE(data_offset + (limit - start), image_size);
+    memory_state.CopyMemoryBytes(
+        start, limit - start,
+        reinterpret_cast<char*>(image_data + data_offset));
+
+    uint64_t linked_key = kNoTable;
+    for (uint64_t va = start; va < limit;
+         va += kGranule, data_offset += kGranule) {
+      const VirtualAddress decoded_va(va);
+      const uint64_t key = va >> kTableShift[3];
+      if (key != leaf_table_key) {
+        auto it = tables_[3].find(key);
+        if (it != tables_[3].end()) {
+          leaf_table = it->second;
+        } else {
+          leaf_table = next_leaf_table;
+          next_leaf_table += kEntriesPerTable;
+        }
+        leaf_table_key = key;
+      }
+      // Grant the permissions of this mapping to the L2 table descriptor.
+      if (key != linked_key) {
+        uint64_t& entry = tables[tables_[2].at(va >> kTableShift[2]) +
+                                 decoded_va.table_index_l2()];
+        entry = UpdateTableDescriptor<arch>(
+            entry,
+            PhysicalAddress(physical_address_ + leaf_table * sizeof(uint64_t)),
+            writeable, executable);
+        linked_key = key;
+      }
+      uint64_t& entry = tables[leaf_table + decoded_va.table_index_l3()];
+      absl::StatusOr<uint64_t> descriptor = CreatePageDescriptor<arch>(
+          entry, PhysicalAddress(physical_address_ + data_offset), writeable,
+          executable);
+      if (!descriptor.ok()) {
+        status = absl::Status(
+            descriptor.status().code(),
+            absl::StrFormat("Failed to map virtual_address=0x%x: %s", va,
+                            descriptor.status().message()));
+        return;
+      }
+      entry = *descriptor;
+    }
+  });
+  RETURN_IF_NOT_OK(status);
+  CHECK_EQ(next_leaf_table * sizeof(uint64_t), table_bytes);
+  CHECK_EQ(data_offset, image_size);
+  return absl::OkStatus();
+}
+
+template <typename arch>
+absl::StatusOr<MemoryStateImage<arch>> MemoryStateImageBuilder<arch>::Build(
+    const MemoryState& memory_state) const {
+  ASSIGN_OR_RETURN_IF_NOT_OK(const size_t image_size,
+                             ImageSize(memory_state));
+  std::vector<uint8_t> image_data(image_size);
+  RETURN_IF_NOT_OK(
+      BuildInto(memory_state, image_data.data(), image_data.size()));
+  return MemoryStateImage<arch>(physical_address_, std::move(image_data),
+                                physical_address_);
+}
+
+template class MemoryStateImageBuilder<AArch64>;
+
+template class MemoryStateImageBuilder<X86_64>;
+
 }  // namespace silifuzz::proxies
@@ -17,8 +17,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "./common/memory_mapping.h"
 #include "./common/memory_state.h"
@@ -26,6 +29,9 @@
 
 namespace silifuzz::proxies {
 
+template <typename arch>
+class MemoryStateImageBuilder;
+
 // MemoryStateImage takes a MemoryState object representing a virtual address
 // space and converts it into a contiguous block of physical memory containing
 // both the memory bytes in the virtual address space and an
@@ -72,13 +78,14 @@ class MemoryStateImage {
       const std::vector<ExternalMapping>& external_mappings = {});
 
  private:
+  friend class MemoryStateImageBuilder<arch>;
+
   // Default constructor is private. Object must be created using Build() since
   // a constructor cannot report errors.
-  MemoryStateImage(uint64_t physical_address,
-                   const std::vector<uint8_t>& image_data,
+  MemoryStateImage(uint64_t physical_address, std::vector<uint8_t> image_data,
                    uint64_t page_table_root)
       : physical_address_(physical_address),
-        image_data_(image_data),
+        image_data_(std::move(image_data)),
         page_table_root_(page_table_root) {}
   MemoryStateImage() = default;
 
@@ -101,6 +108,108 @@ class MemoryStateImage {
   uint64_t page_table_root_;
 };
 
+// MemoryStateImageBuilder builds images of many memory states that share a
+// fixed set of virtual address regions, e.g. the code and data ranges of a
+// FuzzingConfig. Upper levels of the page table only depend on the regions and
+// are laid out once by Create(). Building an image of a memory state copies
+// this skeleton, then fills in the last level tables and the data pages in a
+// single pass over the memory state.
+//
+// The image layout is the skeleton (starting with the page table root), the
+// last level tables for the memory state and then the memory state contents.
+// Translations are the same as those of MemoryStateImage::Build(), but upper
+// level table descriptors grant the permissions of the enclosing regions rather
+// than those of the mappings behind them.
+//
+// This class is thread-compatible. Const methods may be called concurrently.
+template <typename arch>
+class MemoryStateImageBuilder {
+ public:
+  using ExternalMapping = typename MemoryStateImage<arch>::ExternalMapping;
+
+  ~MemoryStateImageBuilder() = default;
+
+  // Copyable and moveable
+  MemoryStateImageBuilder(const MemoryStateImageBuilder&) = default;
+  MemoryStateImageBuilder& operator=(const MemoryStateImageBuilder&) = default;
+  MemoryStateImageBuilder(MemoryStateImageBuilder&&) = default;
+  MemoryStateImageBuilder& operator=(MemoryStateImageBuilder&&) = default;
+
+  // Creates a builder for images loaded at 'physical_address'. Memory states
+  // passed to the builder may only map memory inside 'regions' and with a
+  // subset of the permissions of the enclosing region. 'external_mappings' are
+  // included in every image as in MemoryStateImage::Build(). Returns a builder
+  // or an error.
+  static absl::StatusOr<MemoryStateImageBuilder> Create(
+      const std::vector<MemoryMapping>& regions, uint64_t physical_address,
+      const std::vector<ExternalMapping>& external_mappings = {});
+
+  // Returns the size in bytes of the image of 'memory_state' or an error if
+  // the builder cannot handle 'memory_state'.
+  absl::StatusOr<size_t> ImageSize(const MemoryState& memory_state) const;
+
+  // Builds the image of 'memory_state' into 'buffer', which holds
+  // 'buffer_size' bytes and must be aligned to 8 bytes. The image occupies the
+  // first ImageSize() bytes of 'buffer'. 'buffer' does not need to be cleared
+  // and can be reused across calls. Returns an error if 'buffer' is too small
+  // or the builder cannot handle 'memory_state'.
+  absl::Status BuildInto(const MemoryState& memory_state, void* buffer,
+                         size_t buffer_size) const;
+
+  // Same as above but returns a new MemoryStateImage.
+  absl::StatusOr<MemoryStateImage<arch>> Build(
+      const MemoryState& memory_state) const;
+
+  // Returns the size in bytes of the page table skeleton at the start of every
+  // image.
+  size_t skeleton_size() const { return entries_.size() * sizeof(uint64_t); }
+
+ private:
+  // Number of page table levels.
+  static constexpr size_t kNumLevels = 4;
+
+  // Per-memory state layout computed by ImageSize().
+  struct Layout {
+    // Number of last level tables not present in the skeleton.
+    size_t num_leaf_tables;
+
+    // Number of bytes of memory contents.
+    size_t num_data_bytes;
+  };
+
+  MemoryStateImageBuilder(const std::vector<MemoryMapping>& regions,
+                          uint64_t physical_address)
+      : regions_(regions), physical_address_(physical_address) {}
+
+  // Returns the index in entries_ of the table at 'level' covering
+  // 'virtual_address', adding an empty table if needed.
+  size_t AddTable(size_t level, uint64_t virtual_address);
+
+  // Links tables from the root down to the table at 'level' covering
+  // 'virtual_address' with 'writeable' and 'executable' table descriptors.
+  void LinkTables(size_t level, uint64_t virtual_address, bool writeable,
+                  bool executable);
+
+  // Returns the layout of 'memory_state' or an error.
+  absl::StatusOr<Layout> GetLayout(const MemoryState& memory_state) const;
+
+  // Page table skeleton. Every 512 entries form a table. The root table comes
+  // first.
+  std::vector<uint64_t> entries_;
+
+  // Tables of the skeleton at each level.
+  // Key: virtual address shifted right by the number of bits covered by a
+  // table at that level.
+  // Value: Index into entries_ of the table.
+  absl::flat_hash_map<uint64_t, size_t> tables_[kNumLevels];
+
+  // Virtual address regions, see Create().
+  std::vector<MemoryMapping> regions_;
+
+  // Physical address to load images.
+  uint64_t physical_address_;
+};
+
 }  // namespace silifuzz::proxies
 
 #endif  // THIRD_PARTY_SILIFUZZ_PROXIES_PAGE_TABLE_MEMORY_STATE_IMAGE_H_
@@ -0,0 +1,118 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the per-input cost of building memory state images for the code and
+// data regions of the default fuzzing configs.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "./common/memory_mapping.h"
+#include "./common/memory_perms.h"
+#include "./common/memory_state.h"
+#include "./common/proxy_config.h"
+#include "./common/snapshot.h"
+#include "./proxies/page_table/memory_state_image.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+
+namespace silifuzz::proxies {
+namespace {
+
+constexpr uint64_t kPageSize = 0x1000;
+
+// Arbitrary page-aligned load address. Images are never loaded.
+constexpr uint64_t kPhysicalAddress = 0x4000'0000;
+
+MemoryMapping RegionOf(const MemoryRange& range, MemoryPerms perms) {
+  return MemoryMapping::MakeSized(range.start_address, range.num_bytes, perms);
+}
+
+std::vector<MemoryMapping> Regions(const FuzzingConfig<X86_64>& config) {
+  return {
+      RegionOf(config.code_range, MemoryPerms::XR()),
+      RegionOf(config.data1_range, MemoryPerms::RW()),
+      RegionOf(config.data2_range, MemoryPerms::RW()),
+  };
+}
+
+std::vector<MemoryMapping> Regions(const FuzzingConfig<AArch64>& config) {
+  return {
+      RegionOf(config.code_range, MemoryPerms::XR()),
+      RegionOf(config.stack_range, MemoryPerms::RW()),
+      RegionOf(config.data1_range, MemoryPerms::RW()),
+      RegionOf(config.data2_range, MemoryPerms::RW()),
+  };
+}
+
+// Returns a memory state resembling a fuzzing input: a code page in the
+// middle of the code region and the first 'num_data_pages' pages of every
+// other region.
+MemoryState MakeInput(const std::vector<MemoryMapping>& regions,
+                      size_t num_data_pages) {
+  MemoryState memory_state;
+  for (const MemoryMapping& region : regions) {
+    const bool is_code = region.perms().Has(MemoryPerms::kExecutable);
+    const uint64_t start =
+        is_code ? region.start_address() + region.num_bytes() / 2
+                : region.start_address();
+    const uint64_t num_bytes = std::min<uint64_t>(
+        region.num_bytes(), (is_code ? 1 : num_data_pages) * kPageSize);
+    const MemoryMapping mapping =
+        MemoryMapping::MakeSized(start, num_bytes, region.perms());
+    memory_state.AddNewMemoryMapping(mapping);
+    memory_state.SetMemoryBytes(
+        Snapshot::MemoryBytes(start, Snapshot::ByteData(num_bytes, 0x5a)));
+  }
+  return memory_state;
+}
+
+template <typename Arch>
+void BM_Build(benchmark::State& state) {
+  const MemoryState input =
+      MakeInput(Regions(DEFAULT_FUZZING_CONFIG<Arch>), state.range(0));
+  for (auto s : state) {
+    auto image = MemoryStateImage<Arch>::Build(input, kPhysicalAddress);
+    CHECK_STATUS(image.status());
+    benchmark::DoNotOptimize(image->image_data().data());
+  }
+}
+
+template <typename Arch>
+void BM_BuilderBuildInto(benchmark::State& state) {
+  const std::vector<MemoryMapping> regions =
+      Regions(DEFAULT_FUZZING_CONFIG<Arch>);
+  const MemoryState input = MakeInput(regions, state.range(0));
+  auto builder =
+      MemoryStateImageBuilder<Arch>::Create(regions, kPhysicalAddress);
+  CHECK_STATUS(builder.status());
+  auto image_size = builder->ImageSize(input);
+  CHECK_STATUS(image_size.status());
+  std::vector<uint64_t> buffer(*image_size / sizeof(uint64_t));
+  for (auto s : state) {
+    CHECK_STATUS(builder->BuildInto(input, buffer.data(), *image_size));
+    benchmark::DoNotOptimize(buffer.data());
+  }
+}
+
+BENCHMARK(BM_Build<X86_64>)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_BuilderBuildInto<X86_64>)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_Build<AArch64>)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_BuilderBuildInto<AArch64>)->RangeMultiplier(4)->Range(1, 64);
+
+}  // namespace
+}  // namespace silifuzz::proxies
@@ -28,6 +28,7 @@
 #include "./common/snapshot.h"
 #include "./proxies/page_table/page_table_test_util.h"
 #include "./util/arch.h"
+#include "./util/checks.h"
 #include "./util/testing/status_macros.h"
 
 namespace silifuzz::proxies {
@@ -129,7 +130,153 @@ TYPED_TEST_P(MemoryStateImageTest, BasicTest) {
   EXPECT_FALSE(is_in_range(external_addr.value()));
 }
 
-REGISTER_TYPED_TEST_SUITE_P(MemoryStateImageTest, BasicTest);
+// Allocates page-aligned fake physical memory for builder tests.
+struct FakePhysicalMemory {
+  explicit FakePhysicalMemory(size_t size) : size(size) {
+    CHECK_EQ(posix_memalign(&data, 0x1000, size), 0);
+  }
+  ~FakePhysicalMemory() { free(data); }
+
+  uint64_t address() const { return reinterpret_cast<uintptr_t>(data); }
+
+  void *data;
+  size_t size;
+};
+
+// Checks that 'virtual_addr' translates to a page holding 'contents' inside
+// 'memory' with at least the given permissions.
+template <typename arch>
+void ExpectMapped(const FakePhysicalMemory &memory, uint64_t virtual_addr,
+                  bool writeable, bool executable,
+                  const Snapshot::ByteData &contents) {
+  auto physical_addr = TranslateVirtualAddress<arch>(
+      reinterpret_cast<uint64_t *>(memory.address()), virtual_addr, writeable,
+      executable);
+  ASSERT_OK(physical_addr);
+  ASSERT_GE(physical_addr.value(), memory.address());
+  ASSERT_LE(physical_addr.value() + contents.size(),
+            memory.address() + memory.size);
+  EXPECT_EQ(memcmp(reinterpret_cast<void *>(physical_addr.value()),
+                   contents.data(), contents.size()),
+            0);
+}
+
+TYPED_TEST_P(MemoryStateImageTest, Builder) {
+  Snapshot s(Snapshot::ArchitectureTypeToEnum<TypeParam>());
+  const Snapshot::ByteSize kPageSize = s.page_size();
+  constexpr Snapshot::Address kCodeRegion = 0x123400000;
+  constexpr Snapshot::Address kDataRegion = 0x567800000;
+  constexpr Snapshot::ByteSize kRegionSize = 0x400000;
+  const std::vector<MemoryMapping> regions = {
+      MemoryMapping::MakeSized(kCodeRegion, kRegionSize, MemoryPerms::XR()),
+      MemoryMapping::MakeSized(kDataRegion, kRegionSize, MemoryPerms::RW()),
+  };
+  constexpr Snapshot::Address kExternalVirtualAddr = 0x222220000;
+  constexpr Snapshot::Address kExternalPhysicalAddr = 0x333330000;
+  std::vector<typename MemoryStateImage<TypeParam>::ExternalMapping>
+      external_mappings{
+          {MemoryMapping::MakeSized(kExternalVirtualAddr, kPageSize,
+                                    MemoryPerms::RW()),
+           kExternalPhysicalAddr},
+      };
+  FakePhysicalMemory memory(16 * kPageSize);
+  ASSERT_OK_AND_ASSIGN(MemoryStateImageBuilder<TypeParam> builder,
+                       MemoryStateImageBuilder<TypeParam>::Create(
+                           regions, memory.address(), external_mappings));
+
+  // Two code pages straddling a last level table boundary and one data page.
+  const Snapshot::Address code_addr = kCodeRegion + 0x200000 - kPageSize;
+  const Snapshot::Address data_addr = kDataRegion + 3 * kPageSize;
+  MemoryState memory_state;
+  memory_state.AddNewMemoryMapping(
+      MemoryMapping::MakeSized(code_addr, 2 * kPageSize, MemoryPerms::XR()));
+  Snapshot::ByteData code_bytes = "code";
+  code_bytes.resize(2 * kPageSize, 'c');
+  memory_state.SetMemoryBytes(Snapshot::MemoryBytes{code_addr, code_bytes});
+  memory_state.AddNewMemoryMapping(
+      MemoryMapping::MakeSized(data_addr, kPageSize, MemoryPerms::RW()));
+  Snapshot::ByteData data_bytes = "data";
+  data_bytes.resize(kPageSize);
+  memory_state.SetMemoryBytes(Snapshot::MemoryBytes{data_addr, data_bytes});
+
+  // Built into a dirty buffer.
+  memset(memory.data, 0xa5, memory.size);
+  ASSERT_OK_AND_ASSIGN(size_t image_size, builder.ImageSize(memory_state));
+  ASSERT_LE(image_size, memory.size);
+  ASSERT_OK(builder.BuildInto(memory_state, memory.data, memory.size));
+  ExpectMapped<TypeParam>(memory, code_addr, /*writeable=*/false,
+                          /*executable=*/true, code_bytes);
+  ExpectMapped<TypeParam>(memory, data_addr, /*writeable=*/true,
+                          /*executable=*/false, data_bytes);
+  auto external_addr = TranslateVirtualAddress<TypeParam>(
+      reinterpret_cast<uint64_t *>(memory.address()), kExternalVirtualAddr,
+      /*writeable=*/true, /*executable=*/false);
+  ASSERT_OK(external_addr);
+  EXPECT_EQ(external_addr.value(), kExternalPhysicalAddr);
+
+  // The image matches the translations of MemoryStateImage::Build().
+  ASSERT_OK_AND_ASSIGN(MemoryStateImage<TypeParam> image,
+                       builder.Build(memory_state));
+  EXPECT_EQ(image.image_data().size(), image_size);
+  EXPECT_EQ(image.page_table_root(), memory.address());
+  EXPECT_EQ(memcmp(image.image_data().data(), memory.data, image_size), 0);
+
+  // Reusing the buffer for another memory state leaves no stale mappings.
+  MemoryState other_memory_state;
+  other_memory_state.AddNewMemoryMapping(
+      MemoryMapping::MakeSized(data_addr, kPageSize, MemoryPerms::R()));
+  other_memory_state.SetMemoryBytes(
+      Snapshot::MemoryBytes{data_addr, data_bytes});
+  ASSERT_OK(builder.BuildInto(other_memory_state, memory.data, memory.size));
+  ExpectMapped<TypeParam>(memory, data_addr, /*writeable=*/false,
+                          /*executable=*/false, data_bytes);
+  EXPECT_FALSE(TranslateVirtualAddress<TypeParam>(
+                   reinterpret_cast<uint64_t *>(memory.address()), code_addr,
+                   /*writeable=*/false, /*executable=*/false)
+                   .ok());
+  EXPECT_FALSE(TranslateVirtualAddress<TypeParam>(
+                   reinterpret_cast<uint64_t *>(memory.address()), data_addr,
+                   /*writeable=*/true, /*executable=*/false)
+                   .ok());
+}
+
+TYPED_TEST_P(MemoryStateImageTest, BuilderRejectsMappingsOutsideRegions) {
+  Snapshot s(Snapshot::ArchitectureTypeToEnum<TypeParam>());
+  const Snapshot::ByteSize kPageSize = s.page_size();
+  constexpr Snapshot::Address kCodeRegion = 0x123400000;
+  const std::vector<MemoryMapping> regions = {
+      MemoryMapping::MakeSized(kCodeRegion, 16 * kPageSize, MemoryPerms::XR()),
+  };
+  FakePhysicalMemory memory(8 * kPageSize);
+  ASSERT_OK_AND_ASSIGN(
+      MemoryStateImageBuilder<TypeParam> builder,
+      MemoryStateImageBuilder<TypeParam>::Create(regions, memory.address()));
+
+  MemoryState outside;
+  outside.AddNewMemoryMapping(MemoryMapping::MakeSized(
+      kCodeRegion + 15 * kPageSize, 2 * kPageSize, MemoryPerms::XR()));
+  outside.ZeroMappedMemoryBytes(MemoryMapping::MakeSized(
+      kCodeRegion + 15 * kPageSize, 2 * kPageSize, MemoryPerms::XR()));
+  EXPECT_FALSE(builder.ImageSize(outside).ok());
+
+  MemoryState writable;
+  writable.AddNewMemoryMapping(
+      MemoryMapping::MakeSized(kCodeRegion, kPageSize, MemoryPerms::RW()));
+  writable.ZeroMappedMemoryBytes(
+      MemoryMapping::MakeSized(kCodeRegion, kPageSize, MemoryPerms::RW()));
+  EXPECT_FALSE(builder.ImageSize(writable).ok());
+
+  MemoryState inside;
+  inside.AddNewMemoryMapping(
+      MemoryMapping::MakeSized(kCodeRegion, 4 * kPageSize, MemoryPerms::XR()));
+  inside.ZeroMappedMemoryBytes(
+      MemoryMapping::MakeSized(kCodeRegion, 4 * kPageSize, MemoryPerms::XR()));
+  EXPECT_FALSE(builder.BuildInto(inside, memory.data, kPageSize).ok());
+  EXPECT_OK(builder.BuildInto(inside, memory.data, memory.size));
+}
+
+REGISTER_TYPED_TEST_SUITE_P(MemoryStateImageTest, BasicTest, Builder,
+                            BuilderRejectsMappingsOutsideRegions);
 
 INSTANTIATE_TYPED_TEST_SUITE_P(AArch64MemoryStateImageTest,
                                MemoryStateImageTest, AArch64);
@@ -18,13 +18,10 @@
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "./common/proxy_config.h"
-#include "./instruction/default_disassembler.h"
-#include "./proxies/arch_feature_generator.h"
+#include "./proxies/unicorn_proxy.h"
 #include "./proxies/user_features.h"
-#include "./tracing/unicorn_tracer.h"
 #include "./util/arch.h"
 #include "./util/checks.h"
-#include "./util/ucontext/ucontext_types.h"
 
 namespace silifuzz {
 
@@ -45,111 +42,11 @@ USER_FEATURE_ARRAY static user_feature_t features[100000];
 // report, etc.
 // In general, we should try to do work per-batch rather than per-input when it
 // is possible.
-class BatchState {
- public:
-  BatchState() { feature_gen.BeforeBatch(disasm.NumInstructionIDs()); }
-
-  DefaultDisassembler<AArch64> disasm;
-  ArchFeatureGenerator<AArch64> feature_gen;
-};
-
-BatchState *batch;
+UnicornProxy<AArch64> *proxy;
 
 void BeforeBatch() {
-  CHECK_EQ(batch, nullptr);
-  batch = new BatchState();
-}
-
-absl::Status RunAArch64Instructions(
-    absl::string_view instructions,
-    const FuzzingConfig<AArch64> &fuzzing_config, size_t max_inst_executed) {
-  // Require at least one instruction.
-  if (instructions.size() < 4) {
-    return absl::InvalidArgumentError("Input too short");
-  }
-
-  // Details to sort out later:
-  // TODO(ncbray) why do atomic ops using the initial stack pointer not fault?
-  // 1000000: 787f63fc ldumaxlh    wzr, w28, [sp]
-
-  DefaultDisassembler<AArch64> &disasm = batch->disasm;
-  ArchFeatureGenerator<AArch64> &feature_gen = batch->feature_gen;
-
-  UnicornTracerConfig<AArch64> tracer_config{.force_a72 = true};
-  UnicornTracer<AArch64> tracer;
-  RETURN_IF_NOT_OK(
-      tracer.InitSnippet(instructions, tracer_config, fuzzing_config));
-
-  feature_gen.BeforeInput(features);
-
-  UContext<AArch64> registers;
-  tracer.GetRegisters(registers);
-  feature_gen.BeforeExecution(registers);
-
-  // Unicorn generates callbacks before the instruction executes and not after.
-  // We need to do a little extra work to synthesize a callback after every
-  // instruction.
-  uint32_t instruction_id = kInvalidInstructionId;
-  bool instruction_pending = false;
-
-  auto after_instruction = [&]() {
-    if (instruction_pending) {
-      tracer.GetRegisters(registers);
-      feature_gen.AfterInstruction(instruction_id, registers);
-      instruction_pending = false;
-    }
-  };
-
-  tracer.SetInstructionCallback(
-      [&](UnicornTracer<AArch64> *tracer, uint64_t address, size_t max_size) {
-        after_instruction();
-
-        // Read the next instruction.
-        uint8_t insn[4];
-        CHECK_LE(max_size, sizeof(insn));
-        tracer->ReadMemory(address, insn, max_size);
-
-        // Decompile the next instruction.
-        if (disasm.Disassemble(address, insn, max_size)) {
-          instruction_id = disasm.InstructionID();
-          CHECK_LT(instruction_id, disasm.NumInstructionIDs());
-        } else {
-          instruction_id = kInvalidInstructionId;
-        }
-
-        instruction_pending = true;
-      });
-
-  // Stop at an arbitrary instruction count to avoid infinite loops.
-  absl::Status status = tracer.Run(max_inst_executed);
-
-  // Flush the last instruction.
-  after_instruction();
-
-  feature_gen.AfterExecution();
-
-  // Emit features for memory bits that are different from the initial state.
-  // The initial state is zero, so we can skip the diff.
-  // (The inital stack state is not entirely zero, but close enough.)
-  constexpr size_t kMemBytesPerChunk = 4096;
-  uint8_t mem[kMemBytesPerChunk];
-
-  // Stack
-  tracer.ReadMemory(fuzzing_config.stack_range.start_address, mem,
-                    kMemBytesPerChunk);
-  feature_gen.FinalMemory(mem);
-
-  // Data 1
-  tracer.ReadMemory(fuzzing_config.data1_range.start_address, mem,
-                    kMemBytesPerChunk);
-  feature_gen.FinalMemory(mem);
-
-  // Data 2
-  tracer.ReadMemory(fuzzing_config.data2_range.start_address, mem,
-                    kMemBytesPerChunk);
-  feature_gen.FinalMemory(mem);
-
-  return status;
+  CHECK_EQ(proxy, nullptr);
+  proxy = new UnicornProxy<AArch64>();
 }
 
 }  // namespace
@@ -162,10 +59,11 @@ extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) {
 }
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
-  const size_t max_inst_executed = 0x1000;
-  absl::Status status = silifuzz::RunAArch64Instructions(
+  absl::Status status = silifuzz::proxy->Run(
       absl::string_view(reinterpret_cast<const char *>(data), size),
-      silifuzz::DEFAULT_FUZZING_CONFIG<silifuzz::AArch64>, max_inst_executed);
+      silifuzz::DEFAULT_FUZZING_CONFIG<silifuzz::AArch64>,
+      silifuzz::kUnicornProxyMaxInstExecuted<silifuzz::AArch64>,
+      silifuzz::features);
   if (!status.ok()) {
     LOG_ERROR(status.message());
     return -1;
@@ -0,0 +1,107 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_PROXIES_UNICORN_PROXY_H_
+#define THIRD_PARTY_SILIFUZZ_PROXIES_UNICORN_PROXY_H_
+
+#include <cstddef>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "./common/proxy_config.h"
+#include "./instruction/decode_cache.h"
+#include "./instruction/default_disassembler.h"
+#include "./proxies/arch_feature_generator.h"
+#include "./proxies/user_features.h"
+#include "./util/arch.h"
+
+namespace silifuzz {
+
+// Number of instructions the Centipede proxies execute per input before
+// giving up on it.
+template <typename Arch>
+inline constexpr size_t kUnicornProxyMaxInstExecuted = 0;
+template <>
+inline constexpr size_t kUnicornProxyMaxInstExecuted<X86_64> = 1000;
+template <>
+inline constexpr size_t kUnicornProxyMaxInstExecuted<AArch64> = 0x1000;
+
+// Knobs of UnicornProxy that do not change the features it emits.
+struct UnicornProxyOptions {
+  // Keep a shadow copy of the register file in the tracer. Only affects
+  // x86-64, see UnicornTracerConfig<X86_64>::shadow_registers.
+  bool shadow_registers = true;
+};
+
+// UnicornProxy runs an instruction snippet in Unicorn and turns the trace into
+// user features with ArchFeatureGenerator. This is the body of the Centipede
+// proxies; it is a separate library so that offline tools can compute exactly
+// the features the fuzzer sees.
+//
+// Per-batch setup happens in the c-tor, so one instance should be reused for
+// many inputs.
+//
+// This class is thread-compatible.
+template <typename Arch>
+class UnicornProxy {
+ public:
+  explicit UnicornProxy(const UnicornProxyOptions &options = {})
+      : options_(options) {
+    feature_gen_.BeforeBatch(disasm_.NumInstructionIDs());
+  }
+
+  // Not copyable or moveable -- ArchFeatureGenerator is neither.
+  UnicornProxy(const UnicornProxy &) = delete;
+  UnicornProxy(UnicornProxy &&) = delete;
+  UnicornProxy &operator=(const UnicornProxy &) = delete;
+  UnicornProxy &operator=(UnicornProxy &&) = delete;
+
+  // Executes at most `max_inst_executed` instructions of `instructions` in
+  // the environment described by `fuzzing_config` and emits user features
+  // into `features`. Features may be emitted even if the returned status is
+  // not ok.
+  template <size_t N>
+  absl::Status Run(absl::string_view instructions,
+                   const FuzzingConfig<Arch> &fuzzing_config,
+                   size_t max_inst_executed, user_feature_t (&features)[N]) {
+    feature_gen_.BeforeInput(features);
+    return RunInput(instructions, fuzzing_config, max_inst_executed);
+  }
+
+ private:
+  // Arch-specific part of Run(). Defined in unicorn_proxy_<arch>.cc.
+  absl::Status RunInput(absl::string_view instructions,
+                        const FuzzingConfig<Arch> &fuzzing_config,
+                        size_t max_inst_executed);
+
+  const UnicornProxyOptions options_;
+  DefaultDisassembler<Arch> disasm_;
+  // Inputs tend to loop, so most instructions are decoded many times.
+  DecodeCache<DefaultDisassembler<Arch>> decode_cache_{disasm_};
+  ArchFeatureGenerator<Arch> feature_gen_;
+};
+
+template <>
+absl::Status UnicornProxy<X86_64>::RunInput(
+    absl::string_view instructions, const FuzzingConfig<X86_64> &fuzzing_config,
+    size_t max_inst_executed);
+
+template <>
+absl::Status UnicornProxy<AArch64>::RunInput(
+    absl::string_view instructions,
+    const FuzzingConfig<AArch64> &fuzzing_config, size_t max_inst_executed);
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_PROXIES_UNICORN_PROXY_H_
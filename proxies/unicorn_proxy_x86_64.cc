@@ -0,0 +1,131 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "./common/proxy_config.h"
+#include "./instruction/decode_cache.h"
+#include "./proxies/arch_feature_generator.h"
+#include "./proxies/unicorn_proxy.h"
+#include "./tracing/unicorn_tracer.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/ucontext/ucontext_types.h"
+
+namespace silifuzz {
+
+template <>
+absl::Status UnicornProxy<X86_64>::RunInput(
+    absl::string_view instructions, const FuzzingConfig<X86_64> &fuzzing_config,
+    size_t max_inst_executed) {
+  // Addresses are reused across inputs.
+  decode_cache_.Clear();
+
+  UnicornTracerConfig<X86_64> tracer_config{
+      .shadow_registers = options_.shadow_registers};
+  UnicornTracer<X86_64> tracer;
+  RETURN_IF_NOT_OK(
+      tracer.InitSnippet(instructions, tracer_config, fuzzing_config));
+
+  UContext<X86_64> registers;
+  tracer.GetRegisters(registers);
+  feature_gen_.BeforeExecution(registers);
+
+  // Unicorn generates callbacks before the instruction executes and not after.
+  // We need to do a little extra work to synthesize a callback after every
+  // instruction.
+  uint32_t instruction_id = kInvalidInstructionId;
+  bool instruction_pending = false;
+
+  auto after_instruction = [&]() {
+    if (instruction_pending) {
+      tracer.GetRegisters(registers);
+      feature_gen_.AfterInstruction(instruction_id, registers);
+      instruction_pending = false;
+    }
+  };
+
+  bool instructions_are_in_range = true;
+
+  tracer.SetInstructionCallback(
+      [&](UnicornTracer<X86_64> *tracer, uint64_t address, size_t max_size) {
+        after_instruction();
+
+        // Read the next instruction.
+        // 16 bytes should hold any x86-64 instruction. The actual limit should
+        // be 15 bytes, but keep things as nice powers of two.
+        uint8_t insn[16];
+
+        // Sometimes Unicorn will invoke this function with an invalid max_size
+        // when it has absolutely no idea what the instruction does. (AVX512 for
+        // example.) It appears to be some sort of error code gone wrong?
+        max_size = std::min(max_size, sizeof(insn));
+
+        tracer->ReadMemory(address, insn, max_size);
+
+        // Decompile the next instruction.
+        const DecodedInstructionInfo &info =
+            decode_cache_.Decode(address, insn, max_size);
+        if (info.valid) {
+          instruction_id = info.id;
+          // If an instruction doesn't entirely lie within the code snippet,
+          // we're likely executing an incomplete instruction that includes
+          // bytes immediately after the snippet. We try to filter out this
+          // case because it can make the snippet hard to disassemble.
+          instructions_are_in_range &=
+              tracer->InstructionIsInRange(address, info.size);
+        } else {
+          instruction_id = kInvalidInstructionId;
+        }
+
+        instruction_pending = true;
+      });
+
+  // Stop at an arbitrary instruction count to avoid infinite loops.
+  absl::Status status = tracer.Run(max_inst_executed);
+
+  // Flush the last instruction.
+  after_instruction();
+
+  feature_gen_.AfterExecution();
+
+  // Emit features for memory bits that are different from the initial state.
+  // The initial state is zero, so we can skip the diff.
+  // (The inital stack state is not entirely zero, but close enough.)
+  constexpr size_t kMemBytesPerChunk = 8192;
+  uint8_t mem[kMemBytesPerChunk];
+
+  // Data 1
+  tracer.ReadMemory(fuzzing_config.data1_range.start_address, mem,
+                    kMemBytesPerChunk);
+  feature_gen_.FinalMemory(mem);
+
+  // Data 2
+  tracer.ReadMemory(fuzzing_config.data2_range.start_address, mem,
+                    kMemBytesPerChunk);
+  feature_gen_.FinalMemory(mem);
+
+  if (!instructions_are_in_range) {
+    return absl::OutOfRangeError(
+        "Instructions are not entirely contained in code.");
+  }
+
+  return status;
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,86 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the per-input cost of the x86-64 Unicorn proxy on a fixed corpus of
+// snippets, with and without the tracer's register shadow.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/string_view.h"
+#include "./common/proxy_config.h"
+#include "./proxies/unicorn_proxy.h"
+#include "./proxies/user_features.h"
+#include "./util/arch.h"
+
+namespace silifuzz {
+namespace {
+
+user_feature_t features[100000];
+
+// Snippets from unicorn_x86_64_test.cc that the proxy accepts, plus a few
+// that touch vector and x87 state. Loops dominate real corpora, so most of the
+// executed instructions come from the loops here too.
+std::vector<std::string> Corpus() {
+  return {
+      // nop
+      "\x90",
+      // xor rcx, rcx
+      // mov cl, 10
+      // loop .
+      std::string("\x48\x31\xC9\xB1\x0A\xE2\xFE", 7),
+      // mov rcx, 0x5
+      // movabs rsi, 0x1000010000
+      // loop: mov rax, QWORD PTR [rsi]
+      //       add rsi, 0x1000
+      //       loop loop
+      std::string("\x48\xC7\xC1\x05\x00\x00\x00\x48\xBE\x00\x00\x01\x00\x10"
+                  "\x00\x00\x00\x48\x8B\x06\x48\x81\xC6\x00\x10\x00\x00\xE2"
+                  "\xF4",
+                  29),
+      // mov ecx, 100
+      // loop: paddq xmm0, xmm1
+      //       pxor xmm2, xmm0
+      //       loop loop
+      std::string("\xB9\x64\x00\x00\x00\x66\x0F\xD4\xC1\x66\x0F\xEF\xD0\xE2"
+                  "\xF6",
+                  15),
+      // mov ecx, 100
+      // fld1
+      // loop: fadd st(0), st(0)
+      //       loop loop
+      std::string("\xB9\x64\x00\x00\x00\xD9\xE8\xD8\xC0\xE2\xFC", 11),
+  };
+}
+
+void BM_RunCorpus(benchmark::State& state) {
+  const std::vector<std::string> corpus = Corpus();
+  UnicornProxy<X86_64> proxy({.shadow_registers = state.range(0) != 0});
+  for (auto s : state) {
+    for (const std::string& input : corpus) {
+      benchmark::DoNotOptimize(
+          proxy.Run(input, DEFAULT_FUZZING_CONFIG<X86_64>,
+                    kUnicornProxyMaxInstExecuted<X86_64>, features));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+
+BENCHMARK(BM_RunCorpus)->ArgName("shadow_registers")->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace silifuzz
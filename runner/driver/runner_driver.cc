@@ -26,8 +26,10 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -133,9 +135,14 @@ absl::StatusOr<RunnerDriver::RunResult> RunnerDriver::RunImpl(
   if (runner_options.map_stderr_to_dev_null()) {
     options.MapStderr(Subprocess::kMapToDevNull);
   }
+  if (runner_options.cgroup_procs_fd() != -1) {
+    options.SetCgroupProcsFd(runner_options.cgroup_procs_fd());
+  }
 
   Subprocess runner_proc(options);
-  RETURN_IF_NOT_OK(runner_proc.Start(argv));
+  if (absl::Status status = runner_proc.Start(argv); !status.ok()) {
+    return absl::UnavailableError(status.message());
+  }
 
   std::unique_ptr<HarnessTracer> tracer = nullptr;
   if (trace_cb.has_value()) {
@@ -174,14 +181,42 @@ absl::StatusOr<RunnerDriver::RunResult> RunnerDriver::HandleRunnerOutput(
       // The process died with SIGSYS because an unexpected syscall was made.
       return absl::InternalError("Snapshot made a syscall");
     }
+    if (sig_num == SIGKILL || sig_num == SIGXCPU) {
+      // The kernel sends these when the runner exceeds the RLIMIT_CPU budget
+      // set in RunImpl(). SIGKILL may also come from the OOM killer or the
+      // job manager. Neither is specific to the snapshot.
+      return absl::UnavailableError(
+          absl::StrCat("Runner killed by signal ", sig_num));
+    }
     return absl::InternalError(
         absl::StrCat("Runner killed by signal ", sig_num));
   }
   if (WIFEXITED(info.status)) {
+    // The runner reports quarantined snaps on stdout regardless of how the
+    // run ends. A runner that ends successfully prints nothing else.
+    google::protobuf::TextFormat::Parser parser;
+    proto::SnapshotExecutionResult exec_result_proto;
+    const bool parsed =
+        parser.ParseFromString(runner_stdout, &exec_result_proto);
+    std::vector<std::string> quarantined_snapshot_ids(
+        exec_result_proto.quarantined_snapshot_ids().begin(),
+        exec_result_proto.quarantined_snapshot_ids().end());
+    if (!snapshot_id.empty() &&
+        absl::c_linear_search(quarantined_snapshot_ids, snapshot_id)) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Snapshot [", snapshot_id,
+                       "] conflicts with the runner's memory mappings"));
+    }
+    auto successful = [&info, &quarantined_snapshot_ids] {
+      RunResult result = RunResult::Successful(info.rusage);
+      result.set_quarantined_snapshot_ids(std::move(quarantined_snapshot_ids));
+      return result;
+    };
+
     // Successful execution
     ExitCode exit_code = static_cast<ExitCode>(WEXITSTATUS(info.status));
     if (exit_code == ExitCode::kSuccess) {
-      return RunResult::Successful(info.rusage);
+      return successful();
     }
     // Graceful shutdown due to timeout. Convert this to success with the
     // caveat that this can hide runners that are not making progress.
@@ -193,11 +228,9 @@ absl::StatusOr<RunnerDriver::RunResult> RunnerDriver::HandleRunnerOutput(
     // was made.
     if (exit_code == ExitCode::kTimeout && snapshot_id.empty()) {
       VLOG_INFO(1, "Runner process timed out");
-      return RunResult::Successful(info.rusage);
+      return successful();
     }
-    google::protobuf::TextFormat::Parser parser;
-    proto::SnapshotExecutionResult exec_result_proto;
-    if (!parser.ParseFromString(runner_stdout, &exec_result_proto)) {
+    if (!parsed) {
       return absl::InternalError(
           absl::StrCat("couldn't parse [", runner_stdout,
                        "] as proto::SnapshotExecutionResult. Exit status = ",
@@ -218,8 +251,10 @@ absl::StatusOr<RunnerDriver::RunResult> RunnerDriver::HandleRunnerOutput(
       return absl::InternalError(
           absl::StrCat(exec_result_proto, " has no actual_end_state"));
     }
-    return RunResult(*player_result_or, info.rusage,
+    RunResult result(*player_result_or, info.rusage,
                      exec_result_proto.snapshot_id());
+    result.set_quarantined_snapshot_ids(std::move(quarantined_snapshot_ids));
+    return result;
   }
   return absl::InternalError(
       absl::StrCat("Unknown runner exit status ", info.status));
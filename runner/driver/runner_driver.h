@@ -23,6 +23,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -50,8 +51,16 @@ class RunnerDriver {
   // Represents result of the runner binary invocation. Contains a success bit
   // and an optional PlayerResult representing the result of Snap playback.
   //
+  // Snapshots whose memory conflicts with the runner's are reported via
+  // quarantined_snapshot_ids() rather than as a failure.
+  //
+  // Failures of the environment the runner runs in (the runner could not be
+  // started, or was killed by SIGKILL or SIGXCPU) are reported as
+  // kUnavailable. Other runner failures, e.g. a crash, are reported as
+  // kInternal since they are likely caused by the snapshot.
+  //
   // TODO(ksteuck): [as-needed] Finer-grained error codes needed to handle
-  // conditions like "unmappable memory page" or "memory page conflict".
+  // conditions like "unmappable memory page".
   // TODO(ksteuck): [as-needed] While the runner provides a way to tell if
   // an unexpected syscall was made, this class does not model that state and
   // relies on higher-level StatusOr to capture the fact. If finer-grained
@@ -102,6 +111,16 @@ class RunnerDriver {
     // Information about the resource usage of the run.
     const struct rusage& rusage() const { return rusage_; }
 
+    // IDs of the snapshots the runner quarantined, i.e. skipped because their
+    // memory mappings conflict with those of the runner. Quarantined
+    // snapshots were never executed and do not affect success().
+    const std::vector<std::string>& quarantined_snapshot_ids() const {
+      return quarantined_snapshot_ids_;
+    }
+    void set_quarantined_snapshot_ids(std::vector<std::string> ids) {
+      quarantined_snapshot_ids_ = std::move(ids);
+    }
+
    private:
     // Constructs a new RunResult with the given success status and no
     // associated `player_result`.
@@ -118,6 +137,9 @@ class RunnerDriver {
     std::string snapshot_id_;
 
     struct rusage rusage_;
+
+    // Snapshots quarantined by the runner (if any).
+    std::vector<std::string> quarantined_snapshot_ids_;
   };
 
   // Creates a RunnerDriver for a binary with baked-in corpus.
@@ -14,16 +14,20 @@
 
 #include "./runner/driver/runner_driver.h"
 
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/user.h>
 
+#include <csignal>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <string>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "./common/harness_tracer.h"
 #include "./common/proxy_config.h"
 #include "./common/snapshot.h"
@@ -32,7 +36,9 @@
 #include "./runner/runner_provider.h"
 #include "./snap/testing/snap_test_snapshots.h"
 #include "./util/arch.h"
+#include "./util/checks.h"
 #include "./util/data_dependency.h"
+#include "./util/file_util.h"
 #include "./util/itoa.h"
 #include "./util/path_util.h"
 #include "./util/testing/status_macros.h"
@@ -64,6 +70,42 @@ TEST(RunnerDriver, BasicRun) {
               StatusIs(absl::StatusCode::kInternal, HasSubstr("syscall")));
 }
 
+// Returns the path of a fake runner that kills itself with `sig_num`.
+std::string SelfKillingRunner(int sig_num) {
+  std::string path =
+      absl::StrCat(::testing::TempDir(), "/self_killing_runner_", sig_num);
+  CHECK(SetContents(path, absl::StrCat("#!/bin/sh\nkill -", sig_num, " $$\n")));
+  CHECK_EQ(chmod(path.c_str(), 0700), 0);
+  return path;
+}
+
+TEST(RunnerDriver, EnvironmentFailureIsUnavailable) {
+  for (int sig_num : {SIGKILL, SIGXCPU}) {
+    RunnerDriver driver = RunnerDriver::ReadingRunner(
+        SelfKillingRunner(sig_num),
+        GetDataDependencyFilepath("snap/testing/test_corpus"));
+    EXPECT_THAT(driver.PlayOne(EnumStr(TestSnapshot::kEndsAsExpected)),
+                StatusIs(absl::StatusCode::kUnavailable,
+                         HasSubstr("killed by signal")));
+  }
+}
+
+TEST(RunnerDriver, RunnerCrashIsInternal) {
+  RunnerDriver driver = RunnerDriver::ReadingRunner(
+      SelfKillingRunner(SIGSEGV),
+      GetDataDependencyFilepath("snap/testing/test_corpus"));
+  EXPECT_THAT(driver.PlayOne(EnumStr(TestSnapshot::kEndsAsExpected)),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("killed by signal")));
+
+  // /bin/false exits with an error without reporting the snapshot.
+  driver = RunnerDriver::ReadingRunner(
+      "/bin/false", GetDataDependencyFilepath("snap/testing/test_corpus"));
+  EXPECT_THAT(
+      driver.PlayOne(EnumStr(TestSnapshot::kEndsAsExpected)),
+      StatusIs(absl::StatusCode::kInternal, HasSubstr("Runner misbehaved")));
+}
+
 TEST(RunnerDriver, BasicMake) {
   RunnerDriver driver = HelperDriver();
   auto make_result_or = driver.MakeOne(EnumStr(TestSnapshot::kSigSegvRead));
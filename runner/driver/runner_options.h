@@ -65,6 +65,11 @@ class RunnerOptions {
     return *this;
   }
 
+  RunnerOptions& set_cgroup_procs_fd(int cgroup_procs_fd) {
+    this->cgroup_procs_fd_ = cgroup_procs_fd;
+    return *this;
+  }
+
   int cpu() const { return cpu_; }
   absl::Duration cpu_time_budget() const { return cpu_time_budget_; }
   absl::Duration wall_time_budget() const { return wall_time_budget_; }
@@ -73,6 +78,7 @@ class RunnerOptions {
   bool disable_aslr() const { return disable_aslr_; }
   bool sequential_mode() const { return sequential_mode_; }
   bool map_stderr_to_dev_null() const { return map_stderr_to_dev_null_; }
+  int cgroup_procs_fd() const { return cgroup_procs_fd_; }
 
   RunnerOptions(const RunnerOptions&) = default;
   RunnerOptions(RunnerOptions&&) = default;
@@ -124,6 +130,10 @@ class RunnerOptions {
 
   // If true, map runner's stderr to /dev/null.
   bool map_stderr_to_dev_null_ = false;
+
+  // If not -1, an FD of the cgroup.procs file the runner joins before exec.
+  // Not owned.
+  int cgroup_procs_fd_ = -1;
 };
 
 }  // namespace silifuzz
@@ -51,6 +51,8 @@ absl::StatusOr<Snapshot> MakeSnapshot(const Snapshot& snapshot,
   opts.max_pages_to_add = making_config.max_pages_to_add;
   opts.num_verify_attempts = making_config.num_verify_attempts;
   opts.cpu = making_config.cpu;
+  opts.verify_cpus = making_config.verify_cpus;
+  opts.verify_parallelism = making_config.verify_parallelism;
   opts.enforce_fuzzing_config = making_config.enforce_fuzzing_config;
   SnapMaker maker(opts);
 
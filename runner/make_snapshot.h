@@ -16,6 +16,7 @@
 #define THIRD_PARTY_SILIFUZZ_RUNNER_MAKE_SNAPSHOT_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -47,6 +48,16 @@ struct MakingConfig {
   // known good CPU.
   int cpu = kAnyCPUId;
 
+  // If non-empty, determinism is verified by playing the snapshot on each of
+  // these CPUs concurrently instead of repeatedly on `cpu`. A snapshot that
+  // reaches different end states on different CPUs is rejected.
+  // SelectVerifyCpus() from snap_maker.h picks CPUs on distinct cores.
+  std::vector<int> verify_cpus;
+
+  // Maximum number of concurrent runners used to verify on `verify_cpus`.
+  // 0 means one runner per CPU.
+  int verify_parallelism = 0;
+
   // If true, enforce fuzzing config. Snapshots with non-conforming
   // mappings are rejected.
   bool enforce_fuzzing_config = true;
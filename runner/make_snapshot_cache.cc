@@ -0,0 +1,406 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./runner/make_snapshot_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <openssl/sha.h>  // IWYU pragma: keep
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "./common/proxy_config.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_file_util.h"
+#include "./common/snapshot_proto.h"
+#include "./instruction/static_insn_filter.h"
+#include "./proto/snapshot.pb.h"
+#include "./runner/make_snapshot.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/file_util.h"
+#include "./util/itoa.h"
+#include "./util/platform.h"
+#include "./util/tool_util.h"
+
+namespace silifuzz {
+
+namespace {
+
+constexpr absl::string_view kSnapshotSuffix = ".snap";
+constexpr absl::string_view kStatusSuffix = ".status";
+
+// Bumped whenever the entry format or key derivation changes.
+constexpr absl::string_view kKeyVersion = "silifuzz-make-cache-v3";
+
+std::string Sha256Hex(absl::string_view data) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+  return absl::BytesToHexString(absl::string_view(
+      reinterpret_cast<const char*>(digest), sizeof(digest)));
+}
+
+std::string MemoryRangeCacheKey(const MemoryRange& range) {
+  return absl::StrCat(HexStr(range.start_address), "+",
+                      HexStr(range.num_bytes));
+}
+
+// As in MakingConfigCacheKey(), structured bindings make adding a filter knob
+// without updating the key a compile error.
+std::string CacheKeyOf(const InstructionFilterConfig<X86_64>& config) {
+  const auto& [non_deterministic_instructions_allowed,
+               avx512_instructions_allowed, amx_instructions_allowed,
+               memory_operands_allowed] = config;
+  return absl::StrCat(
+      ";non_deterministic=", non_deterministic_instructions_allowed,
+      ";avx512=", avx512_instructions_allowed,
+      ";amx=", amx_instructions_allowed,
+      ";memory_operands=", memory_operands_allowed);
+}
+
+std::string CacheKeyOf(const InstructionFilterConfig<AArch64>& config) {
+  const auto& [sve_instructions_allowed, load_store_instructions_allowed] =
+      config;
+  return absl::StrCat(";sve=", sve_instructions_allowed,
+                      ";load_store=", load_store_instructions_allowed);
+}
+
+std::string CacheKeyOf(const FuzzingConfig<X86_64>& config) {
+  return absl::StrCat("code=", MemoryRangeCacheKey(config.code_range),
+                      ";data1=", MemoryRangeCacheKey(config.data1_range),
+                      ";data2=", MemoryRangeCacheKey(config.data2_range),
+                      CacheKeyOf(config.instruction_filter));
+}
+
+std::string CacheKeyOf(const FuzzingConfig<AArch64>& config) {
+  return absl::StrCat("code=", MemoryRangeCacheKey(config.code_range),
+                      ";stack=", MemoryRangeCacheKey(config.stack_range),
+                      ";data1=", MemoryRangeCacheKey(config.data1_range),
+                      ";data2=", MemoryRangeCacheKey(config.data2_range),
+                      CacheKeyOf(config.instruction_filter));
+}
+
+// A cache entry found while scanning the cache directory.
+struct DirEntry {
+  std::string path;
+  uint64_t size;
+  struct timespec mtime;
+};
+
+// Lists cache entries in `directory`. Temporary files are skipped.
+std::vector<DirEntry> ScanEntries(const std::string& directory) {
+  std::vector<DirEntry> entries;
+  DIR* dir = opendir(directory.c_str());
+  if (dir == nullptr) {
+    LOG_ERROR("Cannot open ", directory, ": ", ErrnoStr(errno));
+    return entries;
+  }
+  while (struct dirent* de = readdir(dir)) {
+    if (de->d_name[0] == '.') continue;
+    std::string path = absl::StrCat(directory, "/", de->d_name);
+    struct stat st;
+    // The entry may have been evicted by another process in the meantime.
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+    entries.push_back({std::move(path), static_cast<uint64_t>(st.st_size),
+                       st.st_mtim});
+  }
+  closedir(dir);
+  return entries;
+}
+
+// Marks `path` as recently used.
+void Touch(const std::string& path) {
+  utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+}
+
+}  // namespace
+
+bool IsTransientMakingError(const absl::Status& status) {
+  switch (status.code()) {
+    case absl::StatusCode::kUnknown:
+    case absl::StatusCode::kCancelled:
+    case absl::StatusCode::kDeadlineExceeded:
+    case absl::StatusCode::kResourceExhausted:
+    case absl::StatusCode::kAborted:
+    case absl::StatusCode::kUnavailable:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string MakingConfigCacheKey(const MakingConfig& config) {
+  // Structured bindings fail to compile when a field is added to
+  // TraceOptions or PlayOptions, which forces a decision on whether the new
+  // field belongs in the key.
+  const auto& [play_options, instruction_count_limit,
+               expensive_instruction_count_limit, x86_filter_split_lock,
+               filter_non_deterministic_insn, x86_filter_vsyscall_region_access,
+               filter_memory_access] = config.trace;
+  // `preferred_cpu_id` only pins the making runner.
+  [[maybe_unused]] const auto& [run_time_budget, cpu_usage_baseline,
+                                preferred_cpu_id] = play_options;
+  return absl::StrCat(
+      "max_pages_to_add=", config.max_pages_to_add,
+      ";num_verify_attempts=", config.num_verify_attempts,
+      ";verify_cpus=", absl::StrJoin(config.verify_cpus, ","),
+      ";verify_parallelism=", config.verify_parallelism,
+      ";enforce_fuzzing_config=", config.enforce_fuzzing_config,
+      ";run_time_budget_ns=", absl::ToInt64Nanoseconds(run_time_budget),
+      ";cpu_usage_baseline_ns=", absl::ToInt64Nanoseconds(cpu_usage_baseline),
+      ";instruction_count_limit=", instruction_count_limit,
+      ";expensive_instruction_count_limit=", expensive_instruction_count_limit,
+      ";x86_filter_split_lock=", x86_filter_split_lock,
+      ";filter_non_deterministic_insn=", filter_non_deterministic_insn,
+      ";x86_filter_vsyscall_region_access=", x86_filter_vsyscall_region_access,
+      ";filter_memory_access=", filter_memory_access);
+}
+
+std::string FuzzingConfigCacheKey(const FuzzingConfig<Host>& config) {
+  return CacheKeyOf(config);
+}
+
+absl::StatusOr<std::unique_ptr<SnapshotMakingCache>>
+SnapshotMakingCache::Create(const Options& options,
+                            absl::string_view runner_path) {
+  if (options.directory.empty()) {
+    return absl::InvalidArgumentError("directory must be non-empty");
+  }
+  if (options.max_bytes == 0) {
+    return absl::InvalidArgumentError("max_bytes must be positive");
+  }
+  if (mkdir(options.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    return absl::InternalError(absl::StrCat(
+        "Cannot create ", options.directory, ": ", ErrnoStr(errno)));
+  }
+  // The runner binary is hashed as a whole rather than trusting an ELF
+  // build-id note, which is absent in some build configurations.
+  ASSIGN_OR_RETURN_IF_NOT_OK(std::string runner, GetFileContents(runner_path));
+  uint64_t initial_bytes = 0;
+  for (const DirEntry& entry : ScanEntries(options.directory)) {
+    initial_bytes += entry.size;
+  }
+  // Cannot use std::make_unique() with a private c-tor.
+  return std::unique_ptr<SnapshotMakingCache>(
+      new SnapshotMakingCache(options, Sha256Hex(runner), initial_bytes));
+}
+
+SnapshotMakingCache::SnapshotMakingCache(const Options& options,
+                                         std::string runner_build_id,
+                                         uint64_t initial_bytes)
+    : options_(options),
+      runner_build_id_(std::move(runner_build_id)),
+      total_bytes_(initial_bytes) {}
+
+std::string SnapshotMakingCache::Key(
+    absl::string_view instructions, const MakingConfig& making_config,
+    const FuzzingConfig<Host>& fuzzing_config) const {
+  const std::string making_key = MakingConfigCacheKey(making_config);
+  const std::string fuzzing_key = FuzzingConfigCacheKey(fuzzing_config);
+  // Length-prefix each field so that no two inputs share a preimage.
+  std::string preimage;
+  for (absl::string_view field :
+       {kKeyVersion, absl::string_view(runner_build_id_),
+        absl::string_view(EnumStr(CurrentPlatformId())),
+        absl::string_view(making_key), absl::string_view(fuzzing_key),
+        instructions}) {
+    absl::StrAppend(&preimage, field.size(), ":");
+    preimage.append(field.data(), field.size());
+  }
+  return Sha256Hex(preimage);
+}
+
+std::string SnapshotMakingCache::SnapshotPath(absl::string_view key) const {
+  return absl::StrCat(options_.directory, "/", key, kSnapshotSuffix);
+}
+
+std::string SnapshotMakingCache::StatusPath(absl::string_view key) const {
+  return absl::StrCat(options_.directory, "/", key, kStatusSuffix);
+}
+
+std::optional<absl::StatusOr<Snapshot>> SnapshotMakingCache::Lookup(
+    absl::string_view key) {
+  std::optional<absl::StatusOr<Snapshot>> result;
+  const std::string snapshot_path = SnapshotPath(key);
+  const std::string status_path = StatusPath(key);
+  if (access(snapshot_path.c_str(), F_OK) == 0) {
+    absl::StatusOr<Snapshot> snapshot = ReadSnapshotFromFile(snapshot_path);
+    if (snapshot.ok()) {
+      Touch(snapshot_path);
+      result = std::move(snapshot);
+    } else {
+      LOG_ERROR("Dropping corrupted cache entry ", snapshot_path, ": ",
+                snapshot.status().message());
+      unlink(snapshot_path.c_str());
+    }
+  } else if (absl::StatusOr<std::string> contents =
+                 GetFileContents(status_path);
+             contents.ok()) {
+    // <numeric status code>\n<message>
+    const size_t newline = contents->find('\n');
+    int code;
+    if (newline != std::string::npos &&
+        absl::SimpleAtoi(absl::string_view(*contents).substr(0, newline),
+                         &code) &&
+        code != static_cast<int>(absl::StatusCode::kOk)) {
+      Touch(status_path);
+      result = absl::Status(static_cast<absl::StatusCode>(code),
+                            contents->substr(newline + 1));
+    } else {
+      LOG_ERROR("Dropping corrupted cache entry ", status_path);
+      unlink(status_path.c_str());
+    }
+  }
+
+  absl::MutexLock l(&mu_);
+  if (result.has_value()) {
+    ++stats_.hits;
+  } else {
+    ++stats_.misses;
+  }
+  return result;
+}
+
+void SnapshotMakingCache::Store(absl::string_view key,
+                                const absl::StatusOr<Snapshot>& result) {
+  if (!result.ok() && IsTransientMakingError(result.status())) return;
+  std::string path;
+  std::string contents;
+  if (result.ok()) {
+    proto::Snapshot proto;
+    SnapshotProto::ToProto(*result, &proto);
+    path = SnapshotPath(key);
+    contents = proto.SerializeAsString();
+  } else {
+    path = StatusPath(key);
+    contents = absl::StrCat(static_cast<int>(result.status().code()), "\n",
+                            result.status().message());
+  }
+  if (absl::Status s = WriteEntry(path, contents); !s.ok()) {
+    LOG_ERROR("Cannot store cache entry: ", s.message());
+    return;
+  }
+  bool needs_eviction;
+  {
+    absl::MutexLock l(&mu_);
+    ++stats_.stores;
+    total_bytes_ += contents.size();
+    needs_eviction = total_bytes_ > options_.max_bytes;
+  }
+  if (needs_eviction) Evict();
+}
+
+absl::StatusOr<Snapshot> SnapshotMakingCache::GetOrMake(
+    absl::string_view key,
+    absl::FunctionRef<absl::StatusOr<Snapshot>()> make) {
+  if (std::optional<absl::StatusOr<Snapshot>> cached = Lookup(key);
+      cached.has_value()) {
+    return *std::move(cached);
+  }
+  absl::StatusOr<Snapshot> result = make();
+  Store(key, result);
+  return result;
+}
+
+absl::StatusOr<Snapshot> SnapshotMakingCache::MakeRawInstructions(
+    absl::string_view instructions, const MakingConfig& making_config,
+    const FuzzingConfig<Host>& fuzzing_config) {
+  return GetOrMake(Key(instructions, making_config, fuzzing_config), [&]() {
+    return silifuzz::MakeRawInstructions(instructions, making_config,
+                                         fuzzing_config);
+  });
+}
+
+SnapshotMakingCache::Stats SnapshotMakingCache::stats() const {
+  absl::MutexLock l(&mu_);
+  return stats_;
+}
+
+absl::Status SnapshotMakingCache::WriteEntry(const std::string& path,
+                                             absl::string_view contents) {
+  // Temporary names start with '.' so that ScanEntries() skips them.
+  static std::atomic<uint64_t> tmp_counter = 0;
+  const std::string tmp_path =
+      absl::StrCat(options_.directory, "/.tmp-", getpid(), "-",
+                   tmp_counter.fetch_add(1, std::memory_order_relaxed));
+  if (!SetContents(tmp_path, contents)) {
+    unlink(tmp_path.c_str());
+    return absl::InternalError(absl::StrCat("Cannot write ", tmp_path));
+  }
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    const int err = errno;
+    unlink(tmp_path.c_str());
+    return absl::InternalError(
+        absl::StrCat("Cannot rename to ", path, ": ", ErrnoStr(err)));
+  }
+  return absl::OkStatus();
+}
+
+void SnapshotMakingCache::Evict() {
+  absl::MutexLock evict_lock(&evict_mu_);
+  // Rescan instead of trusting total_bytes_ so that entries stored or
+  // evicted by other processes are accounted for.
+  std::vector<DirEntry> entries = ScanEntries(options_.directory);
+  uint64_t total_bytes = 0;
+  for (const DirEntry& entry : entries) total_bytes += entry.size;
+
+  // Evict down to 7/8 of the budget so that the next few stores do not
+  // trigger another scan.
+  const uint64_t target_bytes = options_.max_bytes / 8 * 7;
+  uint64_t evictions = 0;
+  if (total_bytes > options_.max_bytes) {
+    std::sort(entries.begin(), entries.end(),
+              [](const DirEntry& a, const DirEntry& b) {
+                if (a.mtime.tv_sec != b.mtime.tv_sec) {
+                  return a.mtime.tv_sec < b.mtime.tv_sec;
+                }
+                return a.mtime.tv_nsec < b.mtime.tv_nsec;
+              });
+    for (const DirEntry& entry : entries) {
+      if (total_bytes <= target_bytes) break;
+      // ENOENT means another process evicted it first.
+      if (unlink(entry.path.c_str()) == 0 || errno == ENOENT) {
+        total_bytes -= entry.size;
+        ++evictions;
+      }
+    }
+  }
+
+  absl::MutexLock l(&mu_);
+  total_bytes_ = total_bytes;
+  stats_.evictions += evictions;
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,153 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_RUNNER_MAKE_SNAPSHOT_CACHE_H_
+#define THIRD_PARTY_SILIFUZZ_RUNNER_MAKE_SNAPSHOT_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "./common/proxy_config.h"
+#include "./common/snapshot.h"
+#include "./runner/make_snapshot.h"
+#include "./util/arch.h"
+
+namespace silifuzz {
+
+// Returns true if `status` describes a failure of the making machinery (e.g.
+// the runner could not be started, was killed or timed out) rather than a
+// rejection of the input. Such results are not reproducible and must not be
+// cached. RunnerDriver reports environment failures of the runner as
+// kUnavailable, and crashes that the snapshot likely caused as kInternal.
+bool IsTransientMakingError(const absl::Status& status);
+
+// Returns a canonical string of the fields of `config` that affect the
+// outcome of MakeSnapshot(). `cpu`, `trace.play_options.preferred_cpu_id` and
+// `runner_path` are left out: the former two only pin the making runner and
+// the latter is covered by the runner build id. `verify_cpus` and
+// `verify_parallelism` are included: which CPUs must agree on the end state,
+// and how many of them run at once, can change the verdict.
+std::string MakingConfigCacheKey(const MakingConfig& config);
+
+// Same for FuzzingConfig<Host>.
+std::string FuzzingConfigCacheKey(const FuzzingConfig<Host>& config);
+
+// SnapshotMakingCache is a persistent, content-addressed store of
+// MakeRawInstructions()-like results. Each entry is either a made Snapshot
+// or the status that rejected the input, keyed by a SHA-256 over the raw
+// instruction bytes, the making and fuzzing configs, the current platform
+// and the runner binary.
+//
+// Entries are single files in `directory` written to a temporary name and
+// renamed into place, so several processes can share one directory. When
+// the total size of entries exceeds `max_bytes` the least recently used
+// entries are removed. Lookups refresh the mtime of the entry they hit.
+//
+// This class is thread-safe.
+class SnapshotMakingCache {
+ public:
+  struct Options {
+    // Directory that holds cache entries. Created if it does not exist.
+    std::string directory;
+
+    // Upper bound on the total size of entries in `directory`.
+    uint64_t max_bytes = uint64_t{1} << 30;
+  };
+
+  // Cache counters since construction. Only covers this process.
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+  };
+
+  // Creates a cache in `options.directory` for results made with the runner
+  // at `runner_path`.
+  static absl::StatusOr<std::unique_ptr<SnapshotMakingCache>> Create(
+      const Options& options, absl::string_view runner_path);
+
+  // Not copyable or moveable -- the counters are shared with workers.
+  SnapshotMakingCache(const SnapshotMakingCache&) = delete;
+  SnapshotMakingCache(SnapshotMakingCache&&) = delete;
+  SnapshotMakingCache& operator=(const SnapshotMakingCache&) = delete;
+  SnapshotMakingCache& operator=(SnapshotMakingCache&&) = delete;
+
+  ~SnapshotMakingCache() = default;
+
+  // Returns the key for making `instructions` with the given configs.
+  std::string Key(absl::string_view instructions,
+                  const MakingConfig& making_config,
+                  const FuzzingConfig<Host>& fuzzing_config) const;
+
+  // Returns the cached result for `key` or std::nullopt on a miss.
+  std::optional<absl::StatusOr<Snapshot>> Lookup(absl::string_view key);
+
+  // Stores `result` under `key` unless it is a transient error.
+  void Store(absl::string_view key, const absl::StatusOr<Snapshot>& result);
+
+  // Returns the cached result for `key`, calling `make` and storing its
+  // result on a miss.
+  absl::StatusOr<Snapshot> GetOrMake(
+      absl::string_view key, absl::FunctionRef<absl::StatusOr<Snapshot>()> make);
+
+  // Cached version of MakeRawInstructions().
+  absl::StatusOr<Snapshot> MakeRawInstructions(
+      absl::string_view instructions, const MakingConfig& making_config,
+      const FuzzingConfig<Host>& fuzzing_config = DEFAULT_FUZZING_CONFIG<Host>);
+
+  Stats stats() const;
+
+ private:
+  SnapshotMakingCache(const Options& options, std::string runner_build_id,
+                      uint64_t initial_bytes);
+
+  // Returns the path of the entry for `key` holding a snapshot or a status.
+  std::string SnapshotPath(absl::string_view key) const;
+  std::string StatusPath(absl::string_view key) const;
+
+  // Atomically replaces `path` with `contents`.
+  absl::Status WriteEntry(const std::string& path, absl::string_view contents);
+
+  // Removes least recently used entries until the directory fits in
+  // `max_bytes` with some slack.
+  void Evict() ABSL_LOCKS_EXCLUDED(evict_mu_);
+
+  const Options options_;
+
+  // Hash of the runner binary.
+  const std::string runner_build_id_;
+
+  mutable absl::Mutex mu_;
+  Stats stats_ ABSL_GUARDED_BY(mu_);
+
+  // Estimated size of all entries. Stores by other processes are only seen
+  // at the next Evict().
+  uint64_t total_bytes_ ABSL_GUARDED_BY(mu_);
+
+  // Serializes eviction scans.
+  absl::Mutex evict_mu_;
+};
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_RUNNER_MAKE_SNAPSHOT_CACHE_H_
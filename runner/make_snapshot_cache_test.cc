@@ -0,0 +1,273 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./runner/make_snapshot_cache.h"
+
+#include <dirent.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "./common/proxy_config.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
+#include "./common/snapshot_test_util.h"
+#include "./instruction/static_insn_filter.h"
+#include "./runner/make_snapshot.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/file_util.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+
+// Returns a fresh directory for the current test.
+std::string TestDir() {
+  return absl::StrCat(
+      ::testing::TempDir(), "/",
+      ::testing::UnitTest::GetInstance()->current_test_info()->name());
+}
+
+// Writes a fake runner binary with `contents` and returns its path.
+std::string FakeRunner(const std::string& contents) {
+  const std::string path = absl::StrCat(TestDir(), ".runner");
+  CHECK(SetContents(path, contents));
+  return path;
+}
+
+std::unique_ptr<SnapshotMakingCache> CreateCache(
+    uint64_t max_bytes = uint64_t{1} << 20,
+    const std::string& runner = "runner") {
+  auto cache = SnapshotMakingCache::Create(
+      {.directory = TestDir(), .max_bytes = max_bytes}, FakeRunner(runner));
+  CHECK_STATUS(cache.status());
+  return *std::move(cache);
+}
+
+// Counts entries in the cache directory, including temporary files.
+int NumFiles(const std::string& directory) {
+  int n = 0;
+  DIR* dir = opendir(directory.c_str());
+  CHECK(dir != nullptr);
+  while (struct dirent* de = readdir(dir)) {
+    if (de->d_name[0] != '.' || de->d_name[1] == 't') ++n;
+  }
+  closedir(dir);
+  return n;
+}
+
+TEST(SnapshotMakingCache, Key) {
+  auto cache = CreateCache();
+  MakingConfig config = MakingConfig::Quick();
+  const std::string key =
+      cache->Key("abc", config, DEFAULT_FUZZING_CONFIG<Host>);
+  EXPECT_EQ(key.size(), 64);
+  EXPECT_EQ(key, cache->Key("abc", config, DEFAULT_FUZZING_CONFIG<Host>));
+  EXPECT_NE(key, cache->Key("abd", config, DEFAULT_FUZZING_CONFIG<Host>));
+  FuzzingConfig<Host> fuzzing_config = DEFAULT_FUZZING_CONFIG<Host>;
+  fuzzing_config.data1_range.num_bytes /= 2;
+  EXPECT_NE(key, cache->Key("abc", config, fuzzing_config));
+
+  // The CPU of the making runner does not matter.
+  MakingConfig pinned = config;
+  pinned.cpu = 3;
+  pinned.trace.play_options.preferred_cpu_id = 3;
+  EXPECT_EQ(key, cache->Key("abc", pinned, DEFAULT_FUZZING_CONFIG<Host>));
+
+  // Cross-CPU verification does.
+  MakingConfig cross_cpu = config;
+  cross_cpu.verify_cpus = {1, 2};
+  const std::string cross_cpu_key =
+      cache->Key("abc", cross_cpu, DEFAULT_FUZZING_CONFIG<Host>);
+  EXPECT_NE(key, cross_cpu_key);
+  cross_cpu.verify_parallelism = 1;
+  EXPECT_NE(cross_cpu_key,
+            cache->Key("abc", cross_cpu, DEFAULT_FUZZING_CONFIG<Host>));
+
+  MakingConfig stricter = config;
+  stricter.trace.filter_memory_access = !config.trace.filter_memory_access;
+  EXPECT_NE(key, cache->Key("abc", stricter, DEFAULT_FUZZING_CONFIG<Host>));
+  MakingConfig more_attempts = config;
+  ++more_attempts.num_verify_attempts;
+  EXPECT_NE(key,
+            cache->Key("abc", more_attempts, DEFAULT_FUZZING_CONFIG<Host>));
+
+  // A different runner binary invalidates everything.
+  auto other_cache = CreateCache(uint64_t{1} << 20, "other runner");
+  EXPECT_NE(key,
+            other_cache->Key("abc", config, DEFAULT_FUZZING_CONFIG<Host>));
+}
+
+// Returns pointers to all knobs of InstructionFilterConfig<Arch>.
+template <typename Arch>
+std::vector<bool InstructionFilterConfig<Arch>::*> InstructionFilterKnobs();
+
+template <>
+std::vector<bool InstructionFilterConfig<X86_64>::*>
+InstructionFilterKnobs<X86_64>() {
+  using Config = InstructionFilterConfig<X86_64>;
+  return {&Config::non_deterministic_instructions_allowed,
+          &Config::avx512_instructions_allowed,
+          &Config::amx_instructions_allowed, &Config::memory_operands_allowed};
+}
+
+template <>
+std::vector<bool InstructionFilterConfig<AArch64>::*>
+InstructionFilterKnobs<AArch64>() {
+  using Config = InstructionFilterConfig<AArch64>;
+  return {&Config::sve_instructions_allowed,
+          &Config::load_store_instructions_allowed};
+}
+
+TEST(SnapshotMakingCache, InstructionFilterKey) {
+  std::set<std::string> keys = {
+      FuzzingConfigCacheKey(DEFAULT_FUZZING_CONFIG<Host>)};
+  for (bool InstructionFilterConfig<Host>::*knob :
+       InstructionFilterKnobs<Host>()) {
+    FuzzingConfig<Host> config = DEFAULT_FUZZING_CONFIG<Host>;
+    config.instruction_filter.*knob = !(config.instruction_filter.*knob);
+    EXPECT_TRUE(keys.insert(FuzzingConfigCacheKey(config)).second);
+  }
+}
+
+TEST(SnapshotMakingCache, StoreAndLookup) {
+  auto cache = CreateCache();
+  const Snapshot snapshot =
+      CreateTestSnapshot<Host>(TestSnapshot::kEndsAsExpected);
+  EXPECT_FALSE(cache->Lookup("snap").has_value());
+  cache->Store("snap", snapshot.Copy());
+  std::optional<absl::StatusOr<Snapshot>> cached = cache->Lookup("snap");
+  ASSERT_TRUE(cached.has_value());
+  ASSERT_OK(*cached);
+  EXPECT_EQ(**cached, snapshot);
+
+  cache->Store("rejected", absl::InternalError("Memory access not allowed"));
+  cached = cache->Lookup("rejected");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_THAT(*cached, StatusIs(absl::StatusCode::kInternal,
+                                "Memory access not allowed"));
+
+  // Transient errors are not cached.
+  cache->Store("transient",
+               absl::UnavailableError("Runner killed by signal 9"));
+  EXPECT_FALSE(cache->Lookup("transient").has_value());
+  EXPECT_TRUE(IsTransientMakingError(
+      absl::UnavailableError("Runner killed by signal 9")));
+  EXPECT_FALSE(IsTransientMakingError(
+      absl::InternalError("Snapshot made a syscall")));
+  EXPECT_FALSE(IsTransientMakingError(
+      absl::InternalError("Runner killed by signal 11")));
+
+  SnapshotMakingCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.stores, 2);
+
+  // Entries survive the cache object.
+  cache.reset();
+  auto reopened = CreateCache();
+  EXPECT_TRUE(reopened->Lookup("snap").has_value());
+}
+
+TEST(SnapshotMakingCache, GetOrMake) {
+  auto cache = CreateCache();
+  int calls = 0;
+  auto make = [&calls]() -> absl::StatusOr<Snapshot> {
+    ++calls;
+    return absl::InternalError("rejected");
+  };
+  EXPECT_THAT(cache->GetOrMake("key", make),
+              StatusIs(absl::StatusCode::kInternal, "rejected"));
+  EXPECT_THAT(cache->GetOrMake("key", make),
+              StatusIs(absl::StatusCode::kInternal, "rejected"));
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(SnapshotMakingCache, CorruptedEntry) {
+  auto cache = CreateCache();
+  ASSERT_TRUE(SetContents(absl::StrCat(TestDir(), "/bad.snap"), "garbage"));
+  ASSERT_TRUE(SetContents(absl::StrCat(TestDir(), "/bad2.status"), "x"));
+  EXPECT_FALSE(cache->Lookup("bad").has_value());
+  EXPECT_FALSE(cache->Lookup("bad2").has_value());
+  EXPECT_EQ(NumFiles(TestDir()), 0);
+}
+
+TEST(SnapshotMakingCache, Evicts) {
+  const std::string message(100, 'x');
+  auto cache = CreateCache(/*max_bytes=*/1000);
+  for (int i = 0; i < 20; ++i) {
+    cache->Store(absl::StrCat("key", i), absl::InternalError(message));
+  }
+  SnapshotMakingCache::Stats stats = cache->stats();
+  EXPECT_EQ(stats.stores, 20);
+  EXPECT_GT(stats.evictions, 0);
+  EXPECT_LE(NumFiles(TestDir()), 10);
+}
+
+TEST(SnapshotMakingCache, Concurrent) {
+  auto cache = CreateCache();
+  const Snapshot snapshot =
+      CreateTestSnapshot<Host>(TestSnapshot::kEndsAsExpected);
+  std::atomic<int> calls = 0;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 10; ++i) {
+        absl::StatusOr<Snapshot> result =
+            cache->GetOrMake(absl::StrCat("key", i), [&]() {
+              ++calls;
+              return snapshot.Copy();
+            });
+        ASSERT_OK(result);
+        EXPECT_EQ(*result, snapshot);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  // Racing misses may make the same key twice but every key is made.
+  EXPECT_GE(calls, 10);
+  EXPECT_EQ(cache->stats().hits + cache->stats().misses, 80);
+  // No temporary files are left behind.
+  EXPECT_EQ(NumFiles(TestDir()), 10);
+}
+
+TEST(SnapshotMakingCache, InvalidOptions) {
+  EXPECT_THAT(SnapshotMakingCache::Create({}, FakeRunner("runner")).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(
+      SnapshotMakingCache::Create({.directory = TestDir(), .max_bytes = 0},
+                                  FakeRunner("runner"))
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_FALSE(
+      SnapshotMakingCache::Create({.directory = TestDir()}, "/does/not/exist")
+          .ok());
+}
+
+}  // namespace
+}  // namespace silifuzz
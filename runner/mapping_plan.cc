@@ -0,0 +1,158 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./runner/mapping_plan.h"
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./util/checks.h"
+
+namespace silifuzz {
+
+namespace {
+
+void Swap(MappingPlanEntry& a, MappingPlanEntry& b) {
+  MappingPlanEntry tmp = a;
+  a = b;
+  b = tmp;
+}
+
+// In-place heap sort. We cannot use std::sort() as it may need memmove(),
+// which nolibc does not provide. 'less' is a strict weak ordering.
+template <typename Less>
+void HeapSort(MappingPlanEntry* entries, size_t num_entries, Less less) {
+  auto sift_down = [&](size_t root, size_t size) {
+    while (true) {
+      size_t largest = root;
+      const size_t left = 2 * root + 1;
+      const size_t right = left + 1;
+      if (left < size && less(entries[largest], entries[left])) {
+        largest = left;
+      }
+      if (right < size && less(entries[largest], entries[right])) {
+        largest = right;
+      }
+      if (largest == root) return;
+      Swap(entries[root], entries[largest]);
+      root = largest;
+    }
+  };
+  for (size_t i = num_entries / 2; i > 0; --i) {
+    sift_down(i - 1, num_entries);
+  }
+  for (size_t size = num_entries; size > 1; --size) {
+    Swap(entries[0], entries[size - 1]);
+    sift_down(0, size - 1);
+  }
+}
+
+bool ByAddress(const MappingPlanEntry& a, const MappingPlanEntry& b) {
+  if (a.start_address != b.start_address) {
+    return a.start_address < b.start_address;
+  }
+  return a.order < b.order;
+}
+
+bool ByOrder(const MappingPlanEntry& a, const MappingPlanEntry& b) {
+  return a.order < b.order;
+}
+
+// Returns true if all entries of the group describe the same writable range
+// with the same protection. The most common case is snaps sharing a stack
+// location. Whether the entries are direct mapped does not matter: the initial
+// contents of writable mappings are overwritten before every snap runs.
+bool AllIdenticalWritable(const MappingPlanEntry* entries, size_t num_entries) {
+  const MappingPlanEntry& first = entries[0];
+  for (size_t i = 0; i < num_entries; ++i) {
+    const MappingPlanEntry& e = entries[i];
+    if ((e.perms & PROT_WRITE) == 0 ||
+        e.start_address != first.start_address ||
+        e.limit_address != first.limit_address || e.perms != first.perms) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void BuildMappingPlan(MappingPlanEntry* entries, size_t num_entries) {
+  HeapSort(entries, num_entries, ByAddress);
+
+  // Split the entries into groups of transitively overlapping entries.
+  size_t begin = 0;
+  while (begin < num_entries) {
+    CHECK_LT(entries[begin].start_address, entries[begin].limit_address);
+    uint64_t group_limit = entries[begin].limit_address;
+    size_t end = begin + 1;
+    while (end < num_entries && entries[end].start_address < group_limit) {
+      if (entries[end].limit_address > group_limit) {
+        group_limit = entries[end].limit_address;
+      }
+      ++end;
+    }
+
+    const size_t group_size = end - begin;
+    if (group_size == 1) {
+      entries[begin].action = MappingPlanAction::kCoalesce;
+    } else if (AllIdenticalWritable(&entries[begin], group_size)) {
+      entries[begin].action = MappingPlanAction::kCoalesce;
+      for (size_t i = begin + 1; i < end; ++i) {
+        entries[i].action = MappingPlanAction::kSkip;
+      }
+    } else {
+      for (size_t i = begin; i < end; ++i) {
+        entries[i].action = MappingPlanAction::kIndividual;
+      }
+      HeapSort(&entries[begin], group_size, ByOrder);
+    }
+    begin = end;
+  }
+}
+
+size_t MappingRunEnd(const MappingPlanEntry* entries, size_t num_entries,
+                     size_t begin) {
+  CHECK_LT(begin, num_entries);
+  const MappingPlanEntry& first = entries[begin];
+  if (first.action != MappingPlanAction::kCoalesce) {
+    return begin + 1;
+  }
+  const MappingPlanEntry* last = &first;
+  size_t end = begin + 1;
+  for (; end < num_entries; ++end) {
+    const MappingPlanEntry& e = entries[end];
+    if (e.action == MappingPlanAction::kSkip) continue;
+    if (e.action != MappingPlanAction::kCoalesce ||
+        e.start_address != last->limit_address ||
+        e.direct_mapped() != first.direct_mapped()) {
+      break;
+    }
+    // A file mapping has a single protection and must be contiguous in the
+    // file as well.
+    if (first.direct_mapped() &&
+        (e.perms != first.perms ||
+         e.file_offset != last->file_offset + static_cast<int64_t>(
+                                                  last->limit_address -
+                                                  last->start_address))) {
+      break;
+    }
+    last = &e;
+  }
+  return end;
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,94 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_RUNNER_MAPPING_PLAN_H_
+#define THIRD_PARTY_SILIFUZZ_RUNNER_MAPPING_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./snap/snap.h"
+
+namespace silifuzz {
+
+// A mapping plan coalesces the memory mappings of all snaps in a corpus so
+// that MapCorpus() can create them with as few mmap() and mprotect() calls as
+// possible.
+//
+// Creating snap mappings one at a time costs an mmap(), a copy and often an
+// mprotect() for every SnapMemoryMapping. Most mappings in a shard are
+// adjacent to another mapping of the same kind, so a run of them can share
+// one mmap() and one mprotect() per distinct protection.
+
+// How BuildMappingPlan() decided to create a mapping.
+enum class MappingPlanAction : uint8_t {
+  // Created as part of a run of adjacent mappings. See MappingRunEnd().
+  kCoalesce = 0,
+
+  // Identical to the preceding writable mapping. Nothing to do: contents of
+  // writable mappings are only set up right before a snap runs.
+  kSkip,
+
+  // Overlaps another mapping in a way that cannot be merged. Created on its
+  // own. BuildMappingPlan() orders these in corpus order so that mappings
+  // created later win, just like when mapping snaps one by one.
+  kIndividual,
+};
+
+// Offset value for a mapping that is not mapped from the corpus file.
+inline constexpr int64_t kNotDirectMapped = -1;
+
+struct MappingPlanEntry {
+  uint64_t start_address;
+  uint64_t limit_address;
+  int perms;
+
+  // Offset of the mapping contents in the corpus file or kNotDirectMapped if
+  // the mapping is anonymous and its contents are copied in.
+  int64_t file_offset;
+
+  // Position of the mapping in corpus order.
+  uint32_t order;
+
+  // Set by BuildMappingPlan().
+  MappingPlanAction action;
+
+  // The mapping this entry was made from. Not used by the planner.
+  const SnapMemoryMapping* mapping;
+
+  bool direct_mapped() const { return file_offset != kNotDirectMapped; }
+};
+
+// Sorts 'entries[0..num_entries)' by address and sets the action of each
+// entry. Each group of overlapping kIndividual entries is sorted by 'order'
+// instead.
+//
+// This function works without libc and does not allocate.
+void BuildMappingPlan(MappingPlanEntry* entries, size_t num_entries);
+
+// Returns the end of the run that starts at 'begin' in a plan built by
+// BuildMappingPlan().
+//
+// A run of kCoalesce entries covers one contiguous address range and is
+// either anonymous, possibly with mixed protections, or mapped from a
+// contiguous range of the corpus file with a single protection. kSkip entries
+// inside a run belong to it. A kIndividual entry is a run of its own.
+//
+// REQUIRES: begin < num_entries.
+size_t MappingRunEnd(const MappingPlanEntry* entries, size_t num_entries,
+                     size_t begin);
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_RUNNER_MAPPING_PLAN_H_
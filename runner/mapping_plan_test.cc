@@ -0,0 +1,162 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./runner/mapping_plan.h"
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./util/checks.h"
+#include "./util/nolibc_gunit.h"
+
+namespace silifuzz {
+namespace {
+
+constexpr uint64_t kPage = 0x1000;
+
+MappingPlanEntry Entry(uint64_t start_page, uint64_t num_pages, int perms,
+                       uint32_t order,
+                       int64_t file_offset = kNotDirectMapped) {
+  return MappingPlanEntry{
+      .start_address = start_page * kPage,
+      .limit_address = (start_page + num_pages) * kPage,
+      .perms = perms,
+      .file_offset = file_offset,
+      .order = order,
+      .action = MappingPlanAction::kIndividual,
+      .mapping = nullptr,
+  };
+}
+
+TEST(MappingPlan, CoalescesAdjacentAnonymousMappings) {
+  MappingPlanEntry entries[] = {
+      Entry(12, 1, PROT_READ, 0),
+      Entry(10, 1, PROT_READ | PROT_EXEC, 1),
+      Entry(11, 1, PROT_READ | PROT_WRITE, 2),
+      Entry(20, 2, PROT_READ, 3),
+  };
+  BuildMappingPlan(entries, 4);
+  for (size_t i = 0; i < 4; ++i) {
+    CHECK(entries[i].action == MappingPlanAction::kCoalesce);
+    if (i > 0) {
+      CHECK_LT(entries[i - 1].start_address, entries[i].start_address);
+    }
+  }
+  // Pages 10-12 share a run despite different protections. Page 20 is not
+  // adjacent.
+  CHECK_EQ(MappingRunEnd(entries, 4, 0), 3);
+  CHECK_EQ(MappingRunEnd(entries, 4, 3), 4);
+}
+
+TEST(MappingPlan, SkipsIdenticalWritableMappings) {
+  MappingPlanEntry entries[] = {
+      Entry(10, 4, PROT_READ | PROT_WRITE, 0),
+      Entry(14, 1, PROT_READ, 1),
+      Entry(10, 4, PROT_READ | PROT_WRITE, 2),
+      Entry(10, 4, PROT_READ | PROT_WRITE, 3),
+  };
+  BuildMappingPlan(entries, 4);
+  CHECK(entries[0].action == MappingPlanAction::kCoalesce);
+  CHECK_EQ(entries[0].order, 0);
+  CHECK(entries[1].action == MappingPlanAction::kSkip);
+  CHECK(entries[2].action == MappingPlanAction::kSkip);
+  CHECK(entries[3].action == MappingPlanAction::kCoalesce);
+  CHECK_EQ(MappingRunEnd(entries, 4, 0), 4);
+}
+
+TEST(MappingPlan, OverlappingMappingsAreIndividual) {
+  MappingPlanEntry entries[] = {
+      Entry(11, 2, PROT_READ, 0),
+      Entry(10, 2, PROT_READ, 1),
+      Entry(9, 1, PROT_READ, 2),
+      Entry(12, 4, PROT_READ | PROT_WRITE, 3),
+      Entry(16, 1, PROT_READ | PROT_WRITE, 4),
+  };
+  BuildMappingPlan(entries, 5);
+  CHECK(entries[0].action == MappingPlanAction::kCoalesce);
+  CHECK_EQ(entries[0].order, 2);
+  // The overlapping group keeps corpus order.
+  constexpr uint32_t kExpectedOrder[] = {0, 1, 3};
+  for (size_t i = 1; i < 4; ++i) {
+    CHECK(entries[i].action == MappingPlanAction::kIndividual);
+    CHECK_EQ(entries[i].order, kExpectedOrder[i - 1]);
+    CHECK_EQ(MappingRunEnd(entries, 5, i), i + 1);
+  }
+  CHECK(entries[4].action == MappingPlanAction::kCoalesce);
+  CHECK_EQ(MappingRunEnd(entries, 5, 0), 1);
+}
+
+TEST(MappingPlan, DirectMappedRuns) {
+  MappingPlanEntry entries[] = {
+      Entry(10, 1, PROT_READ, 0, 0),
+      Entry(11, 2, PROT_READ, 1, kPage),
+      // Not contiguous in the file.
+      Entry(13, 1, PROT_READ, 2, 5 * kPage),
+      // Different protection.
+      Entry(14, 1, PROT_READ | PROT_EXEC, 3, 6 * kPage),
+      // Anonymous.
+      Entry(15, 1, PROT_READ | PROT_EXEC, 4),
+  };
+  BuildMappingPlan(entries, 5);
+  CHECK_EQ(MappingRunEnd(entries, 5, 0), 2);
+  CHECK_EQ(MappingRunEnd(entries, 5, 2), 3);
+  CHECK_EQ(MappingRunEnd(entries, 5, 3), 4);
+  CHECK_EQ(MappingRunEnd(entries, 5, 4), 5);
+}
+
+TEST(MappingPlan, SkipsIdenticalDirectMappedWritableMappings) {
+  MappingPlanEntry entries[] = {
+      Entry(10, 2, PROT_READ | PROT_WRITE, 0, 4 * kPage),
+      Entry(10, 2, PROT_READ | PROT_WRITE, 1),
+      Entry(10, 2, PROT_READ | PROT_WRITE, 2, 8 * kPage),
+      Entry(12, 1, PROT_READ | PROT_WRITE, 3, 6 * kPage),
+  };
+  BuildMappingPlan(entries, 4);
+  CHECK(entries[0].action == MappingPlanAction::kCoalesce);
+  CHECK_EQ(entries[0].order, 0);
+  CHECK(entries[1].action == MappingPlanAction::kSkip);
+  CHECK(entries[2].action == MappingPlanAction::kSkip);
+  CHECK(entries[3].action == MappingPlanAction::kCoalesce);
+  // The kept entry is contiguous in the file with the next one.
+  CHECK_EQ(MappingRunEnd(entries, 4, 0), 4);
+}
+
+TEST(MappingPlan, ManyEntries) {
+  constexpr size_t kNumEntries = 1000;
+  static MappingPlanEntry entries[kNumEntries];
+  // Insert in a scrambled order.
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    const uint64_t page = (i * 379) % kNumEntries;
+    entries[i] = Entry(page, 1, PROT_READ, i);
+  }
+  BuildMappingPlan(entries, kNumEntries);
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    CHECK_EQ(entries[i].start_address, i * kPage);
+  }
+  CHECK_EQ(MappingRunEnd(entries, kNumEntries, 0), kNumEntries);
+}
+
+}  // namespace
+}  // namespace silifuzz
+
+NOLIBC_TEST_MAIN({
+  RUN_TEST(MappingPlan, CoalescesAdjacentAnonymousMappings);
+  RUN_TEST(MappingPlan, SkipsIdenticalWritableMappings);
+  RUN_TEST(MappingPlan, OverlappingMappingsAreIndividual);
+  RUN_TEST(MappingPlan, DirectMappedRuns);
+  RUN_TEST(MappingPlan, SkipsIdenticalDirectMappedWritableMappings);
+  RUN_TEST(MappingPlan, ManyEntries);
+})
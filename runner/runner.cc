@@ -32,9 +32,11 @@
 #include "third_party/lss/lss/linux_syscall_support.h"
 #include "./common/snapshot_enums.h"
 #include "./runner/endspot.h"
+#include "./runner/mapping_plan.h"
 #include "./runner/runner_main_options.h"
 #include "./runner/runner_util.h"
 #include "./runner/snap_runner_util.h"
+#include "./runner/startup_profile.h"
 #include "./snap/exit_sequence.h"
 #include "./snap/snap.h"
 #include "./snap/snap_checksum.h"
@@ -130,6 +132,10 @@ size_t num_added_pages = 0;
 // This should only be non-zero when the runner is in make mode.
 size_t max_pages_to_add = 0;
 
+// If true, writable mappings may be mapped copy-on-write from the corpus file.
+// Set from RunnerMainOptions::direct_map_writable before the corpus is mapped.
+bool direct_map_writable = false;
+
 // Static limit of number of page addresses below.
 constexpr size_t kMaxAddedPageAddresses = 20;
 
@@ -137,6 +143,10 @@ uint64_t added_page_addresses[kMaxAddedPageAddresses];
 
 constexpr int kInitialMappingProtection = PROT_READ | PROT_WRITE;
 
+// Register groups of the current platform that can be included in a register
+// checksum. This is set by CommonMain().
+RegisterGroupSet<Host> platform_checksum_register_groups;
+
 // Attempts to recover from a SEGV fault due to missing mapping.
 // Returns true iff the fault is recoverable by adding a new mapping.
 bool TryToRecoverFromSignal(int signal, const siginfo_t& siginfo,
@@ -236,9 +246,16 @@ void SigAction(int signal, siginfo_t* siginfo, void* uc) {
 bool VerifyMemoryBytes(const SnapMemoryBytes& memory_bytes) {
   const void* address = AsPtr(memory_bytes.start_address);
   const size_t size = memory_bytes.size();
-  return memory_bytes.repeating()
-             ? MemAllEqualTo(address, memory_bytes.data.byte_run.value, size)
-             : MemEq(address, memory_bytes.data.byte_values.elements, size);
+  if (memory_bytes.repeating()) {
+    return MemAllEqualTo(address, memory_bytes.data.byte_run.value, size);
+  }
+  if (memory_bytes.pattern_run()) {
+    const SnapMemoryBytes::PatternRun& pattern_run =
+        memory_bytes.data.pattern_run;
+    return MemAllEqualToPattern(address, pattern_run.pattern,
+                                pattern_run.pattern_size, size);
+  }
+  return MemEq(address, memory_bytes.data.byte_values.elements, size);
 }
 
 // Copies memory bytes from Snap to runtime address.
@@ -247,6 +264,10 @@ void SetupMemoryBytes(const SnapMemoryBytes& memory_bytes) {
   if (memory_bytes.repeating()) {
     MemSet(target_address, memory_bytes.data.byte_run.value,
            memory_bytes.size());
+  } else if (memory_bytes.pattern_run()) {
+    MemSetPattern(target_address, memory_bytes.data.pattern_run.pattern,
+                  memory_bytes.data.pattern_run.pattern_size,
+                  memory_bytes.size());
   } else {
     MemCopy(target_address, memory_bytes.data.byte_values.elements,
             memory_bytes.size());
@@ -265,10 +286,10 @@ void CheckFixedMmapOK(void* mapped_address, void* target_address) {
 }
 
 // Can this memory mapping be mapped directly from the backing file?
+// Writable mappings are mapped copy-on-write, see DirectMapFlags(), and only
+// if direct_map_writable is set.
 bool CanDirectMap(const SnapMemoryMapping& memory_mapping) {
-  // We could support mmapping writeable pages with COW, but that's not a
-  // feature we need right now and it makes the code a little more complicated.
-  if ((memory_mapping.perms & PROT_WRITE) != 0) {
+  if (memory_mapping.writable() && !direct_map_writable) {
     return false;
   }
   // There must be only one memory_bytes entry.
@@ -277,7 +298,7 @@ bool CanDirectMap(const SnapMemoryMapping& memory_mapping) {
   }
   const SnapMemoryBytes& memory_bytes = memory_mapping.memory_bytes[0];
   // The bytes must be uncompressed.
-  if (memory_bytes.repeating()) {
+  if (memory_bytes.repeating() || memory_bytes.pattern_run()) {
     return false;
   }
   // The bytes must cover the mapping completely.
@@ -289,6 +310,42 @@ bool CanDirectMap(const SnapMemoryMapping& memory_mapping) {
   return IsPageAligned(memory_bytes.data.byte_values.elements);
 }
 
+// Returns the mmap() flags for mapping memory with 'perms' from the corpus
+// file. Writable mappings are private so that writes by a snap never reach the
+// corpus file. Pages a snap does not write stay shared with the page cache.
+int DirectMapFlags(int perms) {
+  return ((perms & PROT_WRITE) != 0 ? MAP_PRIVATE : MAP_SHARED) | MAP_FIXED;
+}
+
+// Copies the non-repeating 'memory_bytes' into place one page at a time,
+// skipping pages that already hold the expected contents. A page of a
+// copy-on-write mapping that the previous run did not write is still shared
+// with the page cache. Writing it would needlessly fault in a private copy.
+void RestoreMemoryBytesByPage(const SnapMemoryBytes& memory_bytes) {
+  uint8_t* target = reinterpret_cast<uint8_t*>(memory_bytes.start_address);
+  const uint8_t* source = memory_bytes.data.byte_values.elements;
+  const size_t size = memory_bytes.size();
+  for (size_t offset = 0; offset < size; offset += kPageSize) {
+    const size_t chunk = std::min<size_t>(kPageSize, size - offset);
+    if (!MemEq(target + offset, source + offset, chunk)) {
+      MemCopy(target + offset, source + offset, chunk);
+    }
+  }
+}
+
+// Selects the register groups saved by SnapExitImpl() after executing 'snap'.
+// Saving extension registers is expensive relative to a small Snap. On an
+// AVX-512 host it is up to 2KB of stores plus checksumming. We only save the
+// groups covered by the expected register checksum of 'snap', which the Snap
+// generator records per Snap. Other groups are never compared so there is no
+// need to save them.
+void SelectSnapExitRegisterGroups(const Snap<Host>& snap) {
+  snap_exit_register_group_io_buffer.register_groups =
+      RegisterGroupSet<Host>::Deserialize(
+          snap.end_state_register_checksum.register_groups.Serialize() &
+          platform_checksum_register_groups.Serialize());
+}
+
 SeccompOptions SeccompOptionsFromRunnerMainOptions(
     const RunnerMainOptions& options) {
   SeccompOptions seccomp_options;
@@ -302,6 +359,8 @@ SeccompOptions SeccompOptionsFromRunnerMainOptions(
 
 }  // namespace
 
+StartupProfile runner_startup_profile = {};
+
 void InstallSigHandler() {
   struct kernel_sigaction action = {};  // zero-initialized.
   action.sa_sigaction_ = SigAction;
@@ -368,7 +427,7 @@ void CreateMemoryMapping(const SnapMemoryMapping& memory_mapping, int corpus_fd,
     // Map.
     void* mapped_address =
         mmap(target_address, memory_mapping.num_bytes, memory_mapping.perms,
-             MAP_SHARED | MAP_FIXED, corpus_fd, offset);
+             DirectMapFlags(memory_mapping.perms), corpus_fd, offset);
     CheckFixedMmapOK(mapped_address, target_address);
   } else {
     // The data cannot be direct mapped.
@@ -402,10 +461,78 @@ void CreateMemoryMapping(const SnapMemoryMapping& memory_mapping, int corpus_fd,
   }
 }
 
-void MapSnap(const Snap<Host>& snap, int corpus_fd,
-             const void* corpus_mapping) {
-  for (const auto& memory_mapping : snap.memory_mappings) {
-    CreateMemoryMapping(memory_mapping, corpus_fd, corpus_mapping);
+// Returns the offset of the contents of 'memory_mapping' in the corpus file or
+// kNotDirectMapped if the mapping cannot be mapped from the file.
+int64_t DirectMapFileOffset(const SnapMemoryMapping& memory_mapping,
+                            int corpus_fd, const void* corpus_mapping) {
+  if (corpus_fd == -1 || !CanDirectMap(memory_mapping)) {
+    return kNotDirectMapped;
+  }
+  const int64_t offset = static_cast<int64_t>(
+      AsInt(memory_mapping.memory_bytes[0].data.byte_values.elements) -
+      AsInt(corpus_mapping));
+  CHECK(IsPageAligned(offset));
+  return offset;
+}
+
+// Creates the mappings of 'entries[begin..end)', a run returned by
+// MappingRunEnd(). A run of coalesced mappings takes one mmap() plus one
+// mprotect() per distinct protection.
+void CreateMappingRun(const MappingPlanEntry* entries, size_t begin,
+                      size_t end, int corpus_fd, const void* corpus_mapping) {
+  const MappingPlanEntry& first = entries[begin];
+  if (first.action == MappingPlanAction::kIndividual) {
+    CreateMemoryMapping(*first.mapping, corpus_fd, corpus_mapping);
+    return;
+  }
+
+  const uint64_t start_address = first.start_address;
+  const uint64_t num_bytes = entries[end - 1].limit_address - start_address;
+  void* target_address = AsPtr(start_address);
+  VLOG_INFO(2, "Mapping run ", HexStr(start_address), " size ",
+            HexStr(num_bytes));
+  if (first.direct_mapped()) {
+    void* mapped_address = mmap(target_address, num_bytes, first.perms,
+                                DirectMapFlags(first.perms), corpus_fd,
+                                static_cast<off_t>(first.file_offset));
+    CheckFixedMmapOK(mapped_address, target_address);
+    return;
+  }
+
+  void* mapped_address =
+      mmap(target_address, num_bytes, kInitialMappingProtection,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  CheckFixedMmapOK(mapped_address, target_address);
+
+  // As in CreateMemoryMapping(), only read-only mappings are initialized here.
+  for (size_t i = begin; i < end; ++i) {
+    if (entries[i].action == MappingPlanAction::kSkip) continue;
+    const SnapMemoryMapping& memory_mapping = *entries[i].mapping;
+    if (!memory_mapping.writable()) {
+      for (const auto& memory_bytes : memory_mapping.memory_bytes) {
+        SetupMemoryBytes(memory_bytes);
+      }
+    }
+  }
+
+  // Set the final protections, one mprotect() per range of equal protection.
+  for (size_t i = begin; i < end;) {
+    const int perms = entries[i].perms;
+    size_t j = i + 1;
+    while (j < end && (entries[j].action == MappingPlanAction::kSkip ||
+                       entries[j].perms == perms)) {
+      ++j;
+    }
+    if (perms != kInitialMappingProtection) {
+      const uint64_t range_start = entries[i].start_address;
+      const uint64_t range_size = entries[j - 1].limit_address - range_start;
+      VLOG_INFO(2, "mprotect range ", HexStr(range_start));
+      if (mprotect(AsPtr(range_start), range_size, perms) != 0) {
+        LOG_FATAL("mprotect(", HexStr(range_start),
+                  ") failed: ", ErrnoStr(errno));
+      }
+    }
+    i = j;
   }
 }
 
@@ -441,17 +568,49 @@ void ApplyProcMapsFixups(ProcMapsEntry proc_maps_entries[],
 // snap uses a memory mapping that conflicts with the runner itself (binary,
 // stack, heap and VDSO), it can crash the runner. Therefore, it performs
 // range checks before adding memory mappings into the runners address
-// space and dies if a conflict is detected.
-void MapCorpus(const SnapCorpus<Host>& corpus, int corpus_fd,
-               const void* corpus_mapping) {
+// space and quarantines snaps for which a conflict is detected.
+MappedCorpus MapCorpus(const SnapCorpus<Host>& corpus, int corpus_fd,
+                       const void* corpus_mapping) {
   CHECK(corpus.IsExpectedArch());
 
+  // The mapping plan and the snap array live in scratch memory that is mapped
+  // before reading /proc/self/maps so that snaps conflicting with it are
+  // caught by the range checks below. The snap array is only kept if some
+  // snaps are quarantined. It then holds the mapped snaps followed by the
+  // quarantined ones.
+  size_t num_mappings = 0;
+  for (const auto& snap : corpus.snaps) {
+    num_mappings += snap->memory_mappings.size;
+  }
+  const size_t snaps_bytes =
+      RoundUpToPageAlignment(corpus.snaps.size * sizeof(const Snap<Host>*));
+  const size_t plan_bytes =
+      RoundUpToPageAlignment(num_mappings * sizeof(MappingPlanEntry));
+  const Snap<Host>** snaps = nullptr;
+  MappingPlanEntry* plan = nullptr;
+  if (snaps_bytes + plan_bytes > 0) {
+    void* scratch_memory =
+        mmap(nullptr, snaps_bytes + plan_bytes, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (scratch_memory == MAP_FAILED) {
+      LOG_FATAL("mmap() for mapping plan failed: ", ErrnoStr(errno));
+    }
+    snaps = static_cast<const Snap<Host>**>(scratch_memory);
+    plan = reinterpret_cast<MappingPlanEntry*>(
+        static_cast<char*>(scratch_memory) + snaps_bytes);
+  }
+
   // On x86_64, we should only need 8 entries to describe all memory ranges when
   // running a fully static runner. 20 is more than enough to avoid overflow.
   constexpr size_t kMaxProcMapsEntries = 20;
   ProcMapsEntry proc_maps_entries[kMaxProcMapsEntries];
-  const size_t num_proc_maps_entries =
-      ReadProcMapsEntries(proc_maps_entries, kMaxProcMapsEntries);
+  size_t num_proc_maps_entries;
+  {
+    ScopedStartupPhase phase(runner_startup_profile,
+                             StartupPhase::kReadProcMaps);
+    num_proc_maps_entries =
+        ReadProcMapsEntries(proc_maps_entries, kMaxProcMapsEntries);
+  }
 
   if (VLOG_IS_ON(1)) {
     for (size_t i = 0; i < num_proc_maps_entries; ++i) {
@@ -463,29 +622,87 @@ void MapCorpus(const SnapCorpus<Host>& corpus, int corpus_fd,
   ApplyProcMapsFixups(proc_maps_entries, num_proc_maps_entries);
 
   VLOG_INFO(1, "Creating memory mappings");
+  ScopedStartupPhase phase(runner_startup_profile, StartupPhase::kMapSnaps);
+  // Partition the snaps: mapped snaps fill the snap array from the front and
+  // quarantined snaps from the back, both in corpus order.
+  size_t num_quarantined = 0;
   for (const auto& snap : corpus.snaps) {
-    // TODO(dougkwan): [impl] Make this fail more gracefully. We can skip
-    // conflicting snaps. To do that we need space to store the passing
-    // snaps. One possible way to do that without additional memory
-    // allocation at runtime is to make 'corpus' writable and remove
-    // conflicting snaps found here.
     if (SnapOverlapsWithProcMapsEntries(*snap, proc_maps_entries,
                                         num_proc_maps_entries)) {
-      LOG_FATAL("Cannot handle overlapping mappings");
+      ++num_quarantined;
     }
-    // If any of these memory mappings overlap, the mapping earlier in this list
-    // will be silently overwritten by the mapping later in this list.
-    // Currently, the corpus creator should avoid overlapping RO pages, but
-    // there may be zero-initialized RW pages that overlap between snaps. The
-    // most obvious case will be that most Snaps will have stacks mapped in
-    // exactly the same location.
-    MapSnap(*snap, corpus_fd, corpus_mapping);
+  }
+  const size_t num_snaps = corpus.snaps.size - num_quarantined;
+  size_t snap_index = 0;
+  size_t quarantine_index = num_snaps;
+  size_t num_entries = 0;
+  for (const auto& snap : corpus.snaps) {
+    if (SnapOverlapsWithProcMapsEntries(*snap, proc_maps_entries,
+                                        num_proc_maps_entries)) {
+      LOG_ERROR("Snap [", snap->id,
+                "] conflicts with the runner's memory mappings, skipping");
+      snaps[quarantine_index++] = snap;
+      continue;
+    }
+    snaps[snap_index++] = snap;
+    for (const auto& memory_mapping : snap->memory_mappings) {
+      plan[num_entries] = MappingPlanEntry{
+          .start_address = memory_mapping.start_address,
+          .limit_address =
+              memory_mapping.start_address + memory_mapping.num_bytes,
+          .perms = memory_mapping.perms,
+          .file_offset = DirectMapFileOffset(memory_mapping, corpus_fd,
+                                             corpus_mapping),
+          .order = static_cast<uint32_t>(num_entries),
+          .action = MappingPlanAction::kIndividual,
+          .mapping = &memory_mapping,
+      };
+      ++num_entries;
+    }
+  }
+  runner_startup_profile.num_snaps += num_snaps;
+  runner_startup_profile.num_mappings += num_entries;
+
+  // If any of these memory mappings overlap, the mapping earlier in corpus
+  // order is overwritten by the mapping later in corpus order, just as if the
+  // snaps were mapped one by one. Currently, the corpus creator should avoid
+  // overlapping RO pages, but there may be zero-initialized RW pages that
+  // overlap between snaps. The most obvious case will be that most Snaps will
+  // have stacks mapped in exactly the same location. The plan merges those.
+  BuildMappingPlan(plan, num_entries);
+  size_t num_runs = 0;
+  for (size_t begin = 0; begin < num_entries; ++num_runs) {
+    const size_t end = MappingRunEnd(plan, num_entries, begin);
+    CreateMappingRun(plan, begin, end, corpus_fd, corpus_mapping);
+    begin = end;
+  }
+  VLOG_INFO(1, "Created ", num_entries, " memory mappings in ", num_runs,
+            " runs");
+  if (plan_bytes > 0) {
+    CHECK_EQ(munmap(plan, plan_bytes), 0);
   }
   VLOG_INFO(1, "Done creating memory mappings");
 
   if (corpus_fd != -1) {
     CHECK_EQ(close(corpus_fd), 0);
   }
+
+  if (num_quarantined == 0) {
+    if (snaps_bytes > 0) {
+      CHECK_EQ(munmap(snaps, snaps_bytes), 0);
+    }
+    return MappedCorpus{.corpus = &corpus, .quarantined_snaps = {0, nullptr}};
+  }
+  // A slice of the snap array in the same fashion as the one-snap corpus
+  // synthesized by CommonMain().
+  static SnapCorpus<Host> mapped_corpus = {};
+  memcpy(&mapped_corpus, &corpus, sizeof(mapped_corpus));
+  mapped_corpus.snaps.size = num_snaps;
+  mapped_corpus.snaps.elements = snaps;
+  return MappedCorpus{
+      .corpus = &mapped_corpus,
+      .quarantined_snaps = {num_quarantined, snaps + num_snaps},
+  };
 }
 
 bool VerifySnapChecksums(const Snap<Host>& snap) {
@@ -595,7 +812,12 @@ void PrepareSnapMemory(const Snap<Host>& snap) {
     // Read-only contents will not have changed.
     if (memory_mapping.writable()) {
       for (const auto& memory_bytes : memory_mapping.memory_bytes) {
-        SetupMemoryBytes(memory_bytes);
+        if (!direct_map_writable || memory_bytes.repeating() ||
+            memory_bytes.pattern_run()) {
+          SetupMemoryBytes(memory_bytes);
+        } else {
+          RestoreMemoryBytesByPage(memory_bytes);
+        }
       }
     }
   }
@@ -724,12 +946,35 @@ void LogSnapRunResult(const Snap<Host>& snap, const RunnerMainOptions& options,
       memory_bytes_m->Bytes("byte_values", start_address, kPageSize);
     }
   }
+  {
+    auto startup_profile = snapshot_execution_result.Message("startup_profile");
+    for (size_t i = 0; i < kNumStartupPhases; ++i) {
+      startup_profile->Int(StartupPhaseFieldName(static_cast<StartupPhase>(i)),
+                           runner_startup_profile.phase_nanos[i]);
+    }
+    startup_profile->Int("num_snaps", runner_startup_profile.num_snaps);
+    startup_profile->Int("num_mappings", runner_startup_profile.num_mappings);
+  }
   LogToStdout(snapshot_execution_result.c_str());
 }
 
+// Logs the ids of `quarantined_snaps` to stdout formatted as
+// proto.SnapshotExecutionResult text proto, one quarantined_snapshot_ids field
+// per snap. The output is a prefix of whatever LogSnapRunResult() logs later so
+// that the driver can parse all of stdout as a single message.
+void LogQuarantinedSnaps(
+    const SnapArray<const Snap<Host>*>& quarantined_snaps) {
+  for (const Snap<Host>* snap : quarantined_snaps) {
+    TextProtoPrinter snapshot_execution_result;
+    snapshot_execution_result.String("quarantined_snapshot_ids", snap->id);
+    LogToStdout(snapshot_execution_result.c_str());
+  }
+}
+
 const SnapCorpus<Host>* CommonMain(const RunnerMainOptions& options) {
   // Pin CPU if pinning is requested.
   if (options.cpu != kAnyCPUId) {
+    ScopedStartupPhase phase(runner_startup_profile, StartupPhase::kPinCpu);
     const int error = SetCPUAffinity(options.cpu);
     // Linux kernel API uses unsigned long type.
     if (error != 0) {
@@ -738,13 +983,24 @@ const SnapCorpus<Host>* CommonMain(const RunnerMainOptions& options) {
     }
   }
 
-  InitSnapExit(&SnapExitImpl);
+  {
+    ScopedStartupPhase phase(runner_startup_profile,
+                             StartupPhase::kInitSnapExit);
+    InitSnapExit(&SnapExitImpl);
+  }
 
-  // Initialize register checksumming.
-  InitRegisterGroupIO();
-  RegisterGroupSet<Host> checksum_register_group =
-      GetCurrentPlatformChecksumRegisterGroups();
-  snap_exit_register_group_io_buffer.register_groups = checksum_register_group;
+  // Initialize register checksumming. All checksummable groups are saved
+  // by default. This is what make mode needs to record an end state. Modes
+  // that check end states narrow this per Snap.
+  {
+    ScopedStartupPhase phase(runner_startup_profile,
+                             StartupPhase::kInitRegisterGroups);
+    InitRegisterGroupIO();
+    platform_checksum_register_groups =
+        GetCurrentPlatformChecksumRegisterGroups();
+    snap_exit_register_group_io_buffer.register_groups =
+        platform_checksum_register_groups;
+  }
 
   // Preserve this value because the following logic might synthesize a new
   // SnapCorpus struct.
@@ -767,11 +1023,22 @@ const SnapCorpus<Host>* CommonMain(const RunnerMainOptions& options) {
     }
     LOG_FATAL("Snap ", options.snap_id, " not found in the corpus");
   }();
-  MapCorpus(*corpus, options.corpus_fd, corpus_mapping);
+  direct_map_writable = options.direct_map_writable;
+  const MappedCorpus mapped_corpus =
+      MapCorpus(*corpus, options.corpus_fd, corpus_mapping);
+  LogQuarantinedSnaps(mapped_corpus.quarantined_snaps);
+  corpus = mapped_corpus.corpus;
   if (options.strict) {
+    ScopedStartupPhase phase(runner_startup_profile,
+                             StartupPhase::kVerifyChecksums);
     VerifyChecksums(*corpus);
   }
-  InstallSigHandler();
+  {
+    ScopedStartupPhase phase(runner_startup_profile,
+                             StartupPhase::kInstallSignalHandlers);
+    InstallSigHandler();
+  }
+  LogStartupProfile(runner_startup_profile);
 
   return corpus;
 }
@@ -791,6 +1058,10 @@ void RunSnap(const Snap<Host>& snap, const RunnerMainOptions& options,
 
 int MakerMain(const RunnerMainOptions& options) {
   const SnapCorpus<Host>* corpus = CommonMain(options);
+  if (corpus->snaps.size == 0) {
+    LOG_ERROR("The snap was quarantined, exiting");
+    return EXIT_SUCCESS;
+  }
 
   max_pages_to_add = options.max_pages_to_add;
   EnterSeccompFilterMode(SeccompOptionsFromRunnerMainOptions(options));
@@ -810,7 +1081,11 @@ int MakerMain(const RunnerMainOptions& options) {
 int RunnerMain(const RunnerMainOptions& options) {
   CHECK(!options.sequential_mode);
   const SnapCorpus<Host>* corpus = CommonMain(options);
-  CHECK_GT(corpus->snaps.size, 0);
+  if (corpus->snaps.size == 0) {
+    // MapCorpus() quarantined every snap and CommonMain() reported them.
+    LOG_ERROR("All snaps were quarantined, exiting");
+    return EXIT_SUCCESS;
+  }
 
   EnterSeccompFilterMode(SeccompOptionsFromRunnerMainOptions(options));
 
@@ -841,6 +1116,7 @@ int RunnerMain(const RunnerMainOptions& options) {
       }
       const Snap<Host>& snap = *(corpus->snaps[batch[schedule_dist(gen)]]);
       VLOG_INFO(3, "#", IntStr(snap_execution_count), " Running ", snap.id);
+      SelectSnapExitRegisterGroups(snap);
       RunSnapResult run_result;
       RunSnap(snap, options, run_result);
       if (run_result.outcome != RunSnapOutcome::kAsExpected) {
@@ -877,6 +1153,7 @@ int RunnerMainSequential(const RunnerMainOptions& options) {
       VLOG_INFO(1, "iter #", IntStr(i), " of ", IntStr(corpus->snaps.size));
     }
     VLOG_INFO(3, "#", IntStr(i), " Running ", snap.id);
+    SelectSnapExitRegisterGroups(snap);
     RunSnapResult run_result;
     RunSnap(snap, options, run_result);
     if (run_result.outcome != RunSnapOutcome::kAsExpected) {
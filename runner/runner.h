@@ -21,6 +21,7 @@
 
 #include "./runner/endspot.h"
 #include "./runner/runner_main_options.h"
+#include "./runner/startup_profile.h"
 #include "./snap/snap.h"
 #include "./util/arch.h"
 
@@ -60,14 +61,34 @@ struct RunSnapResult {
   int64_t cpu_id;
 };
 
-// Establishes memory mappings in 'corpus'.
+// Time spent in each phase of runner startup. CommonMain() records its own
+// phases. Phases that happen before, i.e. loading the corpus, are recorded by
+// the caller of RunnerMain() and friends.
+extern StartupProfile runner_startup_profile;
+
+// Result of MapCorpus().
+struct MappedCorpus {
+  // Snaps whose memory mappings were established, in corpus order. This is
+  // the input corpus itself unless some snaps were quarantined.
+  const SnapCorpus<Host>* corpus;
+
+  // Snaps that were skipped because their memory mappings conflict with those
+  // of the runner itself (binary, stack, heap and VDSO), in corpus order.
+  SnapArray<const Snap<Host>*> quarantined_snaps;
+};
+
+// Establishes memory mappings in 'corpus'. Adjacent mappings of all snaps are
+// coalesced so that they can share mmap() and mprotect() calls. See
+// mapping_plan.h.
+// Snaps that conflict with the runner's own mappings are quarantined: they
+// are not mapped and are left out of the returned corpus.
 // Takes ownership of 'corpus_fd' and closes it after the corpus is mapped.
 // If the corpus is not backed by a file object, 'corpus_fd' may be -1.
 // 'corpus_mapping' points to the address where corpus_fd is mapped. This is
 // usually identical to the SnapCorpus pointer. This value can be NULL if
 // corpus_fd == -1.
-void MapCorpus(const SnapCorpus<Host>& corpus, int corpus_fd,
-               const void* corpus_mapping);
+MappedCorpus MapCorpus(const SnapCorpus<Host>& corpus, int corpus_fd,
+                       const void* corpus_mapping);
 
 // Executes 'snap' with 'options' and stores the execution result in 'result'.
 // REQUIRES: the runtime environment, including memory mapping used by 'snap'
@@ -40,6 +40,7 @@ size_t FLAGS_schedule_size = RunnerMainOptions::kDefaultScheduleSize;
 bool FLAGS_sequential_mode = false;
 bool FLAGS_skip_end_state_check = false;
 bool FLAGS_strict = false;
+bool FLAGS_direct_map_writable = false;
 uint64_t FLAGS_max_pages_to_add = 0;
 
 // Print all flags and exit.
@@ -66,6 +67,9 @@ void ShowUsage(const char* program_name) {
   LOG_INFO(
       "  --strict\tPerform additional integrity checking. May slow down "
       "execution.");
+  LOG_INFO(
+      "  --direct_map_writable\tMap writable snap memory copy-on-write from "
+      "the corpus file.");
   LOG_INFO(
       "  --max_pages_to_add [value]\tMaximum number of r/w pages added in snap "
       "making.");
@@ -153,6 +157,9 @@ int ParseRunnerFlags(int argc, char* argv[]) {
       FLAGS_skip_end_state_check = true;
     } else if (matcher.Match("strict", CommandLineFlagMatcher::kNoArgument)) {
       FLAGS_strict = true;
+    } else if (matcher.Match("direct_map_writable",
+                             CommandLineFlagMatcher::kNoArgument)) {
+      FLAGS_direct_map_writable = true;
     } else if (matcher.Match("max_pages_to_add",
                              CommandLineFlagMatcher::kRequiredArgument)) {
       uint64_t max_pages_to_add;
@@ -72,6 +72,10 @@ extern bool FLAGS_skip_end_state_check;
 // If true, perform additional integrity checking. May slow down execution.
 extern bool FLAGS_strict;
 
+// If true, map writable Snap memory copy-on-write from the corpus file where
+// possible.
+extern bool FLAGS_direct_map_writable;
+
 // Maximum number of pages to be added during snap making. This option is used
 // only in snap making mode.
 extern uint64_t FLAGS_max_pages_to_add;
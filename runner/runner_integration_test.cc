@@ -18,6 +18,8 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -25,6 +27,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "./common/memory_perms.h"
 #include "./common/proxy_config.h"
 #include "./common/snapshot.h"
 #include "./common/snapshot_enums.h"
@@ -34,6 +37,7 @@
 #include "./runner/driver/runner_options.h"
 #include "./runner/runner_provider.h"
 #include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/gen/runner_base_address.h"
 #include "./snap/testing/snap_test_snapshots.h"
 #include "./util/arch.h"
 #include "./util/data_dependency.h"
@@ -51,6 +55,7 @@ namespace {
 
 using ::silifuzz::testing::StatusIs;
 using snapshot_types::PlaybackOutcome;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::Not;
@@ -185,6 +190,49 @@ TEST(RunnerTest, EmptyCorpus) {
   ASSERT_OK(driver.Run(opts));
 }
 
+TEST(RunnerTest, QuarantinesConflictingSnap) {
+  Snapshot snapshot =
+      MakeSnapRunnerTestSnapshot<Host>(TestSnapshot::kEndsAsExpected);
+  // A copy of the snapshot that also maps a page over the runner binary.
+  Snapshot conflicting = snapshot.Copy();
+  conflicting.set_id("conflicting");
+  const Snapshot::MemoryMapping mapping = Snapshot::MemoryMapping::MakeSized(
+      SILIFUZZ_RUNNER_BASE_ADDRESS, conflicting.page_size(), MemoryPerms::R());
+  ASSERT_OK(conflicting.can_add_memory_mapping(mapping));
+  conflicting.add_memory_mapping(mapping);
+  conflicting.add_memory_bytes(Snapshot::MemoryBytes(
+      SILIFUZZ_RUNNER_BASE_ADDRESS,
+      Snapshot::ByteData(conflicting.page_size(), '\0')));
+  std::vector<Snapshot> corpus;
+  corpus.push_back(std::move(conflicting));
+  corpus.push_back(std::move(snapshot));
+  MmappedMemoryPtr<char> buffer =
+      GenerateRelocatableSnaps(Host::architecture_id, corpus);
+  ASSERT_OK_AND_ASSIGN(auto path, CreateTempFile("ConflictingCorpus", ""));
+
+  int fd = open(path.c_str(), O_WRONLY);
+  ASSERT_NE(fd, -1);
+  absl::string_view buf(buffer.get(), MmappedMemorySize(buffer));
+  ASSERT_TRUE(WriteToFileDescriptor(fd, buf));
+  close(fd);
+
+  RunnerDriver driver = RunnerDriver::ReadingRunner(
+      RunnerLocation(), path, "", [&path] { unlink(path.c_str()); });
+  // The rest of the corpus keeps running.
+  auto opts = RunnerOptions::Default();
+  opts.set_sequential_mode(true);
+  ASSERT_OK_AND_ASSIGN(auto result, driver.Run(opts));
+  EXPECT_TRUE(result.success());
+  EXPECT_THAT(result.quarantined_snapshot_ids(), ElementsAre("conflicting"));
+
+  ASSERT_OK_AND_ASSIGN(
+      result, driver.PlayOne(EnumStr(TestSnapshot::kEndsAsExpected)));
+  EXPECT_TRUE(result.success());
+
+  EXPECT_THAT(driver.PlayOne("conflicting"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
 TEST(RunnerTest, UnknownFlags) {
   MmappedMemoryPtr<char> buffer =
       GenerateRelocatableSnaps(Host::architecture_id, {});
@@ -32,6 +32,7 @@
 #include "./runner/runner.h"
 #include "./runner/runner_flags.h"
 #include "./runner/runner_main_options.h"
+#include "./runner/startup_profile.h"
 #include "./util/arch.h"
 #include "./util/checks.h"
 #include "./util/strcat.h"
@@ -74,8 +75,11 @@ int Main(int argc, char* argv[]) {
   options.strict = FLAGS_strict;
 
   const char* corpus_file_name = flags_end < argc ? argv[flags_end] : nullptr;
-  options.corpus =
-      LoadCorpus(corpus_file_name, options.strict, &options.corpus_fd);
+  {
+    ScopedStartupPhase phase(runner_startup_profile, StartupPhase::kLoadCorpus);
+    options.corpus =
+        LoadCorpus(corpus_file_name, options.strict, &options.corpus_fd);
+  }
   if (options.corpus == nullptr) {
     LOG_ERROR("No corpus file name was specified");
     return EXIT_FAILURE;
@@ -128,6 +132,7 @@ int Main(int argc, char* argv[]) {
   options.batch_size = FLAGS_batch_size;
   options.schedule_size = FLAGS_schedule_size;
   options.sequential_mode = FLAGS_sequential_mode;
+  options.direct_map_writable = FLAGS_direct_map_writable;
   options.max_pages_to_add = FLAGS_make ? FLAGS_max_pages_to_add : 0;
 
   // These cannot be set together.
@@ -104,6 +104,11 @@ struct RunnerMainOptions {
   // use the FD to create Snap mappings faster.
   int corpus_fd = -1;
 
+  // If true, writable Snap mappings whose contents are stored uncompressed
+  // and page-aligned in the corpus file are mapped copy-on-write from
+  // corpus_fd instead of being copied into anonymous memory.
+  bool direct_map_writable = false;
+
   // If true, the end state after snap execution is not checked. Snaps are
   // considered to always end as expected.
   bool skip_end_state_check = false;
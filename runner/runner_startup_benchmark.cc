@@ -0,0 +1,120 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures runner cold start, i.e. the cost of starting a runner process on a
+// corpus and running a single Snap, against the number of Snaps in the corpus
+// and the number of memory mappings per Snap.
+//
+// To run:
+//
+// bazel run -c opt third_party/silifuzz/runner:runner_startup_benchmark -- \
+//   --benchmark_filter=all
+//
+// Run a runner with --v=1 to see where startup time goes, see
+// runner/startup_profile.h.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "./common/memory_perms.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
+#include "./runner/driver/runner_driver.h"
+#include "./runner/driver/runner_options.h"
+#include "./runner/runner_provider.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/testing/snap_test_snapshots.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/file_util.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/path_util.h"
+
+namespace silifuzz {
+namespace {
+
+// Start of the read-only data pages added to each Snap. Far away from the
+// test snapshot's own mappings.
+constexpr Snapshot::Address kExtraMappingsStart = 0x700000000000ULL;
+
+// Writes a relocatable corpus of `num_snaps` copies of the ends-as-expected
+// test Snap to a temporary file and returns its path. Each copy gets
+// `extra_mappings` additional one-page mappings of its own.
+std::string MakeCorpusFile(size_t num_snaps, size_t extra_mappings) {
+  const Snapshot base =
+      MakeSnapRunnerTestSnapshot<Host>(TestSnapshot::kEndsAsExpected);
+  const size_t page_size = base.page_size();
+  std::vector<Snapshot> snapshots;
+  snapshots.reserve(num_snaps);
+  for (size_t i = 0; i < num_snaps; ++i) {
+    Snapshot snapshot = base.Copy();
+    snapshot.set_id(absl::StrCat(base.id(), "_", i));
+    for (size_t j = 0; j < extra_mappings; ++j) {
+      const Snapshot::Address address =
+          kExtraMappingsStart + (i * extra_mappings + j) * page_size;
+      snapshot.add_memory_mapping(Snapshot::MemoryMapping::MakeSized(
+          address, page_size, MemoryPerms::R()));
+      // Distinct bytes per page so that nothing is stored as a byte run.
+      Snapshot::ByteData bytes(page_size, 0);
+      for (size_t k = 0; k < page_size; ++k) {
+        bytes[k] = static_cast<char>(i + j + k);
+      }
+      snapshot.add_memory_bytes(Snapshot::MemoryBytes(address, bytes));
+    }
+    snapshots.push_back(std::move(snapshot));
+  }
+
+  MmappedMemoryPtr<char> buffer =
+      GenerateRelocatableSnaps(Host::architecture_id, snapshots);
+  absl::StatusOr<std::string> path = CreateTempFile("runner_startup_corpus");
+  CHECK_STATUS(path.status());
+  CHECK(SetContents(
+      *path, absl::string_view(buffer.get(), MmappedMemorySize(buffer))));
+  return *path;
+}
+
+void BM_RunnerColdStart(benchmark::State& state) {
+  const size_t num_snaps = state.range(0);
+  const size_t extra_mappings = state.range(1);
+  const std::string corpus_path = MakeCorpusFile(num_snaps, extra_mappings);
+  RunnerDriver driver = RunnerDriver::ReadingRunner(
+      RunnerLocation(), corpus_path, "",
+      [&corpus_path] { unlink(corpus_path.c_str()); });
+  RunnerOptions options = RunnerOptions::Default();
+  options.set_extra_argv({"--num_iterations", "1"});
+
+  for (auto s : state) {
+    absl::StatusOr<RunnerDriver::RunResult> result = driver.Run(options);
+    CHECK_STATUS(result.status());
+    CHECK(result->success());
+  }
+}
+
+BENCHMARK(BM_RunnerColdStart)
+    ->ArgNames({"snaps", "extra_mappings"})
+    ->ArgsProduct({{1, 16, 256, 1024}, {0, 4, 16}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace silifuzz
@@ -14,19 +14,29 @@
 
 #include "./runner/snap_maker.h"
 
+#include <sched.h>
 #include <sys/user.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "absl/functional/bind_front.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "./common/mapped_memory_map.h"
 #include "./common/memory_bytes_set.h"
 #include "./common/memory_mapping.h"
@@ -45,6 +55,7 @@
 #include "./util/line_printer.h"
 #include "./util/page_util.h"
 #include "./util/platform.h"
+#include "./util/tool_util.h"
 
 #if defined(__x86_64__)
 #include "./runner/disassembling_snap_tracer.h"
@@ -192,6 +203,17 @@ absl::StatusOr<Snapshot> SnapMaker::CheckTrace(
 
 absl::Status SnapMaker::VerifyPlaysDeterministically(
     const Snapshot& snapshot) const {
+  if (!opts_.verify_cpus.empty()) {
+    ASSIGN_OR_RETURN_IF_NOT_OK(CpuVerifyReport report,
+                               VerifyOnCpus(snapshot, opts_.verify_cpus));
+    if (!report.ok()) {
+      return absl::InternalError(
+          absl::StrCat("Verify() failed, non-deterministic snapshot? ",
+                       report.DebugString()));
+    }
+    return absl::OkStatus();
+  }
+
   SnapifyOptions snapify_opts =
       SnapifyOptions::V2InputRunOpts(snapshot.architecture_id());
   ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot snapified,
@@ -221,6 +243,94 @@ absl::Status SnapMaker::VerifyPlaysDeterministically(
   return absl::OkStatus();
 }
 
+std::string SnapMaker::CpuVerifyReport::DebugString() const {
+  std::string result =
+      absl::StrCat("agreed: ", absl::StrJoin(agreeing_cpus, ","));
+  if (!divergences.empty()) {
+    absl::StrAppend(&result, "; diverged:");
+    for (const Divergence& divergence : divergences) {
+      absl::StrAppend(&result, " {", absl::StrJoin(divergence.cpus, ","), "}");
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<SnapMaker::CpuVerifyReport> SnapMaker::VerifyOnCpus(
+    const Snapshot& snapshot, const std::vector<int>& cpus) const {
+  CHECK(!cpus.empty());
+  SnapifyOptions snapify_opts =
+      SnapifyOptions::V2InputRunOpts(snapshot.architecture_id());
+  ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot snapified,
+                             Snapify(snapshot, snapify_opts));
+  ASSIGN_OR_RETURN_IF_NOT_OK(
+      RunnerDriver driver,
+      RunnerDriverFromSnapshot(snapified, opts_.runner_path));
+
+  // Each slot is written by exactly one worker and read after all workers
+  // are joined.
+  std::vector<std::optional<absl::StatusOr<RunnerDriver::RunResult>>> results(
+      cpus.size());
+  std::atomic<size_t> next_index = 0;
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < cpus.size(); i = next_index++) {
+      results[i] = driver.VerifyOneRepeatedly(
+          snapified.id(), opts_.num_verify_attempts, cpus[i]);
+    }
+  };
+  size_t num_workers = opts_.verify_parallelism == 0
+                           ? cpus.size()
+                           : std::min<size_t>(opts_.verify_parallelism,
+                                              cpus.size());
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers.emplace_back(worker);
+  }
+  for (std::thread& t : workers) {
+    t.join();
+  }
+
+  CpuVerifyReport report;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    absl::StatusOr<RunnerDriver::RunResult>& result = *results[i];
+    if (!result.ok()) {
+      return absl::Status(
+          result.status().code(),
+          absl::StrCat("CPU ", cpus[i], ": ", result.status().message()));
+    }
+    if (result->success()) {
+      report.agreeing_cpus.push_back(cpus[i]);
+      continue;
+    }
+    const std::optional<Snapshot::EndState>& actual_end_state =
+        result->player_result().actual_end_state;
+    if (!actual_end_state.has_value()) {
+      return absl::InternalError(absl::StrCat(
+          "CPU ", cpus[i], ": the runner didn't report actual_end_state"));
+    }
+    auto it = std::find_if(
+        report.divergences.begin(), report.divergences.end(),
+        [&](const CpuVerifyReport::Divergence& divergence) {
+          return divergence.actual_end_state == *actual_end_state;
+        });
+    if (it != report.divergences.end()) {
+      it->cpus.push_back(cpus[i]);
+    } else {
+      report.divergences.push_back({{cpus[i]}, *actual_end_state});
+    }
+  }
+
+  if (VLOG_IS_ON(1)) {
+    LinePrinter lp(LinePrinter::StdErrPrinter);
+    SnapshotPrinter printer(&lp);
+    for (const CpuVerifyReport::Divergence& divergence : report.divergences) {
+      lp.Line("CPUs ", absl::StrJoin(divergence.cpus, ","), " reached:");
+      printer.PrintActualEndState(snapified, divergence.actual_end_state);
+    }
+  }
+  return report;
+}
+
 absl::Status SnapMaker::AddWritableMemoryForAddress(
     Snapshot* snapshot, snapshot_types::Address addr) {
   const uint64_t kPageSizeBytes = snapshot->page_size();
@@ -398,4 +508,53 @@ absl::StatusOr<Endpoint> SnapMaker::MakeLoop(Snapshot* snapshot,
   }
 }
 
+namespace {
+
+// Reads an integer from a sysfs file. Returns -1 if that fails.
+int ReadSysfsInt(const std::string& path) {
+  absl::StatusOr<std::string> contents = GetFileContents(path);
+  int value;
+  if (!contents.ok() ||
+      !absl::SimpleAtoi(absl::StripAsciiWhitespace(*contents), &value)) {
+    return -1;
+  }
+  return value;
+}
+
+}  // namespace
+
+std::vector<int> SelectVerifyCpus(int max_cpus) {
+  CHECK_GT(max_cpus, 0);
+  cpu_set_t all_cpus;
+  CPU_ZERO(&all_cpus);
+  if (sched_getaffinity(0 /* this thread */, sizeof(all_cpus), &all_cpus) !=
+      0) {
+    LOG_FATAL("Cannot get current CPU affinity mask: ", ErrnoStr(errno));
+  }
+
+  // First pass takes one CPU per (package, core). Second pass adds the
+  // remaining SMT siblings. CPUs with unreadable topology count as their own
+  // core.
+  std::vector<int> selected;
+  std::vector<int> siblings;
+  std::set<std::pair<int, int>> seen_cores;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &all_cpus)) continue;
+    const std::string topology =
+        absl::StrCat("/sys/devices/system/cpu/cpu", cpu, "/topology/");
+    const int package = ReadSysfsInt(topology + "physical_package_id");
+    const int core = ReadSysfsInt(topology + "core_id");
+    if (package < 0 || core < 0 || seen_cores.insert({package, core}).second) {
+      selected.push_back(cpu);
+    } else {
+      siblings.push_back(cpu);
+    }
+  }
+  selected.insert(selected.end(), siblings.begin(), siblings.end());
+  if (selected.size() > static_cast<size_t>(max_cpus)) {
+    selected.resize(max_cpus);
+  }
+  return selected;
+}
+
 }  // namespace silifuzz
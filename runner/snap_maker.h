@@ -16,6 +16,7 @@
 #define THIRD_PARTY_SILIFUZZ_RUNNER_SNAP_MAKER_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -67,6 +68,15 @@ class SnapMaker {
     // mappings are rejected.
     bool enforce_fuzzing_config = true;
 
+    // If non-empty, VerifyPlaysDeterministically() plays the snapshot
+    // `num_verify_attempts` times on each of these CPUs instead of once on
+    // `cpu`. See VerifyOnCpus().
+    std::vector<int> verify_cpus = {};
+
+    // Maximum number of runners VerifyOnCpus() starts at the same time.
+    // 0 means one runner per CPU in `verify_cpus`.
+    int verify_parallelism = 0;
+
     absl::Status Validate() const {
       if (runner_path.empty()) {
         return absl::InvalidArgumentError("runner_path must be non-empty");
@@ -77,11 +87,40 @@ class SnapMaker {
       if (num_verify_attempts <= 0) {
         return absl::InvalidArgumentError("num_verify_attempts <= 0");
       }
+      for (int verify_cpu : verify_cpus) {
+        if (verify_cpu < 0) {
+          return absl::InvalidArgumentError("verify_cpus must be >= 0");
+        }
+      }
+      if (verify_parallelism < 0) {
+        return absl::InvalidArgumentError("verify_parallelism < 0");
+      }
 
       return absl::OkStatus();
     }
   };
 
+  // Outcome of VerifyOnCpus().
+  struct CpuVerifyReport {
+    // A set of CPUs that reached the same unexpected end state.
+    struct Divergence {
+      std::vector<int> cpus;
+      Snapshot::EndState actual_end_state;
+    };
+
+    // CPUs on which every attempt reached the expected end state.
+    std::vector<int> agreeing_cpus;
+
+    // CPUs on which some attempt did not, grouped by the end state they
+    // reached instead.
+    std::vector<Divergence> divergences;
+
+    bool ok() const { return divergences.empty(); }
+
+    // Returns a one-line summary like "agreed: 0,2; diverged: {1} {3,5}".
+    std::string DebugString() const;
+  };
+
   explicit SnapMaker(const Options& opts);
 
   // Not movable or copyable (not needed).
@@ -115,6 +154,16 @@ class SnapMaker {
   // RETURNS: OkStatus() if the snapshot was successfully verified.
   absl::Status VerifyPlaysDeterministically(const Snapshot& snapshot) const;
 
+  // Plays the snapshot `num_verify_attempts` times on each CPU in `cpus` using
+  // one runner process per CPU. Up to `verify_parallelism` runners play at the
+  // same time so that per-core differences show up without making
+  // verification slower than the serial path.
+  //
+  // RETURNS: A report of which CPUs agreed with the expected end state or an
+  // error if a runner could not be started.
+  absl::StatusOr<CpuVerifyReport> VerifyOnCpus(
+      const Snapshot& snapshot, const std::vector<int>& cpus) const;
+
   // Single-steps the input snapshot and checks the conditions described below.
   //
   // Returns a Status if the snapshot does one of the following: a) executes
@@ -155,6 +204,11 @@ class SnapMaker {
   Options opts_;
 };
 
+// Returns up to `max_cpus` CPUs this thread may run on for use as
+// SnapMaker::Options::verify_cpus. CPUs on distinct physical cores come
+// first; SMT siblings are only picked once every core has one CPU picked.
+std::vector<int> SelectVerifyCpus(int max_cpus);
+
 }  // namespace silifuzz
 
 #endif  // THIRD_PARTY_SILIFUZZ_RUNNER_SNAP_MAKER_H_
@@ -15,11 +15,14 @@
 #include "./runner/snap_maker.h"
 
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "./common/proxy_config.h"
+#include "./common/raw_insns_util.h"
 #include "./common/snapshot.h"
 #include "./common/snapshot_test_enum.h"
 #include "./player/trace_options.h"
@@ -37,8 +40,11 @@ using silifuzz::DefaultSnapMakerOptionsForTest;
 using silifuzz::FixSnapshotInTest;
 using silifuzz::testing::IsOk;
 using silifuzz::testing::StatusIs;
+using ::testing::Contains;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::UnorderedElementsAreArray;
 
 TEST(SnapMaker, AsExpected) {
   auto endsAsExpectedSnap =
@@ -222,5 +228,73 @@ TEST(SnapMaker, FuzzingConfigNonconformance) {
                HasSubstr("Snapshot does not conform to fuzzing config")));
 }
 
+TEST(SnapMaker, VerifyOnCpus) {
+  const std::vector<int> cpus = SelectVerifyCpus(4);
+  ASSERT_THAT(cpus, Not(IsEmpty()));
+  const auto snapshot =
+      MakeSnapRunnerTestSnapshot<Host>(TestSnapshot::kEndsAsExpected);
+  SnapMaker::Options options = DefaultSnapMakerOptionsForTest();
+  options.verify_cpus = cpus;
+  options.verify_parallelism = 2;
+  ASSERT_OK_AND_ASSIGN(auto fixed, FixSnapshotInTest(snapshot, options));
+
+  SnapMaker snap_maker(options);
+  ASSERT_OK_AND_ASSIGN(SnapMaker::CpuVerifyReport report,
+                       snap_maker.VerifyOnCpus(fixed, cpus));
+  EXPECT_TRUE(report.ok()) << report.DebugString();
+  EXPECT_THAT(report.agreeing_cpus, UnorderedElementsAreArray(cpus));
+}
+
+TEST(SnapMaker, VerifyOnCpusRandomRegs) {
+  const std::vector<int> cpus = SelectVerifyCpus(2);
+  const auto snapshot =
+      MakeSnapRunnerTestSnapshot<Host>(TestSnapshot::kRegsMismatchRandom);
+  SnapMaker::Options options = DefaultSnapMakerOptionsForTest();
+  options.verify_cpus = cpus;
+  EXPECT_THAT(FixSnapshotInTest(snapshot, options),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("non-deterministic")));
+}
+
+TEST(SnapMaker, VerifyOnCpusCpuDependent) {
+#if !defined(__x86_64__)
+  GTEST_SKIP() << "CPUID-based test implemented only on x86_64.";
+#else
+  const std::vector<int> cpus = SelectVerifyCpus(4);
+  if (cpus.size() < 2) {
+    GTEST_SKIP() << "Need at least 2 CPUs";
+  }
+  // mov eax, 1; cpuid. EBX[31:24] holds the initial APIC ID of the CPU.
+  const std::string code("\xb8\x01\x00\x00\x00\x0f\xa2", 7);
+  // The static instruction filter rejects CPUID by default.
+  FuzzingConfig<X86_64> config = DEFAULT_FUZZING_CONFIG<X86_64>;
+  config.instruction_filter.non_deterministic_instructions_allowed = true;
+  ASSERT_OK_AND_ASSIGN(Snapshot snapshot,
+                       InstructionsToSnapshot<X86_64>(code, config));
+  snapshot.set_id(InstructionsToSnapshotId(code));
+
+  // Record the end state on the first CPU only.
+  SnapMaker::Options options = DefaultSnapMakerOptionsForTest();
+  options.cpu = cpus[0];
+  SnapMaker snap_maker(options);
+  ASSERT_OK_AND_ASSIGN(Snapshot made, snap_maker.Make(snapshot));
+  ASSERT_OK_AND_ASSIGN(Snapshot recorded, snap_maker.RecordEndState(made));
+  ASSERT_OK(snap_maker.VerifyPlaysDeterministically(recorded));
+
+  ASSERT_OK_AND_ASSIGN(SnapMaker::CpuVerifyReport report,
+                       snap_maker.VerifyOnCpus(recorded, cpus));
+  EXPECT_FALSE(report.ok()) << report.DebugString();
+  EXPECT_THAT(report.agreeing_cpus, Contains(cpus[0]));
+  for (const auto& divergence : report.divergences) {
+    EXPECT_THAT(divergence.cpus, Not(Contains(cpus[0])));
+  }
+
+  options.verify_cpus = cpus;
+  SnapMaker multi_cpu_snap_maker(options);
+  EXPECT_THAT(multi_cpu_snap_maker.VerifyPlaysDeterministically(recorded),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("diverged")));
+#endif
+}
+
 }  // namespace
 }  // namespace silifuzz
@@ -25,6 +25,7 @@
 #include "./runner/runner_main_options.h"
 #include "./snap/exit_sequence.h"
 #include "./util/arch.h"
+#include "./util/avx.h"
 #include "./util/checks.h"
 #include "./util/misc_util.h"
 #include "./util/reg_group_io.h"
@@ -179,6 +180,16 @@ void RunSnap(const UContextView<Host>& view, const RunnerMainOptions& options,
   }
 
   if (enter_snap_context) {
+#if defined(__x86_64__)
+    // Put zmm16-zmm31 and k0-k7 into their initial configuration. A previous
+    // Snap cannot leak these into this one, and SnapExitImpl() skips saving
+    // them if this Snap does not touch them. The runner is not compiled with
+    // AVX-512, so there is no live AVX-512 state around this call.
+    // RestoreUContextViewNoSyscalls() does not restore these registers.
+    if (HasAVX512Registers()) {
+      ClearAVX512OnlyState();
+    }
+#endif
     RestoreUContextViewNoSyscalls(view);
     __builtin_unreachable();
   }
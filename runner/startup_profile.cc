@@ -0,0 +1,79 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./runner/startup_profile.h"
+
+#include <time.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "third_party/lss/lss/linux_syscall_support.h"
+#include "./util/checks.h"
+#include "./util/itoa.h"
+
+namespace silifuzz {
+
+const char* StartupPhaseFieldName(StartupPhase phase) {
+  switch (phase) {
+    case StartupPhase::kLoadCorpus:
+      return "load_corpus_nanos";
+    case StartupPhase::kPinCpu:
+      return "pin_cpu_nanos";
+    case StartupPhase::kInitSnapExit:
+      return "init_snap_exit_nanos";
+    case StartupPhase::kInitRegisterGroups:
+      return "init_register_groups_nanos";
+    case StartupPhase::kReadProcMaps:
+      return "read_proc_maps_nanos";
+    case StartupPhase::kMapSnaps:
+      return "map_snaps_nanos";
+    case StartupPhase::kVerifyChecksums:
+      return "verify_checksums_nanos";
+    case StartupPhase::kInstallSignalHandlers:
+      return "install_signal_handlers_nanos";
+    case StartupPhase::kNumPhases:
+      break;
+  }
+  LOG_FATAL("Bad StartupPhase ", IntStr(static_cast<int>(phase)));
+}
+
+uint64_t StartupProfile::TotalNanos() const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < kNumStartupPhases; ++i) {
+    total += phase_nanos[i];
+  }
+  return total;
+}
+
+uint64_t MonotonicNanos() {
+  // No vDSO without libc. A clock_gettime() syscall costs well under a
+  // microsecond, which is negligible next to the phases being timed.
+  kernel_timespec tp{0};
+  CHECK_EQ(sys_clock_gettime(CLOCK_MONOTONIC, &tp), 0);
+  return tp.tv_sec * static_cast<uint64_t>(1000000000) + tp.tv_nsec;
+}
+
+void LogStartupProfile(const StartupProfile& profile) {
+  if (!VLOG_IS_ON(1)) return;
+  VLOG_INFO(1, "Startup took ", IntStr(profile.TotalNanos() / 1000), "us for ",
+            IntStr(profile.num_snaps), " snaps with ",
+            IntStr(profile.num_mappings), " mappings");
+  for (size_t i = 0; i < kNumStartupPhases; ++i) {
+    VLOG_INFO(1, "  ", StartupPhaseFieldName(static_cast<StartupPhase>(i)),
+              " = ", IntStr(profile.phase_nanos[i]));
+  }
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,87 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_SILIFUZZ_RUNNER_STARTUP_PROFILE_H_
+#define THIRD_PARTY_SILIFUZZ_RUNNER_STARTUP_PROFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace silifuzz {
+
+// Phases of runner startup, in execution order.
+enum class StartupPhase : int {
+  kLoadCorpus = 0,         // Reading and relocating the corpus.
+  kPinCpu,                 // SetCPUAffinity().
+  kInitSnapExit,           // InitSnapExit().
+  kInitRegisterGroups,     // Register group I/O and checksum setup.
+  kReadProcMaps,           // Parsing /proc/self/maps in MapCorpus().
+  kMapSnaps,               // Mapping Snap memory in MapCorpus().
+  kVerifyChecksums,        // VerifyChecksums(), only in strict mode.
+  kInstallSignalHandlers,  // InstallSigHandler().
+  kNumPhases,
+};
+
+inline constexpr size_t kNumStartupPhases =
+    static_cast<size_t>(StartupPhase::kNumPhases);
+
+// Returns the name of the RunnerStartupProfile proto field for `phase`.
+const char* StartupPhaseFieldName(StartupPhase phase);
+
+// Where runner startup time goes. All times are CLOCK_MONOTONIC nanoseconds.
+struct StartupProfile {
+  uint64_t phase_nanos[kNumStartupPhases];
+
+  // Size of the corpus mapped by MapCorpus().
+  uint64_t num_snaps;
+  uint64_t num_mappings;
+
+  uint64_t TotalNanos() const;
+};
+
+// Returns CLOCK_MONOTONIC time in nanoseconds.
+//
+// This function is async-signal-safe and works without libc.
+uint64_t MonotonicNanos();
+
+// Adds the time between construction and destruction to a phase of a
+// StartupProfile.
+class ScopedStartupPhase {
+ public:
+  ScopedStartupPhase(StartupProfile& profile, StartupPhase phase)
+      : profile_(profile), phase_(phase), start_nanos_(MonotonicNanos()) {}
+
+  ~ScopedStartupPhase() {
+    profile_.phase_nanos[static_cast<size_t>(phase_)] +=
+        MonotonicNanos() - start_nanos_;
+  }
+
+  // Not copyable or moveable -- records exactly once.
+  ScopedStartupPhase(const ScopedStartupPhase&) = delete;
+  ScopedStartupPhase(ScopedStartupPhase&&) = delete;
+  ScopedStartupPhase& operator=(const ScopedStartupPhase&) = delete;
+  ScopedStartupPhase& operator=(ScopedStartupPhase&&) = delete;
+
+ private:
+  StartupProfile& profile_;
+  StartupPhase phase_;
+  uint64_t start_nanos_;
+};
+
+// Logs the breakdown of `profile` at VLOG level 1.
+void LogStartupProfile(const StartupProfile& profile);
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_RUNNER_STARTUP_PROFILE_H_
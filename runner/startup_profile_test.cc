@@ -0,0 +1,76 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./runner/startup_profile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "./util/checks.h"
+#include "./util/nolibc_gunit.h"
+
+namespace silifuzz {
+namespace {
+
+TEST(StartupProfile, MonotonicNanos) {
+  uint64_t before = MonotonicNanos();
+  uint64_t after = MonotonicNanos();
+  CHECK_LE(before, after);
+}
+
+TEST(StartupProfile, ScopedStartupPhase) {
+  StartupProfile profile = {};
+  {
+    ScopedStartupPhase phase(profile, StartupPhase::kMapSnaps);
+    // Make sure some time passes.
+    const uint64_t start = MonotonicNanos();
+    while (MonotonicNanos() == start) {
+    }
+  }
+  const uint64_t first = profile.phase_nanos[static_cast<size_t>(
+      StartupPhase::kMapSnaps)];
+  CHECK_GT(first, 0);
+  CHECK_EQ(profile.TotalNanos(), first);
+
+  // Phases accumulate.
+  { ScopedStartupPhase phase(profile, StartupPhase::kMapSnaps); }
+  CHECK_GE(profile.phase_nanos[static_cast<size_t>(StartupPhase::kMapSnaps)],
+           first);
+  CHECK_EQ(
+      profile.phase_nanos[static_cast<size_t>(StartupPhase::kLoadCorpus)], 0);
+}
+
+TEST(StartupProfile, FieldNames) {
+  for (size_t i = 0; i < kNumStartupPhases; ++i) {
+    const char* name = StartupPhaseFieldName(static_cast<StartupPhase>(i));
+    const size_t len = strlen(name);
+    CHECK_GT(len, 6);
+    CHECK_EQ(strcmp(name + len - 6, "_nanos"), 0);
+    for (size_t j = 0; j < i; ++j) {
+      CHECK_NE(
+          strcmp(name, StartupPhaseFieldName(static_cast<StartupPhase>(j))),
+          0);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace silifuzz
+
+NOLIBC_TEST_MAIN({
+  RUN_TEST(StartupProfile, MonotonicNanos);
+  RUN_TEST(StartupProfile, ScopedStartupPhase);
+  RUN_TEST(StartupProfile, FieldNames);
+})
@@ -147,6 +147,13 @@ class Traversal {
   RelocatableDataBlock::Ref ProcessMemoryBytes(
       PassType pass, const Snapshot::MemoryBytes& memory_bytes);
 
+  // Processes the `pattern_size`-byte pattern at the start of `memory_bytes`
+  // for `pass`. Allocates a deduplicated ref for the pattern in the byte data
+  // block and returns it.
+  RelocatableDataBlock::Ref ProcessPattern(
+      PassType pass, const Snapshot::MemoryBytes& memory_bytes,
+      size_t pattern_size);
+
   // Processes `memory_mappings` for `pass`. Allocates a ref for the
   // elements of the SnapMemoryMapping array and returns it.
   RelocatableDataBlock::Ref ProcessMemoryMappings(
@@ -217,6 +224,15 @@ class Traversal {
   DedupedRefMap byte_data_ref_map_;
   DedupedRefMap fpregs_ref_map_;
   DedupedRefMap gregs_ref_map_;
+
+  // Patterns of pattern runs are short, so they are used directly as keys.
+  absl::flat_hash_map<Snapshot::ByteData, RelocatableDataBlock::Ref>
+      pattern_ref_map_;
+
+  // Number of memory bytes encoded as byte and pattern runs in the current
+  // pass. These are for debugging only.
+  uint64_t num_byte_runs_ = 0;
+  uint64_t num_pattern_runs_ = 0;
 };
 
 template <typename Arch>
@@ -267,6 +283,28 @@ RelocatableDataBlock::Ref Traversal<Arch>::ProcessMemoryBytes(
   return ref;
 }
 
+template <typename Arch>
+RelocatableDataBlock::Ref Traversal<Arch>::ProcessPattern(
+    PassType pass, const Snapshot::MemoryBytes& memory_bytes,
+    size_t pattern_size) {
+  Snapshot::ByteData pattern = memory_bytes.byte_values().substr(
+      0, pattern_size);
+  static constexpr RelocatableDataBlock::Ref kNullRef;
+  auto [it, success] = pattern_ref_map_.try_emplace(pattern, kNullRef);
+  auto&& [unused, ref] = *it;
+  if (!success) {
+    return ref;
+  }
+
+  // Patterns are 8-byte aligned so that they can be expanded and compared a
+  // word at a time.
+  ref = byte_data_block_.Allocate(pattern.size(), sizeof(uint64_t));
+  if (pass == PassType::kGeneration) {
+    memcpy(ref.contents(), pattern.data(), pattern.size());
+  }
+  return ref;
+}
+
 template <typename Arch>
 void Traversal<Arch>::ProcessMemoryMapping(
     PassType pass, const Snapshot::MemoryMapping& memory_mapping,
@@ -324,14 +362,35 @@ void Traversal<Arch>::ProcessAllocated(
   const bool compress_repeating_bytes =
       options_.compress_repeating_bytes &&
       IsRepeatingByteRun(memory_bytes.byte_values());
+  const size_t pattern_size =
+      options_.compress_repeating_bytes && !compress_repeating_bytes
+          ? PatternRunSize(memory_bytes.byte_values())
+          : 0;
   RelocatableDataBlock::Ref byte_values_elements_ref;
-  if (!compress_repeating_bytes) {
+  if (compress_repeating_bytes) {
+    ++num_byte_runs_;
+  } else if (pattern_size > 0) {
+    ++num_pattern_runs_;
+    byte_values_elements_ref = ProcessPattern(pass, memory_bytes, pattern_size);
+  } else {
     byte_values_elements_ref = ProcessMemoryBytes(pass, memory_bytes);
   }
 
   if (pass == PassType::kGeneration) {
     // Construct MemoryBytes in contents buffer.
-    if (compress_repeating_bytes) {
+    if (pattern_size > 0) {
+      new (memory_bytes_ref.contents_as_pointer_of<SnapMemoryBytes>())
+          SnapMemoryBytes{
+              .start_address = memory_bytes.start_address(),
+              .flags = SnapMemoryBytes::kPatternRun,
+              .data{.pattern_run{
+                  .pattern = byte_values_elements_ref
+                                 .load_address_as_pointer_of<const uint8_t>(),
+                  .pattern_size = static_cast<uint32_t>(pattern_size),
+                  .size = static_cast<uint32_t>(memory_bytes.num_bytes()),
+              }},
+          };
+    } else if (compress_repeating_bytes) {
       new (memory_bytes_ref.contents_as_pointer_of<SnapMemoryBytes>())
           SnapMemoryBytes{
               .start_address = memory_bytes.start_address(),
@@ -548,10 +607,13 @@ absl::flat_hash_map<std::string, uint64_t> Traversal<Arch>::Process(
   main_block_.Allocate(page_data_block_);
 
   if (pass == PassType::kGeneration) {
+    // Only corpora that need a newer encoding get a newer format version, so
+    // that the rest stay readable by runners that predate format_version.
+    const uint8_t format_version = num_pattern_runs_ > 0 ? 1 : 0;
     SnapCorpus<Arch>* corpus = new (corpus_ref.contents()) SnapCorpus<Arch>{
         .header =
             {
-                .magic = kSnapCorpusMagic,
+                .magic = SnapCorpusMagicOf(format_version),
                 .header_size = sizeof(SnapCorpusHeader),
                 .checksum = 0,
                 .num_bytes = main_block_.size(),
@@ -560,6 +622,7 @@ absl::flat_hash_map<std::string, uint64_t> Traversal<Arch>::Process(
                 .register_state_type_size =
                     sizeof(typename Snap<Arch>::RegisterState),
                 .architecture_id = static_cast<uint8_t>(Arch::architecture_id),
+                .format_version = format_version,
                 .padding = {},
             },
         .snaps =
@@ -599,6 +662,8 @@ absl::flat_hash_map<std::string, uint64_t> Traversal<Arch>::Process(
       {"fpregs_block", fpregs_block_.size()},
       {"gregs_block", gregs_block_.size()},
       {"page_data_block", page_data_block_.size()},
+      {"num_byte_runs", num_byte_runs_},
+      {"num_pattern_runs", num_pattern_runs_},
   };
   return block_sizes;
 }
@@ -636,6 +701,10 @@ void Traversal<Arch>::PrepareSnapGeneration(char* content_buffer,
   byte_data_ref_map_.clear();
   fpregs_ref_map_.clear();
   gregs_ref_map_.clear();
+  pattern_ref_map_.clear();
+
+  num_byte_runs_ = 0;
+  num_pattern_runs_ = 0;
 }
 
 }  // namespace
@@ -93,7 +93,8 @@ namespace silifuzz {
 //
 // 6. Byte array.
 // Variable-sized part of memory bytes.  These are aligned to 64-bit boundaries
-// to speed up access.
+// to speed up access. Patterns of pattern runs are stored here too, one copy
+// per distinct pattern.
 //
 // 7. String array.
 // Snapshot IDs.
@@ -111,7 +112,8 @@ namespace silifuzz {
 
 // Options passed to relocatable Snap corpus generator.
 struct RelocatableSnapGeneratorOptions {
-  // If true, apply run-length compression to memory bytes data.
+  // If true, apply run-length compression to memory bytes data. Runs of a
+  // single byte value and runs of short multi-byte patterns are compressed.
   bool compress_repeating_bytes = true;
 
   // When present, this map will be populated with various _debug-only_
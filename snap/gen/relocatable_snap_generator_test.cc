@@ -191,6 +191,7 @@ TYPED_TEST(RelocatableSnapGenerator, SupportDirectMMap) {
       ASSERT_EQ(memory_mapping.memory_bytes.size, 1);
       const SnapMemoryBytes& memory_bytes = memory_mapping.memory_bytes[0];
       ASSERT_FALSE(memory_bytes.repeating());
+      ASSERT_FALSE(memory_bytes.pattern_run());
       EXPECT_EQ(
           reinterpret_cast<uintptr_t>(memory_bytes.data.byte_values.elements) %
               4096,
@@ -283,7 +284,7 @@ TYPED_TEST(RelocatableSnapGenerator, DedupeMemoryBytes) {
   int times_seen = 0;
   for (const auto& mapping : snap.memory_mappings) {
     for (const auto& memory_bytes : mapping.memory_bytes) {
-      if (!memory_bytes.repeating() &&
+      if (!memory_bytes.repeating() && !memory_bytes.pattern_run() &&
           memory_bytes.size() == test_byte_data.size() &&
           memcmp(memory_bytes.data.byte_values.elements, test_byte_data.data(),
                  test_byte_data.size()) == 0) {
@@ -296,6 +297,72 @@ TYPED_TEST(RelocatableSnapGenerator, DedupeMemoryBytes) {
   EXPECT_EQ(addresses_seen.size(), 1);
 }
 
+// Test that pages repeating a short pattern are stored as pattern runs sharing
+// a single copy of the pattern.
+TYPED_TEST(RelocatableSnapGenerator, PatternRuns) {
+  Snapshot snapshot =
+      CreateTestSnapshot<TypeParam>(TestSnapshot::kEndsAsExpected);
+
+  const size_t page_size = getpagesize();
+  constexpr size_t kPatternSize = 16;
+  Snapshot::ByteData pattern_page;
+  pattern_page.reserve(page_size);
+  for (size_t i = 0; i < page_size; ++i) {
+    pattern_page.push_back(0x80 + i % kPatternSize);
+  }
+
+  const Snapshot::Address addr1 = 0x6502 * page_size;
+  const Snapshot::Address addr2 = 0x8086 * page_size;
+  for (Snapshot::Address address : {addr1, addr2}) {
+    const MemoryMapping mapping =
+        MemoryMapping::MakeSized(address, page_size, MemoryPerms::R());
+    ASSERT_OK(snapshot.can_add_memory_mapping(mapping));
+    snapshot.add_memory_mapping(mapping);
+    const Snapshot::MemoryBytes memory_bytes(address, pattern_page);
+    ASSERT_OK(snapshot.can_add_memory_bytes(memory_bytes));
+    snapshot.add_memory_bytes(memory_bytes);
+  }
+
+  SnapifyOptions snapify_opts =
+      SnapifyOptions::V2InputRunOpts(snapshot.architecture_id());
+  ASSERT_OK_AND_ASSIGN(auto snapified, Snapify(snapshot, snapify_opts));
+  std::vector<Snapshot> snapified_corpus;
+  snapified_corpus.push_back(std::move(snapified));
+
+  absl::flat_hash_map<std::string, uint64_t> counters;
+  auto relocated_corpus = GenerateRelocatedCorpus<TypeParam>(
+      snapified_corpus, {.counters = &counters});
+  EXPECT_GE(counters["num_pattern_runs"], 2);
+  // Pattern runs need format version 1.
+  EXPECT_EQ(relocated_corpus->header.format_version, 1);
+  EXPECT_EQ(relocated_corpus->header.magic, kVersionedSnapCorpusMagic);
+
+  ASSERT_EQ(relocated_corpus->snaps.size, 1);
+  const Snap<TypeParam>& snap = *relocated_corpus->snaps.at(0);
+  absl::flat_hash_set<const uint8_t*> patterns_seen;
+  int times_seen = 0;
+  for (const auto& mapping : snap.memory_mappings) {
+    for (const auto& memory_bytes : mapping.memory_bytes) {
+      if (memory_bytes.start_address == addr1 ||
+          memory_bytes.start_address == addr2) {
+        ASSERT_TRUE(memory_bytes.pattern_run());
+        EXPECT_EQ(memory_bytes.size(), page_size);
+        EXPECT_EQ(memory_bytes.data.pattern_run.pattern_size, kPatternSize);
+        times_seen++;
+        patterns_seen.insert(memory_bytes.data.pattern_run.pattern);
+      }
+    }
+  }
+  EXPECT_EQ(times_seen, 2);
+  EXPECT_EQ(patterns_seen.size(), 1);
+
+  // Pattern runs expand back to the original bytes.
+  ASSERT_OK_AND_ASSIGN(
+      Snapshot round_trip,
+      SnapToSnapshot(snap, TestSnapshotPlatform<TypeParam>()));
+  EXPECT_EQ(snapified_corpus[0], round_trip);
+}
+
 // Test register memory checksums.
 TYPED_TEST(RelocatableSnapGenerator, RegisterMemoryChecksums) {
   Snapshot snapshot =
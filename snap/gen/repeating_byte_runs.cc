@@ -15,6 +15,8 @@
 #include "./snap/gen/repeating_byte_runs.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <optional>
 #include <string>
 #include <utility>
@@ -36,15 +38,55 @@ using MemoryBytesList = Snapshot::MemoryBytesList;
 
 // Information about a byte run.
 struct ByteRunInfo {
-  size_t offset = 0;       // offset from beginning of original memory bytes
-  size_t size = 0;         // number of bytes in run.
-  bool repeating = false;  // whether all bytes are the same.
+  size_t offset = 0;          // offset from beginning of original memory bytes
+  size_t size = 0;            // number of bytes in run.
+  bool compressible = false;  // whether all bytes are the same or the run
+                              // repeats a pattern.
 };
 
+// Returns the size of the longest run of a pattern in kPatternRunSizes at
+// `offset` in `byte_data`, rounded down to a multiple of the pattern size, or
+// 0 if there is no run of at least kMinPatternRunRepeats copies.
+size_t LongestPatternRunSize(const ByteData& byte_data, size_t offset) {
+  const size_t max_run_size = byte_data.size() - offset;
+  size_t longest_run_size = 0;
+  for (size_t pattern_size : kPatternRunSizes) {
+    if (pattern_size * kMinPatternRunRepeats > max_run_size) break;
+    size_t run_size = pattern_size;
+    while (run_size < max_run_size &&
+           byte_data[offset + run_size] ==
+               byte_data[offset + run_size - pattern_size]) {
+      ++run_size;
+    }
+    run_size -= run_size % pattern_size;
+    if (run_size >= pattern_size * kMinPatternRunRepeats &&
+        run_size > longest_run_size) {
+      longest_run_size = run_size;
+    }
+  }
+  return longest_run_size;
+}
+
 }  // namespace
 
+size_t PatternRunSize(const ByteData& byte_data) {
+  if (byte_data.size() > UINT32_MAX || IsRepeatingByteRun(byte_data)) {
+    return 0;
+  }
+  for (size_t pattern_size : kPatternRunSizes) {
+    if (byte_data.size() < pattern_size * kMinPatternRunRepeats) break;
+    if (byte_data.size() % pattern_size == 0 &&
+        memcmp(byte_data.data(), byte_data.data() + pattern_size,
+               byte_data.size() - pattern_size) == 0) {
+      return pattern_size;
+    }
+  }
+  return 0;
+}
+
 // Split repeating byte runs in `memory_bytes` of size kMinRepeatingByteRunSize
-// or above into their own MemoryBytes objects.
+// or above and pattern runs of kMinPatternRunRepeats or more copies into their
+// own MemoryBytes objects.
 // Returns a list of memory bytes.
 absl::StatusOr<MemoryBytesList> GetRepeatingByteRuns(
     const MemoryBytes& memory_bytes) {
@@ -67,13 +109,20 @@ absl::StatusOr<MemoryBytesList> GetRepeatingByteRuns(
       // Round run size down to a multiple of alignment.
       run_size -= run_size % kByteRunAlignmentSize;
       byte_run_infos.push_back({offset, run_size, true});
+    } else if (const size_t pattern_run_size =
+                   LongestPatternRunSize(byte_data, offset);
+               pattern_run_size > 0) {
+      // A multi-byte pattern repeats. Pattern sizes are multiples of
+      // alignment, so is the run size.
+      run_size = pattern_run_size;
+      byte_run_infos.push_back({offset, run_size, true});
     } else {
       // This run is not compressible. Round run size up to the next multiple of
       // kByteRunAlignmentSize as the remaining bytes up to the alignment
       // boundary are also not compressible.
       run_size += (-run_size) & (kByteRunAlignmentSize - 1);
 
-      if (!byte_run_infos.empty() && !byte_run_infos.back().repeating) {
+      if (!byte_run_infos.empty() && !byte_run_infos.back().compressible) {
         // merge this run into the previous uncompressed run.
         byte_run_infos.back().size += run_size;
       } else {
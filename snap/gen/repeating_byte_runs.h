@@ -35,13 +35,23 @@ static constexpr size_t kMinRepeatingByteRunSize = 16;
 static_assert(kMinRepeatingByteRunSize >= kByteRunAlignmentSize &&
               kMinRepeatingByteRunSize % kByteRunAlignmentSize == 0);
 
-// Splits `memory bytes_list` into 8-byte aligned runs of repeating bytes and
-// non repeating bytes.
+// Sizes of multi-byte patterns, smallest first, whose runs we split out from a
+// MemoryBytes object. All are multiples of kByteRunAlignmentSize so that
+// patterns can be expanded and compared a word at a time.
+inline constexpr size_t kPatternRunSizes[] = {8, 16, 32, 64};
+
+// The minimum number of copies of a pattern in a pattern run. Shorter runs are
+// not worth the indirection.
+static constexpr size_t kMinPatternRunRepeats = 4;
+
+// Splits `memory bytes_list` into 8-byte aligned runs of repeating bytes,
+// repeating multi-byte patterns and non repeating bytes.
 //
 // RETURNS A memory bytes list in ascending order of addresses and with the
 // same contents as `memory_bytes_list`. If there are any repeating byte runs
-// of sizes at least kMinRepeatingByteRunSize, the runs are split into
-// individual elements of the returned list.
+// of sizes at least kMinRepeatingByteRunSize or runs of at least
+// kMinPatternRunRepeats copies of a pattern of one of kPatternRunSizes, the
+// runs are split into individual elements of the returned list.
 //
 // REQUIRES `memory_bytes_list` is sorted by address and all elements are 8-byte
 // aligned.
@@ -61,6 +71,12 @@ bool inline IsRepeatingByteRun(const Snapshot::ByteData& byte_data) {
          MemAllEqualTo(byte_data.data(), byte_data[0], byte_data.size());
 }
 
+// Returns the size of the smallest pattern in kPatternRunSizes that
+// `byte_data` consists of at least kMinPatternRunRepeats copies of, or 0 if
+// `byte_data` should not be encoded as a pattern run. Byte runs are not
+// pattern runs.
+size_t PatternRunSize(const Snapshot::ByteData& byte_data);
+
 }  // namespace silifuzz
 
 #endif  // THIRD_PARTY_SILIFUZZ_SNAP_GEN_REPEATING_BYTE_RUNS_H_
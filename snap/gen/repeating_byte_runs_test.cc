@@ -184,5 +184,60 @@ TEST(RepeatingByteRuns, IsRepeatingByteRun) {
   ByteData repeating(kMinRepeatingByteRunSize, 'D');
   EXPECT_TRUE(IsRepeatingByteRun(repeating));
 }
+
+// Returns `num_copies` copies of a `pattern_size`-byte pattern.
+ByteData PatternRun(size_t pattern_size, size_t num_copies) {
+  ByteData pattern;
+  for (size_t i = 0; i < pattern_size; ++i) {
+    pattern.push_back('a' + i % 26);
+  }
+  ByteData byte_data;
+  for (size_t i = 0; i < num_copies; ++i) {
+    byte_data.append(pattern);
+  }
+  return byte_data;
+}
+
+TEST(RepeatingByteRuns, SplitPatternRuns) {
+  const ByteData pattern_run = PatternRun(32, kMinPatternRunRepeats);
+  const ByteData non_repeating("xx0123456789abxx");
+  constexpr Address addr = 0x1230000;
+
+  const MemoryBytesList expected{
+      MemoryBytes(addr, non_repeating),
+      MemoryBytes(addr + non_repeating.size(), pattern_run),
+      MemoryBytes(addr + non_repeating.size() + pattern_run.size(),
+                  non_repeating),
+  };
+  ByteData byte_data = non_repeating + pattern_run + non_repeating;
+  ASSERT_OK_AND_ASSIGN(auto runs,
+                       GetRepeatingByteRuns(MemoryBytes(addr, byte_data)));
+  EXPECT_EQ(runs, expected);
+}
+
+TEST(RepeatingByteRuns, ShortPatternRunsNotSplit) {
+  const ByteData byte_data = PatternRun(16, kMinPatternRunRepeats - 1);
+  const MemoryBytesList expected{MemoryBytes(0x1230000, byte_data)};
+  EXPECT_THAT(GetRepeatingByteRuns(expected), IsOkAndHolds(expected));
+}
+
+TEST(RepeatingByteRuns, PatternRunSize) {
+  for (size_t pattern_size : kPatternRunSizes) {
+    EXPECT_EQ(PatternRunSize(PatternRun(pattern_size, kMinPatternRunRepeats)),
+              pattern_size);
+    EXPECT_EQ(
+        PatternRunSize(PatternRun(pattern_size, kMinPatternRunRepeats - 1)),
+        0);
+  }
+  // The smallest pattern wins.
+  EXPECT_EQ(PatternRunSize(PatternRun(8, 4 * kMinPatternRunRepeats)), 8);
+
+  ByteData not_repeating = PatternRun(8, kMinPatternRunRepeats);
+  not_repeating.back() = '!';
+  EXPECT_EQ(PatternRunSize(not_repeating), 0);
+
+  // Byte runs are encoded as such.
+  EXPECT_EQ(PatternRunSize(ByteData(64, 'x')), 0);
+}
 }  // namespace
 }  // namespace silifuzz
@@ -30,6 +30,7 @@
 #include "./snap/testing/snap_test_snapshots.h"
 #include "./snap/testing/snap_test_types.h"
 #include "./util/arch.h"
+#include "./util/page_util.h"
 #include "./util/testing/status_macros.h"
 #include "./util/testing/status_matchers.h"
 
@@ -146,6 +147,46 @@ TEST(SnapGenerator, SnapifyMerge) {
             snapified_modified.memory_mappings());
 }
 
+TEST(SnapGenerator, SupportDirectMmapWritable) {
+  Snapshot snapshot = MakeSnapGeneratorTestSnapshot<Host>(
+      SnapGeneratorTestType::kBasicSnapGeneratorTest);
+
+  // Arbitrary address that shouldn't collide with the test snapshot.
+  const Snapshot::Address data_address = 0x90000000ULL;
+  ASSERT_EQ(snapshot.PermsAt(data_address), MemoryPerms::None());
+
+  // A writable page with a compressible run of zeros in its first half.
+  Snapshot::ByteData data(kPageSize, 0);
+  for (size_t i = kPageSize / 2; i < kPageSize; ++i) {
+    data[i] = static_cast<char>(i * 7);
+  }
+  snapshot.add_memory_mapping(Snapshot::MemoryMapping::MakeSized(
+      data_address, kPageSize, MemoryPerms::RW()));
+  snapshot.add_memory_bytes(Snapshot::MemoryBytes(data_address, data));
+
+  auto num_data_memory_bytes = [data_address](const Snapshot& snapified) {
+    int n = 0;
+    for (const auto& memory_bytes : snapified.memory_bytes()) {
+      if (memory_bytes.start_address() >= data_address &&
+          memory_bytes.start_address() < data_address + kPageSize) {
+        ++n;
+      }
+    }
+    return n;
+  };
+
+  SnapifyOptions opts =
+      SnapifyOptions::V2InputRunOpts(snapshot.architecture_id());
+  opts.support_direct_mmap = true;
+  ASSERT_OK_AND_ASSIGN(Snapshot snapified, Snapify(snapshot, opts));
+  // Writable pages are compressed unless asked otherwise.
+  EXPECT_GT(num_data_memory_bytes(snapified), 1);
+
+  opts.support_direct_mmap_writable = true;
+  ASSERT_OK_AND_ASSIGN(snapified, Snapify(snapshot, opts));
+  EXPECT_EQ(num_data_memory_bytes(snapified), 1);
+}
+
 TEST(SnapGenerator, CanSnapify) {
   Snapshot snapshot = MakeSnapGeneratorTestSnapshot<Host>(
       SnapGeneratorTestType::kBasicSnapGeneratorTest);
@@ -33,6 +33,7 @@
 #include "./util/arch.h"
 #include "./util/checks.h"
 #include "./util/itoa.h"
+#include "./util/page_util.h"
 #include "./util/platform.h"
 
 namespace silifuzz {
@@ -79,6 +80,26 @@ bool ShouldCompressNonExecutable(const MemoryState &memory_state,
               .Has(MemoryPerms::kExecutable);
 }
 
+// Like ShouldCompressNonExecutable() but also keeps page-aligned writable bytes
+// uncompressed so that the runner can map them copy-on-write. Writable pages
+// filled with a single byte value, such as zeroed stacks, are still compressed
+// as they are cheaper to memset than to fault in from the corpus.
+bool ShouldCompressNonExecutableOrWritable(const MemoryState &memory_state,
+                                           const Snapshot::MemoryBytes &bytes) {
+  const MemoryPerms perms =
+      memory_state.mapped_memory().PermsAt(bytes.start_address());
+  if (perms.Has(MemoryPerms::kExecutable)) {
+    return false;
+  }
+  if (perms.Has(MemoryPerms::kWritable) &&
+      IsPageAligned(bytes.start_address()) &&
+      IsPageAligned(bytes.num_bytes())) {
+    const std::string &values = bytes.byte_values();
+    return values.find_first_not_of(values[0]) == std::string::npos;
+  }
+  return true;
+}
+
 bool ShouldNeverCompress(const MemoryState &memory_state,
                          const Snapshot::MemoryBytes &bytes) {
   return false;
@@ -122,12 +143,16 @@ absl::StatusOr<Snapshot::MemoryBytesList> SnapifyMemoryByteList(
 // writable bytes from the parent Snapshot.
 absl::Status SnapifyMemoryBytes(Snapshot &snapshot,
                                 const SnapifyOptions &opts) {
-  MemoryState memory_state =
-      MemoryState::MakeInitial(snapshot, MemoryState::kZeroMappedBytes);
+  // Paged storage makes the per-end-state copies below cheap: they share all
+  // pages that the end state does not modify.
+  const MemoryState initial_memory_state = MemoryState::MakeInitial(
+      snapshot, MemoryState::kZeroMappedBytes, MemoryState::kPagedBytes);
 
   CompressionQuery should_compress_initial = &ShouldNeverCompress;
   if (opts.compress_repeating_bytes) {
-    if (opts.support_direct_mmap) {
+    if (opts.support_direct_mmap && opts.support_direct_mmap_writable) {
+      should_compress_initial = &ShouldCompressNonExecutableOrWritable;
+    } else if (opts.support_direct_mmap) {
       should_compress_initial = &ShouldCompressNonExecutable;
     } else {
       should_compress_initial = &ShouldAlwaysCompress;
@@ -136,7 +161,7 @@ absl::Status SnapifyMemoryBytes(Snapshot &snapshot,
 
   ASSIGN_OR_RETURN_IF_NOT_OK(
       Snapshot::MemoryBytesList snapified_memory_bytes_list,
-      SnapifyMemoryByteList(memory_state, should_compress_initial));
+      SnapifyMemoryByteList(initial_memory_state, should_compress_initial));
   RETURN_IF_NOT_OK(
       snapshot.ReplaceMemoryBytes(std::move(snapified_memory_bytes_list)));
 
@@ -145,8 +170,9 @@ absl::Status SnapifyMemoryBytes(Snapshot &snapshot,
 
   for (Snapshot::EndState &end_state : end_states) {
     if (end_state.IsComplete().ok()) {
-      MemoryState memory_state =
-          MemoryState::MakeInitial(snapshot, MemoryState::kZeroMappedBytes);
+      // The initial state of `snapshot` is unchanged by ReplaceMemoryBytes()
+      // above, which only re-fragments the same byte values.
+      MemoryState memory_state = initial_memory_state.Copy();
       // Apply deltas from the current end state.
       memory_state.SetMemoryBytes(end_state.memory_bytes());
 
@@ -60,8 +60,11 @@ struct SnapArray {
 struct SnapMemoryBytes {
   // Flags
   enum {
-    kRepeating = 1 << 0,  // If set, memory bytes are repeating. This
-                          // determines how data below are interpreted.
+    kRepeating = 1 << 0,   // If set, memory bytes are repeating. This
+                           // determines how data below are interpreted.
+    kPatternRun = 1 << 1,  // If set, memory bytes repeat a multi-byte
+                           // pattern. Exclusive with kRepeating. Requires
+                           // format version 1 or later.
   };
 
   // If memory bytes are all the same value, they are stored as
@@ -71,12 +74,29 @@ struct SnapMemoryBytes {
     size_t size;    // number of bytes in run.
   };
 
+  // If memory bytes repeat a short pattern of 8 or more bytes, e.g. a
+  // broadcast vector constant, they are stored as a run of the pattern.
+  struct PatternRun {
+    const uint8_t* pattern;  // 8-byte aligned pattern of pattern_size bytes.
+    uint32_t pattern_size;   // a multiple of 8, at most kMaxPatternSize.
+    uint32_t size;           // number of bytes in run, a multiple of
+                             // pattern_size.
+  };
+
+  // Largest pattern of a PatternRun.
+  static constexpr size_t kMaxPatternSize = 64;
+
   // Tells if memory bytes are repeating.
   bool repeating() const { return (flags & kRepeating) != 0; }
 
+  // Tells if memory bytes are a pattern run.
+  bool pattern_run() const { return (flags & kPatternRun) != 0; }
+
   // Returns byte size of the memory bytes.
   size_t size() const {
-    return repeating() ? data.byte_run.size : data.byte_values.size;
+    if (repeating()) return data.byte_run.size;
+    if (pattern_run()) return data.pattern_run.size;
+    return data.byte_values.size;
   }
 
   // Where `byte_values` start.
@@ -87,12 +107,16 @@ struct SnapMemoryBytes {
 
   union {
     // The memory byte values to exist at start_address. This is set only when
-    // repeating == false.
+    // neither repeating() nor pattern_run() is true.
     SnapArray<uint8_t> byte_values;
 
     // A repeated run of a single byte value at start_address. This is set
     // only when repeating == true.
     ByteRun byte_run;
+
+    // A repeated run of a multi-byte pattern at start_address. This is set
+    // only when pattern_run() == true.
+    PatternRun pattern_run;
   } data;
 };
 
@@ -210,9 +234,25 @@ constexpr T MakeMagic(const char (&data)[sizeof(T)]) {
 
 }  // namespace snap_internal
 
+// Magic of corpora with format_version 0.
 constexpr uint64_t kSnapCorpusMagic = snap_internal::MakeMagic<uint64_t>(
     {'S', 'n', 'a', 'p', 'C', 'o', 'r', 'p'});
 
+// Magic of corpora with format_version 1 or later. Readers that predate
+// format_version only accept kSnapCorpusMagic, so they reject these corpora
+// instead of misreading them.
+constexpr uint64_t kVersionedSnapCorpusMagic =
+    snap_internal::MakeMagic<uint64_t>(
+        {'S', 'n', 'a', 'p', 'C', 'o', 'r', 'V'});
+
+// Latest version of the encoding of Snap data, see
+// SnapCorpusHeader::format_version. Bump when readers of the previous version
+// would misread new corpora, e.g. when adding a SnapMemoryBytes flag.
+//
+// Version 0: the original encoding, without format_version.
+// Version 1: SnapMemoryBytes::kPatternRun.
+constexpr uint8_t kSnapCorpusFormatVersion = 1;
+
 struct SnapCorpusHeader {
   // For checking this is actually a snap corpus.
   uint64_t magic;
@@ -244,10 +284,33 @@ struct SnapCorpusHeader {
   // The runner should check that this equals Host::architecture_id.
   uint8_t architecture_id;
 
+  // The format version the corpus was generated with, at most
+  // kSnapCorpusFormatVersion. This byte was padding before versioning, so
+  // corpora generated before it read as version 0. See
+  // SnapCorpusMagicMatchesFormatVersion().
+  uint8_t format_version;
+
   // Make the unused space in this struct explicit.
-  uint8_t padding[3];
+  uint8_t padding[2];
 };
 
+// Readers check header_size before anything else, so changing the header size
+// makes every existing corpus or reader incompatible.
+static_assert(sizeof(SnapCorpusHeader) == 40);
+
+// Returns the magic of corpora with `format_version`.
+constexpr uint64_t SnapCorpusMagicOf(uint8_t format_version) {
+  return format_version == 0 ? kSnapCorpusMagic : kVersionedSnapCorpusMagic;
+}
+
+// Tells if `header` has a corpus magic consistent with a format version this
+// code can read.
+constexpr bool SnapCorpusMagicMatchesFormatVersion(
+    const SnapCorpusHeader& header) {
+  return header.format_version <= kSnapCorpusFormatVersion &&
+         header.magic == SnapCorpusMagicOf(header.format_version);
+}
+
 template <typename Arch>
 struct SnapCorpus {
   // Should stay at the top of the struct so it's easy to find in the file.
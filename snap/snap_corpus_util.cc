@@ -88,7 +88,8 @@ ArchitectureId CorpusFileArchitecture(const char* filename) {
   SnapCorpusHeader header;
   int bytes_read = read(fd, &header, sizeof(header));
   if (bytes_read == sizeof(header)) {
-    if (header.magic == kSnapCorpusMagic) {
+    if (header.magic == kSnapCorpusMagic ||
+        header.magic == kVersionedSnapCorpusMagic) {
       arch = static_cast<ArchitectureId>(header.architecture_id);
     }
   }
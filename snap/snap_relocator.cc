@@ -158,9 +158,34 @@ SnapRelocatorError SnapRelocator<Arch>::RelocateMemoryBytesArray(
     SnapArray<SnapMemoryBytes>& memory_bytes_array) {
   RETURN_IF_RELOCATION_FAILED(AdjustArray(memory_bytes_array));
   for (SnapMemoryBytes& memory_byte : RelocationIterator(memory_bytes_array)) {
-    if (!memory_byte.repeating()) {
+    // Reject flags we do not understand, e.g. from a newer corpus format,
+    // rather than misinterpreting the data union.
+    const uint8_t flags = read_once(memory_byte.flags);
+    if (flags == SnapMemoryBytes::kRepeating) {
+      // Byte runs have no pointers.
+    } else if (flags == 0) {
       RETURN_IF_RELOCATION_FAILED(
           AdjustPointer(memory_byte.data.byte_values.elements));
+    } else if (flags == SnapMemoryBytes::kPatternRun && format_version_ >= 1) {
+      SnapMemoryBytes::PatternRun& pattern_run = memory_byte.data.pattern_run;
+      const uint32_t pattern_size = read_once(pattern_run.pattern_size);
+      if (pattern_size == 0 || pattern_size % sizeof(uint64_t) != 0 ||
+          pattern_size > SnapMemoryBytes::kMaxPatternSize ||
+          read_once(pattern_run.size) % pattern_size != 0) {
+        return SnapRelocatorError::kBadData;
+      }
+      RETURN_IF_RELOCATION_FAILED(AdjustPointer(pattern_run.pattern));
+      const uintptr_t pattern_address =
+          reinterpret_cast<uintptr_t>(pattern_run.pattern);
+      if (pattern_address % sizeof(uint64_t) != 0) {
+        return SnapRelocatorError::kAlignment;
+      }
+      // The pattern is small so this cannot overflow after AdjustPointer().
+      if (pattern_address + pattern_size > limit_address_) {
+        return SnapRelocatorError::kOutOfBound;
+      }
+    } else {
+      return SnapRelocatorError::kBadData;
     }
   }
   return SnapRelocatorError::kOk;
@@ -184,10 +209,13 @@ SnapRelocatorError SnapRelocator<Arch>::RelocateCorpus(bool verify) {
   SnapCorpus<Arch>& corpus =
       *reinterpret_cast<SnapCorpus<Arch>*>(start_address_);
 
-  // If this constant isn't at the start of the file, it's likely not a corpus.
-  if (corpus.header.magic != kSnapCorpusMagic) {
+  // If neither magic is at the start of the file, it's likely not a corpus.
+  // Otherwise the magic must match the format version, which must be one we
+  // can read. Snap data encoded differently would be misread.
+  if (!SnapCorpusMagicMatchesFormatVersion(corpus.header)) {
     return SnapRelocatorError::kBadData;
   }
+  format_version_ = corpus.header.format_version;
   // If the header isn't the size we expected, this is likely a version
   // mismatch. We check early since the rest of the checks rely on the header
   // having the layout we expect.
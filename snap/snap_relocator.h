@@ -117,6 +117,9 @@ class SnapRelocator {
 
   // Address after the last byte of the corpus.
   uintptr_t limit_address_;
+
+  // SnapCorpusHeader::format_version of the corpus, set by RelocateCorpus().
+  uint8_t format_version_ = 0;
 };
 
 }  // namespace silifuzz
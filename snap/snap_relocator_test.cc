@@ -70,6 +70,21 @@ class SnapRelocatorTest : public ::testing::Test {
     EXPECT_EQ(error, expected_error);
   }
 
+  // Returns the first end state memory bytes of the first Snap in the
+  // unrelocated corpus or nullptr if there is none.
+  SnapMemoryBytes* FirstEndStateMemoryBytes() {
+    // Pointers in an unrelocated corpus are offsets from the start of it.
+    char* const base = relocatable_.get();
+    const Snap<Arch>* const* snaps = reinterpret_cast<const Snap<Arch>* const*>(
+        base + reinterpret_cast<uintptr_t>(corpus_->snaps.elements));
+    const Snap<Arch>* snap = reinterpret_cast<const Snap<Arch>*>(
+        base + reinterpret_cast<uintptr_t>(snaps[0]));
+    if (snap->end_state_memory_bytes.size == 0) return nullptr;
+    return reinterpret_cast<SnapMemoryBytes*>(
+        base +
+        reinterpret_cast<uintptr_t>(snap->end_state_memory_bytes.elements));
+  }
+
   MmappedMemoryPtr<char> relocatable_;  // A relocatable corpus for testing.
   SnapCorpus<Arch>* corpus_;  // relocatable_ cast as a SnapCorpus pointer.
 };
@@ -120,6 +135,84 @@ TYPED_TEST(SnapRelocatorTest, ArrayElementAddressOverflow) {
   this->ExpectRelocationResultIs(SnapRelocatorError::kOutOfBound);
 }
 
+// A corpus without pattern runs keeps format version 0 so that runners that
+// predate format_version can still read it.
+TYPED_TEST(SnapRelocatorTest, Version0Corpus) {
+  EXPECT_EQ(this->corpus_->header.format_version, 0);
+  EXPECT_EQ(this->corpus_->header.magic, kSnapCorpusMagic);
+  SnapRelocatorError error;
+  MmappedMemoryPtr<const SnapCorpus<TypeParam>> corpus =
+      SnapRelocator<TypeParam>::RelocateCorpus(std::move(this->relocatable_),
+                                               true, &error);
+  EXPECT_EQ(error, SnapRelocatorError::kOk);
+}
+
+TYPED_TEST(SnapRelocatorTest, Version1Corpus) {
+  this->corpus_->header.magic = kVersionedSnapCorpusMagic;
+  this->corpus_->header.format_version = 1;
+  this->ExpectRelocationResultIs(SnapRelocatorError::kOk);
+}
+
+TYPED_TEST(SnapRelocatorTest, FormatVersionTooNew) {
+  this->corpus_->header.magic = kVersionedSnapCorpusMagic;
+  this->corpus_->header.format_version = kSnapCorpusFormatVersion + 1;
+  this->ExpectRelocationResultIs(SnapRelocatorError::kBadData);
+}
+
+TYPED_TEST(SnapRelocatorTest, MagicFormatVersionMismatch) {
+  this->corpus_->header.format_version = 1;
+  this->ExpectRelocationResultIs(SnapRelocatorError::kBadData);
+}
+
+TYPED_TEST(SnapRelocatorTest, PatternRunNeedsVersion1) {
+  SnapMemoryBytes* memory_bytes = this->FirstEndStateMemoryBytes();
+  ASSERT_NE(memory_bytes, nullptr);
+  // Repeat the first 8 bytes of the corpus.
+  memory_bytes->flags = SnapMemoryBytes::kPatternRun;
+  memory_bytes->data.pattern_run = {
+      .pattern = nullptr,
+      .pattern_size = 8,
+      .size = 64,
+  };
+  this->ExpectRelocationResultIs(SnapRelocatorError::kBadData);
+}
+
+TYPED_TEST(SnapRelocatorTest, PatternRunInVersion1Corpus) {
+  SnapMemoryBytes* memory_bytes = this->FirstEndStateMemoryBytes();
+  ASSERT_NE(memory_bytes, nullptr);
+  this->corpus_->header.magic = kVersionedSnapCorpusMagic;
+  this->corpus_->header.format_version = 1;
+  // Repeat the first 8 bytes of the corpus.
+  memory_bytes->flags = SnapMemoryBytes::kPatternRun;
+  memory_bytes->data.pattern_run = {
+      .pattern = nullptr,
+      .pattern_size = 8,
+      .size = 64,
+  };
+  this->ExpectRelocationResultIs(SnapRelocatorError::kOk);
+}
+
+TYPED_TEST(SnapRelocatorTest, UnknownMemoryBytesFlags) {
+  SnapMemoryBytes* memory_bytes = this->FirstEndStateMemoryBytes();
+  ASSERT_NE(memory_bytes, nullptr);
+  memory_bytes->flags = 1 << 7;
+  this->ExpectRelocationResultIs(SnapRelocatorError::kBadData);
+}
+
+TYPED_TEST(SnapRelocatorTest, BadPatternRunSize) {
+  SnapMemoryBytes* memory_bytes = this->FirstEndStateMemoryBytes();
+  ASSERT_NE(memory_bytes, nullptr);
+  this->corpus_->header.magic = kVersionedSnapCorpusMagic;
+  this->corpus_->header.format_version = 1;
+  memory_bytes->flags = SnapMemoryBytes::kPatternRun;
+  memory_bytes->data.pattern_run = {
+      .pattern = nullptr,
+      .pattern_size = SnapMemoryBytes::kMaxPatternSize + 8,
+      .size = 4 * (SnapMemoryBytes::kMaxPatternSize + 8),
+  };
+  this->ExpectRelocationResultIs(SnapRelocatorError::kBadData);
+}
+
 }  // namespace
 
 }  // namespace silifuzz
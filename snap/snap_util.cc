@@ -14,6 +14,10 @@
 
 #include "./snap/snap_util.h"
 
+#include <sys/types.h>
+
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "./common/memory_mapping.h"
 #include "./common/memory_perms.h"
@@ -21,7 +25,9 @@
 #include "./common/snapshot_util.h"
 #include "./snap/snap.h"
 #include "./util/checks.h"
+#include "./util/mem_util.h"
 #include "./util/platform.h"
+#include "./util/reg_checksum.h"
 
 namespace silifuzz {
 
@@ -32,6 +38,13 @@ Snapshot::ByteData SnapMemoryBytesData(const SnapMemoryBytes& memory_bytes) {
   if (memory_bytes.repeating()) {
     return Snapshot::ByteData(memory_bytes.size(),
                               memory_bytes.data.byte_run.value);
+  } else if (memory_bytes.pattern_run()) {
+    const SnapMemoryBytes::PatternRun& pattern_run =
+        memory_bytes.data.pattern_run;
+    Snapshot::ByteData byte_data(memory_bytes.size(), 0);
+    MemSetPattern(byte_data.data(), pattern_run.pattern,
+                  pattern_run.pattern_size, byte_data.size());
+    return byte_data;
   } else {
     return Snapshot::ByteData(
         reinterpret_cast<const char*>(memory_bytes.data.byte_values.elements),
@@ -43,7 +56,8 @@ Snapshot::ByteData SnapMemoryBytesData(const SnapMemoryBytes& memory_bytes) {
 
 template <typename Arch>
 absl::StatusOr<Snapshot> SnapToSnapshot(const Snap<Arch>& snap,
-                                        PlatformId platform) {
+                                        PlatformId platform,
+                                        bool keep_register_checksum) {
   CHECK(Arch::architecture_id == PlatformArchitecture(platform));
   Snapshot snapshot(Snapshot::ArchitectureTypeToEnum<Arch>(), snap.id);
   for (const SnapMemoryMapping& m : snap.memory_mappings) {
@@ -74,6 +88,15 @@ absl::StatusOr<Snapshot> SnapToSnapshot(const Snap<Arch>& snap,
     es.add_memory_bytes(mb);
   }
 
+  if (keep_register_checksum &&
+      !snap.end_state_register_checksum.register_groups.Empty()) {
+    uint8_t buffer[256];
+    ssize_t len =
+        Serialize(snap.end_state_register_checksum, buffer, sizeof(buffer));
+    CHECK_NE(len, -1);
+    es.set_register_checksum(
+        Snapshot::ByteData(reinterpret_cast<const char*>(buffer), len));
+  }
   es.add_platform(platform);
 
   RETURN_IF_NOT_OK(snapshot.can_add_expected_end_state(es));
@@ -82,8 +105,10 @@ absl::StatusOr<Snapshot> SnapToSnapshot(const Snap<Arch>& snap,
 }
 
 template absl::StatusOr<Snapshot> SnapToSnapshot(const Snap<X86_64>& snap,
-                                                 PlatformId platform);
+                                                 PlatformId platform,
+                                                 bool keep_register_checksum);
 template absl::StatusOr<Snapshot> SnapToSnapshot(const Snap<AArch64>& snap,
-                                                 PlatformId platform);
+                                                 PlatformId platform,
+                                                 bool keep_register_checksum);
 
 }  // namespace silifuzz
@@ -28,11 +28,15 @@ namespace silifuzz {
 
 // Converts Snap into Snapshot with `platform` representing the platform for the
 // only expected end state in `snap`.
+// If `keep_register_checksum` is true, the end state also gets the register
+// checksum from `snap`, if any. Otherwise it is left empty like in Snapshots
+// that have not been through the fixer.
 // TODO(ksteuck): [impl] There should be metadata in the corpus file or the Snap
 // to describe the target platform.
 template <typename Arch>
 absl::StatusOr<Snapshot> SnapToSnapshot(const Snap<Arch>& snap,
-                                        PlatformId platform);
+                                        PlatformId platform,
+                                        bool keep_register_checksum = false);
 
 }  // namespace silifuzz
 
@@ -16,6 +16,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -23,9 +25,11 @@
 #include "./common/mapped_memory_map.h"
 #include "./common/memory_perms.h"
 #include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
 #include "./common/snapshot_util.h"
 #include "./snap/gen/snap_generator.h"
 #include "./snap/snap.h"
+#include "./snap/testing/snap_test_snapshots.h"
 #include "./util/checks.h"
 #include "./util/mem_util.h"
 #include "./util/reg_checksum.h"
@@ -73,6 +77,20 @@ void VerifyByteRun(absl::string_view name, const Snapshot::ByteData byte_data,
       MemAllEqualTo(byte_data.data(), snap_byte_run.value, snap_byte_run.size));
 }
 
+// Verifies Snapshot::ByteData -> SnapMemoryBytes::PatternRun conversion.
+void VerifyPatternRun(absl::string_view name,
+                      const Snapshot::ByteData byte_data,
+                      const SnapMemoryBytes::PatternRun snap_pattern_run) {
+  VerifySnapField(absl::StrCat(name, " size"), byte_data.size(),
+                  snap_pattern_run.size);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(snap_pattern_run.pattern) %
+               sizeof(uint64_t),
+           0);
+  CHECK(MemAllEqualToPattern(byte_data.data(), snap_pattern_run.pattern,
+                             snap_pattern_run.pattern_size,
+                             snap_pattern_run.size));
+}
+
 // Verifies Snapshot::MemoryBytes -> SnapMemoryBytes conversion.
 void VerifySnapMemoryBytes(const Snapshot::MemoryBytes& memory_bytes,
                            const SnapMemoryBytes& snap_memory_bytes,
@@ -92,6 +110,9 @@ void VerifySnapMemoryBytes(const Snapshot::MemoryBytes& memory_bytes,
   if (snap_memory_bytes.repeating()) {
     VerifyByteRun("byte_run", memory_bytes.byte_values(),
                   snap_memory_bytes.data.byte_run);
+  } else if (snap_memory_bytes.pattern_run()) {
+    VerifyPatternRun("pattern_run", memory_bytes.byte_values(),
+                     snap_memory_bytes.data.pattern_run);
   } else {
     VerifyByteData("byte_values", memory_bytes.byte_values(),
                    snap_memory_bytes.data.byte_values);
@@ -197,4 +218,19 @@ template void VerifyTestSnap(const Snapshot& snapshot,
                              const Snap<AArch64>& snap,
                              const SnapifyOptions& generator_options);
 
+template <typename Arch>
+Snapshot MakeSnapifiedTestSnapshot(TestSnapshot type, const std::string& id) {
+  Snapshot snapshot = MakeSnapRunnerTestSnapshot<Arch>(type);
+  snapshot.set_id(id);
+  absl::StatusOr<Snapshot> snapified = Snapify(
+      snapshot, SnapifyOptions::V2InputRunOpts(snapshot.architecture_id()));
+  CHECK_STATUS(snapified.status());
+  return *std::move(snapified);
+}
+
+template Snapshot MakeSnapifiedTestSnapshot<X86_64>(TestSnapshot type,
+                                                    const std::string& id);
+template Snapshot MakeSnapifiedTestSnapshot<AArch64>(TestSnapshot type,
+                                                     const std::string& id);
+
 }  // namespace silifuzz
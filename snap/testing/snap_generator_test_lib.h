@@ -15,7 +15,10 @@
 #ifndef THIRD_PARTY_SILIFUZZ_SNAP_TESTING_SNAP_GENERATOR_TEST_LIB_H_
 #define THIRD_PARTY_SILIFUZZ_SNAP_TESTING_SNAP_GENERATOR_TEST_LIB_H_
 
+#include <string>
+
 #include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
 #include "./snap/gen/snap_generator.h"
 #include "./snap/snap.h"
 
@@ -26,6 +29,13 @@ namespace silifuzz {
 template <typename Arch>
 void VerifyTestSnap(const Snapshot& snapshot, const Snap<Arch>& snap,
                     const SnapifyOptions& generator_options);
+
+// Returns the Snap runner test snapshot of 'type' renamed to 'id' and
+// snapified for the V2 input runner, ready to go into a relocatable corpus.
+// Dies if the snapshot cannot be snapified.
+template <typename Arch>
+Snapshot MakeSnapifiedTestSnapshot(TestSnapshot type, const std::string& id);
+
 }  // namespace silifuzz
 
 #endif  // THIRD_PARTY_SILIFUZZ_SNAP_TESTING_SNAP_GENERATOR_TEST_LIB_H_
@@ -0,0 +1,262 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/corpus_minimizer_lib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "./common/proxy_config.h"
+#include "./proxies/unicorn_proxy.h"
+#include "./proxies/user_features.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/thread_pool.h"
+
+namespace silifuzz {
+
+SetCoverResult GreedySetCover(const std::vector<CorpusEntryFeatures>& entries) {
+  SetCoverResult result;
+  result.order.reserve(entries.size());
+  absl::flat_hash_set<uint64_t> covered;
+  std::vector<bool> selected(entries.size(), false);
+
+  auto select = [&](size_t index) {
+    selected[index] = true;
+    result.order.push_back(index);
+    covered.insert(entries[index].features.begin(),
+                   entries[index].features.end());
+  };
+  auto uncovered = [&](size_t index) {
+    size_t count = 0;
+    for (uint64_t feature : entries[index].features) {
+      count += !covered.contains(feature);
+    }
+    return count;
+  };
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    CHECK_GT(entries[i].cost, 0);
+    if (entries[i].keep) select(i);
+  }
+
+  // Lazy greedy: the gain of an entry can only shrink as more features are
+  // covered, so a stale gain is an upper bound. An entry whose refreshed gain
+  // still beats every other stale gain is the best pick.
+  struct Candidate {
+    double gain;
+    size_t index;
+    bool operator<(const Candidate& other) const {
+      if (gain != other.gain) return gain < other.gain;
+      return index > other.index;
+    }
+  };
+  std::priority_queue<Candidate> queue;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (selected[i]) continue;
+    size_t count = uncovered(i);
+    if (count > 0) queue.push({count / entries[i].cost, i});
+  }
+  while (!queue.empty()) {
+    Candidate top = queue.top();
+    queue.pop();
+    size_t count = uncovered(top.index);
+    if (count == 0) continue;
+    Candidate refreshed{count / entries[top.index].cost, top.index};
+    if (!queue.empty() && refreshed < queue.top()) {
+      queue.push(refreshed);
+      continue;
+    }
+    select(top.index);
+  }
+  result.num_selected = result.order.size();
+  result.num_features = covered.size();
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (!selected[i]) result.order.push_back(i);
+  }
+  return result;
+}
+
+namespace corpus_minimizer_internal {
+
+std::string FormatCheckpointLine(const CorpusEntryFeatures& entry) {
+  std::string line = absl::StrCat(entry.id, " ", entry.keep ? 1 : 0);
+  for (uint64_t feature : entry.features) {
+    absl::StrAppend(&line, " ", absl::Hex(feature));
+  }
+  return line;
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, CorpusEntryFeatures>>
+ReadCheckpoint(absl::string_view path) {
+  absl::flat_hash_map<std::string, CorpusEntryFeatures> checkpoint;
+  std::ifstream is{std::string(path)};
+  if (!is.is_open()) {
+    return checkpoint;
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+    // A line without its newline was cut short by an interrupted run.
+    if (is.eof()) break;
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (fields.size() < 2 || (fields[1] != "0" && fields[1] != "1")) continue;
+    CorpusEntryFeatures entry;
+    entry.id = std::string(fields[0]);
+    entry.keep = fields[1] == "1";
+    bool ok = true;
+    for (size_t i = 2; i < fields.size() && ok; ++i) {
+      uint64_t feature;
+      ok = absl::SimpleHexAtoi(fields[i], &feature);
+      entry.features.push_back(feature);
+    }
+    if (ok) checkpoint[entry.id] = std::move(entry);
+  }
+  if (is.bad()) {
+    return absl::InternalError(absl::StrCat("Cannot read ", path));
+  }
+  return checkpoint;
+}
+
+}  // namespace corpus_minimizer_internal
+
+namespace {
+
+// Same size as the arrays in the Centipede proxies.
+struct FeatureBuffer {
+  user_feature_t features[100000];
+};
+
+template <typename Arch>
+CorpusEntryFeatures RunOne(UnicornProxy<Arch>& proxy, FeatureBuffer& buffer,
+                           const CorpusEntry& entry, size_t max_inst_executed) {
+  CorpusEntryFeatures result;
+  result.id = entry.id;
+  absl::Status status = proxy.Run(entry.instructions,
+                                  DEFAULT_FUZZING_CONFIG<Arch>,
+                                  max_inst_executed, buffer.features);
+  // Features are emitted contiguously from the start of the buffer and are
+  // never 0, which is also how Centipede finds them.
+  size_t num_features = 0;
+  while (num_features < std::size(buffer.features) &&
+         buffer.features[num_features] != 0) {
+    ++num_features;
+  }
+  result.features.assign(buffer.features, buffer.features + num_features);
+  std::fill_n(buffer.features, num_features, 0);
+  std::sort(result.features.begin(), result.features.end());
+  result.features.erase(
+      std::unique(result.features.begin(), result.features.end()),
+      result.features.end());
+  if (!status.ok()) {
+    VLOG_INFO(1, entry.id, ": ", status.message());
+    result.keep = true;
+  }
+  return result;
+}
+
+}  // namespace
+
+template <typename Arch>
+absl::StatusOr<std::vector<CorpusEntryFeatures>> CollectProxyFeatures(
+    const std::vector<CorpusEntry>& corpus,
+    const CollectProxyFeaturesOptions& options) {
+  CHECK_GT(options.num_threads, 0);
+  const size_t max_inst_executed = options.max_inst_executed != 0
+                                       ? options.max_inst_executed
+                                       : kUnicornProxyMaxInstExecuted<Arch>;
+  std::vector<CorpusEntryFeatures> result(corpus.size());
+  // Not std::vector<bool>: workers read different elements concurrently.
+  std::vector<char> done(corpus.size(), false);
+  size_t num_resumed = 0;
+
+  std::ofstream checkpoint;
+  if (!options.checkpoint_path.empty()) {
+    ASSIGN_OR_RETURN_IF_NOT_OK(
+        auto previous,
+        corpus_minimizer_internal::ReadCheckpoint(options.checkpoint_path));
+    for (size_t i = 0; i < corpus.size(); ++i) {
+      auto it = previous.find(corpus[i].id);
+      if (it == previous.end()) continue;
+      result[i] = std::move(it->second);
+      done[i] = true;
+      ++num_resumed;
+    }
+    checkpoint.open(options.checkpoint_path, std::ios::app);
+    if (!checkpoint.is_open()) {
+      return absl::InternalError(
+          absl::StrCat("Cannot open ", options.checkpoint_path));
+    }
+    VLOG_INFO(0, "Resumed ", num_resumed, " of ", corpus.size(),
+              " entries from ", options.checkpoint_path);
+  }
+
+  std::atomic<size_t> next_index = 0;
+  absl::Mutex checkpoint_mu;
+  {
+    ThreadPool pool(options.num_threads);
+    for (int t = 0; t < options.num_threads; ++t) {
+      pool.Schedule([&]() {
+        // Proxies and feature buffers are per worker; they are expensive to
+        // set up and not thread-safe.
+        UnicornProxy<Arch> proxy;
+        auto buffer = std::make_unique<FeatureBuffer>();
+        for (size_t i = next_index++; i < corpus.size(); i = next_index++) {
+          if (done[i]) continue;
+          result[i] = RunOne(proxy, *buffer, corpus[i], max_inst_executed);
+          if (checkpoint.is_open()) {
+            std::string line =
+                corpus_minimizer_internal::FormatCheckpointLine(result[i]);
+            absl::MutexLock l(&checkpoint_mu);
+            checkpoint << line << '\n';
+            checkpoint.flush();
+          }
+        }
+      });
+    }
+  }
+
+  if (checkpoint.is_open() && checkpoint.fail()) {
+    return absl::InternalError(
+        absl::StrCat("Cannot write ", options.checkpoint_path));
+  }
+  return result;
+}
+
+template absl::StatusOr<std::vector<CorpusEntryFeatures>>
+CollectProxyFeatures<X86_64>(const std::vector<CorpusEntry>& corpus,
+                             const CollectProxyFeaturesOptions& options);
+template absl::StatusOr<std::vector<CorpusEntryFeatures>>
+CollectProxyFeatures<AArch64>(const std::vector<CorpusEntry>& corpus,
+                              const CollectProxyFeaturesOptions& options);
+
+}  // namespace silifuzz
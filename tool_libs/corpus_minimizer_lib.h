@@ -0,0 +1,110 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Library for coverage-preserving corpus minimization. Features of each
+// corpus entry are computed by replaying its instructions through the same
+// Unicorn proxy Centipede uses. A weighted greedy set cover then picks a
+// subset of entries that covers every feature seen in the whole corpus.
+#ifndef THIRD_PARTY_SILIFUZZ_TOOL_LIBS_CORPUS_MINIMIZER_LIB_H_
+#define THIRD_PARTY_SILIFUZZ_TOOL_LIBS_CORPUS_MINIMIZER_LIB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace silifuzz {
+
+// Features of one corpus entry.
+struct CorpusEntryFeatures {
+  std::string id;
+
+  // Sorted and deduplicated user features emitted by the proxy.
+  std::vector<uint64_t> features;
+
+  // Relative cost of keeping the entry. Must be positive.
+  double cost = 1.0;
+
+  // If true, the entry is selected regardless of its features. Used for
+  // entries the proxy cannot judge, e.g. because Unicorn failed to run them.
+  bool keep = false;
+};
+
+struct SetCoverResult {
+  // Indices of all input entries in priority order. The first `num_selected`
+  // entries cover every feature covered by the input.
+  std::vector<size_t> order;
+  size_t num_selected = 0;
+
+  // Number of distinct features in the input.
+  size_t num_features = 0;
+};
+
+// Computes a weighted greedy set cover of `entries`. Entries with `keep` set
+// come first in input order. After that, the entry with the most uncovered
+// features per unit of cost is picked until all features are covered. Ties
+// are broken by input order so the result is deterministic. Entries that add
+// no new features are appended in input order.
+SetCoverResult GreedySetCover(const std::vector<CorpusEntryFeatures>& entries);
+
+// Input to CollectProxyFeatures().
+struct CorpusEntry {
+  std::string id;
+
+  // Raw instruction bytes, as fed to the proxy by Centipede.
+  std::string instructions;
+};
+
+struct CollectProxyFeaturesOptions {
+  // Number of worker threads, each with its own proxy instance.
+  int num_threads = 1;
+
+  // If not empty, features are appended to this file as entries finish and
+  // entries already recorded in it are not run again. This allows an
+  // interrupted run to be resumed.
+  std::string checkpoint_path;
+
+  // Instruction budget per entry. 0 means the budget of the Centipede proxy.
+  size_t max_inst_executed = 0;
+};
+
+// Replays every entry of `corpus` through UnicornProxy<Arch> and returns
+// their features in the same order as `corpus`. Entries on which the proxy
+// reports an error have `keep` set.
+template <typename Arch>
+absl::StatusOr<std::vector<CorpusEntryFeatures>> CollectProxyFeatures(
+    const std::vector<CorpusEntry>& corpus,
+    const CollectProxyFeaturesOptions& options);
+
+namespace corpus_minimizer_internal {
+
+// Checkpoint format: one text line per entry, holding the id, the `keep`
+// bit and the features in hex separated by spaces.
+std::string FormatCheckpointLine(const CorpusEntryFeatures& entry);
+
+// Reads a checkpoint file. Truncated or otherwise malformed lines, as left
+// by an interrupted run, are ignored. A missing file is an empty checkpoint.
+absl::StatusOr<absl::flat_hash_map<std::string, CorpusEntryFeatures>>
+ReadCheckpoint(absl::string_view path);
+
+}  // namespace corpus_minimizer_internal
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_TOOL_LIBS_CORPUS_MINIMIZER_LIB_H_
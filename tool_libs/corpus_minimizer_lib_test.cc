@@ -0,0 +1,135 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/corpus_minimizer_lib.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "./util/arch.h"
+#include "./util/path_util.h"
+#include "./util/testing/status_macros.h"
+
+namespace silifuzz {
+namespace {
+
+using corpus_minimizer_internal::FormatCheckpointLine;
+using corpus_minimizer_internal::ReadCheckpoint;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+CorpusEntryFeatures Entry(const std::string& id,
+                          std::vector<uint64_t> features, double cost = 1.0) {
+  return {.id = id, .features = std::move(features), .cost = cost};
+}
+
+TEST(GreedySetCover, PicksLargestFirst) {
+  std::vector<CorpusEntryFeatures> entries = {
+      Entry("a", {1, 2}),
+      Entry("b", {1, 2, 3, 4}),
+      Entry("c", {4, 5}),
+      Entry("d", {3}),
+  };
+  SetCoverResult result = GreedySetCover(entries);
+  EXPECT_EQ(result.num_features, 5);
+  EXPECT_EQ(result.num_selected, 2);
+  EXPECT_THAT(result.order, ElementsAre(1, 2, 0, 3));
+}
+
+TEST(GreedySetCover, Weighted) {
+  // "b" covers everything but costs more than "a" and "c" together.
+  std::vector<CorpusEntryFeatures> entries = {
+      Entry("a", {1, 2}, 1.0),
+      Entry("b", {1, 2, 3, 4}, 3.0),
+      Entry("c", {3, 4}, 1.0),
+  };
+  SetCoverResult result = GreedySetCover(entries);
+  EXPECT_EQ(result.num_selected, 2);
+  EXPECT_THAT(result.order, ElementsAre(0, 2, 1));
+}
+
+TEST(GreedySetCover, KeepAndEmpty) {
+  std::vector<CorpusEntryFeatures> entries = {
+      Entry("a", {1, 2}),
+      Entry("b", {}),
+      Entry("c", {1}),
+  };
+  entries[2].keep = true;
+  SetCoverResult result = GreedySetCover(entries);
+  EXPECT_EQ(result.num_selected, 2);
+  EXPECT_THAT(result.order, ElementsAre(2, 0, 1));
+  EXPECT_THAT(GreedySetCover({}).order, IsEmpty());
+}
+
+TEST(Checkpoint, RoundTripAndTruncation) {
+  ASSERT_OK_AND_ASSIGN(std::string path, CreateTempFile("checkpoint"));
+  CorpusEntryFeatures a = Entry("a", {1, 0xabcdef0123});
+  CorpusEntryFeatures b = Entry("b", {});
+  b.keep = true;
+  {
+    std::ofstream os(path);
+    os << FormatCheckpointLine(a) << '\n'
+       << FormatCheckpointLine(b) << '\n'
+       << "not valid\n"
+       << "c 0 12";  // Truncated by a crash.
+  }
+  ASSERT_OK_AND_ASSIGN(auto checkpoint, ReadCheckpoint(path));
+  EXPECT_EQ(checkpoint.size(), 2);
+  EXPECT_THAT(checkpoint["a"].features, ElementsAre(1, 0xabcdef0123));
+  EXPECT_FALSE(checkpoint["a"].keep);
+  EXPECT_THAT(checkpoint["b"].features, IsEmpty());
+  EXPECT_TRUE(checkpoint["b"].keep);
+  unlink(path.c_str());
+
+  ASSERT_OK_AND_ASSIGN(auto missing, ReadCheckpoint("/does/not/exist"));
+  EXPECT_THAT(missing, IsEmpty());
+}
+
+TEST(CollectProxyFeatures, ResumesFromCheckpoint) {
+  ASSERT_OK_AND_ASSIGN(std::string path, CreateTempFile("checkpoint"));
+  {
+    std::ofstream os(path);
+    os << FormatCheckpointLine(Entry("nop", {42})) << '\n';
+  }
+  std::vector<CorpusEntry> corpus = {
+      {.id = "nop", .instructions = "\x90"},
+      {.id = "xor", .instructions = "\x48\x31\xc0"},  // xor rax, rax
+      {.id = "jmp", .instructions = "\xeb\xfe"},      // jmp .
+  };
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<CorpusEntryFeatures> features,
+      CollectProxyFeatures<X86_64>(
+          corpus, {.num_threads = 2, .checkpoint_path = path}));
+  ASSERT_EQ(features.size(), 3);
+  EXPECT_THAT(features[0].features, ElementsAre(42));
+  EXPECT_EQ(features[1].id, "xor");
+  EXPECT_THAT(features[1].features, Not(IsEmpty()));
+  EXPECT_FALSE(features[1].keep);
+  // Runaway loops are rejected by the proxy.
+  EXPECT_TRUE(features[2].keep);
+
+  ASSERT_OK_AND_ASSIGN(auto checkpoint, ReadCheckpoint(path));
+  EXPECT_EQ(checkpoint.size(), 3);
+  EXPECT_EQ(checkpoint["xor"].features, features[1].features);
+  unlink(path.c_str());
+}
+
+}  // namespace
+}  // namespace silifuzz
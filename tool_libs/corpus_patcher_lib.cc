@@ -0,0 +1,116 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/corpus_patcher_lib.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "./common/snapshot.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/snap.h"
+#include "./snap/snap_util.h"
+#include "./tool_libs/snap_group.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/itoa.h"
+#include "./util/platform.h"
+
+namespace silifuzz {
+
+template <typename Arch>
+absl::StatusOr<CorpusPatchResult> PatchRelocatableCorpus(
+    const SnapCorpus<Arch>& corpus, PlatformId platform,
+    const CorpusPatch& patch, const RelocatableSnapGeneratorOptions& options) {
+  absl::flat_hash_set<std::string> remove_ids(patch.remove_ids.begin(),
+                                              patch.remove_ids.end());
+  for (const std::string& id : remove_ids) {
+    if (corpus.Find(id.c_str()) == nullptr) {
+      return absl::NotFoundError(absl::StrCat("Snap ", id, " not in corpus"));
+    }
+  }
+
+  CorpusPatchResult result;
+  std::vector<Snapshot> snapshots;
+  snapshots.reserve(corpus.snaps.size - remove_ids.size() + patch.add.size());
+  // Use the same policy as PartitionCorpus() so that a patched shard could
+  // have come out of the partitioner.
+  SnapshotGroup group(SnapshotGroup::kAllowWriteConflictsWithSamePerm);
+  for (const Snap<Arch>* snap : corpus.snaps) {
+    if (remove_ids.contains(snap->id)) {
+      ++result.num_removed;
+      continue;
+    }
+    // Keep the register checksum so that kept Snaps round-trip unchanged.
+    ASSIGN_OR_RETURN_IF_NOT_OK(
+        Snapshot snapshot,
+        SnapToSnapshot(*snap, platform, /*keep_register_checksum=*/true));
+    SnapshotGroup::SnapshotSummary summary(snapshot);
+    // Shards that were not built by the partitioner may already contain
+    // overlapping Snaps. Those are kept as is; only additions are checked.
+    if (group.CanAddSnapshot(summary).ok()) {
+      group.AddSnapshot(summary);
+    } else {
+      VLOG_INFO(1, "Kept Snap ", snap->id, " conflicts with other kept Snaps");
+    }
+    snapshots.push_back(std::move(snapshot));
+    ++result.num_kept;
+  }
+
+  absl::flat_hash_set<std::string> ids;
+  for (const Snapshot& snapshot : snapshots) ids.insert(snapshot.id());
+  for (const Snapshot& snapshot : patch.add) {
+    if (snapshot.architecture_id() != Arch::architecture_id) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Snapshot ", snapshot.id(), " is for ",
+                       EnumStr(snapshot.architecture_id()), ", corpus is for ",
+                       Arch::arch_name));
+    }
+    if (snapshot.expected_end_states().size() != 1) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Snapshot ", snapshot.id(), " is not snapified"));
+    }
+    if (!ids.insert(snapshot.id()).second) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Snapshot ", snapshot.id(), " already in corpus"));
+    }
+    SnapshotGroup::SnapshotSummary summary(snapshot);
+    if (absl::Status s = group.CanAddSnapshot(summary); !s.ok()) {
+      VLOG_INFO(1, "Rejecting ", snapshot.id(), ": ", s.message());
+      result.rejected_ids.push_back(snapshot.id());
+      continue;
+    }
+    group.AddSnapshot(summary);
+    snapshots.push_back(snapshot.Copy());
+    ++result.num_added;
+  }
+
+  result.corpus =
+      GenerateRelocatableSnaps(Arch::architecture_id, snapshots, options);
+  return result;
+}
+
+template absl::StatusOr<CorpusPatchResult> PatchRelocatableCorpus(
+    const SnapCorpus<X86_64>& corpus, PlatformId platform,
+    const CorpusPatch& patch, const RelocatableSnapGeneratorOptions& options);
+template absl::StatusOr<CorpusPatchResult> PatchRelocatableCorpus(
+    const SnapCorpus<AArch64>& corpus, PlatformId platform,
+    const CorpusPatch& patch, const RelocatableSnapGeneratorOptions& options);
+
+}  // namespace silifuzz
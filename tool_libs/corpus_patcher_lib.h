@@ -0,0 +1,81 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Library for applying small add/remove edits to a relocatable Snap corpus.
+#ifndef THIRD_PARTY_SILIFUZZ_TOOL_LIBS_CORPUS_PATCHER_LIB_H_
+#define THIRD_PARTY_SILIFUZZ_TOOL_LIBS_CORPUS_PATCHER_LIB_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "./common/snapshot.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/snap.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/platform.h"
+
+namespace silifuzz {
+
+// A set of edits to apply to a corpus shard.
+struct CorpusPatch {
+  // IDs of Snaps to drop from the shard.
+  std::vector<std::string> remove_ids;
+
+  // Snapified snapshots to add to the shard. An added snapshot may reuse the
+  // ID of a removed one, in which case it replaces that Snap.
+  std::vector<Snapshot> add;
+};
+
+struct CorpusPatchResult {
+  // The patched relocatable corpus.
+  MmappedMemoryPtr<char> corpus;
+
+  size_t num_kept = 0;
+  size_t num_removed = 0;
+  size_t num_added = 0;
+
+  // IDs of snapshots in CorpusPatch::add that were not added because their
+  // memory mappings conflict with Snaps already in the shard.
+  std::vector<std::string> rejected_ids;
+};
+
+// Applies `patch` to `corpus` and returns a new relocatable corpus.
+//
+// Snaps that are kept are decoded straight from `corpus` and are never
+// re-made or re-fixed, so the cost is proportional to the size of the shard
+// and not to the cost of the making pipeline. The output is laid out by
+// GenerateRelocatableSnaps(), which deduplicates byte data across kept and
+// added Snaps and recomputes the corpus checksum. Kept Snaps retain their
+// relative order and their end state checksums; added Snaps are appended.
+//
+// Added snapshots must not conflict with the kept Snaps under the same
+// mapping policy the corpus partitioner uses. Conflicting snapshots are
+// skipped and reported in `rejected_ids`.
+//
+// `platform` is the platform the kept Snaps' end states were recorded on.
+//
+// RETURNS NotFound if a removed ID is not in `corpus`, AlreadyExists if an
+// added ID is already in the patched shard and InvalidArgument if an added
+// snapshot is not snapified or is for a different architecture.
+template <typename Arch>
+absl::StatusOr<CorpusPatchResult> PatchRelocatableCorpus(
+    const SnapCorpus<Arch>& corpus, PlatformId platform,
+    const CorpusPatch& patch,
+    const RelocatableSnapGeneratorOptions& options = {});
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_TOOL_LIBS_CORPUS_PATCHER_LIB_H_
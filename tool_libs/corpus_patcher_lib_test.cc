@@ -0,0 +1,198 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/corpus_patcher_lib.h"
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
+#include "./common/snapshot_test_util.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/snap.h"
+#include "./snap/snap_relocator.h"
+#include "./snap/snap_util.h"
+#include "./snap/testing/snap_generator_test_lib.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/reg_checksum.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Sets a made-up register checksum on the only end state of `snapshot`.
+template <typename Arch>
+void SetRegisterChecksum(Snapshot& snapshot) {
+  RegisterChecksum<Arch> register_checksum;
+  register_checksum.register_groups.SetGPR(true);
+  register_checksum.checksum = 0xc0ffee;
+  uint8_t buffer[256];
+  ssize_t len = Serialize(register_checksum, buffer, sizeof(buffer));
+  CHECK_NE(len, -1);
+  Snapshot::EndStateList end_states = snapshot.expected_end_states();
+  CHECK_EQ(end_states.size(), 1);
+  end_states[0].set_register_checksum(
+      Snapshot::ByteData(reinterpret_cast<const char*>(buffer), len));
+  snapshot.set_expected_end_states(end_states);
+}
+
+template <typename Arch>
+MmappedMemoryPtr<const SnapCorpus<Arch>> Relocate(
+    MmappedMemoryPtr<char> relocatable) {
+  SnapRelocatorError error;
+  auto corpus =
+      SnapRelocator<Arch>::RelocateCorpus(std::move(relocatable), true, &error);
+  CHECK(error == SnapRelocatorError::kOk);
+  return corpus;
+}
+
+template <typename Arch>
+MmappedMemoryPtr<const SnapCorpus<Arch>> MakeCorpus(
+    const std::vector<Snapshot>& snapshots) {
+  return Relocate<Arch>(
+      GenerateRelocatableSnaps(Arch::architecture_id, snapshots));
+}
+
+template <typename>
+struct CorpusPatcher : ::testing::Test {};
+using arch_typelist = ::testing::Types<ALL_ARCH_TYPES>;
+TYPED_TEST_SUITE(CorpusPatcher, arch_typelist);
+
+TYPED_TEST(CorpusPatcher, RemoveKeepsOtherSnapsIntact) {
+  std::vector<Snapshot> snapshots;
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<TypeParam>(TestSnapshot::kEndsAsExpected,
+                                           "a"));
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<TypeParam>(TestSnapshot::kSigSegvRead, "b"));
+  SetRegisterChecksum<TypeParam>(snapshots[0]);
+  auto corpus = MakeCorpus<TypeParam>(snapshots);
+
+  CorpusPatch patch;
+  patch.remove_ids.push_back(snapshots[1].id());
+  ASSERT_OK_AND_ASSIGN(
+      CorpusPatchResult result,
+      PatchRelocatableCorpus(*corpus, TestSnapshotPlatform<TypeParam>(),
+                             patch));
+  EXPECT_EQ(result.num_kept, 1);
+  EXPECT_EQ(result.num_removed, 1);
+  EXPECT_EQ(result.num_added, 0);
+
+  auto patched = Relocate<TypeParam>(std::move(result.corpus));
+  ASSERT_EQ(patched->snaps.size, 1);
+  ASSERT_OK_AND_ASSIGN(
+      Snapshot kept,
+      SnapToSnapshot(*patched->snaps.at(0), TestSnapshotPlatform<TypeParam>(),
+                     /*keep_register_checksum=*/true));
+  EXPECT_EQ(kept, snapshots[0]);
+
+  // By default the checksum is not extracted.
+  ASSERT_OK_AND_ASSIGN(
+      Snapshot extracted,
+      SnapToSnapshot(*patched->snaps.at(0), TestSnapshotPlatform<TypeParam>()));
+  EXPECT_TRUE(extracted.expected_end_states()[0].register_checksum().empty());
+}
+
+TYPED_TEST(CorpusPatcher, ReplaceSnap) {
+  std::vector<Snapshot> snapshots;
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<TypeParam>(TestSnapshot::kEndsAsExpected,
+                                           "a"));
+  auto corpus = MakeCorpus<TypeParam>(snapshots);
+
+  CorpusPatch patch;
+  patch.remove_ids.push_back(snapshots[0].id());
+  patch.add.push_back(snapshots[0].Copy());
+  ASSERT_OK_AND_ASSIGN(
+      CorpusPatchResult result,
+      PatchRelocatableCorpus(*corpus, TestSnapshotPlatform<TypeParam>(),
+                             patch));
+  EXPECT_EQ(result.num_kept, 0);
+  EXPECT_EQ(result.num_removed, 1);
+  EXPECT_EQ(result.num_added, 1);
+  EXPECT_THAT(result.rejected_ids, IsEmpty());
+  auto patched = Relocate<TypeParam>(std::move(result.corpus));
+  ASSERT_EQ(patched->snaps.size, 1);
+  EXPECT_EQ(patched->snaps.at(0)->id, snapshots[0].id());
+}
+
+TYPED_TEST(CorpusPatcher, RejectsConflictingAddition) {
+  std::vector<Snapshot> snapshots;
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<TypeParam>(TestSnapshot::kEndsAsExpected,
+                                           "a"));
+  auto corpus = MakeCorpus<TypeParam>(snapshots);
+
+  // A copy of "a" under a different ID overlaps its non-writable code
+  // mapping.
+  CorpusPatch patch;
+  Snapshot conflicting = snapshots[0].Copy();
+  conflicting.set_id("b");
+  patch.add.push_back(std::move(conflicting));
+  ASSERT_OK_AND_ASSIGN(
+      CorpusPatchResult result,
+      PatchRelocatableCorpus(*corpus, TestSnapshotPlatform<TypeParam>(),
+                             patch));
+  EXPECT_EQ(result.num_kept, 1);
+  EXPECT_EQ(result.num_added, 0);
+  EXPECT_THAT(result.rejected_ids, ElementsAre(patch.add[0].id()));
+  auto patched = Relocate<TypeParam>(std::move(result.corpus));
+  EXPECT_EQ(patched->snaps.size, 1);
+}
+
+TYPED_TEST(CorpusPatcher, Errors) {
+  std::vector<Snapshot> snapshots;
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<TypeParam>(TestSnapshot::kEndsAsExpected,
+                                           "a"));
+  auto corpus = MakeCorpus<TypeParam>(snapshots);
+  const PlatformId platform = TestSnapshotPlatform<TypeParam>();
+
+  CorpusPatch unknown_id;
+  unknown_id.remove_ids.push_back("no_such_snap");
+  EXPECT_THAT(PatchRelocatableCorpus(*corpus, platform, unknown_id),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  CorpusPatch duplicate;
+  duplicate.add.push_back(snapshots[0].Copy());
+  EXPECT_THAT(PatchRelocatableCorpus(*corpus, platform, duplicate),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+
+  // Snapified snapshots have exactly one end state.
+  CorpusPatch not_snapified;
+  not_snapified.remove_ids.push_back(snapshots[0].id());
+  Snapshot no_end_state = snapshots[0].Copy();
+  no_end_state.set_expected_end_states({});
+  not_snapified.add.push_back(std::move(no_end_state));
+  EXPECT_THAT(PatchRelocatableCorpus(*corpus, platform, not_snapified),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace silifuzz
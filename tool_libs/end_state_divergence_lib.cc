@@ -0,0 +1,371 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/end_state_divergence_lib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "./common/snapshot.h"
+#include "./snap/snap.h"
+#include "./snap/snap_corpus_util.h"
+#include "./snap/snap_util.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/enum_flag.h"
+#include "./util/itoa.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/platform.h"
+#include "./util/reg_checksum.h"
+#include "./util/thread_pool.h"
+
+namespace silifuzz {
+
+namespace {
+
+// Returns the number of differing bytes between `a` and `b`, counting bytes
+// past the end of the shorter one as differing.
+size_t ByteDataDiffBytes(absl::string_view a, absl::string_view b) {
+  const size_t common = std::min(a.size(), b.size());
+  size_t diff = std::max(a.size(), b.size()) - common;
+  for (size_t i = 0; i < common; ++i) {
+    diff += a[i] != b[i];
+  }
+  return diff;
+}
+
+// Counts bytes of `a` that differ from `b` in `*differing` and bytes of `a`
+// that `b` does not cover in `*uncovered`.
+void OneWayMemoryDiff(const Snapshot::MemoryBytesList& a,
+                      const Snapshot::MemoryBytesList& b, size_t* differing,
+                      size_t* uncovered) {
+  for (const Snapshot::MemoryBytes& x : a) {
+    size_t covered = 0;
+    for (const Snapshot::MemoryBytes& y : b) {
+      const Snapshot::Address start =
+          std::max(x.start_address(), y.start_address());
+      const Snapshot::Address limit =
+          std::min(x.limit_address(), y.limit_address());
+      if (start >= limit) continue;
+      covered += limit - start;
+      *differing += ByteDataDiffBytes(
+          absl::string_view(x.byte_values())
+              .substr(start - x.start_address(), limit - start),
+          absl::string_view(y.byte_values())
+              .substr(start - y.start_address(), limit - start));
+    }
+    *uncovered += x.num_bytes() - covered;
+  }
+}
+
+// Returns true if the serialized Arch register checksums `a` and `b` are both
+// valid and cover the same register groups.
+template <typename Arch>
+bool SameRegisterGroups(const Snapshot::ByteData& a,
+                        const Snapshot::ByteData& b) {
+  RegisterChecksum<Arch> x, y;
+  return Deserialize(reinterpret_cast<const uint8_t*>(a.data()), a.size(),
+                     x) != -1 &&
+         Deserialize(reinterpret_cast<const uint8_t*>(b.data()), b.size(),
+                     y) != -1 &&
+         x.register_groups == y.register_groups;
+}
+
+// Returns true if the register checksums of `a` and `b` can be compared.
+// Platforms checksum different register groups depending on the extensions
+// they support, so checksums over different group sets always differ.
+bool RegisterChecksumsComparable(const Snapshot::EndState& a,
+                                 const Snapshot::EndState& b) {
+  return a.register_checksum() == b.register_checksum() ||
+         SameRegisterGroups<X86_64>(a.register_checksum(),
+                                    b.register_checksum()) ||
+         SameRegisterGroups<AArch64>(a.register_checksum(),
+                                     b.register_checksum());
+}
+
+// Like EndState::DataEquals() but ignores register checksums that cannot be
+// compared.
+bool SameEndStateData(const Snapshot::EndState& a,
+                      const Snapshot::EndState& b) {
+  if (RegisterChecksumsComparable(a, b)) return a.DataEquals(b);
+  Snapshot::EndState b_without_checksum = b;
+  b_without_checksum.set_register_checksum(a.register_checksum());
+  return a.DataEquals(b_without_checksum);
+}
+
+// Returns the index in `end_states` of the base end state, see
+// SnapEndStateDivergence::platforms.
+size_t BaseEndStateIndex(const std::vector<Snapshot::EndState>& end_states) {
+  size_t base = 0;
+  for (size_t i = 1; i < end_states.size(); ++i) {
+    const std::vector<PlatformId> candidate = end_states[i].platforms();
+    const std::vector<PlatformId> best = end_states[base].platforms();
+    if (candidate.size() > best.size() ||
+        (candidate.size() == best.size() && !candidate.empty() &&
+         (best.empty() || candidate[0] < best[0]))) {
+      base = i;
+    }
+  }
+  return base;
+}
+
+}  // namespace
+
+absl::StatusOr<PlatformShard> ParsePlatformShard(absl::string_view spec) {
+  const size_t colon = spec.find(':');
+  if (colon == absl::string_view::npos || colon + 1 == spec.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Expected <platform>:<path>, got ", spec));
+  }
+  ASSIGN_OR_RETURN_IF_NOT_OK(PlatformId platform,
+                             ParseEnum<PlatformId>(spec.substr(0, colon)));
+  // Only real platforms have an architecture.
+  if (platform == PlatformId::kUndefined || platform >= PlatformId::kAny ||
+      absl::StartsWith(EnumStr(platform), "reserved-")) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Not a real platform: ", EnumStr(platform)));
+  }
+  return PlatformShard{.platform = platform,
+                       .path = std::string(spec.substr(colon + 1))};
+}
+
+size_t SnapEndStateDivergence::max_diff_bytes() const {
+  size_t max_diff = 0;
+  for (const PlatformEndStateDiff& diff : platforms) {
+    max_diff = std::max(max_diff, diff.diff_bytes());
+  }
+  return max_diff;
+}
+
+size_t RegisterDiffBytes(const Snapshot::RegisterState& a,
+                         const Snapshot::RegisterState& b) {
+  return ByteDataDiffBytes(a.gregs(), b.gregs()) +
+         ByteDataDiffBytes(a.fpregs(), b.fpregs());
+}
+
+size_t MemoryDiffBytes(const Snapshot::MemoryBytesList& a,
+                       const Snapshot::MemoryBytesList& b) {
+  size_t differing = 0, uncovered = 0, ignored = 0;
+  OneWayMemoryDiff(a, b, &differing, &uncovered);
+  OneWayMemoryDiff(b, a, &ignored, &uncovered);
+  return differing + uncovered;
+}
+
+SnapEndStateDivergence ComputeEndStateDivergence(
+    absl::string_view id, const std::vector<Snapshot::EndState>& end_states) {
+  SnapEndStateDivergence divergence{.id = std::string(id),
+                                    .num_end_states = end_states.size()};
+  if (end_states.empty()) return divergence;
+  const Snapshot::EndState& base = end_states[BaseEndStateIndex(end_states)];
+  for (const Snapshot::EndState& end_state : end_states) {
+    PlatformEndStateDiff diff;
+    if (&end_state != &base) {
+      diff.endpoint_differs = end_state.endpoint() != base.endpoint();
+      diff.register_checksum_differs =
+          RegisterChecksumsComparable(base, end_state) &&
+          end_state.register_checksum() != base.register_checksum();
+      diff.register_diff_bytes =
+          RegisterDiffBytes(base.registers(), end_state.registers());
+      diff.memory_diff_bytes =
+          MemoryDiffBytes(base.memory_bytes(), end_state.memory_bytes());
+    }
+    for (PlatformId platform : end_state.platforms()) {
+      diff.platform = platform;
+      divergence.platforms.push_back(diff);
+    }
+  }
+  std::sort(divergence.platforms.begin(), divergence.platforms.end(),
+            [](const PlatformEndStateDiff& a, const PlatformEndStateDiff& b) {
+              return a.platform < b.platform;
+            });
+  return divergence;
+}
+
+template <typename Arch>
+absl::StatusOr<std::vector<SnapEndStateDivergence>> AnalyzeEndStateDivergence(
+    const std::vector<PlatformShard>& shards, int num_threads) {
+  CHECK_GT(num_threads, 0);
+  struct SnapEndState {
+    std::string id;
+    Snapshot::EndState end_state;
+  };
+  std::vector<std::vector<SnapEndState>> result(shards.size());
+  std::vector<absl::Status> status(shards.size());
+
+  auto read_shard =
+      [&](size_t index) -> absl::StatusOr<std::vector<SnapEndState>> {
+    const PlatformShard& shard = shards[index];
+    if (PlatformArchitecture(shard.platform) != Arch::architecture_id) {
+      return absl::InvalidArgumentError(
+          absl::StrCat(EnumStr(shard.platform), " is not a ", Arch::arch_name,
+                       " platform"));
+    }
+    MmappedMemoryPtr<const SnapCorpus<Arch>> corpus = LoadCorpusFromFile<Arch>(
+        shard.path.c_str(), /* preload = */ false);
+    std::vector<SnapEndState> end_states;
+    end_states.reserve(corpus->snaps.size);
+    for (const Snap<Arch>* snap : corpus->snaps) {
+      ASSIGN_OR_RETURN_IF_NOT_OK(
+          Snapshot snapshot,
+          SnapToSnapshot(*snap, shard.platform,
+                         /*keep_register_checksum=*/true));
+      if (snapshot.expected_end_states().size() != 1) {
+        return absl::InternalError(
+            absl::StrCat("Snap ", snap->id, " has ",
+                         snapshot.expected_end_states().size(), " end states"));
+      }
+      end_states.push_back({.id = snap->id,
+                            .end_state = snapshot.expected_end_states()[0]});
+    }
+    return end_states;
+  };
+
+  std::atomic<size_t> next_index = 0;
+  {
+    ThreadPool pool(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&]() {
+        for (size_t i = next_index++; i < shards.size(); i = next_index++) {
+          absl::StatusOr<std::vector<SnapEndState>> end_states = read_shard(i);
+          if (end_states.ok()) {
+            result[i] = *std::move(end_states);
+          } else {
+            status[i] = end_states.status();
+          }
+        }
+      });
+    }
+  }
+
+  // Group distinct end states by Snap ID in shard order.
+  absl::flat_hash_map<std::string, std::vector<Snapshot::EndState>> by_id;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    if (!status[i].ok()) {
+      return absl::Status(
+          status[i].code(),
+          absl::StrCat(shards[i].path, ": ", status[i].message()));
+    }
+    for (SnapEndState& entry : result[i]) {
+      std::vector<Snapshot::EndState>& end_states = by_id[entry.id];
+      auto same = std::find_if(end_states.begin(), end_states.end(),
+                               [&](const Snapshot::EndState& end_state) {
+                                 return SameEndStateData(end_state,
+                                                         entry.end_state);
+                               });
+      if (same == end_states.end()) {
+        end_states.push_back(std::move(entry.end_state));
+      } else {
+        same->add_platform(shards[i].platform);
+      }
+    }
+    result[i].clear();
+  }
+
+  std::vector<SnapEndStateDivergence> divergences;
+  divergences.reserve(by_id.size());
+  for (const auto& [id, end_states] : by_id) {
+    divergences.push_back(ComputeEndStateDivergence(id, end_states));
+  }
+  std::sort(divergences.begin(), divergences.end(),
+            [](const SnapEndStateDivergence& a,
+               const SnapEndStateDivergence& b) {
+              if (a.num_end_states != b.num_end_states) {
+                return a.num_end_states > b.num_end_states;
+              }
+              if (a.max_diff_bytes() != b.max_diff_bytes()) {
+                return a.max_diff_bytes() > b.max_diff_bytes();
+              }
+              return a.id < b.id;
+            });
+  return divergences;
+}
+
+template absl::StatusOr<std::vector<SnapEndStateDivergence>>
+AnalyzeEndStateDivergence<X86_64>(const std::vector<PlatformShard>& shards,
+                                  int num_threads);
+template absl::StatusOr<std::vector<SnapEndStateDivergence>>
+AnalyzeEndStateDivergence<AArch64>(const std::vector<PlatformShard>& shards,
+                                   int num_threads);
+
+std::vector<PlatformDivergenceSummary> SummarizeDivergenceByPlatform(
+    const std::vector<SnapEndStateDivergence>& divergences) {
+  absl::flat_hash_map<PlatformId, PlatformDivergenceSummary> by_platform;
+  for (const SnapEndStateDivergence& divergence : divergences) {
+    for (const PlatformEndStateDiff& diff : divergence.platforms) {
+      PlatformDivergenceSummary& summary = by_platform[diff.platform];
+      summary.platform = diff.platform;
+      ++summary.num_snaps;
+      if (diff.differs()) ++summary.num_divergent;
+      const size_t* limit =
+          std::upper_bound(std::begin(kDivergenceHistogramLimits),
+                           std::end(kDivergenceHistogramLimits),
+                           diff.diff_bytes());
+      ++summary.histogram[limit - std::begin(kDivergenceHistogramLimits)];
+    }
+  }
+  std::vector<PlatformDivergenceSummary> summaries;
+  summaries.reserve(by_platform.size());
+  for (auto& [platform, summary] : by_platform) {
+    summaries.push_back(summary);
+  }
+  std::sort(summaries.begin(), summaries.end(),
+            [](const PlatformDivergenceSummary& a,
+               const PlatformDivergenceSummary& b) {
+              return a.platform < b.platform;
+            });
+  return summaries;
+}
+
+std::string FormatSnapEndStateDivergence(
+    const SnapEndStateDivergence& divergence) {
+  std::vector<std::string> base, diffs;
+  for (const PlatformEndStateDiff& diff : divergence.platforms) {
+    if (!diff.differs()) {
+      base.push_back(EnumStr(diff.platform));
+    } else {
+      diffs.push_back(absl::StrCat(EnumStr(diff.platform), "/",
+                                   diff.register_diff_bytes, "/",
+                                   diff.memory_diff_bytes, "/",
+                                   diff.endpoint_differs ? 1 : 0, "/",
+                                   diff.register_checksum_differs ? 1 : 0));
+    }
+  }
+  auto join = [](const std::vector<std::string>& items) {
+    return items.empty() ? std::string("-") : absl::StrJoin(items, ",");
+  };
+  return absl::StrCat("snap\t", divergence.id, "\t", divergence.num_end_states,
+                      "\t", divergence.max_diff_bytes(), "\t", join(base),
+                      "\t", join(diffs));
+}
+
+std::string FormatPlatformDivergenceSummary(
+    const PlatformDivergenceSummary& summary) {
+  return absl::StrCat("platform\t", EnumStr(summary.platform), "\t",
+                      summary.num_snaps, "\t", summary.num_divergent, "\t",
+                      absl::StrJoin(summary.histogram, ","));
+}
+
+}  // namespace silifuzz
@@ -0,0 +1,155 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Library for finding Snaps whose end states differ between platforms. A
+// relocatable corpus holds the end state of each Snap for one platform, so the
+// analysis reads shards of corpora built for different platforms and groups
+// the end states of each Snap ID. Snaps with more than one distinct end state
+// depend on the microarchitecture and cost a separate end state per platform.
+#ifndef THIRD_PARTY_SILIFUZZ_TOOL_LIBS_END_STATE_DIVERGENCE_LIB_H_
+#define THIRD_PARTY_SILIFUZZ_TOOL_LIBS_END_STATE_DIVERGENCE_LIB_H_
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "./common/snapshot.h"
+#include "./util/platform.h"
+
+namespace silifuzz {
+
+// A corpus shard built for `platform`.
+struct PlatformShard {
+  PlatformId platform = PlatformId::kUndefined;
+  std::string path;
+};
+
+// Parses a "<platform>:<path>" shard spec, e.g. "intel-skylake:/c/shard.0".
+absl::StatusOr<PlatformShard> ParsePlatformShard(absl::string_view spec);
+
+// How the end state of a Snap on `platform` differs from its base end state.
+struct PlatformEndStateDiff {
+  PlatformId platform = PlatformId::kUndefined;
+
+  // True if the end state stops at a different endpoint.
+  bool endpoint_differs = false;
+
+  // True if the register checksums differ, e.g. because extension registers
+  // not present in the register state differ. Only set when both checksums
+  // cover the same register groups; checksums over different groups are
+  // ignored, also when grouping identical end states.
+  bool register_checksum_differs = false;
+
+  // Number of differing bytes in the serialized gregs and fpregs.
+  size_t register_diff_bytes = 0;
+
+  // Number of memory bytes that differ or are only present in one of the end
+  // states.
+  size_t memory_diff_bytes = 0;
+
+  size_t diff_bytes() const { return register_diff_bytes + memory_diff_bytes; }
+
+  bool differs() const {
+    return endpoint_differs || register_checksum_differs || diff_bytes() > 0;
+  }
+};
+
+// End states of one Snap across platforms.
+struct SnapEndStateDivergence {
+  std::string id;
+
+  // Number of distinct end states.
+  size_t num_end_states = 0;
+
+  // One entry per platform the Snap was seen on, ordered by PlatformId.
+  // Platforms sharing the base end state have no differences. The base end
+  // state is the one shared by the most platforms, ties going to the end state
+  // of the lowest PlatformId.
+  std::vector<PlatformEndStateDiff> platforms;
+
+  // Largest PlatformEndStateDiff::diff_bytes() among `platforms`.
+  size_t max_diff_bytes() const;
+};
+
+// Returns the number of differing bytes between register states `a` and `b`.
+// Bytes present in only one of them count as differing.
+size_t RegisterDiffBytes(const Snapshot::RegisterState& a,
+                         const Snapshot::RegisterState& b);
+
+// Returns the number of addresses whose byte differs between `a` and `b` or
+// that only one of them covers. Each list must be disjoint.
+size_t MemoryDiffBytes(const Snapshot::MemoryBytesList& a,
+                       const Snapshot::MemoryBytesList& b);
+
+// Computes the divergence of Snap `id` from its distinct `end_states`. The
+// platforms of each end state tell where it was observed.
+SnapEndStateDivergence ComputeEndStateDivergence(
+    absl::string_view id, const std::vector<Snapshot::EndState>& end_states);
+
+// Loads `shards` using `num_threads` worker threads and returns the
+// divergence of every Snap found in any of them. Snaps with more end states
+// come first, then Snaps with larger max_diff_bytes(), then by ID.
+template <typename Arch>
+absl::StatusOr<std::vector<SnapEndStateDivergence>> AnalyzeEndStateDivergence(
+    const std::vector<PlatformShard>& shards, int num_threads);
+
+// Upper bounds (exclusive) of the diff_bytes() buckets of
+// PlatformDivergenceSummary::histogram. The last bucket is unbounded.
+inline constexpr size_t kDivergenceHistogramLimits[] = {1, 8, 64, 512};
+inline constexpr size_t kNumDivergenceHistogramBuckets =
+    std::size(kDivergenceHistogramLimits) + 1;
+
+// Per-platform statistics over a set of SnapEndStateDivergence.
+struct PlatformDivergenceSummary {
+  PlatformId platform = PlatformId::kUndefined;
+
+  // Number of Snaps seen on `platform`.
+  size_t num_snaps = 0;
+
+  // Number of Snaps whose end state on `platform` differs from the base.
+  size_t num_divergent = 0;
+
+  // Number of Snaps by PlatformEndStateDiff::diff_bytes(). Bucket i counts
+  // values below kDivergenceHistogramLimits[i] and not counted by bucket i-1.
+  std::array<size_t, kNumDivergenceHistogramBuckets> histogram = {};
+};
+
+// Returns the summary of every platform in `divergences` ordered by
+// PlatformId.
+std::vector<PlatformDivergenceSummary> SummarizeDivergenceByPlatform(
+    const std::vector<SnapEndStateDivergence>& divergences);
+
+// Formats `divergence` as a tab-separated line:
+//   snap <id> <num_end_states> <max_diff_bytes> <base platforms> <diffs>
+// <base platforms> is a comma-separated list of platforms with the base end
+// state. <diffs> is a comma-separated list of
+// <platform>/<register_diff_bytes>/<memory_diff_bytes>/<endpoint_differs>/
+// <register_checksum_differs> for the other platforms, with 0 or 1 for the
+// flags. Empty lists are printed as "-".
+std::string FormatSnapEndStateDivergence(
+    const SnapEndStateDivergence& divergence);
+
+// Formats `summary` as a tab-separated line:
+//   platform <platform> <num_snaps> <num_divergent> <histogram>
+// <histogram> is a comma-separated list of bucket counts.
+std::string FormatPlatformDivergenceSummary(
+    const PlatformDivergenceSummary& summary);
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_TOOL_LIBS_END_STATE_DIVERGENCE_LIB_H_
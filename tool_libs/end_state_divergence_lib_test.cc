@@ -0,0 +1,324 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/end_state_divergence_lib.h"
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
+#include "./common/snapshot_test_util.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/testing/snap_generator_test_lib.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/file_util.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/path_util.h"
+#include "./util/platform.h"
+#include "./util/reg_checksum.h"
+#include "./util/reg_group_set.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+Snapshot::EndState MakeEndState(Snapshot::Address endpoint,
+                                const std::string& gregs,
+                                const Snapshot::MemoryBytesList& memory_bytes,
+                                const std::vector<PlatformId>& platforms) {
+  Snapshot::EndState end_state(Snapshot::Endpoint(endpoint),
+                               Snapshot::RegisterState(gregs, "fp"));
+  end_state.add_memory_bytes(memory_bytes);
+  end_state.set_platforms(platforms);
+  return end_state;
+}
+
+// Returns a serialized register checksum of `groups` with `checksum`.
+template <typename Arch>
+std::string SerializedChecksum(const RegisterGroupSet<Arch>& groups,
+                               uint64_t checksum) {
+  RegisterChecksum<Arch> register_checksum;
+  register_checksum.register_groups = groups;
+  register_checksum.checksum = checksum;
+  uint8_t buffer[256];
+  ssize_t len = Serialize(register_checksum, buffer, sizeof(buffer));
+  CHECK_NE(len, -1);
+  return std::string(reinterpret_cast<const char*>(buffer), len);
+}
+
+// Returns the set of general purpose and floating point register groups.
+template <typename Arch>
+RegisterGroupSet<Arch> GPRAndFPR() {
+  RegisterGroupSet<Arch> groups;
+  groups.SetGPR(true);
+  if constexpr (std::is_same_v<Arch, X86_64>) {
+    groups.SetFPRAndSSE(true);
+  } else {
+    groups.SetFPR(true);
+  }
+  return groups;
+}
+
+// Sets the register checksum of the only end state of `snapshot`.
+void SetRegisterChecksum(Snapshot& snapshot, const std::string& checksum) {
+  Snapshot::EndStateList end_states = snapshot.expected_end_states();
+  CHECK_EQ(end_states.size(), 1);
+  end_states[0].set_register_checksum(checksum);
+  snapshot.set_expected_end_states(end_states);
+}
+
+// Writes a relocatable corpus of `snapshots` to a temporary file and returns
+// its path.
+std::string WriteShard(const std::vector<Snapshot>& snapshots) {
+  MmappedMemoryPtr<char> buffer =
+      GenerateRelocatableSnaps(Host::architecture_id, snapshots);
+  absl::StatusOr<std::string> path = CreateTempFile("shard");
+  CHECK_OK(path.status());
+  CHECK(SetContents(*path, {buffer.get(), MmappedMemorySize(buffer)}));
+  return *path;
+}
+
+// Returns the first platform other than `platform` whose architecture is the
+// host architecture iff `host` is true.
+PlatformId OtherPlatform(PlatformId platform, bool host) {
+  for (PlatformId other :
+       {PlatformId::kIntelSkylake, PlatformId::kIntelHaswell,
+        PlatformId::kArmNeoverseN1, PlatformId::kAmpereOne}) {
+    if (other != platform &&
+        (PlatformArchitecture(other) == Host::architecture_id) == host) {
+      return other;
+    }
+  }
+  LOG_FATAL("No other platform");
+}
+
+TEST(EndStateDivergence, ParsePlatformShard) {
+  ASSERT_OK_AND_ASSIGN(PlatformShard shard,
+                       ParsePlatformShard("intel-skylake:/a/b:c"));
+  EXPECT_EQ(shard.platform, PlatformId::kIntelSkylake);
+  EXPECT_EQ(shard.path, "/a/b:c");
+  EXPECT_THAT(ParsePlatformShard("/a/b"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParsePlatformShard("intel-skylake:"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_FALSE(ParsePlatformShard("no-such-platform:/a").ok());
+  EXPECT_THAT(ParsePlatformShard("ANY-PLATFORM:/a"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(EndStateDivergence, DiffBytes) {
+  EXPECT_EQ(RegisterDiffBytes(Snapshot::RegisterState("abcd", "xy"),
+                              Snapshot::RegisterState("abXd", "xy")),
+            1);
+  EXPECT_EQ(RegisterDiffBytes(Snapshot::RegisterState("ab", "xy"),
+                              Snapshot::RegisterState("abcd", "")),
+            4);
+
+  const Snapshot::MemoryBytesList a = {
+      Snapshot::MemoryBytes(0x1000, "abcd"),
+      Snapshot::MemoryBytes(0x2000, "ef"),
+  };
+  EXPECT_EQ(MemoryDiffBytes(a, a), 0);
+  // One changed byte, two bytes only in `b` and two bytes only in `a`.
+  const Snapshot::MemoryBytesList b = {
+      Snapshot::MemoryBytes(0x1002, "cX"),
+      Snapshot::MemoryBytes(0x1000, "ab"),
+      Snapshot::MemoryBytes(0x3000, "gh"),
+  };
+  EXPECT_EQ(MemoryDiffBytes(a, b), 5);
+  EXPECT_EQ(MemoryDiffBytes(b, a), 5);
+}
+
+TEST(EndStateDivergence, ComputeEndStateDivergence) {
+  const Snapshot::MemoryBytesList memory = {
+      Snapshot::MemoryBytes(0x1000, "abcd")};
+  const Snapshot::MemoryBytesList other_memory = {
+      Snapshot::MemoryBytes(0x1000, "aXcd")};
+  std::vector<Snapshot::EndState> end_states = {
+      MakeEndState(0x10, "gregs", other_memory, {PlatformId::kIntelHaswell}),
+      MakeEndState(0x10, "gregs", memory,
+                   {PlatformId::kIntelSkylake, PlatformId::kAmdRome}),
+      MakeEndState(0x20, "GREGS", memory, {PlatformId::kIntelIcelake}),
+  };
+  SnapEndStateDivergence divergence =
+      ComputeEndStateDivergence("snap", end_states);
+  EXPECT_EQ(divergence.id, "snap");
+  EXPECT_EQ(divergence.num_end_states, 3);
+  ASSERT_THAT(divergence.platforms, SizeIs(4));
+  EXPECT_EQ(divergence.max_diff_bytes(), 5);
+  EXPECT_EQ(FormatSnapEndStateDivergence(divergence),
+            "snap\tsnap\t3\t5\tintel-skylake,amd-rome\t"
+            "intel-haswell/0/1/0/0,intel-icelake/5/0/1/0");
+
+  // The base end state is the one shared by most platforms.
+  for (const PlatformEndStateDiff& diff : divergence.platforms) {
+    EXPECT_EQ(diff.differs(), diff.platform == PlatformId::kIntelHaswell ||
+                                  diff.platform == PlatformId::kIntelIcelake)
+        << EnumStr(diff.platform);
+  }
+
+  // Ties go to the end state of the lowest PlatformId.
+  end_states.pop_back();
+  end_states[1].set_platforms({PlatformId::kAmdRome});
+  divergence = ComputeEndStateDivergence("snap", end_states);
+  EXPECT_EQ(FormatSnapEndStateDivergence(divergence),
+            "snap\tsnap\t2\t1\tintel-haswell\tamd-rome/0/1/0/0");
+}
+
+TEST(EndStateDivergence, SummarizeDivergenceByPlatform) {
+  std::vector<SnapEndStateDivergence> divergences = {
+      {.id = "a",
+       .num_end_states = 2,
+       .platforms = {{.platform = PlatformId::kIntelSkylake},
+                     {.platform = PlatformId::kIntelHaswell,
+                      .register_diff_bytes = 8,
+                      .memory_diff_bytes = 100}}},
+      {.id = "b",
+       .num_end_states = 2,
+       .platforms = {{.platform = PlatformId::kIntelSkylake},
+                     {.platform = PlatformId::kIntelHaswell,
+                      .endpoint_differs = true}}},
+      {.id = "c",
+       .num_end_states = 1,
+       .platforms = {{.platform = PlatformId::kIntelHaswell}}},
+  };
+  std::vector<PlatformDivergenceSummary> summaries =
+      SummarizeDivergenceByPlatform(divergences);
+  ASSERT_THAT(summaries, SizeIs(2));
+  EXPECT_EQ(FormatPlatformDivergenceSummary(summaries[0]),
+            "platform\tintel-skylake\t2\t0\t2,0,0,0,0");
+  EXPECT_EQ(summaries[1].platform, PlatformId::kIntelHaswell);
+  EXPECT_EQ(summaries[1].num_snaps, 3);
+  EXPECT_EQ(summaries[1].num_divergent, 2);
+  EXPECT_THAT(summaries[1].histogram, ElementsAre(2, 0, 0, 1, 0));
+}
+
+TEST(EndStateDivergence, RegisterChecksumGroups) {
+  const Snapshot::MemoryBytesList memory = {
+      Snapshot::MemoryBytes(0x1000, "abcd")};
+  RegisterGroupSet<Host> gpr;
+  gpr.SetGPR(true);
+  std::vector<Snapshot::EndState> end_states = {
+      MakeEndState(0x10, "gregs", memory, {PlatformId::kIntelSkylake}),
+      MakeEndState(0x10, "GREGS", memory, {PlatformId::kIntelHaswell}),
+  };
+  end_states[0].set_register_checksum(SerializedChecksum(gpr, 1));
+  end_states[1].set_register_checksum(SerializedChecksum(gpr, 2));
+  SnapEndStateDivergence divergence =
+      ComputeEndStateDivergence("snap", end_states);
+  ASSERT_THAT(divergence.platforms, SizeIs(2));
+  EXPECT_TRUE(divergence.platforms[1].register_checksum_differs);
+
+  // Checksums over different register groups are not compared.
+  end_states[1].set_register_checksum(
+      SerializedChecksum(GPRAndFPR<Host>(), 2));
+  divergence = ComputeEndStateDivergence("snap", end_states);
+  ASSERT_THAT(divergence.platforms, SizeIs(2));
+  EXPECT_FALSE(divergence.platforms[0].register_checksum_differs);
+  EXPECT_FALSE(divergence.platforms[1].register_checksum_differs);
+  EXPECT_EQ(divergence.platforms[1].register_diff_bytes, 5);
+}
+
+TEST(EndStateDivergence, AnalyzeEndStateDivergence) {
+  // Snap "a" ends differently on the two platforms, "b" does not and "c" is
+  // only in one corpus.
+  const PlatformId platform = TestSnapshotPlatform<Host>();
+  const PlatformId other_platform = OtherPlatform(platform, /*host=*/true);
+  std::vector<Snapshot> snapshots;
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "a"));
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "b"));
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "c"));
+  const std::string shard = WriteShard(snapshots);
+  snapshots.clear();
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kSigSegvRead, "a"));
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "b"));
+  const std::string other_shard = WriteShard(snapshots);
+
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<SnapEndStateDivergence> divergences,
+      AnalyzeEndStateDivergence<Host>(
+          {{.platform = platform, .path = shard},
+           {.platform = other_platform, .path = other_shard}},
+          /* num_threads = */ 2));
+  ASSERT_THAT(divergences, SizeIs(3));
+  EXPECT_EQ(divergences[0].id, "a");
+  EXPECT_EQ(divergences[0].num_end_states, 2);
+  ASSERT_THAT(divergences[0].platforms, SizeIs(2));
+  EXPECT_TRUE(divergences[0].platforms[0].differs() ||
+              divergences[0].platforms[1].differs());
+  EXPECT_EQ(divergences[1].id, "b");
+  EXPECT_EQ(divergences[1].num_end_states, 1);
+  EXPECT_THAT(divergences[1].platforms, SizeIs(2));
+  EXPECT_EQ(divergences[2].id, "c");
+  EXPECT_THAT(divergences[2].platforms, SizeIs(1));
+
+  EXPECT_THAT(
+      AnalyzeEndStateDivergence<Host>(
+          {{.platform = platform, .path = shard},
+           {.platform = OtherPlatform(platform, /*host=*/false),
+            .path = other_shard}},
+          /* num_threads = */ 1),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+// Two platforms that checksum different register groups but otherwise end
+// the same way share one end state.
+TEST(EndStateDivergence, AnalyzeIgnoresRegisterGroupDifferences) {
+  const PlatformId platform = TestSnapshotPlatform<Host>();
+  const PlatformId other_platform = OtherPlatform(platform, /*host=*/true);
+  RegisterGroupSet<Host> gpr;
+  gpr.SetGPR(true);
+  std::vector<Snapshot> snapshots;
+  snapshots.push_back(
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "a"));
+  SetRegisterChecksum(snapshots[0], SerializedChecksum(gpr, 0xc0ffee));
+  const std::string shard = WriteShard(snapshots);
+  SetRegisterChecksum(snapshots[0],
+                      SerializedChecksum(GPRAndFPR<Host>(), 0xc0ffee));
+  const std::string other_shard = WriteShard(snapshots);
+
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<SnapEndStateDivergence> divergences,
+      AnalyzeEndStateDivergence<Host>(
+          {{.platform = platform, .path = shard},
+           {.platform = other_platform, .path = other_shard}},
+          /* num_threads = */ 1));
+  ASSERT_THAT(divergences, SizeIs(1));
+  EXPECT_EQ(divergences[0].num_end_states, 1);
+  ASSERT_THAT(divergences[0].platforms, SizeIs(2));
+  EXPECT_FALSE(divergences[0].platforms[0].differs());
+  EXPECT_FALSE(divergences[0].platforms[1].differs());
+}
+
+}  // namespace
+}  // namespace silifuzz
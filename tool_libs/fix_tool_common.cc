@@ -44,6 +44,12 @@ namespace {
 // Returns the remade snapshot or an error status.
 absl::StatusOr<Snapshot> RemakeAndVerify(const Snapshot& snapshot,
                                          const FixupSnapshotOptions& options) {
+  return MakeSnapshot(snapshot, FixupMakingConfig(options));
+}
+
+}  // namespace
+
+MakingConfig FixupMakingConfig(const FixupSnapshotOptions& options) {
   MakingConfig config = MakingConfig::Default();
   config.runner_path = RunnerLocation();
   config.trace.x86_filter_split_lock = options.x86_filter_split_lock;
@@ -53,12 +59,9 @@ absl::StatusOr<Snapshot> RemakeAndVerify(const Snapshot& snapshot,
   config.trace.expensive_instruction_count_limit =
       options.expensive_instruction_count_limit;
   config.enforce_fuzzing_config = options.enforce_fuzzing_config;
-
-  return MakeSnapshot(snapshot, config);
+  return config;
 }
 
-}  // namespace
-
 bool NormalizeSnapshot(Snapshot& snapshot, FixToolCounters* counters) {
   // If there's a single end state keep it
   bool has_one_endstate = snapshot.expected_end_states().size() == 1 &&
@@ -24,6 +24,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "./common/snapshot.h"
+#include "./runner/make_snapshot.h"
 
 namespace silifuzz {
 namespace fix_tool_internal {
@@ -131,6 +132,9 @@ struct FixupSnapshotOptions {
   int expensive_instruction_count_limit = 0;
 };
 
+// Returns the MakingConfig used by FixupSnapshot() for `options`.
+MakingConfig FixupMakingConfig(const FixupSnapshotOptions& options);
+
 // Fixes up `input` and updates fix tool statistics in `*counters`.
 // If `x86_filter_split_lock` is true, snapshots containing instructions that
 // access memory across cache line boundaries are filtered. This option is
@@ -0,0 +1,274 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/snap_dedup_lib.h"
+
+#include <openssl/sha.h>  // IWYU pragma: keep
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "./common/memory_mapping.h"
+#include "./common/snapshot.h"
+#include "./snap/snap.h"
+#include "./snap/snap_corpus_util.h"
+#include "./snap/snap_util.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/thread_pool.h"
+
+namespace silifuzz {
+
+namespace {
+
+// Builds the byte string that is hashed. Every variable-length item is
+// prefixed by its length so that the encoding is unambiguous.
+class CanonicalWriter {
+ public:
+  void AddTag(char tag) { data_.push_back(tag); }
+
+  void AddU64(uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      data_.push_back(static_cast<char>(value >> (8 * i)));
+    }
+  }
+
+  void AddBytes(absl::string_view bytes) {
+    AddU64(bytes.size());
+    data_.append(bytes.data(), bytes.size());
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+// Merges `memory_bytes` into sorted maximal contiguous ranges.
+Snapshot::MemoryBytesList Canonicalize(
+    const Snapshot::MemoryBytesList& memory_bytes) {
+  Snapshot::MemoryBytesList sorted = memory_bytes;
+  std::sort(sorted.begin(), sorted.end());
+  Snapshot::MemoryBytesList merged;
+  for (Snapshot::MemoryBytes& bytes : sorted) {
+    if (!merged.empty() &&
+        merged.back().limit_address() == bytes.start_address()) {
+      merged.back().mutable_byte_values()->append(bytes.byte_values());
+    } else {
+      merged.push_back(std::move(bytes));
+    }
+  }
+  return merged;
+}
+
+// Drops the parts of `memory_bytes` that fall in [start, limit).
+Snapshot::MemoryBytesList Exclude(Snapshot::MemoryBytesList memory_bytes,
+                                  Snapshot::Address start,
+                                  Snapshot::Address limit) {
+  Snapshot::MemoryBytesList result;
+  for (Snapshot::MemoryBytes& bytes : memory_bytes) {
+    if (bytes.limit_address() <= start || bytes.start_address() >= limit) {
+      result.push_back(std::move(bytes));
+      continue;
+    }
+    if (bytes.start_address() < start) {
+      result.push_back(bytes.Range(bytes.start_address(), start));
+    }
+    if (bytes.limit_address() > limit) {
+      result.push_back(bytes.Range(limit, bytes.limit_address()));
+    }
+  }
+  return result;
+}
+
+void AddMemoryBytes(const Snapshot::MemoryBytesList& memory_bytes,
+                    CanonicalWriter& writer) {
+  writer.AddU64(memory_bytes.size());
+  for (const Snapshot::MemoryBytes& bytes : memory_bytes) {
+    writer.AddU64(bytes.start_address());
+    writer.AddBytes(bytes.byte_values());
+  }
+}
+
+void AddRegisters(const Snapshot::RegisterState& registers,
+                  CanonicalWriter& writer) {
+  writer.AddBytes(registers.gregs());
+  writer.AddBytes(registers.fpregs());
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> SemanticSnapshotFingerprint(
+    const Snapshot& snapshot) {
+  if (snapshot.expected_end_states().size() != 1) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(snapshot.id(), ": expected exactly one end state, got ",
+                     snapshot.expected_end_states().size()));
+  }
+  const Snapshot::EndState& end_state = snapshot.expected_end_states()[0];
+  const Snapshot::Endpoint& endpoint = end_state.endpoint();
+
+  CanonicalWriter writer;
+  writer.AddTag('A');
+  writer.AddU64(static_cast<uint64_t>(snapshot.architecture_id()));
+
+  std::vector<MemoryMapping> mappings = snapshot.memory_mappings();
+  std::sort(mappings.begin(), mappings.end(),
+            [](const MemoryMapping& a, const MemoryMapping& b) {
+              return a.start_address() < b.start_address();
+            });
+  writer.AddTag('M');
+  writer.AddU64(mappings.size());
+  for (const MemoryMapping& mapping : mappings) {
+    writer.AddU64(mapping.start_address());
+    writer.AddU64(mapping.num_bytes());
+    writer.AddBytes(mapping.perms().ToString());
+  }
+
+  Snapshot::MemoryBytesList memory_bytes =
+      Canonicalize(snapshot.memory_bytes());
+  if (endpoint.type() == Snapshot::Endpoint::kInstruction) {
+    const Snapshot::Address end_address = endpoint.instruction_address();
+    for (const MemoryMapping& mapping : mappings) {
+      if (mapping.perms().Has(MemoryPerms::kExecutable) &&
+          mapping.start_address() <= end_address &&
+          end_address < mapping.limit_address()) {
+        memory_bytes =
+            Exclude(std::move(memory_bytes), end_address,
+                    mapping.limit_address());
+      }
+    }
+  }
+  writer.AddTag('B');
+  AddMemoryBytes(memory_bytes, writer);
+  writer.AddTag('R');
+  AddRegisters(snapshot.registers(), writer);
+
+  writer.AddTag('E');
+  writer.AddU64(static_cast<uint64_t>(endpoint.type()));
+  if (endpoint.type() == Snapshot::Endpoint::kInstruction) {
+    writer.AddU64(endpoint.instruction_address());
+  } else {
+    writer.AddU64(static_cast<uint64_t>(endpoint.sig_num()));
+    writer.AddU64(static_cast<uint64_t>(endpoint.sig_cause()));
+    writer.AddU64(endpoint.sig_address());
+    writer.AddU64(endpoint.sig_instruction_address());
+  }
+  AddRegisters(end_state.registers(), writer);
+  AddMemoryBytes(Canonicalize(end_state.memory_bytes()), writer);
+
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(writer.data().data()),
+         writer.data().size(), digest);
+  return absl::BytesToHexString(
+      {reinterpret_cast<const char*>(digest), sizeof(digest)});
+}
+
+std::vector<DuplicateGroup> FindDuplicateSnaps(
+    const std::vector<std::vector<SnapFingerprint>>& shards) {
+  std::vector<DuplicateGroup> groups;
+  // Maps a digest to its index in `groups`.
+  absl::flat_hash_map<std::string, size_t> group_index;
+  for (size_t shard = 0; shard < shards.size(); ++shard) {
+    for (const SnapFingerprint& snap : shards[shard]) {
+      SnapLocation location{.shard_index = shard, .id = snap.id};
+      auto [it, inserted] = group_index.try_emplace(snap.digest, groups.size());
+      if (inserted) {
+        groups.push_back({.digest = snap.digest, .keep = std::move(location)});
+      } else {
+        groups[it->second].duplicates.push_back(std::move(location));
+      }
+    }
+  }
+  groups.erase(std::remove_if(groups.begin(), groups.end(),
+                              [](const DuplicateGroup& group) {
+                                return group.duplicates.empty();
+                              }),
+               groups.end());
+  return groups;
+}
+
+template <typename Arch>
+absl::StatusOr<std::vector<std::vector<SnapFingerprint>>> FingerprintShards(
+    const std::vector<std::string>& shard_paths, PlatformId platform,
+    int num_threads) {
+  CHECK_GT(num_threads, 0);
+  std::vector<std::vector<SnapFingerprint>> result(shard_paths.size());
+  std::vector<absl::Status> status(shard_paths.size());
+
+  auto fingerprint_shard =
+      [&](size_t index) -> absl::StatusOr<std::vector<SnapFingerprint>> {
+    MmappedMemoryPtr<const SnapCorpus<Arch>> corpus = LoadCorpusFromFile<Arch>(
+        shard_paths[index].c_str(), /* preload = */ false);
+    std::vector<SnapFingerprint> fingerprints;
+    fingerprints.reserve(corpus->snaps.size);
+    for (const Snap<Arch>* snap : corpus->snaps) {
+      ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot snapshot,
+                                 SnapToSnapshot(*snap, platform));
+      ASSIGN_OR_RETURN_IF_NOT_OK(std::string digest,
+                                 SemanticSnapshotFingerprint(snapshot));
+      fingerprints.push_back({.id = snap->id, .digest = std::move(digest)});
+    }
+    return fingerprints;
+  };
+
+  std::atomic<size_t> next_index = 0;
+  {
+    ThreadPool pool(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&]() {
+        for (size_t i = next_index++; i < shard_paths.size();
+             i = next_index++) {
+          absl::StatusOr<std::vector<SnapFingerprint>> fingerprints =
+              fingerprint_shard(i);
+          if (fingerprints.ok()) {
+            result[i] = *std::move(fingerprints);
+          } else {
+            status[i] = fingerprints.status();
+          }
+        }
+      });
+    }
+  }
+
+  for (size_t i = 0; i < shard_paths.size(); ++i) {
+    if (!status[i].ok()) {
+      return absl::Status(
+          status[i].code(),
+          absl::StrCat(shard_paths[i], ": ", status[i].message()));
+    }
+  }
+  return result;
+}
+
+template absl::StatusOr<std::vector<std::vector<SnapFingerprint>>>
+FingerprintShards<X86_64>(const std::vector<std::string>& shard_paths,
+                          PlatformId platform, int num_threads);
+template absl::StatusOr<std::vector<std::vector<SnapFingerprint>>>
+FingerprintShards<AArch64>(const std::vector<std::string>& shard_paths,
+                           PlatformId platform, int num_threads);
+
+}  // namespace silifuzz
@@ -0,0 +1,85 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Library for finding Snaps that are semantically identical, i.e. run the
+// same code from the same initial state to the same end state, but have
+// different IDs. Snap IDs are hashes of the raw instruction bytes, so
+// snapshots that differ only in bytes past their endpoint get different IDs
+// and are run as separate Snaps, often in different shards.
+#ifndef THIRD_PARTY_SILIFUZZ_TOOL_LIBS_SNAP_DEDUP_LIB_H_
+#define THIRD_PARTY_SILIFUZZ_TOOL_LIBS_SNAP_DEDUP_LIB_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "./common/snapshot.h"
+#include "./util/platform.h"
+
+namespace silifuzz {
+
+// Returns the hex SHA-256 digest of the canonical form of `snapshot`.
+//
+// The canonical form consists of the memory mappings, the initial registers
+// and memory contents and the endpoint, registers and memory contents of the
+// end state. The snapshot ID, trace data and register checksums are not
+// part of it. Memory contents are merged into maximal contiguous ranges so
+// that the way they are split does not matter. If the endpoint is an
+// instruction address, the bytes from the endpoint to the end of the
+// executable mapping containing it are left out: they are padding or the
+// exit sequence and never run.
+//
+// RETURNS InvalidArgument if `snapshot` does not have exactly one expected
+// end state.
+absl::StatusOr<std::string> SemanticSnapshotFingerprint(
+    const Snapshot& snapshot);
+
+// A Snap ID with its semantic fingerprint.
+struct SnapFingerprint {
+  std::string id;
+  std::string digest;
+};
+
+// Where a Snap lives in a multi-shard corpus.
+struct SnapLocation {
+  size_t shard_index = 0;
+  std::string id;
+};
+
+// Snaps sharing the same fingerprint. `keep` is the first Snap in shard
+// order and then in Snap order; `duplicates` are the rest in the same order.
+struct DuplicateGroup {
+  std::string digest;
+  SnapLocation keep;
+  std::vector<SnapLocation> duplicates;
+};
+
+// Groups the Snaps of `shards`, indexed by shard, by fingerprint. Only groups
+// with duplicates are returned, ordered by the location of their kept Snap.
+std::vector<DuplicateGroup> FindDuplicateSnaps(
+    const std::vector<std::vector<SnapFingerprint>>& shards);
+
+// Loads the relocatable corpus shards in `shard_paths` and fingerprints all
+// of their Snaps using end states recorded on `platform`. Shards are
+// processed by `num_threads` worker threads. The result is indexed like
+// `shard_paths` and lists Snaps in shard order.
+template <typename Arch>
+absl::StatusOr<std::vector<std::vector<SnapFingerprint>>> FingerprintShards(
+    const std::vector<std::string>& shard_paths, PlatformId platform,
+    int num_threads);
+
+}  // namespace silifuzz
+
+#endif  // THIRD_PARTY_SILIFUZZ_TOOL_LIBS_SNAP_DEDUP_LIB_H_
@@ -0,0 +1,202 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./tool_libs/snap_dedup_lib.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "./common/memory_perms.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_test_enum.h"
+#include "./common/snapshot_test_util.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/testing/snap_generator_test_lib.h"
+#include "./snap/testing/snap_test_snapshots.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/file_util.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/path_util.h"
+#include "./util/testing/status_macros.h"
+#include "./util/testing/status_matchers.h"
+
+namespace silifuzz {
+namespace {
+
+using silifuzz::testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+std::string Fingerprint(const Snapshot& snapshot) {
+  absl::StatusOr<std::string> digest = SemanticSnapshotFingerprint(snapshot);
+  CHECK_OK(digest.status());
+  return *std::move(digest);
+}
+
+// Returns the executable mapping containing the instruction endpoint.
+MemoryMapping CodeMapping(const Snapshot& snapshot) {
+  const Snapshot::Address end_address =
+      snapshot.expected_end_states()[0].endpoint().instruction_address();
+  for (const MemoryMapping& mapping : snapshot.memory_mappings()) {
+    if (mapping.perms().Has(MemoryPerms::kExecutable) &&
+        mapping.start_address() <= end_address &&
+        end_address < mapping.limit_address()) {
+      return mapping;
+    }
+  }
+  LOG_FATAL("No code mapping");
+}
+
+// Returns `snapshot` with the byte at `address` flipped.
+Snapshot FlipByte(const Snapshot& snapshot, Snapshot::Address address) {
+  Snapshot copy = snapshot.Copy();
+  Snapshot::MemoryBytesList memory_bytes = copy.memory_bytes();
+  bool found = false;
+  for (Snapshot::MemoryBytes& bytes : memory_bytes) {
+    if (bytes.start_address() <= address && address < bytes.limit_address()) {
+      (*bytes.mutable_byte_values())[address - bytes.start_address()] ^= 0xff;
+      found = true;
+    }
+  }
+  CHECK(found);
+  CHECK_OK(copy.ReplaceMemoryBytes(std::move(memory_bytes)));
+  return copy;
+}
+
+TEST(SnapDedup, IdDoesNotMatter) {
+  Snapshot a =
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "a");
+  Snapshot b =
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "b");
+  EXPECT_EQ(Fingerprint(a), Fingerprint(b));
+  EXPECT_EQ(Fingerprint(a).size(), 64);
+
+  Snapshot c =
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kSigSegvRead, "c");
+  EXPECT_NE(Fingerprint(a), Fingerprint(c));
+}
+
+TEST(SnapDedup, BytesPastEndpointDoNotMatter) {
+  Snapshot snapshot =
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "a");
+  const Snapshot::Address end_address =
+      snapshot.expected_end_states()[0].endpoint().instruction_address();
+  const MemoryMapping code = CodeMapping(snapshot);
+  ASSERT_GT(end_address, code.start_address());
+
+  EXPECT_EQ(Fingerprint(snapshot),
+            Fingerprint(FlipByte(snapshot, code.limit_address() - 1)));
+  EXPECT_EQ(Fingerprint(snapshot),
+            Fingerprint(FlipByte(snapshot, end_address)));
+  EXPECT_NE(Fingerprint(snapshot),
+            Fingerprint(FlipByte(snapshot, end_address - 1)));
+}
+
+TEST(SnapDedup, MemoryBytesSplitDoesNotMatter) {
+  Snapshot snapshot =
+      MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, "a");
+  Snapshot split = snapshot.Copy();
+  Snapshot::MemoryBytesList memory_bytes;
+  for (Snapshot::MemoryBytes bytes : split.memory_bytes()) {
+    if (bytes.num_bytes() < 2) {
+      memory_bytes.push_back(std::move(bytes));
+      continue;
+    }
+    // Split in two and add in reverse order.
+    const Snapshot::Address middle =
+        bytes.start_address() + bytes.num_bytes() / 2;
+    memory_bytes.push_back(bytes.Range(middle, bytes.limit_address()));
+    memory_bytes.push_back(bytes.Range(bytes.start_address(), middle));
+  }
+  ASSERT_OK(split.ReplaceMemoryBytes(std::move(memory_bytes)));
+  EXPECT_EQ(Fingerprint(snapshot), Fingerprint(split));
+}
+
+TEST(SnapDedup, RequiresOneEndState) {
+  Snapshot snapshot = MakeSnapRunnerTestSnapshot<Host>(
+      TestSnapshot::kEndsAsExpected);
+  snapshot.set_expected_end_states({});
+  EXPECT_THAT(SemanticSnapshotFingerprint(snapshot),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(SnapDedup, FindDuplicateSnaps) {
+  std::vector<std::vector<SnapFingerprint>> shards = {
+      {{"a", "1"}, {"b", "2"}, {"c", "1"}},
+      {{"d", "3"}, {"e", "2"}},
+      {{"f", "1"}},
+  };
+  std::vector<DuplicateGroup> groups = FindDuplicateSnaps(shards);
+  ASSERT_THAT(groups, SizeIs(2));
+
+  EXPECT_EQ(groups[0].digest, "1");
+  EXPECT_EQ(groups[0].keep.shard_index, 0);
+  EXPECT_EQ(groups[0].keep.id, "a");
+  EXPECT_THAT(groups[0].duplicates,
+              ElementsAre(Field(&SnapLocation::id, "c"),
+                          Field(&SnapLocation::id, "f")));
+  EXPECT_EQ(groups[0].duplicates[1].shard_index, 2);
+
+  EXPECT_EQ(groups[1].digest, "2");
+  EXPECT_EQ(groups[1].keep.id, "b");
+  EXPECT_THAT(groups[1].duplicates,
+              ElementsAre(Field(&SnapLocation::id, "e")));
+
+  EXPECT_THAT(FindDuplicateSnaps({{{"a", "1"}}, {{"b", "2"}}}), IsEmpty());
+}
+
+TEST(SnapDedup, FingerprintShards) {
+  std::vector<std::string> paths;
+  for (const char* id : {"a", "b"}) {
+    std::vector<Snapshot> snapshots;
+    snapshots.push_back(
+        MakeSnapifiedTestSnapshot<Host>(TestSnapshot::kEndsAsExpected, id));
+    snapshots.push_back(MakeSnapifiedTestSnapshot<Host>(
+        TestSnapshot::kSigSegvRead, std::string(id) + "_segv"));
+    MmappedMemoryPtr<char> buffer =
+        GenerateRelocatableSnaps(Host::architecture_id, snapshots);
+    ASSERT_OK_AND_ASSIGN(std::string path, CreateTempFile("shard"));
+    ASSERT_TRUE(SetContents(path, {buffer.get(), MmappedMemorySize(buffer)}));
+    paths.push_back(path);
+  }
+
+  ASSERT_OK_AND_ASSIGN(
+      auto fingerprints,
+      FingerprintShards<Host>(paths, TestSnapshotPlatform<Host>(),
+                              /* num_threads = */ 2));
+  ASSERT_THAT(fingerprints, SizeIs(2));
+  ASSERT_THAT(fingerprints[0], SizeIs(2));
+  ASSERT_THAT(fingerprints[1], SizeIs(2));
+  EXPECT_EQ(fingerprints[0][0].id, "a");
+  EXPECT_EQ(fingerprints[1][0].id, "b");
+
+  std::vector<DuplicateGroup> groups = FindDuplicateSnaps(fingerprints);
+  ASSERT_THAT(groups, SizeIs(2));
+  EXPECT_EQ(groups[0].keep.id, "a");
+  EXPECT_THAT(groups[0].duplicates,
+              ElementsAre(Field(&SnapLocation::id, "b")));
+  EXPECT_EQ(groups[1].keep.id, "a_segv");
+  EXPECT_THAT(groups[1].duplicates,
+              ElementsAre(Field(&SnapLocation::id, "b_segv")));
+}
+
+}  // namespace
+}  // namespace silifuzz
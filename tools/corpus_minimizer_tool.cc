@@ -0,0 +1,185 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A tool that shrinks a Snap corpus without losing proxy coverage.
+//
+// Every Snap's instructions are replayed through the Unicorn proxy that
+// Centipede uses and the emitted features are recorded. A weighted greedy set
+// cover then selects a subset of Snaps that covers all features.
+//
+// Usage:
+//   corpus_minimizer_tool [optional flags] <corpus_0> .. <corpus_n>
+//
+// To list flags, use corpus_minimizer_tool --help.
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_util.h"
+#include "./snap/gen/relocatable_snap_generator.h"
+#include "./snap/snap.h"
+#include "./snap/snap_corpus_util.h"
+#include "./snap/snap_util.h"
+#include "./tool_libs/corpus_minimizer_lib.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/enum_flag_types.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/platform.h"
+
+ABSL_FLAG(std::string, output, "",
+          "If set, the minimized corpus is written to this file as a "
+          "relocatable corpus.");
+ABSL_FLAG(std::string, priority_order, "",
+          "If set, IDs of all Snaps are written to this file, one per line, "
+          "in priority order. The first lines form the minimized corpus.");
+ABSL_FLAG(std::string, checkpoint, "",
+          "If set, per-Snap features are recorded in this file and a rerun "
+          "with the same file skips Snaps that are already recorded.");
+ABSL_FLAG(int, parallelism, 0,
+          "Number of parallel worker threads. If it is 0, the tool uses the "
+          "maximum hardware parallelism.");
+ABSL_FLAG(bool, weight_by_size, false,
+          "If true, prefer short Snaps by weighting each Snap by the size of "
+          "its instructions. Otherwise all Snaps cost the same.");
+ABSL_FLAG(silifuzz::PlatformId, target_platform,
+          silifuzz::PlatformId::kUndefined,
+          "Platform of the end states in the output corpus. Defaults to the "
+          "current platform.");
+
+namespace silifuzz {
+namespace {
+
+absl::Status WriteFile(const std::string& path, const char* data,
+                       size_t size) {
+  std::ofstream os(path);
+  if (!os.is_open()) {
+    return absl::InternalError(absl::StrCat("Cannot open ", path));
+  }
+  os.write(data, size);
+  if (os.fail()) {
+    return absl::InternalError(absl::StrCat("Cannot write ", path));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Arch>
+absl::Status MinimizeCorpus(const std::vector<std::string>& corpus_files) {
+  PlatformId platform = absl::GetFlag(FLAGS_target_platform);
+  if (platform == PlatformId::kUndefined) platform = CurrentPlatformId();
+  if (PlatformArchitecture(platform) != Arch::architecture_id) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("--target_platform must be a ", Arch::arch_name,
+                     " platform"));
+  }
+
+  // Keep every shard mapped so that selected Snaps can be written out later.
+  std::vector<MmappedMemoryPtr<const SnapCorpus<Arch>>> shards;
+  std::vector<const Snap<Arch>*> snaps;
+  std::vector<CorpusEntry> entries;
+  for (const std::string& file : corpus_files) {
+    shards.push_back(
+        LoadCorpusFromFile<Arch>(file.c_str(), /* preload = */ false));
+    for (const Snap<Arch>* snap : shards.back()->snaps) {
+      ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot snapshot,
+                                 SnapToSnapshot(*snap, platform));
+      ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot::ByteData instructions,
+                                 GetInstructionBytesFromSnapshot(snapshot));
+      snaps.push_back(snap);
+      entries.push_back({.id = snap->id, .instructions = instructions});
+    }
+  }
+
+  int parallelism = absl::GetFlag(FLAGS_parallelism);
+  if (parallelism == 0) {
+    parallelism = std::max(1u, std::thread::hardware_concurrency());
+  }
+  ASSIGN_OR_RETURN_IF_NOT_OK(
+      std::vector<CorpusEntryFeatures> features,
+      CollectProxyFeatures<Arch>(
+          entries, {.num_threads = parallelism,
+                    .checkpoint_path = absl::GetFlag(FLAGS_checkpoint)}));
+  if (absl::GetFlag(FLAGS_weight_by_size)) {
+    for (size_t i = 0; i < features.size(); ++i) {
+      features[i].cost = std::max<size_t>(1, entries[i].instructions.size());
+    }
+  }
+
+  SetCoverResult cover = GreedySetCover(features);
+  LOG_INFO("Selected ", cover.num_selected, " of ", entries.size(),
+           " Snaps covering ", cover.num_features, " features");
+
+  const std::string priority_order = absl::GetFlag(FLAGS_priority_order);
+  if (!priority_order.empty()) {
+    std::string ids;
+    for (size_t index : cover.order) {
+      absl::StrAppend(&ids, entries[index].id, "\n");
+    }
+    RETURN_IF_NOT_OK(WriteFile(priority_order, ids.data(), ids.size()));
+  }
+
+  const std::string output = absl::GetFlag(FLAGS_output);
+  if (!output.empty()) {
+    std::vector<Snapshot> selected;
+    selected.reserve(cover.num_selected);
+    for (size_t i = 0; i < cover.num_selected; ++i) {
+      ASSIGN_OR_RETURN_IF_NOT_OK(
+          Snapshot snapshot, SnapToSnapshot(*snaps[cover.order[i]], platform));
+      selected.push_back(std::move(snapshot));
+    }
+    MmappedMemoryPtr<char> relocatable =
+        GenerateRelocatableSnaps(Arch::architecture_id, selected);
+    RETURN_IF_NOT_OK(WriteFile(output, relocatable.get(),
+                               MmappedMemorySize(relocatable)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ToolMain(const std::vector<std::string>& corpus_files) {
+  if (corpus_files.empty()) {
+    return absl::InvalidArgumentError("No input corpus files");
+  }
+  ArchitectureId arch = CorpusFileArchitecture(corpus_files[0].c_str());
+  for (const std::string& file : corpus_files) {
+    if (CorpusFileArchitecture(file.c_str()) != arch) {
+      return absl::InvalidArgumentError(
+          absl::StrCat(file, " is for a different architecture"));
+    }
+  }
+  return ARCH_DISPATCH(MinimizeCorpus, arch, corpus_files);
+}
+
+}  // namespace
+}  // namespace silifuzz
+
+int main(int argc, char* argv[]) {
+  std::vector<char*> positional_args = absl::ParseCommandLine(argc, argv);
+  std::vector<std::string> corpus_files(positional_args.begin() + 1,
+                                        positional_args.end());
+  absl::Status result = silifuzz::ToolMain(corpus_files);
+  if (!result.ok()) {
+    LOG_ERROR(result.message());
+  }
+  return result.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
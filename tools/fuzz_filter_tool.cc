@@ -14,17 +14,138 @@
 
 #include "./tools/fuzz_filter_tool.h"
 
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <optional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
+#include "absl/base/attributes.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "./runner/make_snapshot.h"
+#include "./runner/make_snapshot_cache.h"
+#include "./util/checks.h"
+#include "./util/cpu_id.h"
+#include "./util/itoa.h"
 
 namespace silifuzz {
 
+template <>
+ABSL_CONST_INIT const char* EnumNameMap<FilterVerdict>[3] = {
+    "accepted", "filtered", "error"};
+
 // Kept as a separate function so that we can test this exact config.
 absl::Status FilterToolMain(absl::string_view raw_insns_bytes) {
   return MakeRawInstructions(raw_insns_bytes, MakingConfig::Quick()).status();
 }
 
+FilterVerdict FilterVerdictFromStatus(const absl::Status& status) {
+  if (status.ok()) return FilterVerdict::kAccepted;
+  return IsTransientMakingError(status) ? FilterVerdict::kError
+                                        : FilterVerdict::kFiltered;
+}
+
+namespace {
+
+// Lists all available CPUs according to sched_getaffinity(2).
+std::vector<int> AvailableCpus() {
+  std::vector<int> available_cpus;
+  cpu_set_t all_cpus;
+  CPU_ZERO(&all_cpus);
+  if (sched_getaffinity(0 /* this thread */, sizeof(all_cpus), &all_cpus) !=
+      0) {
+    LOG_FATAL("Cannot get current CPU affinity mask: ", ErrnoStr(errno));
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &all_cpus)) {
+      available_cpus.push_back(cpu);
+    }
+  }
+  CHECK(!available_cpus.empty());
+  return available_cpus;
+}
+
+}  // namespace
+
+void FilterBatch(const std::vector<FilterInput>& inputs,
+                 const FilterBatchOptions& options,
+                 absl::FunctionRef<void(const FilterResult&)> sink) {
+  if (inputs.empty()) return;
+  const std::vector<int> cpus = AvailableCpus();
+  size_t num_workers =
+      options.num_workers > 0 ? options.num_workers : cpus.size();
+  num_workers = std::min(num_workers, inputs.size());
+
+  // Looking up the runner once is cheaper than once per input.
+  const MakingConfig base_config = MakingConfig::Quick();
+
+  std::atomic<size_t> next_index = 0;
+  absl::Mutex mu;
+  // Finished results that cannot be passed to `sink` yet because an earlier
+  // input is still running.
+  std::vector<std::optional<FilterResult>> pending(inputs.size());
+  size_t next_to_emit = 0;
+
+  auto worker = [&](size_t worker_index) {
+    MakingConfig config = base_config;
+    if (options.pin_workers) {
+      const int cpu = cpus[worker_index % cpus.size()];
+      if (int err = SetCPUAffinity(cpu); err != 0) {
+        LOG_ERROR("Cannot pin worker ", worker_index, " to CPU ", cpu, ": ",
+                  ErrnoStr(err));
+      } else {
+        // Runners inherit nothing from the worker; pin them explicitly.
+        config.cpu = cpu;
+      }
+    }
+    for (size_t i = next_index++; i < inputs.size(); i = next_index++) {
+      const absl::Status status =
+          options.cache == nullptr
+              ? MakeRawInstructions(inputs[i].raw_insns_bytes, config).status()
+              : options.cache
+                    ->MakeRawInstructions(inputs[i].raw_insns_bytes, config)
+                    .status();
+      FilterResult result{
+          .index = i,
+          .verdict = FilterVerdictFromStatus(status),
+          .reason = std::string(status.message()),
+      };
+      absl::MutexLock l(&mu);
+      pending[i] = std::move(result);
+      while (next_to_emit < inputs.size() && pending[next_to_emit]) {
+        sink(*pending[next_to_emit]);
+        pending[next_to_emit].reset();
+        ++next_to_emit;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t w = 0; w < num_workers; ++w) {
+    workers.emplace_back(worker, w);
+  }
+  for (std::thread& t : workers) {
+    t.join();
+  }
+  CHECK_EQ(next_to_emit, inputs.size());
+}
+
+std::string FormatFilterResult(const FilterInput& input,
+                               const FilterResult& result) {
+  return absl::StrCat(result.index, "\t", absl::CEscape(input.name), "\t",
+                      EnumStr(result.verdict), "\t",
+                      absl::CEscape(result.reason));
+}
+
 }  // namespace silifuzz
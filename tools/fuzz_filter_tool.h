@@ -24,12 +24,83 @@
 #ifndef THIRD_PARTY_SILIFUZZ_TOOLS_FUZZ_FILTER_TOOL_H_
 #define THIRD_PARTY_SILIFUZZ_TOOLS_FUZZ_FILTER_TOOL_H_
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "./runner/make_snapshot_cache.h"
+#include "./util/itoa.h"
 
 namespace silifuzz {
 
 absl::Status FilterToolMain(absl::string_view raw_insns_bytes);
-}
+
+// Outcome of filtering one input in batch mode.
+enum class FilterVerdict {
+  kAccepted = 0,  // The input makes a Snap-compatible Snapshot.
+  kFiltered,      // The input was rejected by the making pipeline.
+  kError,         // The input could not be judged, e.g. the runner failed
+                  // to start. Retrying may give a different verdict.
+};
+
+// EnumStr() works for FilterVerdict and gives the names used in batch output:
+// "accepted", "filtered" and "error".
+template <>
+extern const char* EnumNameMap<FilterVerdict>[3];
+
+// Maps the status returned by FilterToolMain() to a verdict. The making
+// pipeline reports all rejections as kInternal, so only codes that point at
+// the environment rather than the input, such as kUnavailable or
+// kResourceExhausted, are treated as errors.
+FilterVerdict FilterVerdictFromStatus(const absl::Status& status);
+
+// One input of FilterBatch().
+struct FilterInput {
+  // Used to identify the input in the output, e.g. a file name.
+  std::string name;
+  std::string raw_insns_bytes;
+};
+
+struct FilterResult {
+  // Index of the input in the batch.
+  size_t index = 0;
+  FilterVerdict verdict = FilterVerdict::kError;
+  // Empty iff the input was accepted.
+  std::string reason;
+};
+
+struct FilterBatchOptions {
+  // Number of worker threads. 0 means one per CPU in the affinity mask of
+  // the calling thread.
+  int num_workers = 0;
+
+  // If true, each worker and the runners it starts are pinned to one CPU
+  // from the affinity mask of the calling thread. Workers are spread over
+  // distinct CPUs as long as there are enough.
+  bool pin_workers = true;
+
+  // If not nullptr, results are looked up in and stored to this cache.
+  // Not owned.
+  SnapshotMakingCache* cache = nullptr;
+};
+
+// Filters `inputs` with the same config as FilterToolMain() using a bounded
+// set of worker threads. `sink` is called once per input in input order, as
+// soon as the input and all inputs before it are done. Calls to `sink` never
+// overlap.
+void FilterBatch(const std::vector<FilterInput>& inputs,
+                 const FilterBatchOptions& options,
+                 absl::FunctionRef<void(const FilterResult&)> sink);
+
+// Formats `result` for `input` as a single line without the trailing
+// newline: index, name, verdict and reason separated by tabs. The name and
+// the reason are C-escaped so that neither contains tabs or newlines.
+std::string FormatFilterResult(const FilterInput& input,
+                               const FilterResult& result);
+
+}  // namespace silifuzz
 
 #endif  // THIRD_PARTY_SILIFUZZ_TOOLS_FUZZ_FILTER_TOOL_H_
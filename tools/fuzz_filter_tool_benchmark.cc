@@ -0,0 +1,99 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the throughput of the single-input fuzz filter path, i.e.
+// FilterToolMain() called once per input, with FilterBatch() for different
+// numbers of workers.
+//
+// The single-input numbers are a lower bound on the cost of the old way of
+// filtering: a real fuzz_filter_tool process per input also pays process
+// startup, flag parsing and the runner lookup.
+//
+// To run:
+//
+// bazel run -c opt third_party/silifuzz/tools:fuzz_filter_tool_benchmark -- \
+//   --benchmark_filter=all
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "./common/snapshot_test_config.h"
+#include "./common/snapshot_test_enum.h"
+#include "./tools/fuzz_filter_tool.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+
+namespace silifuzz {
+namespace {
+
+constexpr size_t kNumInputs = 64;
+
+// A mix of accepted and filtered inputs.
+std::vector<FilterInput> MakeInputs() {
+  const TestSnapshot kTypes[] = {
+      TestSnapshot::kEndsAsExpected,
+      TestSnapshot::kBreakpoint,
+      TestSnapshot::kSigIll,
+      TestSnapshot::kEndsAsExpected,
+  };
+  std::vector<FilterInput> inputs;
+  inputs.reserve(kNumInputs);
+  for (size_t i = 0; i < kNumInputs; ++i) {
+    inputs.push_back(
+        {.name = absl::StrCat(i),
+         .raw_insns_bytes =
+             GetTestSnippet<Host>(kTypes[i % std::size(kTypes)])});
+  }
+  return inputs;
+}
+
+void BM_SingleInput(benchmark::State& state) {
+  const std::vector<FilterInput> inputs = MakeInputs();
+  for (auto s : state) {
+    for (const FilterInput& input : inputs) {
+      benchmark::DoNotOptimize(FilterToolMain(input.raw_insns_bytes));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+BENCHMARK(BM_SingleInput)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_Batch(benchmark::State& state) {
+  const std::vector<FilterInput> inputs = MakeInputs();
+  const FilterBatchOptions options = {
+      .num_workers = static_cast<int>(state.range(0)),
+      .pin_workers = state.range(1) != 0,
+  };
+  for (auto s : state) {
+    size_t num_results = 0;
+    FilterBatch(inputs, options,
+                [&num_results](const FilterResult&) { ++num_results; });
+    CHECK_EQ(num_results, inputs.size());
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+
+BENCHMARK(BM_Batch)
+    ->ArgNames({"workers", "pinned"})
+    ->ArgsProduct({{1, 4, 16}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace silifuzz
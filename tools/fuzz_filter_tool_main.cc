@@ -17,18 +17,141 @@
 // SiliFuzz Snapshot.
 // The bytes are converted into Snapshot using InstructionsToSnapshot() which
 // is the same as what our fuzzers and the fix pipeline use.
+//
+// In batch mode (--batch or --centipede_corpus) the tool filters many inputs
+// in one process and prints one line per input to stdout, in input order:
+//
+//   <index> TAB <name> TAB accepted|filtered|error TAB <reason>
+//
+// See FormatFilterResult(). The exit code is 0 iff no input had an error
+// verdict; filtered inputs are a normal outcome. With --make_cache_dir,
+// verdicts of inputs seen by earlier runs are read from the cache.
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "external/com_google_fuzztest/common/blob_file.h"
+#include "external/com_google_fuzztest/common/defs.h"
+#include "./runner/make_snapshot.h"
+#include "./runner/make_snapshot_cache.h"
 #include "./tools/fuzz_filter_tool.h"
 #include "./util/checks.h"
 #include "./util/tool_util.h"
 
+ABSL_FLAG(bool, batch, false,
+          "If true, every input file holds one instruction sequence and a "
+          "verdict is printed for each of them.");
+ABSL_FLAG(bool, centipede_corpus, false,
+          "If true, the input files are Centipede corpus files and a verdict "
+          "is printed for every blob in them. Implies --batch.");
+ABSL_FLAG(int, num_workers, 0,
+          "Number of worker threads in batch mode. If it is 0, one worker "
+          "per available CPU is used.");
+ABSL_FLAG(bool, pin_workers, true,
+          "If true, each batch worker and its runners are pinned to a CPU.");
+ABSL_FLAG(std::string, make_cache_dir, "",
+          "If set, batch mode caches making results in this directory and "
+          "reuses them across runs.");
+ABSL_FLAG(int, make_cache_max_mb, 1024,
+          "Size limit of --make_cache_dir in MiB.");
+
+namespace silifuzz {
+namespace {
+
+// Appends all blobs in the Centipede corpus file `path` to `inputs`. Blobs
+// are named <path>:<blob index>.
+absl::Status ReadCentipedeBlobs(const std::string& path,
+                                std::vector<FilterInput>& inputs) {
+  auto reader = centipede::DefaultBlobFileReaderFactory();
+  RETURN_IF_NOT_OK(reader->Open(path));
+  absl::Status status;
+  centipede::ByteSpan blob;
+  for (size_t i = 0; (status = reader->Read(blob)).ok(); ++i) {
+    inputs.push_back({.name = absl::StrCat(path, ":", i),
+                      .raw_insns_bytes = std::string(blob.begin(), blob.end())});
+  }
+  if (!absl::IsOutOfRange(status)) {
+    return status;
+  }
+  return reader->Close();
+}
+
+int BatchMain(const std::vector<std::string>& files) {
+  std::vector<FilterInput> inputs;
+  for (const std::string& file : files) {
+    absl::Status s;
+    if (absl::GetFlag(FLAGS_centipede_corpus)) {
+      s = ReadCentipedeBlobs(file, inputs);
+    } else {
+      absl::StatusOr<std::string> bytes = GetFileContents(file);
+      s = bytes.status();
+      if (s.ok()) {
+        inputs.push_back({.name = file, .raw_insns_bytes = *std::move(bytes)});
+      }
+    }
+    if (!s.ok()) {
+      LOG_ERROR(file, ": ", s.message());
+      return 1;
+    }
+  }
+
+  std::unique_ptr<SnapshotMakingCache> cache;
+  if (const std::string cache_dir = absl::GetFlag(FLAGS_make_cache_dir);
+      !cache_dir.empty()) {
+    absl::StatusOr<std::unique_ptr<SnapshotMakingCache>> cache_or =
+        SnapshotMakingCache::Create(
+            {.directory = cache_dir,
+             .max_bytes =
+                 static_cast<uint64_t>(absl::GetFlag(FLAGS_make_cache_max_mb))
+                 << 20},
+            MakingConfig::Quick().runner_path);
+    if (!cache_or.ok()) {
+      LOG_ERROR(cache_or.status().message());
+      return 1;
+    }
+    cache = *std::move(cache_or);
+  }
+
+  size_t num_errors = 0;
+  FilterBatch(inputs,
+              {.num_workers = absl::GetFlag(FLAGS_num_workers),
+               .pin_workers = absl::GetFlag(FLAGS_pin_workers),
+               .cache = cache.get()},
+              [&](const FilterResult& result) {
+                if (result.verdict == FilterVerdict::kError) ++num_errors;
+                std::string line =
+                    FormatFilterResult(inputs[result.index], result);
+                line.push_back('\n');
+                fputs(line.c_str(), stdout);
+                fflush(stdout);
+              });
+  if (cache != nullptr) {
+    const SnapshotMakingCache::Stats stats = cache->stats();
+    LOG_INFO("Make cache: ", stats.hits, " hits, ", stats.misses, " misses, ",
+             stats.stores, " stores, ", stats.evictions, " evictions");
+  }
+  return ToExitCode(num_errors == 0);
+}
+
+}  // namespace
+}  // namespace silifuzz
+
 int main(int argc, char** argv) {
   std::vector<char*> non_flag_args = absl::ParseCommandLine(argc, argv);
+  if (absl::GetFlag(FLAGS_batch) || absl::GetFlag(FLAGS_centipede_corpus)) {
+    return silifuzz::BatchMain(
+        std::vector<std::string>(non_flag_args.begin() + 1,
+                                 non_flag_args.end()));
+  }
   if (non_flag_args.size() != 2) {
     LOG_ERROR("Expected exactly 1 input file");
     return 1;
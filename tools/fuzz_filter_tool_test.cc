@@ -29,6 +29,8 @@
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "./common/snapshot_test_config.h"
 #include "./common/snapshot_test_enum.h"
 #include "./util/arch.h"
@@ -66,6 +68,52 @@ TEST(FuzzFilterTool, Syscall) {
   EXPECT_FILTER_REJECT(GetTestSnippet<Host>(TestSnapshot::kSyscall));
 }
 
+TEST(FuzzFilterTool, VerdictFromStatus) {
+  EXPECT_EQ(FilterVerdictFromStatus(absl::OkStatus()),
+            FilterVerdict::kAccepted);
+  EXPECT_EQ(FilterVerdictFromStatus(absl::InternalError("nondeterministic")),
+            FilterVerdict::kFiltered);
+  EXPECT_EQ(FilterVerdictFromStatus(absl::UnavailableError("no runner")),
+            FilterVerdict::kError);
+}
+
+TEST(FuzzFilterTool, FormatFilterResult) {
+  FilterInput input{.name = "a\tb"};
+  EXPECT_EQ(FormatFilterResult(input, {.index = 3,
+                                       .verdict = FilterVerdict::kFiltered,
+                                       .reason = "line 1\nline 2"}),
+            "3\ta\\tb\tfiltered\tline 1\\nline 2");
+  EXPECT_EQ(FormatFilterResult(input, {.index = 0,
+                                       .verdict = FilterVerdict::kAccepted}),
+            "0\ta\\tb\taccepted\t");
+}
+
+TEST(FuzzFilterTool, Batch) {
+  const std::string accept =
+      GetTestSnippet<Host>(TestSnapshot::kEndsAsExpected);
+  const std::string reject = GetTestSnippet<Host>(TestSnapshot::kBreakpoint);
+  std::vector<FilterInput> inputs;
+  for (int i = 0; i < 8; ++i) {
+    inputs.push_back({.name = absl::StrCat(i),
+                      .raw_insns_bytes = i % 2 == 0 ? accept : reject});
+  }
+  std::vector<FilterResult> results;
+  FilterBatch(inputs, {.num_workers = 3},
+              [&](const FilterResult& result) { results.push_back(result); });
+  ASSERT_EQ(results.size(), inputs.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    // Results come in input order.
+    EXPECT_EQ(results[i].index, i);
+    if (i % 2 == 0) {
+      EXPECT_EQ(results[i].verdict, FilterVerdict::kAccepted);
+      EXPECT_TRUE(results[i].reason.empty());
+    } else {
+      EXPECT_EQ(results[i].verdict, FilterVerdict::kFiltered);
+      EXPECT_FALSE(results[i].reason.empty());
+    }
+  }
+}
+
 #if defined(__x86_64__)
 
 // Mostly to check that FromBytes can produce something that will be accepted.
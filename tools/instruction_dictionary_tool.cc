@@ -0,0 +1,179 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A tool that mines an instruction dictionary for the SiliFuzz Centipede
+// mutator from an existing corpus.
+//
+// Every input is decoded into a Program the same way the mutator decodes its
+// inputs, and the most common single instructions and short instruction
+// sequences are written out. Pass the output to silifuzz_centipede with
+// --instruction_dictionary.
+//
+// Usage:
+//   instruction_dictionary_tool --output=<file> <snap corpus> ..
+//   instruction_dictionary_tool --centipede_corpus --arch=<arch>
+//       --output=<file> <centipede corpus file> ..
+//
+// To list flags, use instruction_dictionary_tool --help.
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "external/com_google_fuzztest/common/blob_file.h"
+#include "external/com_google_fuzztest/common/defs.h"
+#include "./common/snapshot.h"
+#include "./common/snapshot_util.h"
+#include "./fuzzer/instruction_dictionary.h"
+#include "./fuzzer/program.h"
+#include "./snap/snap.h"
+#include "./snap/snap_corpus_util.h"
+#include "./snap/snap_util.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/enum_flag_types.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/platform.h"
+
+ABSL_FLAG(std::string, output, "", "Dictionary file to write. Required.");
+ABSL_FLAG(bool, centipede_corpus, false,
+          "If true, the input files are Centipede corpus files. Otherwise they "
+          "are Snap corpus files.");
+ABSL_FLAG(silifuzz::ArchitectureId, arch, silifuzz::ArchitectureId::kUndefined,
+          "Architecture of the Centipede corpus files. Snap corpus files "
+          "record their architecture.");
+ABSL_FLAG(size_t, max_length, 3,
+          "Longest instruction sequence, in instructions, to collect.");
+ABSL_FLAG(size_t, max_entries, 10000,
+          "Maximum number of dictionary entries to write.");
+ABSL_FLAG(size_t, min_count, 2,
+          "Only write sequences that occur in at least this many inputs.");
+
+namespace silifuzz {
+namespace {
+
+template <typename Arch>
+void AddInstructions(absl::string_view instructions,
+                     InstructionDictionaryMiner<Arch>& miner) {
+  miner.Add(Program<Arch>(reinterpret_cast<const uint8_t*>(instructions.data()),
+                          instructions.size()));
+}
+
+template <typename Arch>
+absl::Status MineSnapCorpus(const std::string& path,
+                            InstructionDictionaryMiner<Arch>& miner) {
+  MmappedMemoryPtr<const SnapCorpus<Arch>> corpus =
+      LoadCorpusFromFile<Arch>(path.c_str(), /* preload = */ false);
+  // Only the instructions are used, so the platform of the end state does not
+  // matter as long as it is one of Arch.
+  constexpr PlatformId kPlatform = Arch::architecture_id ==
+                                           ArchitectureId::kX86_64
+                                       ? PlatformId::kIntelSkylake
+                                       : PlatformId::kArmNeoverseN1;
+  for (const Snap<Arch>* snap : corpus->snaps) {
+    ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot snapshot,
+                               SnapToSnapshot(*snap, kPlatform));
+    ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot::ByteData instructions,
+                               GetInstructionBytesFromSnapshot(snapshot));
+    AddInstructions(instructions, miner);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Arch>
+absl::Status MineCentipedeCorpus(const std::string& path,
+                                 InstructionDictionaryMiner<Arch>& miner) {
+  auto reader = centipede::DefaultBlobFileReaderFactory();
+  RETURN_IF_NOT_OK(reader->Open(path));
+  absl::Status status;
+  centipede::ByteSpan blob;
+  while ((status = reader->Read(blob)).ok()) {
+    absl::string_view instructions(reinterpret_cast<const char*>(blob.data()),
+                                   blob.size());
+    AddInstructions(instructions, miner);
+  }
+  if (!absl::IsOutOfRange(status)) {
+    return status;
+  }
+  return reader->Close();
+}
+
+template <typename Arch>
+absl::Status MineDictionary(const std::vector<std::string>& files) {
+  InstructionDictionaryMiner<Arch> miner(absl::GetFlag(FLAGS_max_length));
+  for (const std::string& file : files) {
+    absl::Status status = absl::GetFlag(FLAGS_centipede_corpus)
+                              ? MineCentipedeCorpus(file, miner)
+                              : MineSnapCorpus(file, miner);
+    RETURN_IF_NOT_OK_PLUS(status, absl::StrCat(file, ": "));
+  }
+  LOG_INFO("Collected ", miner.num_sequences(), " sequences from ",
+           miner.num_programs(), " inputs");
+
+  const std::string text = miner.ToText(absl::GetFlag(FLAGS_max_entries),
+                                        absl::GetFlag(FLAGS_min_count));
+  const std::string output = absl::GetFlag(FLAGS_output);
+  std::ofstream os(output);
+  os << text;
+  os.close();
+  if (os.fail()) {
+    return absl::InternalError(absl::StrCat("Cannot write ", output));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ToolMain(const std::vector<std::string>& files) {
+  if (files.empty()) {
+    return absl::InvalidArgumentError("No input corpus files");
+  }
+  if (absl::GetFlag(FLAGS_output).empty()) {
+    return absl::InvalidArgumentError("--output is required");
+  }
+  ArchitectureId arch = absl::GetFlag(FLAGS_arch);
+  if (absl::GetFlag(FLAGS_centipede_corpus)) {
+    if (arch == ArchitectureId::kUndefined) {
+      return absl::InvalidArgumentError(
+          "--arch is required for Centipede corpora");
+    }
+  } else {
+    arch = CorpusFileArchitecture(files[0].c_str());
+    for (const std::string& file : files) {
+      if (CorpusFileArchitecture(file.c_str()) != arch) {
+        return absl::InvalidArgumentError(
+            absl::StrCat(file, " is for a different architecture"));
+      }
+    }
+  }
+  return ARCH_DISPATCH(MineDictionary, arch, files);
+}
+
+}  // namespace
+}  // namespace silifuzz
+
+int main(int argc, char* argv[]) {
+  std::vector<char*> positional_args = absl::ParseCommandLine(argc, argv);
+  std::vector<std::string> files(positional_args.begin() + 1,
+                                 positional_args.end());
+  absl::Status result = silifuzz::ToolMain(files);
+  if (!result.ok()) {
+    LOG_ERROR(result.message());
+  }
+  return result.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
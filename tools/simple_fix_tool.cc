@@ -41,8 +41,11 @@
 #include "absl/types/span.h"
 #include "external/com_google_fuzztest/common/blob_file.h"
 #include "external/com_google_fuzztest/common/defs.h"
+#include "./common/proxy_config.h"
 #include "./common/raw_insns_util.h"
 #include "./common/snapshot.h"
+#include "./runner/make_snapshot_cache.h"
+#include "./runner/runner_provider.h"
 #include "./snap/gen/relocatable_snap_generator.h"
 #include "./snap/gen/snap_generator.h"
 #include "./tool_libs/corpus_partitioner_lib.h"
@@ -72,6 +75,8 @@ struct FixToolWorkerArgs {
   // A worker needs to reference simple fix tool options.
   // The worker does not own the option.
   const SimpleFixToolOptions* options;
+  // Shared by all workers. May be nullptr.
+  SnapshotMakingCache* cache;
   absl::Span<const std::string> blobs;
   std::vector<Snapshot> good_snapshots;
   SimpleFixToolCounters counters;
@@ -111,16 +116,26 @@ void FixToolWorker(FixToolWorkerArgs& args) {
         args.options->x86_filter_vsyscall_region_access;
     options.filter_memory_access = args.options->filter_memory_access;
     options.enforce_fuzzing_config = args.options->enforce_fuzzing_config;
+    auto fixup = [&]() -> absl::StatusOr<Snapshot> {
+      ASSIGN_OR_RETURN_IF_NOT_OK(
+          Snapshot remade_snapshot,
+          FixupSnapshot(snapshot.value(), options, &platform_counters));
+      // Snaps need to be snapified before GenerateRelocatableSnaps.
+      // If they are not, executable pages may not be RLE compressed.
+      return Snapify(
+          remade_snapshot,
+          SnapifyOptions::V2InputRunOpts(snapshot->architecture_id()));
+    };
+    // Everything before FixupSnapshot() is a pure function of `blob`, so
+    // the blob is a sufficient cache key input. Counters updated inside
+    // FixupSnapshot() are not replayed on cache hits.
     auto remade_snapshot_or =
-        FixupSnapshot(snapshot.value(), options, &platform_counters);
-    if (!remade_snapshot_or.ok()) {
-      continue;
-    }
-    // Snaps need to be snapified before GenerateRelocatableSnaps.
-    // If they are not, executable pages may not be RLE compressed.
-    remade_snapshot_or =
-        Snapify(remade_snapshot_or.value(),
-                SnapifyOptions::V2InputRunOpts(snapshot->architecture_id()));
+        args.cache == nullptr
+            ? fixup()
+            : args.cache->GetOrMake(
+                  args.cache->Key(blob, FixupMakingConfig(options),
+                                  DEFAULT_FUZZING_CONFIG<Host>),
+                  fixup);
     if (!remade_snapshot_or.ok()) {
       continue;
     }
@@ -207,6 +222,21 @@ std::vector<Snapshot> MakeSnapshotsFromBlobs(
   const std::vector<absl::Span<const std::string>> blob_spans =
       PartitionEvenly(blobs, num_workers);
 
+  std::unique_ptr<SnapshotMakingCache> cache;
+  if (!options.make_cache_dir.empty()) {
+    absl::StatusOr<std::unique_ptr<SnapshotMakingCache>> cache_or =
+        SnapshotMakingCache::Create(
+            {.directory = options.make_cache_dir,
+             .max_bytes = options.make_cache_max_bytes},
+            RunnerLocation());
+    if (cache_or.ok()) {
+      cache = std::move(cache_or).value();
+    } else {
+      LOG_ERROR("Not using make cache: ", cache_or.status().message());
+      counters->Increment("silifuzz-ERROR-MakeCache:create-failed");
+    }
+  }
+
   // Start progress monitor.
   std::atomic<bool> stop_progress_monitor = false;
   std::thread progress_monitor = std::thread(MakeProgressMonitor, blobs.size(),
@@ -218,6 +248,7 @@ std::vector<Snapshot> MakeSnapshotsFromBlobs(
   for (size_t i = 0; i < num_workers; ++i) {
     FixToolWorkerArgs args;
     args.options = &options;
+    args.cache = cache.get();
     args.blobs = blob_spans[i];
     worker_args.push_back(std::move(args));
   }
@@ -238,6 +269,15 @@ std::vector<Snapshot> MakeSnapshotsFromBlobs(
     num_good_snapshots += worker_args[i].good_snapshots.size();
   }
 
+  if (cache != nullptr) {
+    const SnapshotMakingCache::Stats stats = cache->stats();
+    counters->IncrementBy("silifuzz-INFO-MakeCache:hits", stats.hits);
+    counters->IncrementBy("silifuzz-INFO-MakeCache:misses", stats.misses);
+    counters->IncrementBy("silifuzz-INFO-MakeCache:stores", stats.stores);
+    counters->IncrementBy("silifuzz-INFO-MakeCache:evictions",
+                          stats.evictions);
+  }
+
   // Collect made snapshots and bad snapshot id.
   std::vector<Snapshot> made_snapshots;
   made_snapshots.reserve(num_good_snapshots);
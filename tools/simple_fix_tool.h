@@ -25,6 +25,7 @@
 #define THIRD_PARTY_SILIFUZZ_TOOLS_SIMPLE_FIX_TOOL_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -60,6 +61,14 @@ struct SimpleFixToolOptions {
 
   // If true, filter Snapshots that do not conform to fuzzing config.
   bool enforce_fuzzing_config = true;
+
+  // If non-empty, made snapshots and rejections are cached in this directory
+  // and reused by later runs with the same options and runner binary. See
+  // SnapshotMakingCache.
+  std::string make_cache_dir;
+
+  // Size limit of `make_cache_dir`.
+  uint64_t make_cache_max_bytes = uint64_t{1} << 30;
 };
 
 // Converts raw instructions blobs in `inputs` into snapshots of the
@@ -20,6 +20,7 @@
 //   simple_fix_tool_main [optional flags] <corpus_0> .. <corpus_n>
 //
 // To list flags, use simple_fix_tool_main --help.
+#include <cstdint>
 #include <cstdlib>
 #include <string>
 #include <vector>
@@ -57,6 +58,13 @@ ABSL_FLAG(bool, filter_memory_access, false,
 ABSL_FLAG(bool, enforce_fuzzing_config, true,
           "Filter snaps that do not conform to fuzzing config.");
 
+ABSL_FLAG(std::string, make_cache_dir, "",
+          "If set, cache making results in this directory and reuse them "
+          "across runs.");
+
+ABSL_FLAG(int, make_cache_max_mb, 1024,
+          "Size limit of --make_cache_dir in MiB.");
+
 namespace silifuzz {
 namespace {
 
@@ -83,6 +91,9 @@ int SimpleFixToolMain(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_x86_filter_vsyscall_region_access);
   options.filter_memory_access = absl::GetFlag(FLAGS_filter_memory_access);
   options.enforce_fuzzing_config = absl::GetFlag(FLAGS_enforce_fuzzing_config);
+  options.make_cache_dir = absl::GetFlag(FLAGS_make_cache_dir);
+  options.make_cache_max_bytes =
+      static_cast<uint64_t>(absl::GetFlag(FLAGS_make_cache_max_mb)) << 20;
 
   fix_tool_internal::SimpleFixToolCounters counters;
   FixupCorpus(options, inputs, absl::GetFlag(FLAGS_output_path_prefix),
@@ -19,6 +19,7 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>  // NOLINT(build/c++17)
 #include <memory>
 #include <string>
@@ -123,6 +124,42 @@ TEST(SimpleFixTool, MakeSnapshotsFromBlobs) {
   EXPECT_THAT(made_snapshots, SizeIs(kNumBlobs));
 }
 
+// Test that a second run with the same cache directory makes nothing.
+TEST(SimpleFixTool, MakeSnapshotsFromBlobsCached) {
+  const std::string nop = GetNOP();
+  constexpr int kNumBlobs = 4;
+  std::string insns;
+  std::vector<std::string> blobs;
+  for (int i = 0; i < kNumBlobs; ++i, insns += nop) {
+    blobs.push_back(insns);
+  }
+
+  SimpleFixToolOptions options;
+  options.parallelism = 2;
+  options.make_cache_dir =
+      absl::StrCat(::testing::TempDir(), "/MakeSnapshotsFromBlobsCached");
+  SimpleFixToolCounters counters;
+  std::vector<Snapshot> made_snapshots =
+      MakeSnapshotsFromBlobs(options, blobs, &counters);
+  EXPECT_EQ(counters.GetValue("silifuzz-INFO-MakeCache:misses"), kNumBlobs);
+  EXPECT_EQ(counters.GetValue("silifuzz-INFO-MakeCache:stores"), kNumBlobs);
+
+  SimpleFixToolCounters cached_counters;
+  std::vector<Snapshot> cached_snapshots =
+      MakeSnapshotsFromBlobs(options, blobs, &cached_counters);
+  EXPECT_EQ(cached_counters.GetValue("silifuzz-INFO-MakeCache:hits"),
+            kNumBlobs);
+  EXPECT_EQ(cached_counters.GetValue("silifuzz-INFO-MakeCache:misses"), 0);
+  ASSERT_THAT(cached_snapshots, SizeIs(made_snapshots.size()));
+  for (const Snapshot& cached : cached_snapshots) {
+    auto it = std::find_if(
+        made_snapshots.begin(), made_snapshots.end(),
+        [&cached](const Snapshot& made) { return made.id() == cached.id(); });
+    ASSERT_NE(it, made_snapshots.end());
+    EXPECT_EQ(cached, *it);
+  }
+}
+
 }  // namespace
 }  // namespace fix_tool_internal
 
@@ -25,13 +25,27 @@
 //  # List all snaps in the corpus
 //  snap_corpus_tool list_snaps <corpus_file>
 //
+//  # Remove and add snaps without rerunning the making pipeline
+//  snap_corpus_tool --remove_snap_ids=id1,id2 --add_snapshots=a.pb,b.pb \
+//    patch <corpus_file> <output_file>
+//
+//  # Print how memory bytes are encoded: raw, byte runs or pattern runs
+//  snap_corpus_tool memory_bytes_stats <corpus_file>
+//
+//  # Report Snaps whose end states differ across platform shards
+//  snap_corpus_tool end_state_report intel-skylake:<shard> amd-rome:<shard> ...
+//
 #include <sys/mman.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -50,6 +64,8 @@
 #include "./snap/snap.h"
 #include "./snap/snap_corpus_util.h"
 #include "./snap/snap_util.h"
+#include "./tool_libs/corpus_patcher_lib.h"
+#include "./tool_libs/end_state_divergence_lib.h"
 #include "./util/arch.h"
 #include "./util/checks.h"
 #include "./util/enum_flag_types.h"
@@ -62,6 +78,14 @@
 ABSL_FLAG(silifuzz::PlatformId, target_platform,
           silifuzz::PlatformId::kUndefined,
           "Target platform for commands like extract");
+ABSL_FLAG(std::vector<std::string>, remove_snap_ids, {},
+          "Comma-separated IDs of snaps to remove for the patch command");
+ABSL_FLAG(std::vector<std::string>, add_snapshots, {},
+          "Comma-separated snapified snapshot files to add for the patch "
+          "command");
+ABSL_FLAG(int, parallelism, 0,
+          "Number of threads loading shards for the end_state_report command. "
+          "0 means one per available CPU.");
 
 namespace silifuzz {
 namespace {
@@ -100,6 +124,49 @@ absl::StatusOr<const Snap<Arch>*> FindSnapByCodeAddress(
       absl::StrCat("Address ", HexStr(address), " not found"));
 }
 
+// Per-encoding counts of SnapMemoryBytes in a corpus.
+struct MemoryBytesStats {
+  struct Encoding {
+    uint64_t count = 0;
+    uint64_t logical_bytes = 0;  // Bytes once expanded in memory.
+    uint64_t stored_bytes = 0;   // Bytes of data in the corpus, before dedup.
+  };
+  Encoding raw;
+  Encoding byte_run;
+  Encoding pattern_run;
+
+  void Add(const SnapMemoryBytes& memory_bytes) {
+    Encoding* encoding = &raw;
+    uint64_t stored_bytes = memory_bytes.size();
+    if (memory_bytes.repeating()) {
+      encoding = &byte_run;
+      stored_bytes = 0;
+    } else if (memory_bytes.pattern_run()) {
+      encoding = &pattern_run;
+      stored_bytes = memory_bytes.data.pattern_run.pattern_size;
+    }
+    ++encoding->count;
+    encoding->logical_bytes += memory_bytes.size();
+    encoding->stored_bytes += stored_bytes;
+  }
+};
+
+template <typename Arch>
+MemoryBytesStats GetMemoryBytesStats(const SnapCorpus<Arch>& corpus) {
+  MemoryBytesStats stats;
+  for (const Snap<Arch>* snap : corpus.snaps) {
+    for (const auto& mapping : snap->memory_mappings) {
+      for (const auto& memory_bytes : mapping.memory_bytes) {
+        stats.Add(memory_bytes);
+      }
+    }
+    for (const auto& memory_bytes : snap->end_state_memory_bytes) {
+      stats.Add(memory_bytes);
+    }
+  }
+  return stats;
+}
+
 template <typename Arch>
 PlatformId GetTargetPlatform() {
   PlatformId platform_id = absl::GetFlag(FLAGS_target_platform);
@@ -177,6 +244,42 @@ absl::Status ToolMainImpl(absl::string_view command,
       lp.Line(snap->id);
     }
     lp.Line("Total ", corpus->snaps.size);
+  } else if (command == "memory_bytes_stats") {
+    const MemoryBytesStats stats = GetMemoryBytesStats(*corpus);
+    for (const auto& [name, encoding] :
+         {std::pair{"raw", stats.raw}, std::pair{"byte_run", stats.byte_run},
+          std::pair{"pattern_run", stats.pattern_run}}) {
+      lp.Line(name, ": count ", encoding.count, " logical_bytes ",
+              encoding.logical_bytes, " stored_bytes ", encoding.stored_bytes);
+    }
+  } else if (command == "patch") {
+    if (args.empty()) {
+      return absl::InvalidArgumentError("Too few arguments");
+    }
+    absl::string_view output_file = ConsumeArg(args);
+    CorpusPatch patch;
+    patch.remove_ids = absl::GetFlag(FLAGS_remove_snap_ids);
+    for (const std::string& file : absl::GetFlag(FLAGS_add_snapshots)) {
+      ASSIGN_OR_RETURN_IF_NOT_OK(Snapshot snapshot, ReadSnapshotFromFile(file));
+      patch.add.push_back(std::move(snapshot));
+    }
+    ASSIGN_OR_RETURN_IF_NOT_OK(
+        CorpusPatchResult result,
+        PatchRelocatableCorpus(*corpus, GetTargetPlatform<Arch>(), patch));
+    for (const std::string& id : result.rejected_ids) {
+      lp.Line("Rejected conflicting snapshot ", id);
+    }
+    std::ofstream os{std::string(output_file)};
+    if (!os.is_open()) {
+      return absl::InternalError(absl::StrCat("Cannot open ", output_file));
+    }
+    os.write(result.corpus.get(), MmappedMemorySize(result.corpus));
+    if (os.fail()) {
+      return absl::InternalError(absl::StrCat("Cannot write ", output_file));
+    }
+    lp.Line("Kept ", result.num_kept, " removed ", result.num_removed,
+            " added ", result.num_added, " rejected ",
+            result.rejected_ids.size());
   } else {
     return absl::InvalidArgumentError(
         absl::StrCat("Unknown command ", command));
@@ -184,9 +287,57 @@ absl::Status ToolMainImpl(absl::string_view command,
   return absl::OkStatus();
 }
 
+template <typename Arch>
+absl::Status EndStateReportImpl(const std::vector<PlatformShard>& shards) {
+  int num_threads = absl::GetFlag(FLAGS_parallelism);
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  ASSIGN_OR_RETURN_IF_NOT_OK(
+      std::vector<SnapEndStateDivergence> divergences,
+      AnalyzeEndStateDivergence<Arch>(shards, num_threads));
+
+  LinePrinter out(LinePrinter::StdOutPrinter);
+  out.Line("#snap\tid\tnum_end_states\tmax_diff_bytes\tbase_platforms\t",
+           "platform/reg_bytes/mem_bytes/endpoint/reg_checksum,...");
+  size_t num_divergent = 0;
+  for (const SnapEndStateDivergence& divergence : divergences) {
+    if (divergence.num_end_states <= 1) continue;
+    ++num_divergent;
+    out.Line(FormatSnapEndStateDivergence(divergence));
+  }
+  out.Line("#platform\tname\tnum_snaps\tnum_divergent\thistogram");
+  for (const PlatformDivergenceSummary& summary :
+       SummarizeDivergenceByPlatform(divergences)) {
+    out.Line(FormatPlatformDivergenceSummary(summary));
+  }
+  LOG_INFO("Snaps: ", divergences.size(), " divergent: ", num_divergent,
+           " shards: ", shards.size());
+  return absl::OkStatus();
+}
+
+// Runs end_state_report. Unlike the other commands it takes any number of
+// <platform>:<corpus_file> arguments instead of a single corpus file.
+absl::Status EndStateReport(std::vector<char*>& args) {
+  if (args.empty()) {
+    return absl::InvalidArgumentError("Too few arguments");
+  }
+  std::vector<PlatformShard> shards;
+  while (!args.empty()) {
+    ASSIGN_OR_RETURN_IF_NOT_OK(PlatformShard shard,
+                               ParsePlatformShard(ConsumeArg(args)));
+    shards.push_back(std::move(shard));
+  }
+  ArchitectureId arch = CorpusFileArchitecture(shards.front().path.c_str());
+  return ARCH_DISPATCH(EndStateReportImpl, arch, shards);
+}
+
 absl::Status ToolMain(std::vector<char*>& args) {
   ConsumeArg(args);  // consume argv[0]
   std::string command = std::string(ConsumeArg(args));
+  if (command == "end_state_report") {
+    return EndStateReport(args);
+  }
   std::string corpus_file = std::string(ConsumeArg(args));
   ArchitectureId arch = CorpusFileArchitecture(corpus_file.data());
   return ARCH_DISPATCH(ToolMainImpl, arch, command, corpus_file, args);
@@ -49,8 +49,24 @@ function extract_code_address_test() {
   rm -f "${OUTPUT}"
 }
 
+function patch_test() {
+  SNAPSHOT="$(mktemp)"
+  OUTPUT="$(mktemp)"
+  ID=kEndsAsExpected
+  "${TOOL}" extract "${CORPUS}" ${ID} "${SNAPSHOT}"
+  # Replace the Snap with its own extracted snapshot.
+  "${TOOL}" --remove_snap_ids=${ID} --add_snapshots="${SNAPSHOT}" \
+    patch "${CORPUS}" "${OUTPUT}" 2>&1 \
+    | grep -q 'removed 1 added 1 rejected 0' \
+    || die "patch test failed"
+  "${TOOL}" list_snaps "${OUTPUT}" 2>&1 | grep -q -e "^${ID}$" \
+    || die "patched corpus is missing ${ID}"
+  rm -f "${SNAPSHOT}" "${OUTPUT}"
+}
+
 snap_corpus_tool_test
 extract_test
 extract_code_address_test
+patch_test
 
 echo "PASS"
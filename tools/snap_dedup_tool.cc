@@ -0,0 +1,167 @@
+// Copyright 2026 The SiliFuzz Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A tool that finds semantically identical Snaps across the shards of a
+// corpus and optionally removes the duplicates.
+//
+// Snaps are compared by SemanticSnapshotFingerprint(), so Snaps with
+// different IDs that run the same code from the same state to the same end
+// state are duplicates. The first Snap of each group, in the order shards are
+// given on the command line, is kept.
+//
+// Usage:
+//   snap_dedup_tool [optional flags] <corpus_0> .. <corpus_n>
+//
+// To list flags, use snap_dedup_tool --help.
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "./snap/snap.h"
+#include "./snap/snap_corpus_util.h"
+#include "./tool_libs/corpus_patcher_lib.h"
+#include "./tool_libs/snap_dedup_lib.h"
+#include "./util/arch.h"
+#include "./util/checks.h"
+#include "./util/enum_flag_types.h"
+#include "./util/mmapped_memory_ptr.h"
+#include "./util/path_util.h"
+#include "./util/platform.h"
+
+ABSL_FLAG(std::string, output_dir, "",
+          "If set, every shard that contains duplicates is written to this "
+          "directory under its original file name with the duplicates "
+          "removed. Shards without duplicates are not written.");
+ABSL_FLAG(int, parallelism, 0,
+          "Number of parallel worker threads. If it is 0, the tool uses the "
+          "maximum hardware parallelism.");
+ABSL_FLAG(silifuzz::PlatformId, target_platform,
+          silifuzz::PlatformId::kUndefined,
+          "Platform of the end states to compare. Defaults to the current "
+          "platform.");
+
+namespace silifuzz {
+namespace {
+
+absl::Status WriteFile(const std::string& path, const char* data,
+                       size_t size) {
+  std::ofstream os(path);
+  if (!os.is_open()) {
+    return absl::InternalError(absl::StrCat("Cannot open ", path));
+  }
+  os.write(data, size);
+  if (os.fail()) {
+    return absl::InternalError(absl::StrCat("Cannot write ", path));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Arch>
+absl::Status DedupCorpus(const std::vector<std::string>& corpus_files) {
+  PlatformId platform = absl::GetFlag(FLAGS_target_platform);
+  if (platform == PlatformId::kUndefined) platform = CurrentPlatformId();
+  if (PlatformArchitecture(platform) != Arch::architecture_id) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("--target_platform must be a ", Arch::arch_name,
+                     " platform"));
+  }
+
+  int parallelism = absl::GetFlag(FLAGS_parallelism);
+  if (parallelism == 0) {
+    parallelism = std::max(1u, std::thread::hardware_concurrency());
+  }
+  ASSIGN_OR_RETURN_IF_NOT_OK(
+      auto fingerprints,
+      FingerprintShards<Arch>(corpus_files, platform, parallelism));
+
+  size_t num_snaps = 0;
+  for (const auto& shard : fingerprints) num_snaps += shard.size();
+  std::vector<DuplicateGroup> groups = FindDuplicateSnaps(fingerprints);
+
+  // Report one line per group: the digest, the kept Snap and its duplicates.
+  std::vector<std::vector<std::string>> remove_ids(corpus_files.size());
+  size_t num_duplicates = 0;
+  for (const DuplicateGroup& group : groups) {
+    std::cout << group.digest << " keep " << group.keep.id << "@"
+              << Basename(corpus_files[group.keep.shard_index]);
+    for (const SnapLocation& duplicate : group.duplicates) {
+      std::cout << " " << duplicate.id << "@"
+                << Basename(corpus_files[duplicate.shard_index]);
+      remove_ids[duplicate.shard_index].push_back(duplicate.id);
+    }
+    std::cout << "\n";
+    num_duplicates += group.duplicates.size();
+  }
+  LOG_INFO("Found ", num_duplicates, " duplicates in ", groups.size(),
+           " groups among ", num_snaps, " Snaps in ", corpus_files.size(),
+           " shards");
+
+  const std::string output_dir = absl::GetFlag(FLAGS_output_dir);
+  if (output_dir.empty()) return absl::OkStatus();
+  for (size_t i = 0; i < corpus_files.size(); ++i) {
+    if (remove_ids[i].empty()) continue;
+    MmappedMemoryPtr<const SnapCorpus<Arch>> corpus =
+        LoadCorpusFromFile<Arch>(corpus_files[i].c_str(),
+                                 /* preload = */ false);
+    CorpusPatch patch{.remove_ids = std::move(remove_ids[i])};
+    ASSIGN_OR_RETURN_IF_NOT_OK(
+        CorpusPatchResult result,
+        PatchRelocatableCorpus(*corpus, platform, patch));
+    const std::string output =
+        absl::StrCat(output_dir, "/", Basename(corpus_files[i]));
+    RETURN_IF_NOT_OK(WriteFile(output, result.corpus.get(),
+                               MmappedMemorySize(result.corpus)));
+    LOG_INFO("Wrote ", output, ": kept ", result.num_kept, ", removed ",
+             result.num_removed);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ToolMain(const std::vector<std::string>& corpus_files) {
+  if (corpus_files.empty()) {
+    return absl::InvalidArgumentError("No input corpus files");
+  }
+  ArchitectureId arch = CorpusFileArchitecture(corpus_files[0].c_str());
+  for (const std::string& file : corpus_files) {
+    if (CorpusFileArchitecture(file.c_str()) != arch) {
+      return absl::InvalidArgumentError(
+          absl::StrCat(file, " is for a different architecture"));
+    }
+  }
+  return ARCH_DISPATCH(DedupCorpus, arch, corpus_files);
+}
+
+}  // namespace
+}  // namespace silifuzz
+
+int main(int argc, char* argv[]) {
+  std::vector<char*> positional_args = absl::ParseCommandLine(argc, argv);
+  std::vector<std::string> corpus_files(positional_args.begin() + 1,
+                                        positional_args.end());
+  absl::Status result = silifuzz::ToolMain(corpus_files);
+  if (!result.ok()) {
+    LOG_ERROR(result.message());
+  }
+  return result.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
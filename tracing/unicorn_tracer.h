@@ -15,13 +15,17 @@
 #ifndef THIRD_PARTY_SILIFUZZ_TRACING_UNICORN_TRACER_H_
 #define THIRD_PARTY_SILIFUZZ_TRACING_UNICORN_TRACER_H_
 
+#include <sys/mman.h>
+
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
-#include "absl/crc/crc32c.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -32,17 +36,44 @@
 #include "./tracing/unicorn_util.h"
 #include "./util/arch.h"
 #include "./util/checks.h"
+#include "./util/crc32c.h"
 #include "./util/itoa.h"
 #include "./util/ucontext/ucontext.h"
 #include "third_party/unicorn/unicorn.h"
 
 namespace silifuzz {
 
+// Register classes for UnicornTracer::GetRegisters(). Can be OR-ed together.
+// Only the x86-64 tracer reads register classes selectively. The AArch64
+// tracer always reads all registers.
+enum UnicornRegisterClass : uint32_t {
+  // General purpose, instruction pointer and segment registers.
+  kUnicornGPRegs = 1 << 0,
+  kUnicornFlagsReg = 1 << 1,
+  // x87 control, status and ST registers.
+  kUnicornX87Regs = 1 << 2,
+  // MXCSR and XMM registers.
+  kUnicornVectorRegs = 1 << 3,
+  kUnicornAllRegs =
+      kUnicornGPRegs | kUnicornFlagsReg | kUnicornX87Regs | kUnicornVectorRegs,
+};
+
 template <typename Arch>
 struct UnicornTracerConfig;
 
 template <>
-struct UnicornTracerConfig<X86_64> {};
+struct UnicornTracerConfig<X86_64> {
+  // Keep a shadow copy of the registers in the tracer. GetRegisters() reads
+  // each register class from Unicorn at most once per instruction and
+  // SetRegisters() only writes registers that changed, right before Unicorn
+  // resumes execution.
+  bool shadow_registers = true;
+
+  // Hook guest memory writes so that PartialChecksumOfMutableMemory() only
+  // rehashes pages written since the previous call. Memory hooks slow down
+  // emulation, so this only pays off for clients that checksum repeatedly.
+  bool track_dirty_pages = false;
+};
 
 template <>
 struct UnicornTracerConfig<AArch64> {
@@ -51,6 +82,9 @@ struct UnicornTracerConfig<AArch64> {
   // be compatible with most hardware you would want to run on.
   // By default Unicorn is roughly a A77+, it support sha512, sm3, and sm4.
   bool force_a72 = false;
+
+  // See UnicornTracerConfig<X86_64>::track_dirty_pages.
+  bool track_dirty_pages = false;
 };
 
 // An architecture-generic class for executing code snippets in Unicorn.
@@ -71,6 +105,11 @@ class UnicornTracer {
       uc_close(uc_);
       uc_ = nullptr;
     }
+    // Unicorn must be closed first, it may still reference host memory.
+    for (const HostMemory& memory : host_memory_) {
+      munmap(memory.data, memory.size);
+    }
+    host_memory_.clear();
   }
 
   // Prepare Unicorn to run a code snippet.
@@ -106,6 +145,21 @@ class UnicornTracer {
     UNICORN_CHECK(uc_hook_add(uc_, &hook_code_, UC_HOOK_CODE,
                               (void*)&DispatchHookCode, this, 1, 0));
 
+    // Only hook the pages PartialChecksumOfMutableMemory() looks at so that
+    // other writes do not pay for the callback.
+    track_dirty_pages_ = tracer_config.track_dirty_pages;
+    if (track_dirty_pages_) {
+      for (const HostMemory& memory : host_memory_) {
+        if (!(memory.prot & UC_PROT_WRITE)) continue;
+        uc_hook hook;
+        UNICORN_CHECK(uc_hook_add(
+            uc_, &hook, UC_HOOK_MEM_WRITE, (void*)&DispatchHookMemWrite, this,
+            memory.begin,
+            memory.begin + NumChecksummedPages(memory) * kChecksumPageSize -
+                1));
+      }
+    }
+
     return absl::OkStatus();
   }
 
@@ -138,8 +192,10 @@ class UnicornTracer {
     // Empirically, 1 second is about 20x-30x longer than execution takes in the
     // worst case on an unloaded machine.
     uint64_t timeout_microseconds = 1000000;
+    FlushRegisters();
     uc_err err = uc_emu_start(uc_, start_of_code_, end_of_code_,
                               timeout_microseconds, 0);
+    InvalidateRegisterShadow();
 
     // Check if the emulator stopped cleanly.
     if (err) {
@@ -188,36 +244,40 @@ class UnicornTracer {
   // value produced by an old version of the software against a value produced
   // by a new version of the software is not meaningful.
   uint32_t PartialChecksumOfMutableMemory() {
-    uint32_t count;
-    uc_mem_region* regions;
-    UNICORN_CHECK(uc_mem_regions(uc_, &regions, &count));
-    absl::crc32c_t checksum(0);
-    char data[4096];
-    for (uint32_t i = 0; i < count; ++i) {
-      if (regions[i].perms & UC_PROT_WRITE) {
-        // Empirically, checksumming the first 8 pages of each mutable region
-        // covers ~58% of the pages the proxy tends to dirty. Doubling this
-        // raises the coverage to 59%. Beyond the first few pages, the access
-        // patterns are fairly unpredictable, so we'd need to checksum vastly
-        // more memory to catch all the dirty pages. Unfortunately checksumming
-        // all the mutable memory on x86_64 would make fault injection ~18x
-        // slower. So we're trading some accuracy for a huge amount of speed.
-        uint64_t end_offset =
-            std::min(8 * 4096UL, regions[i].end - regions[i].begin + 1);
-        CHECK_EQ(end_offset % sizeof(data), 0);
-        for (uint64_t offset = 0; offset < end_offset; offset += sizeof(data)) {
-          // Note: if we originally mapped this memory with uc_mem_map_ptr then
-          // we could read it directly and avoid a copy. For a small number of
-          // pages, however, this doesn't offer a huge performance improvement.
-          UNICORN_CHECK(
-              uc_mem_read(uc_, regions[i].begin + offset, data, sizeof(data)));
-          checksum = absl::ExtendCrc32c(checksum,
-                                        absl::string_view(data, sizeof(data)));
+    // crc32c() of a zero-filled page, see below.
+    static const uint32_t kZeroPageChecksum =
+        crc32c_zero_extend(0, kChecksumPageSize);
+    uint32_t checksum = 0;
+    // host_memory_ is sorted by address, so the regions are checksummed in
+    // the same order Unicorn lists them.
+    for (HostMemory& memory : host_memory_) {
+      if (!(memory.prot & UC_PROT_WRITE)) continue;
+      // Empirically, checksumming the first 8 pages of each mutable region
+      // covers ~58% of the pages the proxy tends to dirty. Doubling this
+      // raises the coverage to 59%. Beyond the first few pages, the access
+      // patterns are fairly unpredictable, so we'd need to checksum vastly
+      // more memory to catch all the dirty pages. Unfortunately checksumming
+      // all the mutable memory on x86_64 would make fault injection ~18x
+      // slower. So we're trading some accuracy for a huge amount of speed.
+      const size_t num_pages = NumChecksummedPages(memory);
+      if (!track_dirty_pages_) {
+        checksum = crc32c(checksum, memory.data, num_pages * kChecksumPageSize);
+        continue;
+      }
+      for (size_t page = 0; page < num_pages; ++page) {
+        if (memory.dirty_pages & (1U << page)) {
+          memory.page_checksums[page] = crc32c(
+              0, memory.data + page * kChecksumPageSize, kChecksumPageSize);
         }
+        // Appending page P to data D gives the same checksum as appending a
+        // zero page to D and xor-ing in the difference P makes on its own:
+        // crc(D + P) == crc(D + 0) ^ crc(P) ^ crc(0).
+        checksum = crc32c_zero_extend(checksum, kChecksumPageSize) ^
+                   memory.page_checksums[page] ^ kZeroPageChecksum;
       }
+      memory.dirty_pages = 0;
     }
-    UNICORN_CHECK(uc_free(regions));
-    return static_cast<uint32_t>(checksum);
+    return checksum;
   }
 
   uint64_t GetCurrentInstructionPointer();
@@ -227,7 +287,11 @@ class UnicornTracer {
 
   // Read the current register state. Not all platforms can read all registers,
   // so some registers may be set to zero instead of their actual values.
-  void GetRegisters(UContext<Arch>& ucontext);
+  // Only registers in `register_classes` (a set of UnicornRegisterClass) are
+  // read, the rest of `ucontext` is zeroed. Callers that only look at a few
+  // registers should say so to save reading the others.
+  void GetRegisters(UContext<Arch>& ucontext,
+                    uint32_t register_classes = kUnicornAllRegs);
 
   // Write the current register state. Not all platforms can write all
   // registers, so some registers may not be updated.
@@ -249,14 +313,61 @@ class UnicornTracer {
   // and Snapshots. This may involve setting system registers, etc.
   void InitUnicorn(const UnicornTracerConfig<Arch>& tracer_config);
 
+  // Number of leading pages of each mutable region that
+  // PartialChecksumOfMutableMemory() covers.
+  static constexpr size_t kMutableMemoryChecksumPages = 8;
+  static constexpr size_t kChecksumPageSize = 4096;
+
+  // Guest memory mapped with uc_mem_map_ptr() onto host memory owned by the
+  // tracer, so the tracer can read guest memory without copying it out of
+  // Unicorn.
+  struct HostMemory {
+    uint64_t begin;
+    uint64_t size;
+    uint32_t prot;
+    uint8_t* data;
+    // Checksums of the leading pages of the region and a bitmask of the pages
+    // written since their checksum was computed. Only used when tracking
+    // dirty pages.
+    std::array<uint32_t, kMutableMemoryChecksumPages> page_checksums;
+    uint32_t dirty_pages;
+  };
+
+  static size_t NumChecksummedPages(const HostMemory& memory) {
+    return std::min(kMutableMemoryChecksumPages,
+                    memory.size / kChecksumPageSize);
+  }
+
   // Create a memory mapping or die. Helps avoid error handling in the cases we
   // know should succeed unless there is a bug.
   void MapMemory(uint64_t addr, uint64_t size, uint32_t prot) {
-    uc_err err = uc_mem_map(uc_, addr, size, prot);
+    CHECK_EQ(size % kChecksumPageSize, 0);
+    // The x86_64 data regions are large and mostly untouched, don't reserve
+    // swap for them.
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED) {
+      LOG_FATAL("mmap of ", HexStr(size), " bytes failed: ", ErrnoStr(errno));
+    }
+    uc_err err = uc_mem_map_ptr(uc_, addr, size, prot, data);
     if (err != UC_ERR_OK) {
       LOG_FATAL("mapping ", HexStr(addr), " + ", HexStr(size), " failed with ",
                 IntStr(err), ": ", uc_strerror(err));
     }
+    HostMemory memory = {
+        .begin = addr,
+        .size = size,
+        .prot = prot,
+        .data = static_cast<uint8_t*>(data),
+        .page_checksums = {},
+        .dirty_pages = (1U << kMutableMemoryChecksumPages) - 1,
+    };
+    host_memory_.insert(
+        std::upper_bound(host_memory_.begin(), host_memory_.end(), memory,
+                         [](const HostMemory& a, const HostMemory& b) {
+                           return a.begin < b.begin;
+                         }),
+        memory);
   }
 
   // Setup the memory mappings and memory contents for a snippet that has been
@@ -275,7 +386,20 @@ class UnicornTracer {
   // will prevent turning this into a valid Snapshot.
   absl::Status ValidateArchEndState();
 
+  // Writes registers marked dirty in the register shadow to Unicorn.
+  // Must be called before Unicorn executes any instruction.
+  void FlushRegisters();
+
+  // Forgets all register values in the register shadow. Must be called after
+  // Unicorn executed instructions.
+  void InvalidateRegisterShadow() {
+    DCHECK_EQ(shadow_dirty_, 0);
+    shadow_valid_ = 0;
+  }
+
   void HookCode(uint64_t address, uint32_t size) {
+    // The previous instruction has executed since the last hook.
+    InvalidateRegisterShadow();
     if (num_instructions_ >= max_instructions_) {
       // QEMU x86_64 may not always respect uc_emu_stop().
       // Similar to Unicorn, we'll call stop repeatedly once the limit has been
@@ -297,6 +421,9 @@ class UnicornTracer {
       // may not so we treat "size" as a maximum size for the instruction,
       // which happens to be exact for this particular tracer.
       instruction_callback_(this, address, size);
+      // Register writes in the callback must take effect before Unicorn
+      // executes the instruction.
+      FlushRegisters();
     }
     num_instructions_++;
   }
@@ -307,8 +434,36 @@ class UnicornTracer {
     tracer->HookCode(address, size);
   }
 
+  void HookMemWrite(uint64_t address, int size) {
+    const uint64_t end = address + size;
+    for (HostMemory& memory : host_memory_) {
+      const uint64_t checksummed_end =
+          memory.begin + NumChecksummedPages(memory) * kChecksumPageSize;
+      if (end <= memory.begin || address >= checksummed_end) continue;
+      const uint64_t first_page =
+          (std::max(address, memory.begin) - memory.begin) / kChecksumPageSize;
+      const uint64_t last_page =
+          (std::min(end, checksummed_end) - 1 - memory.begin) /
+          kChecksumPageSize;
+      for (uint64_t page = first_page; page <= last_page; ++page) {
+        memory.dirty_pages |= 1U << page;
+      }
+    }
+  }
+
+  static void DispatchHookMemWrite(uc_engine* uc, uc_mem_type type,
+                                   uint64_t address, int size, int64_t value,
+                                   void* user_data) {
+    UnicornTracer<Arch>* tracer = static_cast<UnicornTracer<Arch>*>(user_data);
+    tracer->HookMemWrite(address, size);
+  }
+
   uc_engine* uc_;
 
+  // Sorted by `begin`.
+  std::vector<HostMemory> host_memory_;
+  bool track_dirty_pages_ = false;
+
   uint64_t start_of_code_;
   uint64_t end_of_code_;
 
@@ -319,6 +474,16 @@ class UnicornTracer {
   bool should_be_stopped_;
 
   std::function<InstructionCallback> instruction_callback_;
+
+  // Register shadow, only used by the x86-64 tracer.
+  // shadow_registers_ holds the values of the register classes in
+  // shadow_valid_ as of the current instruction boundary, including writes not
+  // yet flushed to Unicorn. Bit i of shadow_dirty_ marks the i-th register of
+  // the arch-specific register table as not flushed.
+  bool shadow_enabled_ = false;
+  UContext<Arch> shadow_registers_ = {};
+  uint32_t shadow_valid_ = 0;
+  uint64_t shadow_dirty_ = 0;
 };
 
 }  // namespace silifuzz
@@ -305,7 +305,9 @@ void UnicornTracer<AArch64>::SetupSnippetMemory(
 }
 
 template <>
-void UnicornTracer<AArch64>::GetRegisters(UContext<AArch64> &ucontext) {
+void UnicornTracer<AArch64>::GetRegisters(UContext<AArch64> &ucontext,
+                                          uint32_t register_classes) {
+  // Register classes are x86-64 specific, all registers are read.
   // Not all registers will be read. memset so the result is consistent.
   memset(&ucontext, 0, sizeof(ucontext));
   std::array<const void *, kNumUnicornAArch64Reg> ptrs =
@@ -335,6 +337,11 @@ void UnicornTracer<AArch64>::SetInitialRegisters(
   SetRegisters(ucontext);
 }
 
+template <>
+void UnicornTracer<AArch64>::FlushRegisters() {
+  // No register shadow, registers are written immediately.
+}
+
 template <>
 absl::Status UnicornTracer<AArch64>::ValidateArchEndState() {
   // aarch64 requires that stack pointers are 16-byte aligned when they are
@@ -14,13 +14,18 @@
 
 #include "./tracing/unicorn_tracer.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/crc/crc32c.h"
 #include "absl/log/check.h"
+#include "absl/strings/string_view.h"
+#include "./common/proxy_config.h"
 #include "./common/snapshot_test_config.h"
 #include "./common/snapshot_test_enum.h"
 #include "./util/arch.h"
@@ -216,6 +221,100 @@ TYPED_TEST(UnicornTracerTest, SetGetRegisters) {
   EXPECT_EQ(src.fpregs, dst.fpregs);
 }
 
+// Stores to the first page of data1 and to the second page of data2.
+template <typename Arch>
+std::string MemoryWritingSnippet();
+
+template <>
+std::string MemoryWritingSnippet<X86_64>() {
+  // mov rax, 0x10000
+  // mov [rax], rax
+  // movabs rax, 0x1000011000
+  // mov [rax], rax
+  return std::string(
+      "\x48\xC7\xC0\x00\x00\x01\x00\x48\x89\x00"
+      "\x48\xB8\x00\x10\x01\x00\x10\x00\x00\x00\x48\x89\x00",
+      23);
+}
+
+template <>
+std::string MemoryWritingSnippet<AArch64>() {
+  // movz x0, #0x7, lsl #32
+  // str x0, [x0]
+  // movz x1, #0x1007, lsl #32
+  // movk x1, #0x1000
+  // str x1, [x1]
+  return std::string(
+      "\xE0\x00\xC0\xD2\x00\x00\x00\xF9"
+      "\xE1\x00\xC2\xD2\x01\x00\x82\xF2\x21\x00\x00\xF9",
+      20);
+}
+
+// The writable regions of a snippet, in address order.
+std::vector<MemoryRange> WritableRegions(
+    const FuzzingConfig<X86_64>& config) {
+  // The stack lives in data1.
+  return {config.data1_range, config.data2_range};
+}
+
+std::vector<MemoryRange> WritableRegions(
+    const FuzzingConfig<AArch64>& config) {
+  return {config.stack_range, config.data1_range, config.data2_range};
+}
+
+// PartialChecksumOfMutableMemory() as it was before guest memory was backed
+// by host memory: the first 8 pages of each writable region copied out of
+// Unicorn, in address order.
+template <typename Arch>
+uint32_t ReferenceChecksumOfMutableMemory(UnicornTracer<Arch>& tracer) {
+  std::vector<MemoryRange> regions =
+      WritableRegions(DEFAULT_FUZZING_CONFIG<Arch>);
+  std::sort(regions.begin(), regions.end(),
+            [](const MemoryRange& a, const MemoryRange& b) {
+              return a.start_address < b.start_address;
+            });
+  absl::crc32c_t checksum(0);
+  char data[4096];
+  for (const MemoryRange& region : regions) {
+    uint64_t end_offset = std::min<uint64_t>(8 * 4096, region.num_bytes);
+    for (uint64_t offset = 0; offset < end_offset; offset += sizeof(data)) {
+      tracer.ReadMemory(region.start_address + offset, data, sizeof(data));
+      checksum =
+          absl::ExtendCrc32c(checksum, absl::string_view(data, sizeof(data)));
+    }
+  }
+  return static_cast<uint32_t>(checksum);
+}
+
+TYPED_TEST(UnicornTracerTest, PartialChecksumOfMutableMemory) {
+  std::string instructions = MemoryWritingSnippet<TypeParam>();
+
+  for (bool track_dirty_pages : {false, true}) {
+    SCOPED_TRACE(track_dirty_pages ? "tracking dirty pages"
+                                   : "not tracking dirty pages");
+    UnicornTracerConfig<TypeParam> config;
+    config.track_dirty_pages = track_dirty_pages;
+    UnicornTracer<TypeParam> tracer;
+    ASSERT_THAT(tracer.InitSnippet(instructions, config), IsOk());
+    const uint32_t initial_checksum = tracer.PartialChecksumOfMutableMemory();
+    EXPECT_EQ(initial_checksum, ReferenceChecksumOfMutableMemory(tracer));
+
+    // Checksum repeatedly while the snippet dirties memory.
+    tracer.SetInstructionCallback(
+        [&](UnicornTracer<TypeParam>* tracer, uint64_t address, uint32_t size) {
+          EXPECT_EQ(tracer->PartialChecksumOfMutableMemory(),
+                    ReferenceChecksumOfMutableMemory(*tracer));
+        });
+    ASSERT_THAT(tracer.Run(10), IsOk());
+
+    const uint32_t final_checksum = tracer.PartialChecksumOfMutableMemory();
+    EXPECT_EQ(final_checksum, ReferenceChecksumOfMutableMemory(tracer));
+    EXPECT_NE(final_checksum, initial_checksum);
+    // Nothing changed since the last call.
+    EXPECT_EQ(tracer.PartialChecksumOfMutableMemory(), final_checksum);
+  }
+}
+
 }  // namespace
 
 }  // namespace silifuzz
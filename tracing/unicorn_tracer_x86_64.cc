@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <array>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "absl/status/status.h"
@@ -115,84 +117,199 @@ const int kUnicornX86_64RegNames[] = {
 
 static_assert(std::size(kUnicornX86_64RegNames) == kNumUnicornX86_64Reg);
 
-std::array<const void *, kNumUnicornX86_64Reg> UnicornX86_64RegValue(
+// Register classes of the registers in kUnicornX86_64RegNames.
+const uint32_t kUnicornX86_64RegClasses[] = {
+    // GP Reg
+    kUnicornGPRegs,  // r8
+    kUnicornGPRegs,  // r9
+    kUnicornGPRegs,  // r10
+    kUnicornGPRegs,  // r11
+    kUnicornGPRegs,  // r12
+    kUnicornGPRegs,  // r13
+    kUnicornGPRegs,  // r14
+    kUnicornGPRegs,  // r15
+    kUnicornGPRegs,  // rdi
+    kUnicornGPRegs,  // rsi
+    kUnicornGPRegs,  // rbp
+    kUnicornGPRegs,  // rbx
+    kUnicornGPRegs,  // rdx
+    kUnicornGPRegs,  // rax
+    kUnicornGPRegs,  // rcx
+
+    kUnicornGPRegs,    // rsp
+    kUnicornGPRegs,    // rip
+    kUnicornFlagsReg,  // eflags
+
+    kUnicornGPRegs,  // cs
+    kUnicornGPRegs,  // es
+    kUnicornGPRegs,  // ds
+    kUnicornGPRegs,  // fs
+    kUnicornGPRegs,  // gs
+    kUnicornGPRegs,  // ss
+
+    kUnicornGPRegs,  // fs_base
+    kUnicornGPRegs,  // gs_base
+
+    // FP Reg
+    kUnicornX87Regs,  // fpcw
+    kUnicornX87Regs,  // fpsw
+
+    kUnicornX87Regs,  // fop
+    kUnicornX87Regs,  // fip
+    kUnicornX87Regs,  // fdp
+
+    kUnicornVectorRegs,  // mxcsr
+
+    kUnicornX87Regs,  // st0
+    kUnicornX87Regs,  // st1
+    kUnicornX87Regs,  // st2
+    kUnicornX87Regs,  // st3
+    kUnicornX87Regs,  // st4
+    kUnicornX87Regs,  // st5
+    kUnicornX87Regs,  // st6
+    kUnicornX87Regs,  // st7
+
+    kUnicornVectorRegs,  // xmm0
+    kUnicornVectorRegs,  // xmm1
+    kUnicornVectorRegs,  // xmm2
+    kUnicornVectorRegs,  // xmm3
+    kUnicornVectorRegs,  // xmm4
+    kUnicornVectorRegs,  // xmm5
+    kUnicornVectorRegs,  // xmm6
+    kUnicornVectorRegs,  // xmm7
+    kUnicornVectorRegs,  // xmm8
+    kUnicornVectorRegs,  // xmm9
+    kUnicornVectorRegs,  // xmm10
+    kUnicornVectorRegs,  // xmm11
+    kUnicornVectorRegs,  // xmm12
+    kUnicornVectorRegs,  // xmm13
+    kUnicornVectorRegs,  // xmm14
+    kUnicornVectorRegs,  // xmm15
+};
+
+static_assert(std::size(kUnicornX86_64RegClasses) == kNumUnicornX86_64Reg);
+// The register shadow keeps one dirty bit per register.
+static_assert(kNumUnicornX86_64Reg <= 64);
+
+// Index range of the segment registers and their bases in
+// kUnicornX86_64RegNames. Writing a segment selector may reset the base, so
+// these are always written together.
+constexpr size_t kFirstSegmentReg = 18;
+constexpr size_t kLimitSegmentReg = 26;
+constexpr uint64_t kSegmentRegsMask =
+    ((1ULL << kLimitSegmentReg) - 1) & ~((1ULL << kFirstSegmentReg) - 1);
+
+// A register in a UContext<X86_64> and the number of bytes Unicorn reads or
+// writes for it.
+struct UnicornX86_64Reg {
+  const void *value;
+  size_t size;
+};
+
+template <typename T>
+UnicornX86_64Reg Reg(const T &value) {
+  return {&value, sizeof(value)};
+}
+
+// Unicorn transfers the 80 bits of an x87 register and leaves the rest of the
+// slot alone.
+UnicornX86_64Reg X87Reg(const __uint128_t &value) { return {&value, 10}; }
+
+std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> UnicornX86_64RegValue(
     const UContext<X86_64> &ucontext) {
   const GRegSet<X86_64> &gregs = ucontext.gregs;
   const FPRegSet<X86_64> &fpregs = ucontext.fpregs;
 
   return {
       // GP Reg
-      &gregs.r8,
-      &gregs.r9,
-      &gregs.r10,
-      &gregs.r11,
-      &gregs.r12,
-      &gregs.r13,
-      &gregs.r14,
-      &gregs.r15,
-      &gregs.rdi,
-      &gregs.rsi,
-      &gregs.rbp,
-      &gregs.rbx,
-      &gregs.rdx,
-      &gregs.rax,
-      &gregs.rcx,
-      &gregs.rsp,
-      &gregs.rip,
-      &gregs.eflags,
-
-      &gregs.cs,
-      &gregs.es,
-      &gregs.ds,
-      &gregs.fs,
-      &gregs.gs,
-      &gregs.ss,
-
-      &gregs.fs_base,
-      &gregs.gs_base,
+      Reg(gregs.r8),
+      Reg(gregs.r9),
+      Reg(gregs.r10),
+      Reg(gregs.r11),
+      Reg(gregs.r12),
+      Reg(gregs.r13),
+      Reg(gregs.r14),
+      Reg(gregs.r15),
+      Reg(gregs.rdi),
+      Reg(gregs.rsi),
+      Reg(gregs.rbp),
+      Reg(gregs.rbx),
+      Reg(gregs.rdx),
+      Reg(gregs.rax),
+      Reg(gregs.rcx),
+      Reg(gregs.rsp),
+      Reg(gregs.rip),
+      Reg(gregs.eflags),
+
+      Reg(gregs.cs),
+      Reg(gregs.es),
+      Reg(gregs.ds),
+      Reg(gregs.fs),
+      Reg(gregs.gs),
+      Reg(gregs.ss),
+
+      Reg(gregs.fs_base),
+      Reg(gregs.gs_base),
 
       // FP Reg
-      &fpregs.fcw,
-      &fpregs.fsw,
-
-      &fpregs.fop,
-      &fpregs.rip,
-      &fpregs.rdp,
-
-      &fpregs.mxcsr,
-
-      &fpregs.st[0],
-      &fpregs.st[1],
-      &fpregs.st[2],
-      &fpregs.st[3],
-      &fpregs.st[4],
-      &fpregs.st[5],
-      &fpregs.st[6],
-      &fpregs.st[7],
-
-      &fpregs.xmm[0],
-      &fpregs.xmm[1],
-      &fpregs.xmm[2],
-      &fpregs.xmm[3],
-      &fpregs.xmm[4],
-      &fpregs.xmm[5],
-      &fpregs.xmm[6],
-      &fpregs.xmm[7],
-      &fpregs.xmm[8],
-      &fpregs.xmm[9],
-      &fpregs.xmm[10],
-      &fpregs.xmm[11],
-      &fpregs.xmm[12],
-      &fpregs.xmm[13],
-      &fpregs.xmm[14],
-      &fpregs.xmm[15],
+      Reg(fpregs.fcw),
+      Reg(fpregs.fsw),
+
+      Reg(fpregs.fop),
+      Reg(fpregs.rip),
+      Reg(fpregs.rdp),
+
+      Reg(fpregs.mxcsr),
+
+      X87Reg(fpregs.st[0]),
+      X87Reg(fpregs.st[1]),
+      X87Reg(fpregs.st[2]),
+      X87Reg(fpregs.st[3]),
+      X87Reg(fpregs.st[4]),
+      X87Reg(fpregs.st[5]),
+      X87Reg(fpregs.st[6]),
+      X87Reg(fpregs.st[7]),
+
+      Reg(fpregs.xmm[0]),
+      Reg(fpregs.xmm[1]),
+      Reg(fpregs.xmm[2]),
+      Reg(fpregs.xmm[3]),
+      Reg(fpregs.xmm[4]),
+      Reg(fpregs.xmm[5]),
+      Reg(fpregs.xmm[6]),
+      Reg(fpregs.xmm[7]),
+      Reg(fpregs.xmm[8]),
+      Reg(fpregs.xmm[9]),
+      Reg(fpregs.xmm[10]),
+      Reg(fpregs.xmm[11]),
+      Reg(fpregs.xmm[12]),
+      Reg(fpregs.xmm[13]),
+      Reg(fpregs.xmm[14]),
+      Reg(fpregs.xmm[15]),
   };
 }
 
 }  // namespace
 
+template <>
+void UnicornTracer<X86_64>::FlushRegisters() {
+  if (shadow_dirty_ == 0) return;
+  std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> shadow =
+      UnicornX86_64RegValue(shadow_registers_);
+  // In table order, like SetRegisters() without the shadow.
+  for (uint64_t dirty = shadow_dirty_; dirty != 0; dirty &= dirty - 1) {
+    const size_t i = std::countr_zero(dirty);
+    uc_reg_write(uc_, kUnicornX86_64RegNames[i], shadow[i].value);
+    // Unicorn may normalize the value, read it back when asked for.
+    shadow_valid_ &= ~kUnicornX86_64RegClasses[i];
+  }
+  shadow_dirty_ = 0;
+}
+
 template <>
 uint64_t UnicornTracer<X86_64>::GetCurrentInstructionPointer() {
+  FlushRegisters();
+  if (shadow_valid_ & kUnicornGPRegs) return shadow_registers_.gregs.rip;
   uint64_t pc = 0;
   UNICORN_CHECK(uc_reg_read(uc_, UC_X86_REG_RIP, &pc));
   return pc;
@@ -200,11 +317,16 @@ uint64_t UnicornTracer<X86_64>::GetCurrentInstructionPointer() {
 
 template <>
 void UnicornTracer<X86_64>::SetCurrentInstructionPointer(uint64_t address) {
+  // Pending writes must not override this one later.
+  FlushRegisters();
   UNICORN_CHECK(uc_reg_write(uc_, UC_X86_REG_RIP, &address));
+  shadow_registers_.gregs.rip = address;
 }
 
 template <>
 uint64_t UnicornTracer<X86_64>::GetCurrentStackPointer() {
+  FlushRegisters();
+  if (shadow_valid_ & kUnicornGPRegs) return shadow_registers_.gregs.rsp;
   uint64_t sp = 0;
   UNICORN_CHECK(uc_reg_read(uc_, UC_X86_REG_RSP, &sp));
   return sp;
@@ -215,6 +337,11 @@ void UnicornTracer<X86_64>::InitUnicorn(
     const UnicornTracerConfig<X86_64> &tracer_config) {
   UNICORN_CHECK(uc_open(UC_ARCH_X86, UC_MODE_64, &uc_));
 
+  shadow_enabled_ = tracer_config.shadow_registers;
+  shadow_registers_ = {};
+  shadow_valid_ = 0;
+  shadow_dirty_ = 0;
+
   // TODO(ncbray): make this configurable.
   UNICORN_CHECK(uc_ctl_set_cpu_model(uc_, UC_CPU_X86_CASCADELAKE_SERVER));
 
@@ -258,17 +385,63 @@ void UnicornTracer<X86_64>::SetupSnippetMemory(
 }
 
 template <>
-void UnicornTracer<X86_64>::GetRegisters(UContext<X86_64> &ucontext) {
-  // Not all registers will be read. Unicorn also does not set the upper bits of
-  // st registers. memset so the result is consistent.
+void UnicornTracer<X86_64>::GetRegisters(UContext<X86_64> &ucontext,
+                                         uint32_t register_classes) {
+  if (!shadow_enabled_) {
+    // Not all registers will be read. Unicorn also does not set the upper bits
+    // of st registers. memset so the result is consistent.
+    memset(&ucontext, 0, sizeof(ucontext));
+    std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> regs =
+        UnicornX86_64RegValue(ucontext);
+    for (size_t i = 0; i < kNumUnicornX86_64Reg; ++i) {
+      // It's a bit hackish to cast away the constness of
+      // UnicornX86_64RegValue, but it's cleaner than having two const and
+      // non-const versions of the function.
+      uc_reg_read(uc_, kUnicornX86_64RegNames[i],
+                  const_cast<void *>(regs[i].value));
+    }
+    return;
+  }
+
+  // Unicorn may normalize written values, so written registers are read back.
+  FlushRegisters();
+  std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> shadow =
+      UnicornX86_64RegValue(shadow_registers_);
+  const uint32_t missing = register_classes & ~shadow_valid_;
+  if (missing != 0) {
+    // Scalar registers are read with one batch call. Vector and x87 registers
+    // are read one by one like SetRegisters() writes them, batching them is
+    // unreliable.
+    int batch_names[kNumUnicornX86_64Reg];
+    void *batch_values[kNumUnicornX86_64Reg];
+    int batch_size = 0;
+    for (size_t i = 0; i < kNumUnicornX86_64Reg; ++i) {
+      if ((kUnicornX86_64RegClasses[i] & missing) == 0) continue;
+      void *value = const_cast<void *>(shadow[i].value);
+      if (shadow[i].size <= sizeof(uint64_t)) {
+        batch_names[batch_size] = kUnicornX86_64RegNames[i];
+        batch_values[batch_size] = value;
+        ++batch_size;
+      } else {
+        uc_reg_read(uc_, kUnicornX86_64RegNames[i], value);
+      }
+    }
+    if (batch_size > 0) {
+      uc_reg_read_batch(uc_, batch_names, batch_values, batch_size);
+    }
+    shadow_valid_ |= missing;
+  }
+
+  if (register_classes == kUnicornAllRegs) {
+    ucontext = shadow_registers_;
+    return;
+  }
   memset(&ucontext, 0, sizeof(ucontext));
-  std::array<const void *, kNumUnicornX86_64Reg> ptrs =
+  std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> regs =
       UnicornX86_64RegValue(ucontext);
   for (size_t i = 0; i < kNumUnicornX86_64Reg; ++i) {
-    // It's a bit hackish to cast away the constness of UnicornX86_64RegValue,
-    // but it's cleaner than having two const and non-const versions of the
-    // function.
-    uc_reg_read(uc_, kUnicornX86_64RegNames[i], const_cast<void *>(ptrs[i]));
+    if ((kUnicornX86_64RegClasses[i] & register_classes) == 0) continue;
+    memcpy(const_cast<void *>(regs[i].value), shadow[i].value, shadow[i].size);
   }
 }
 
@@ -277,11 +450,31 @@ void UnicornTracer<X86_64>::SetRegisters(const UContext<X86_64> &ucontext) {
   // uc_reg_write_batch does not seem to set all of the registers correctly,
   // (the higher XMM registers for example) but individual uc_reg_write calls
   // seem to work fine.
-  std::array<const void *, kNumUnicornX86_64Reg> ptrs =
+  std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> regs =
       UnicornX86_64RegValue(ucontext);
+  if (!shadow_enabled_) {
+    for (size_t i = 0; i < kNumUnicornX86_64Reg; ++i) {
+      uc_reg_write(uc_, kUnicornX86_64RegNames[i], regs[i].value);
+    }
+    return;
+  }
+
+  // Only registers that differ from the shadow are marked dirty. They are
+  // written by FlushRegisters() before Unicorn needs them.
+  std::array<UnicornX86_64Reg, kNumUnicornX86_64Reg> shadow =
+      UnicornX86_64RegValue(shadow_registers_);
+  uint64_t dirty = 0;
   for (size_t i = 0; i < kNumUnicornX86_64Reg; ++i) {
-    uc_reg_write(uc_, kUnicornX86_64RegNames[i], ptrs[i]);
+    void *shadow_value = const_cast<void *>(shadow[i].value);
+    if ((shadow_valid_ & kUnicornX86_64RegClasses[i]) != 0 &&
+        memcmp(shadow_value, regs[i].value, regs[i].size) == 0) {
+      continue;
+    }
+    memcpy(shadow_value, regs[i].value, regs[i].size);
+    dirty |= 1ULL << i;
   }
+  if (dirty & kSegmentRegsMask) dirty |= kSegmentRegsMask;
+  shadow_dirty_ |= dirty;
 }
 
 template <>
@@ -313,6 +506,7 @@ void UnicornTracer<X86_64>::SetInitialRegisters(
   // executed. Switching between these modes will flush the code translation
   // buffer in Unicorn v2.
   UNICORN_CHECK(uc_emu_start(uc_, code_begin, code_end, 0, 0));
+  InvalidateRegisterShadow();
   UNICORN_CHECK(uc_mem_unmap(uc_, addr, kPageSize));
 
   // This will redundantly set some of the floating point registers, but that
@@ -30,11 +30,15 @@ extern "C" bool HasAVX512Registers();
 // This is part of AVX-512 state that can only be cleared using AVX-512F. The
 // lower 16 AVX registers can be cleared using AVX instruction vzeroupper.
 //
+// This puts the cleared registers in their initial configuration as tracked
+// by XINUSE. It also clobbers %rax and %rdx.
+//
 // REQUIRES: HasAVX512Registers() returns true.
 //
-// This cannot be called from C++ code. The x86_64 ABI specifies all AVX
-// registers as caller-saved. A C++ caller saves all live AVX registers before
-// calling this and restores those registers after call.
+// This cannot be called from C++ code compiled with AVX-512 enabled. The
+// x86_64 ABI specifies all AVX registers as caller-saved. Such a caller saves
+// all live AVX registers before calling this and restores those registers
+// after call.
 //
 // This is in "C" namespace like HasAVX512Registers() above.
 extern "C" void ClearAVX512OnlyState();
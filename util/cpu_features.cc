@@ -22,8 +22,9 @@ namespace silifuzz {
 template <>
 ABSL_CONST_INIT const char*
     EnumNameMap<X86CPUFeatures>[static_cast<int>(X86CPUFeatures::kEnd)] = {
-        "AMX_TILE", "AVX", "AVX512BW", "AVX512F",
-        "OSXSAVE",  "SSE", "SSE4_2",   "XSAVE",
+        "AMX_TILE", "AVX",    "AVX512BW", "AVX512F",
+        "OSXSAVE",  "SSE",    "SSE4_2",   "XGETBV1",
+        "XSAVE",
 };
 
 }
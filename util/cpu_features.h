@@ -30,6 +30,7 @@ enum class X86CPUFeatures {
   kOSXSAVE,  // OS provides processor extended state management.
   kSSE,      // for accessing SSE registers.
   kSSE4_2,   // for CRC32 instructions.
+  kXGETBV1,  // XGETBV with ECX=1 returns XINUSE.
   kXSAVE,    // CPU support XSAVE and related instructions.
   kEnd,      // One past the last valid value.
 };
@@ -138,4 +138,63 @@ bool MemAllEqualTo(const void* src, uint8_t c, size_t n) {
   }
 }
 
+void MemSetPattern(void* dest, const void* pattern, size_t pattern_size,
+                   size_t n)
+    __attribute__((no_builtin("memcpy"))) /* See MemCopy() above */ {
+  // Optimize only if dest, pattern and pattern_size are all 8-byte aligned.
+  if (reinterpret_cast<uintptr_t>(dest) % sizeof(uint64_t) != 0 ||
+      reinterpret_cast<uintptr_t>(pattern) % sizeof(uint64_t) != 0 ||
+      pattern_size % sizeof(uint64_t) != 0) {
+    uint8_t* dest_u8 = reinterpret_cast<uint8_t*>(dest);
+    const uint8_t* pattern_u8 = reinterpret_cast<const uint8_t*>(pattern);
+    for (size_t i = 0; i < n; ++i) {
+      dest_u8[i] = pattern_u8[i % pattern_size];
+    }
+    return;
+  }
+
+  // The pattern is small enough to live in registers. Store it one word at a
+  // time without re-reading the destination.
+  const size_t num_u64s = n / sizeof(uint64_t);
+  const size_t pattern_u64s = pattern_size / sizeof(uint64_t);
+  uint64_t* dest_u64 = reinterpret_cast<uint64_t*>(dest);
+  const uint64_t* pattern_u64 = reinterpret_cast<const uint64_t*>(pattern);
+  for (size_t i = 0; i < num_u64s; i += pattern_u64s) {
+    for (size_t j = 0; j < pattern_u64s; ++j) {
+      dest_u64[i + j] = pattern_u64[j];
+    }
+  }
+}
+
+bool MemAllEqualToPattern(const void* src, const void* pattern,
+                          size_t pattern_size, size_t n)
+    __attribute__((no_builtin("memcmp"))) /* See MemCopy() above */ {
+  // Optimize only if src, pattern and pattern_size are all 8-byte aligned.
+  if (reinterpret_cast<uintptr_t>(src) % sizeof(uint64_t) != 0 ||
+      reinterpret_cast<uintptr_t>(pattern) % sizeof(uint64_t) != 0 ||
+      pattern_size % sizeof(uint64_t) != 0) {
+    const uint8_t* src_u8 = reinterpret_cast<const uint8_t*>(src);
+    const uint8_t* pattern_u8 = reinterpret_cast<const uint8_t*>(pattern);
+    for (size_t i = 0; i < n; ++i) {
+      if (src_u8[i] != pattern_u8[i % pattern_size]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Optimized for the positive case like MemEq().
+  const size_t num_u64s = n / sizeof(uint64_t);
+  const size_t pattern_u64s = pattern_size / sizeof(uint64_t);
+  const uint64_t* src_u64 = reinterpret_cast<const uint64_t*>(src);
+  const uint64_t* pattern_u64 = reinterpret_cast<const uint64_t*>(pattern);
+  uint64_t diff = 0;
+  for (size_t i = 0; i < num_u64s; i += pattern_u64s) {
+    for (size_t j = 0; j < pattern_u64s; ++j) {
+      diff |= src_u64[i + j] ^ pattern_u64[j];
+    }
+  }
+  return diff == 0;
+}
+
 }  // namespace silifuzz
@@ -53,6 +53,25 @@ inline bool MemEqT(const T& s1, const T& s2) {
 // Performance may degrade significantly for all other cases.
 bool MemAllEqualTo(const void* src, uint8_t c, size_t n);
 
+// Fills n bytes at address dest with copies of the pattern_size bytes at
+// address pattern. This is optimized for the case that dest, pattern and
+// pattern_size are all aligned by 8. Performance may degrade significantly for
+// all other cases.
+//
+// REQUIRES: pattern_size > 0 and n is a multiple of pattern_size.
+// REQUIRES: [dest, dest+n) and [pattern, pattern+pattern_size) do not overlap.
+void MemSetPattern(void* dest, const void* pattern, size_t pattern_size,
+                   size_t n);
+
+// Returns true iff the n bytes at src address are copies of the pattern_size
+// bytes at address pattern. This is optimized for the case that src, pattern
+// and pattern_size are all aligned by 8. Performance may degrade significantly
+// for all other cases.
+//
+// REQUIRES: pattern_size > 0 and n is a multiple of pattern_size.
+bool MemAllEqualToPattern(const void* src, const void* pattern,
+                          size_t pattern_size, size_t n);
+
 }  // namespace silifuzz
 
 #endif  // THIRD_PARTY_SILIFUZZ_UTIL_MEM_UTIL_H_
@@ -131,6 +131,16 @@ typedef bool (*MemoryCompareFunc)(const void* s1, const void* s2, size_t n);
 typedef void (*MemoryCopyFunc)(void* dest, const void* src, size_t n);
 typedef void (*MemorySetFunc)(void* dest, uint8_t c, size_t n);
 typedef bool (*MemoryAllEqualToFunc)(const void* src, uint8_t c, size_t n);
+typedef void (*MemorySetPatternFunc)(void* dest, const void* pattern,
+                                     size_t pattern_size, size_t n);
+typedef bool (*MemoryAllEqualToPatternFunc)(const void* src,
+                                            const void* pattern,
+                                            size_t pattern_size, size_t n);
+
+// A 16-byte pattern, e.g. a broadcast XMM constant. All benchmarked sizes are
+// multiples of this.
+alignas(sizeof(uint64_t)) const uint8_t test_pattern[16] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
 
 bool BcmpAdaptor(const void* s1, const void* s2, size_t n) {
   return bcmp(s1, s2, n) == 0;
@@ -347,6 +357,19 @@ void AllEqualToZeroOneIteration(MemoryAllEqualToFunc func, size_t size) {
   func(test_buffer_1, 0, size);
 }
 
+// Fills size bytes of a test buffer with copies of the test pattern.
+void SetPatternOneIteration(MemorySetPatternFunc func, size_t size) {
+  func(test_buffer_1, test_pattern, sizeof(test_pattern), size);
+}
+
+// Checks that size bytes of a test buffer are copies of the test pattern.
+void AllEqualToPatternOneIteration(MemoryAllEqualToPatternFunc func,
+                                   size_t size) {
+  bool result = func(test_buffer_1, test_pattern, sizeof(test_pattern), size);
+  asm volatile("" : : "m"(result));
+  CHECK(result);
+}
+
 int BenchmarkMain() {
   // Measures bandwidth in byte pairs compared per second for a memory
   // comparison function. The actual memory bandwidth is about double of that
@@ -390,6 +413,17 @@ int BenchmarkMain() {
   RunBenchmark(AllEqualToZeroOneIteration, "MemAllEqualToZero", MemAllEqualTo,
                /*should_memset=*/true, /*memset_value=*/0);
 
+  // Measures bandwidth in bytes set per second when restoring a pattern run.
+  // Compare with MemCopy above, which restores the same bytes stored raw.
+  RunBenchmark(SetPatternOneIteration, "MemSetPattern", MemSetPattern);
+
+  // Measures bandwidth in bytes processed per second when verifying a pattern
+  // run. Compare with MemEq above.
+  MemSetPattern(test_buffer_1, test_pattern, sizeof(test_pattern),
+                BUFFER_SIZE);
+  RunBenchmark(AllEqualToPatternOneIteration, "MemAllEqualToPattern",
+               MemAllEqualToPattern);
+
   return 0;
 }
 
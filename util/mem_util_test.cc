@@ -233,6 +233,61 @@ TEST(MemAllEqualTo, BasicTest) {
   }
 }
 
+TEST(MemSetPattern, BasicTest) {
+  TestBuffer buffer;
+  alignas(sizeof(uint64_t)) char pattern[3 * sizeof(uint64_t)];
+  for (size_t i = 0; i < sizeof(pattern); ++i) {
+    pattern[i] = i + 1;
+  }
+
+  auto MemSetPatternTestHelper = [&buffer, &pattern](size_t pattern_size,
+                                                     size_t offset) {
+    buffer.Reset();
+    const size_t size = pattern_size * 4;
+    char* ptr = buffer.AllocateCopyBuffer(size, offset);
+    MemSetPattern(ptr, pattern, pattern_size, size);
+    for (size_t i = 0; i < size; ++i) {
+      CHECK_EQ(ptr[i], pattern[i % pattern_size]);
+    }
+    CHECK(MemAllEqualToPattern(ptr, pattern, pattern_size, size));
+    // Check no overwrite.
+    CHECK_EQ(ptr[-1], 0);
+    CHECK_EQ(ptr[size], 0);
+  };
+
+  // Address and pattern size are aligned.
+  MemSetPatternTestHelper(sizeof(uint64_t), 0);
+  MemSetPatternTestHelper(sizeof(pattern), 0);
+  // Only pattern size is aligned.
+  MemSetPatternTestHelper(sizeof(uint64_t), 1);
+  // Only address is aligned.
+  MemSetPatternTestHelper(sizeof(uint64_t) - 1, 0);
+}
+
+TEST(MemAllEqualToPattern, BasicTest) {
+  TestBuffer buffer;
+  alignas(sizeof(uint64_t)) char pattern[2 * sizeof(uint64_t)];
+  for (size_t i = 0; i < sizeof(pattern); ++i) {
+    pattern[i] = 0xa0 + i;
+  }
+
+  constexpr size_t kOffsets[] = {0, 1};
+  for (size_t offset : kOffsets) {
+    const size_t size = sizeof(pattern) * 4;
+    char* ptr = buffer.AllocateCopyBuffer(size, offset);
+    for (size_t i = 0; i < size; ++i) {
+      ptr[i] = pattern[i % sizeof(pattern)];
+    }
+    CHECK(MemAllEqualToPattern(ptr, pattern, sizeof(pattern), size));
+    // A different pattern of the same bytes does not match.
+    CHECK(!MemAllEqualToPattern(ptr, pattern + sizeof(uint64_t),
+                                sizeof(uint64_t), size));
+
+    ptr[size - 1] ^= 0xff;
+    CHECK(!MemAllEqualToPattern(ptr, pattern, sizeof(pattern), size));
+  }
+}
+
 }  // namespace
 }  // namespace silifuzz
 
@@ -244,4 +299,6 @@ NOLIBC_TEST_MAIN({
   RUN_TEST(MemCopy, BasicTest);
   RUN_TEST(MemSet, BasicTest);
   RUN_TEST(MemAllEqualTo, BasicTest);
+  RUN_TEST(MemSetPattern, BasicTest);
+  RUN_TEST(MemAllEqualToPattern, BasicTest);
 })
@@ -39,6 +39,19 @@
 // AMX tile configuration and tiles.
 #define X86_REG_GROUP_AMX 0x10
 
+// XSAVE state component bits, as used in XCR0 and XINUSE. These are not
+// register groups but are used by code saving register groups to tell which
+// components are in their initial configuration.
+
+// k0-k7
+#define X86_XSTATE_OPMASK 0x20
+
+// Upper 256 bits of zmm0-zmm15
+#define X86_XSTATE_ZMM_HI256 0x40
+
+// zmm16-zmm31
+#define X86_XSTATE_HI16_ZMM 0x80
+
 // ------------------------ AArch64 register groups --------------------------
 #define AARCH64_REG_GROUP_GPR 0x1
 #define AARCH64_REG_GROUP_FPR 0x2
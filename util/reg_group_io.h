@@ -66,6 +66,13 @@ struct RegisterGroupIOBuffer<X86_64> {
   // Groups not listed above are not supported yet and ignored.
   // TODO(dougkwan): Support more register groups.
   RegisterGroupSet<X86_64> register_groups;
+
+  // XSAVE state components that may not be in their initial configuration
+  // when registers were saved, as reported by XGETBV with ECX=1. Registers of
+  // components known to be in their initial configuration are all zeros.
+  // These are not stored and their contents in the buffer are undefined.
+  // All bits are set if the CPU cannot report this.
+  uint64_t xinuse;
   __m256 ymm[kNumYmms];
   __m512 zmm[kNumZmms];
   uint64_t opmask[kNumOpmasks];
@@ -76,6 +83,8 @@ struct RegisterGroupIOBuffer<X86_64> {
 // here the offsets are correct.
 static_assert(REGISTER_GROUP_IO_BUFFER_REGISTER_GROUPS_OFFSET ==
               offsetof(RegisterGroupIOBuffer<X86_64>, register_groups));
+static_assert(REGISTER_GROUP_IO_BUFFER_XINUSE_OFFSET ==
+              offsetof(RegisterGroupIOBuffer<X86_64>, xinuse));
 static_assert(REGISTER_GROUP_IO_BUFFER_YMM_OFFSET ==
               offsetof(RegisterGroupIOBuffer<X86_64>, ymm));
 static_assert(REGISTER_GROUP_IO_BUFFER_ZMM_OFFSET ==
@@ -92,6 +92,11 @@ absl::Status Subprocess::Start(const std::vector<std::string>& argv) {
     if (options_.parent_death_signal_ > 0) {
       CHECK_EQ(prctl(PR_SET_PDEATHSIG, options_.parent_death_signal_), 0);
     }
+    if (options_.cgroup_procs_fd_ != -1) {
+      // Writing "0" migrates the writing process. Ignore errors, the parent
+      // accounts for runners that did not make it into the cgroup.
+      (void)write(options_.cgroup_procs_fd_, "0", 1);
+    }
     dup2(stdout_pipe[1], STDOUT_FILENO);
     switch (options_.map_stderr_) {
       case kNoMapping:
@@ -88,6 +88,15 @@ class Subprocess {
       return *this;
     }
 
+    // Moves the subprocess into the cgroup whose cgroup.procs file is open
+    // for writing as `fd` before exec'ing the binary. The caller retains
+    // ownership of `fd`. A failed migration is not fatal: the subprocess
+    // then stays in the parent's cgroup.
+    Options& SetCgroupProcsFd(int fd) {
+      cgroup_procs_fd_ = fd;
+      return *this;
+    }
+
    private:
     friend class Subprocess;  // for rlimit_tuples_ and itimer_vals_ access.
 
@@ -102,6 +111,9 @@ class Subprocess {
     // process dies.
     int parent_death_signal_ = 0;
 
+    // If not -1, an FD of a cgroup.procs file to join before exec.
+    int cgroup_procs_fd_ = -1;
+
     // Represents setrlimit(2) args.
     struct RLimitTuple {
       int resource = 0;
@@ -17,6 +17,7 @@
 #include <signal.h>
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include <cstdio>
 #include <cstdlib>
@@ -127,6 +128,23 @@ TEST(Subprocess, DisableAslr) {
   ASSERT_EQ(stdout1, stdout2);
 }
 
+TEST(Subprocess, CgroupProcsFd) {
+  // A pipe stands in for cgroup.procs, it receives what the child writes.
+  int procs[2] = {-1, -1};
+  ASSERT_EQ(pipe(procs), 0);
+  Subprocess::Options opts = Subprocess::Options::Default();
+  opts.SetCgroupProcsFd(procs[1]);
+  Subprocess sp(opts);
+  ASSERT_OK(sp.Start({"/bin/true"}));
+  std::string stdout;
+  ASSERT_EQ(sp.Communicate(&stdout).status, 0);
+  close(procs[1]);
+  char buf[8] = {};
+  ASSERT_EQ(read(procs[0], buf, sizeof(buf)), 1);
+  EXPECT_EQ(buf[0], '0');
+  close(procs[0]);
+}
+
 TEST(Subprocess, ParentDeath) {
   Subprocess::Options opts = Subprocess::Options::Default();
   opts.SetParentDeathSignal(SIGKILL);
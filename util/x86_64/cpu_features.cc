@@ -81,6 +81,15 @@ uint64_t GetX86CPUFeatures() {
   if (IsBitSet(cpuid_result.edx, 24)) {
     features |= X86CPUFeatureBitmask(X86CPUFeatures::kAMX_TILE);
   }
+
+  // Leaf 0xd is only valid if XSAVE is supported.
+  if ((features & X86CPUFeatureBitmask(X86CPUFeatures::kXSAVE)) != 0) {
+    X86CPUID(0xd, 1, &cpuid_result);
+    // CPUID.(EAX=0xd,ECX=1):EAX.XGETBV1[bit 2]
+    if (IsBitSet(cpuid_result.eax, 2)) {
+      features |= X86CPUFeatureBitmask(X86CPUFeatures::kXGETBV1);
+    }
+  }
   return features;
 }
 
@@ -68,6 +68,10 @@ void load_zmm_registers(const __m512* buffer);
 // a size of 2 KiB.
 void save_zmm_registers(__m512* buffer);
 
+// Saves AVX-512 registers zmm0-zmm15. 'buffer' must be 64-byte aligned and
+// have a size of 1 KiB.
+void save_lower_zmm_registers(__m512* buffer);
+
 // Sets AVX-512 registers zmm0-zmm31 to zeros.
 void clear_zmm_registers();
 
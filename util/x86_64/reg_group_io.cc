@@ -17,10 +17,13 @@
 #include <stdint.h>
 #include <x86intrin.h>
 
+#include <cstddef>
+
 #include "./util/arch.h"
 #include "./util/cpu_features.h"
 #include "./util/crc32c.h"
 #include "./util/reg_checksum.h"
+#include "./util/reg_group_bits.h"
 #include "./util/reg_group_set.h"
 
 namespace silifuzz {
@@ -29,9 +32,17 @@ namespace silifuzz {
 // save_registers_groups_to_buffer and set by InitRegisterGroupIO.
 extern "C" bool reg_group_io_opmask_is_64_bit;
 
+// Flag to tell if XINUSE can be read using XGETBV.  This is defined in
+// save_registers_groups_to_buffer and set by InitRegisterGroupIO.
+extern "C" bool reg_group_io_has_xgetbv1;
+
 void InitRegisterGroupIO() {
   // SaveRegisterGroupsToBuffer() needs to tell if AVX512BW is supported.
   reg_group_io_opmask_is_64_bit = HasX86CPUFeature(X86CPUFeatures::kAVX512BW);
+
+  // XGETBV raises #UD unless the OS has enabled XSAVE.
+  reg_group_io_has_xgetbv1 = HasX86CPUFeature(X86CPUFeatures::kOSXSAVE) &&
+                             HasX86CPUFeature(X86CPUFeatures::kXGETBV1);
 }
 
 // Computes a CRC32C checksum of registers groups in 'buffer'.
@@ -46,6 +57,10 @@ void InitRegisterGroupIO() {
 // according to register number ordering.  For example, the LSB of zmm0 is
 // read first and the MSB of zmm31 is read last when checksumming AVX512
 // registers.
+//
+// Registers of XSAVE state components that are not in use according to
+// buffer.xinuse are not stored in 'buffer'. These are checksummed as zeros
+// so that the result does not depend on whether XINUSE is available.
 RegisterChecksum<X86_64> GetRegisterGroupsChecksum(
     const RegisterGroupIOBuffer<X86_64>& buffer) {
   uint32_t crc = 0;
@@ -59,10 +74,22 @@ RegisterChecksum<X86_64> GetRegisterGroupsChecksum(
   }
 
   if (groups.GetAVX512()) {
+    constexpr size_t kLowerZmmSize = sizeof(buffer.zmm) / 2;
     crc = crc32c(crc, reinterpret_cast<const uint8_t*>(buffer.zmm),
-                 sizeof(buffer.zmm));
-    crc = crc32c(crc, reinterpret_cast<const uint8_t*>(buffer.opmask),
-                 sizeof(buffer.opmask));
+                 kLowerZmmSize);
+    if ((buffer.xinuse & X86_XSTATE_HI16_ZMM) != 0) {
+      crc = crc32c(crc,
+                   reinterpret_cast<const uint8_t*>(buffer.zmm) + kLowerZmmSize,
+                   sizeof(buffer.zmm) - kLowerZmmSize);
+    } else {
+      crc = crc32c_zero_extend(crc, sizeof(buffer.zmm) - kLowerZmmSize);
+    }
+    if ((buffer.xinuse & X86_XSTATE_OPMASK) != 0) {
+      crc = crc32c(crc, reinterpret_cast<const uint8_t*>(buffer.opmask),
+                   sizeof(buffer.opmask));
+    } else {
+      crc = crc32c_zero_extend(crc, sizeof(buffer.opmask));
+    }
     register_checksum.register_groups.SetAVX512(true);
   }
 
@@ -18,6 +18,7 @@
 // Offsets of data members of RegisterGroupIOBuffer.  These are used by
 // assembly functions.
 #define REGISTER_GROUP_IO_BUFFER_REGISTER_GROUPS_OFFSET 0
+#define REGISTER_GROUP_IO_BUFFER_XINUSE_OFFSET 8
 #define REGISTER_GROUP_IO_BUFFER_YMM_OFFSET 32
 #define REGISTER_GROUP_IO_BUFFER_ZMM_OFFSET 576
 #define REGISTER_GROUP_IO_BUFFER_OPMASK_OFFSET 2624
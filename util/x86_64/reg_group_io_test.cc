@@ -25,6 +25,7 @@
 #include "./util/crc32c.h"
 #include "./util/nolibc_gunit.h"
 #include "./util/reg_checksum.h"
+#include "./util/reg_group_bits.h"
 #include "./util/reg_group_set.h"
 #include "./util/reg_groups.h"
 
@@ -36,6 +37,8 @@ extern "C" void SaveAVXTestDataToRegisterGroupsBuffer(
 extern "C" void SaveAVX512TestDataToRegisterGroupsBuffer(
     const __m512*, const uint64_t*, bool opmask_is_64_bit,
     RegisterGroupIOBuffer<X86_64>&);
+extern "C" void SaveAVX512InitStateTestDataToRegisterGroupsBuffer(
+    const __m512*, RegisterGroupIOBuffer<X86_64>&);
 
 void FillTestPattern(uint8_t* buffer, size_t size) {
   for (size_t i = 0; i < size; ++i) {
@@ -100,6 +103,51 @@ TEST(RegisterGroupIO, AVX512Checksum) {
   CHECK_EQ(register_checksum.checksum, expected_crc);
 }
 
+// Checks that AVX-512 only state components in their initial configuration
+// are checksummed as zeros even when they are not saved.
+TEST(RegisterGroupIO, AVX512InitStateChecksum) {
+  InitRegisterGroupIO();
+  RegisterGroupSet<X86_64> all_register_groups =
+      GetCurrentPlatformChecksumRegisterGroups();
+  if (!all_register_groups.GetAVX512()) return;
+
+  RegisterGroupIOBuffer<X86_64> buffer;
+  // Fill with junk so that skipped registers do not happen to be zeros.
+  memset(&buffer, 0xff, sizeof(buffer));
+  buffer.register_groups = RegisterGroupSet<X86_64>().SetAVX512(true);
+
+  constexpr size_t kNumZmms = 32;
+  constexpr size_t kNumOpmasks = 8;
+  __m512 zmm[kNumZmms];
+  uint64_t opmask[kNumOpmasks];
+  FillTestPattern(reinterpret_cast<uint8_t*>(zmm), sizeof(zmm));
+  SaveAVX512InitStateTestDataToRegisterGroupsBuffer(zmm, buffer);
+
+  // With XINUSE available, the cleared components must have been skipped and
+  // their part of the buffer left untouched.
+  if (HasX86CPUFeature(X86CPUFeatures::kXGETBV1)) {
+    CHECK_EQ(buffer.xinuse & (X86_XSTATE_HI16_ZMM | X86_XSTATE_OPMASK), 0);
+    const uint8_t* skipped =
+        reinterpret_cast<const uint8_t*>(&buffer.zmm[kNumZmms / 2]);
+    const size_t skipped_size = sizeof(buffer.zmm) / 2 + sizeof(buffer.opmask);
+    for (size_t i = 0; i < skipped_size; ++i) {
+      CHECK_EQ(skipped[i], 0xff);
+    }
+  }
+
+  // zmm16-zmm31 and k0-k7 are cleared by ClearAVX512OnlyState().
+  memset(&zmm[kNumZmms / 2], 0, sizeof(zmm) / 2);
+  memset(opmask, 0, sizeof(opmask));
+  uint32_t expected_crc =
+      crc32c(0, reinterpret_cast<const uint8_t*>(zmm), sizeof(zmm));
+  expected_crc = crc32c(expected_crc, reinterpret_cast<const uint8_t*>(opmask),
+                        sizeof(opmask));
+
+  RegisterChecksum<X86_64> register_checksum =
+      GetRegisterGroupsChecksum(buffer);
+  CHECK_EQ(register_checksum.checksum, expected_crc);
+}
+
 }  // namespace
 }  // namespace silifuzz
 
@@ -108,4 +156,5 @@ TEST(RegisterGroupIO, AVX512Checksum) {
 NOLIBC_TEST_MAIN({
   RUN_TEST(RegisterGroupIO, AVXChecksum);
   RUN_TEST(RegisterGroupIO, AVX512Checksum);
+  RUN_TEST(RegisterGroupIO, AVX512InitStateChecksum);
 })